@@ -0,0 +1,365 @@
+/*! \file
+ *  \brief Benchmark of the derivatives from automatic differentiation
+ *
+ * Implements MassConstraint and JetFitObject a second time, as value
+ * functions with AutoDiffParticleConstraint and AutoDiffParticleFitObject,
+ * and writes the constraints a third time as ExpressionConstraint,
+ * and compares them with the hand-written classes on a set of jets
+ * with a fixed seed: a W mass constraint on two jets and an equal mass
+ * constraint on two triplets of jets, as in TopEventILC.
+ *
+ * Usage:
+ * \code
+ * adbench [-n ncalls] [-r nrep] [-s seed] [-v 1]
+ * \endcode
+ *
+ * For each quantity the hand-written (hand), the AD (ad) and the expression
+ * (dsl) version are called ncalls times, nrep times, and the median time
+ * per call is reported. The dsl version uses the hand-written jets.
+ * Quantities:
+ * - jet_derivatives: recalculate the cache of the six jets and get all first
+ *   and second derivatives of E, px, py, pz w.r.t. the jet parameters
+ * - wmass_1st, topmass_1st: derivatives of the constraint w.r.t. all
+ *   parameters (getDerivatives)
+ * - wmass_2nd, topmass_2nd: second derivatives of the constraint,
+ *   added to the global matrix (add2ndDerivativesToMatrix)
+ * Columns of the output, one line per quantity and version:
+ * - ns_per_call: median time per call in ns
+ * - over_hand: time relative to the hand-written version
+ * - max_abs_diff, max_rel_diff: largest absolute and relative difference
+ *   of all values computed by this and the hand-written version
+ *
+ * With -v 1 the numerical checks test1stDerivatives and test2ndDerivatives
+ * of the AD and expression constraints are run as well.
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ * - 16.10.2026 Added the ExpressionConstraint version
+ *
+ */
+
+#include "AutoDiffParticleConstraint.h"
+#include "AutoDiffParticleFitObject.h"
+#include "ExpressionConstraint.h"
+#include "MassConstraint.h"
+#include "JetFitObject.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <time.h>
+
+#undef NDEBUG
+#include <cassert>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+/// MassConstraint as a value function
+class ADMassConstraint: public AutoDiffParticleConstraint<ADMassConstraint> {
+  public:
+    ADMassConstraint (double mass_ = 0): mass (mass_) {}
+
+    /// Mass of the fit objects with flag 1 minus mass of those with other flags, minus mass
+    template <class T>
+    T evaluate (const T p[]) const {
+      T tot[2][4];
+      for (int index = 0; index < 2; ++index) {
+        for (int ii = 0; ii < 4; ++ii) tot[index][ii] = T (0);
+      }
+      for (unsigned int k = 0; k < fitobjects.size(); ++k) {
+        int index = (flags[k] == 1) ? 0 : 1;
+        for (int ii = 0; ii < 4; ++ii) tot[index][ii] += p[4*k+ii];
+      }
+      return invariantMass (tot[0]) - invariantMass (tot[1]) - mass;
+    }
+
+  protected:
+    /// Invariant mass of a four-vector; an empty set of fit objects has mass 0 and no derivatives
+    template <class T>
+    static T invariantMass (const T tot[4]) {
+      using std::sqrt;
+      using std::abs;
+      T m2 = tot[0]*tot[0] - tot[1]*tot[1] - tot[2]*tot[2] - tot[3]*tot[3];
+      return m2 != 0 ? sqrt (abs (m2)) : T (0);
+    }
+
+    double mass;
+};
+
+/// JetFitObject as a value function
+class ADJetFitObject: public AutoDiffParticleFitObject<ADJetFitObject, 3> {
+  public:
+    ADJetFitObject (double E, double theta, double phi,
+                    double DE, double Dtheta, double Dphi,
+                    double m = 0) {
+      initCov();
+      setMass (m);
+      setParam (0, E, true);
+      setParam (1, theta, true);
+      setParam (2, phi, true);
+      setMParam (0, E);
+      setMParam (1, theta);
+      setMParam (2, phi);
+      setError (0, DE);
+      setError (1, Dtheta);
+      setError (2, Dphi);
+      paramCycl[2] = 2.*M_PI;
+      invalidateCache();
+    }
+
+    virtual ADJetFitObject *copy() const {return new ADJetFitObject (*this);}
+
+    virtual ADJetFitObject& assign (const BaseFitObject& source) {
+      if (dynamic_cast<const ADJetFitObject *>(&source)) {
+        if (&source != this) ParticleFitObject::assign (source);
+      }
+      else {
+        assert (0);
+      }
+      return *this;
+    }
+
+    virtual const char *getParamName (int ilocal) const {
+      switch (ilocal) {
+        case 0: return "E";
+        case 1: return "theta";
+        case 2: return "phi";
+      }
+      return "undefined";
+    }
+
+    /// E, px, py, pz from E, theta, phi
+    template <class T>
+    void evaluate (const T par[], T meta[4]) const {
+      using std::sqrt;
+      using std::abs;
+      using std::sin;
+      using std::cos;
+      T p = sqrt (abs (par[0]*par[0] - mass*mass));
+      T pt = p*sin (par[1]);
+      meta[0] = par[0];
+      meta[1] = pt*cos (par[2]);
+      meta[2] = pt*sin (par[2]);
+      meta[3] = p*cos (par[1]);
+    }
+};
+
+enum {NJETS = 6, IDIM = 3*NJETS};
+
+// wall clock time in seconds
+static double now () {
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1E-9*ts.tv_nsec;
+}
+
+// largest absolute and relative differences of two arrays
+struct Diff {
+  Diff (): maxabs (0), maxrel (0) {}
+  void add (const double *a, const double *b, int n) {
+    for (int i = 0; i < n; ++i) {
+      double d = std::abs (a[i] - b[i]);
+      double scale = std::max (std::abs (a[i]), std::abs (b[i]));
+      if (d > maxabs) maxabs = d;
+      if (scale > 0 && d/scale > maxrel) maxrel = d/scale;
+    }
+  }
+  double maxabs, maxrel;
+};
+
+// the hand-written or the AD version of the jets and constraints
+struct Setup {
+  std::vector<ParticleFitObject *> jets;
+  BaseHardConstraint *wmass;
+  BaseHardConstraint *topmass;
+  double M[IDIM*IDIM];
+  double der[IDIM];
+};
+
+static void setupConstraints (Setup& s, BaseHardConstraint *wmass, BaseHardConstraint *topmass) {
+  static const char *jetname[NJETS] = {"j1", "j2", "j3", "j4", "j5", "j6"};
+  s.wmass = wmass;
+  s.topmass = topmass;
+  wmass->setName ("wmass");
+  topmass->setName ("topmass");
+  for (int i = 0; i < NJETS; ++i) {
+    s.jets[i]->setName (jetname[i]);
+    for (int ilocal = 0; ilocal < 3; ++ilocal) s.jets[i]->setGlobalParNum (ilocal, 3*i + ilocal);
+  }
+  ParticleConstraint *w = dynamic_cast<ParticleConstraint *>(wmass);
+  ParticleConstraint *t = dynamic_cast<ParticleConstraint *>(topmass);
+  assert (w && t);
+  w->addToFOList (*s.jets[0]);
+  w->addToFOList (*s.jets[1]);
+  for (int i = 0; i < NJETS; ++i) t->addToFOList (*s.jets[i], i < 3 ? 1 : 2);
+}
+
+enum {JET_DERIVATIVES, WMASS_1ST, WMASS_2ND, TOPMASS_1ST, TOPMASS_2ND, NQUANTITIES};
+
+static const char *quantityname[NQUANTITIES] = {"jet_derivatives", "wmass_1st", "wmass_2nd", "topmass_1st", "topmass_2nd"};
+
+enum {HAND, AD, DSL, NVERSIONS};
+
+static const char *versionname[NVERSIONS] = {"hand", "ad", "dsl"};
+
+// calculate quantity iq, return the number of values in out
+static int calculate (Setup& s, int iq, double *out) {
+  int n = 0;
+  switch (iq) {
+    case JET_DERIVATIVES:
+      for (int i = 0; i < NJETS; ++i) {
+        const ParticleFitObject *jet = s.jets[i];
+        jet->invalidateCache();
+        for (int iMeta = 0; iMeta < 4; ++iMeta) {
+          for (int ilocal = 0; ilocal < 3; ++ilocal) {
+            out[n++] = jet->getFirstDerivative_Meta_Local (iMeta, ilocal, 0);
+            for (int jlocal = ilocal; jlocal < 3; ++jlocal) {
+              out[n++] = jet->getSecondDerivative_Meta_Local (iMeta, ilocal, jlocal, 0);
+            }
+          }
+        }
+      }
+      return n;
+    case WMASS_1ST:
+    case TOPMASS_1ST: {
+      const BaseHardConstraint *c = (iq == WMASS_1ST) ? s.wmass : s.topmass;
+      for (int i = 0; i < IDIM; ++i) s.der[i] = 0;
+      c->getDerivatives (IDIM, s.der);
+      out[0] = c->getValue();
+      for (int i = 0; i < IDIM; ++i) out[1+i] = s.der[i];
+      return 1 + IDIM;
+    }
+    case WMASS_2ND:
+    case TOPMASS_2ND: {
+      const BaseHardConstraint *c = (iq == WMASS_2ND) ? s.wmass : s.topmass;
+      for (int i = 0; i < IDIM*IDIM; ++i) s.M[i] = 0;
+      c->add2ndDerivativesToMatrix (s.M, IDIM, 1.);
+      for (int i = 0; i < IDIM*IDIM; ++i) out[i] = s.M[i];
+      return IDIM*IDIM;
+    }
+  }
+  return 0;
+}
+
+// median time per call of quantity iq in ns
+static double timeQuantity (Setup& s, int iq, int ncalls, int nrep, double *out) {
+  std::vector<double> times;
+  for (int irep = 0; irep < nrep; ++irep) {
+    double start = now();
+    for (int icall = 0; icall < ncalls; ++icall) calculate (s, iq, out);
+    times.push_back (now() - start);
+  }
+  std::sort (times.begin(), times.end());
+  return 1E9*times[nrep/2]/ncalls;
+}
+
+static void usage (const char *prog) {
+  cerr << "usage: " << prog << " [-n ncalls] [-r nrep] [-s seed] [-v 1]\n"
+       << "  -n  number of calls per repetition (default 100000)\n"
+       << "  -r  number of repetitions, the median time is reported (default 5)\n"
+       << "  -s  seed of the jet parameters (default 4357)\n"
+       << "  -v  1: run the numerical derivative checks of the AD constraints (default 0)\n";
+}
+
+int main (int argc, char **argv) {
+  int ncalls = 100000;
+  int nrep = 5;
+  long seed = 4357;
+  int verify = 0;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string opt (argv[i]);
+    if (i+1 >= argc || opt.size() != 2 || opt[0] != '-') {
+      usage (argv[0]);
+      return 1;
+    }
+    const char *arg = argv[++i];
+    switch (opt[1]) {
+      case 'n': ncalls = std::atoi (arg); break;
+      case 'r': nrep = std::atoi (arg); break;
+      case 's': seed = std::atol (arg); break;
+      case 'v': verify = std::atoi (arg); break;
+      default:
+        usage (argv[0]);
+        return 1;
+    }
+  }
+  if (ncalls <= 0 || nrep <= 0) {
+    usage (argv[0]);
+    return 1;
+  }
+
+  // the same jets for all versions
+  Setup setups[NVERSIONS];
+  Setup& hand = setups[HAND];
+  Setup& ad = setups[AD];
+  Setup& dsl = setups[DSL];
+  srand48 (seed);
+  for (int i = 0; i < NJETS; ++i) {
+    double E     = 20 + 130*drand48();
+    double theta = 0.3 + (M_PI - 0.6)*drand48();
+    double phi   = M_PI*(2*drand48() - 1);
+    double m     = 10*drand48();
+    hand.jets.push_back (new JetFitObject (E, theta, phi, 0.1*E, 0.1, 0.1, m));
+    ad.jets.push_back (new ADJetFitObject (E, theta, phi, 0.1*E, 0.1, 0.1, m));
+    dsl.jets.push_back (new JetFitObject (E, theta, phi, 0.1*E, 0.1, 0.1, m));
+  }
+  setupConstraints (hand, new MassConstraint (80.4), new MassConstraint (0.));
+  setupConstraints (ad, new ADMassConstraint (80.4), new ADMassConstraint (0.));
+  {
+    using namespace ConstraintDSL;
+    MomentumSum j1 = particle (0), j2 = particle (1), j3 = particle (2),
+                j4 = particle (3), j5 = particle (4), j6 = particle (5);
+    setupConstraints (dsl, newHardConstraint (mass (j1+j2) - 80.4),
+                           newHardConstraint (mass (j1+j2+j3) - mass (j4+j5+j6)));
+  }
+
+  if (verify) {
+    for (int iv = AD; iv < NVERSIONS; ++iv) {
+      setups[iv].wmass->test1stDerivatives();
+      setups[iv].wmass->test2ndDerivatives();
+      setups[iv].topmass->test1stDerivatives();
+      setups[iv].topmass->test2ndDerivatives();
+    }
+  }
+
+  cout << "quantity,version,ncalls,nrep,ns_per_call,over_hand,max_abs_diff,max_rel_diff" << endl;
+
+  std::vector<double> outhand (IDIM*IDIM), out (IDIM*IDIM);
+  for (int iq = 0; iq < NQUANTITIES; ++iq) {
+    int n = calculate (hand, iq, &outhand[0]);
+    double thand = 0;
+    for (int iv = 0; iv < NVERSIONS; ++iv) {
+      // the dsl version has no jets of its own
+      if (iv == DSL && iq == JET_DERIVATIVES) continue;
+      int nv = calculate (setups[iv], iq, &out[0]);
+      assert (nv == n);
+      Diff diff;
+      diff.add (&outhand[0], &out[0], n);
+
+      double t = timeQuantity (setups[iv], iq, ncalls, nrep, &out[0]);
+      if (iv == HAND) thand = t;
+
+      cout << quantityname[iq] << ","
+           << versionname[iv] << ","
+           << ncalls << ","
+           << nrep << ","
+           << t << ","
+           << (thand > 0 ? t/thand : 0) << ","
+           << diff.maxabs << ","
+           << diff.maxrel << endl;
+    }
+  }
+
+  for (int iv = 0; iv < NVERSIONS; ++iv) {
+    for (int i = 0; i < NJETS; ++i) delete setups[iv].jets[i];
+    delete setups[iv].wmass;
+    delete setups[iv].topmass;
+  }
+  return 0;
+}
@@ -0,0 +1,230 @@
+/*! \file
+ *  \brief Benchmark of the chain rule kernels of the second derivatives
+ *
+ * Compares the implementations of ChainRuleKernels (scalar and, if the CPU
+ * supports it, AVX) on random derivatives, and on the second derivatives
+ * of constraints on a set of jets with a fixed seed: a W mass constraint
+ * on two jets and an equal mass constraint on two triplets of jets,
+ * as in TopEventILC, as hard constraints and as soft constraints
+ * with a Gaussian distribution.
+ *
+ * Usage:
+ * \code
+ * chainrulebench [-n ncalls] [-r nrep] [-s seed]
+ * \endcode
+ *
+ * For each quantity and kernel, the quantity is calculated ncalls times,
+ * nrep times, and the median time per call is reported.
+ * Quantities:
+ * - contract_NxN: ChainRuleKernels::contract for two fit objects
+ *   with N parameters each
+ * - wmass_2nd, topmass_2nd: add2ndDerivativesToMatrix of MassConstraint
+ * - softwmass_2nd, softtopmass_2nd: add2ndDerivativesToMatrix of SoftGaussMassConstraint
+ * Columns of the output, one line per quantity and kernel:
+ * - ns_per_call: median time per call in ns
+ * - over_scalar: time relative to the scalar kernel
+ * - max_abs_diff: largest absolute difference to the result of the scalar kernel
+ *   (the kernels are meant to give identical results)
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#include "ChainRuleKernels.h"
+#include "MassConstraint.h"
+#include "SoftGaussMassConstraint.h"
+#include "JetFitObject.h"
+#include "ScratchArena.h"
+#include "BaseDefs.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <time.h>
+
+#undef NDEBUG
+#include <cassert>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+enum {NJETS = 6, IDIM = 3*NJETS, MAXPAR = BaseDefs::MAXPAR};
+
+// wall clock time in seconds
+static double now () {
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1E-9*ts.tv_nsec;
+}
+
+enum {CONTRACT_3X3, CONTRACT_4X4, CONTRACT_5X5, CONTRACT_10X10,
+      WMASS_2ND, TOPMASS_2ND, SOFTWMASS_2ND, SOFTTOPMASS_2ND, NQUANTITIES};
+
+static const char *quantityname[NQUANTITIES] = {"contract_3x3", "contract_4x4", "contract_5x5", "contract_10x10",
+                                                "wmass_2nd", "topmass_2nd", "softwmass_2nd", "softtopmass_2nd"};
+
+static const int contractsize[4] = {3, 4, 5, 10};
+
+// the input of all quantities
+struct Setup {
+  Setup (): scratch (0) {}
+  double d2GdPidPj[16];
+  double dPidAk[4*MAXPAR];
+  double dPjdAl[4*MAXPAR];
+  std::vector<JetFitObject *> jets;
+  BaseHardConstraint *wmass;
+  BaseHardConstraint *topmass;
+  SoftGaussParticleConstraint *softwmass;
+  SoftGaussParticleConstraint *softtopmass;
+  ScratchArena scratch;
+  double M[IDIM*IDIM];
+};
+
+// calculate quantity iq, return the number of values in out
+static int calculate (Setup& s, int iq, double *out) {
+  switch (iq) {
+    case CONTRACT_3X3:
+    case CONTRACT_4X4:
+    case CONTRACT_5X5:
+    case CONTRACT_10X10: {
+      int n = contractsize[iq - CONTRACT_3X3];
+      ChainRuleKernels::contract (s.d2GdPidPj, s.dPidAk, n, s.dPjdAl, n, out, MAXPAR);
+      return MAXPAR*n;
+    }
+    case WMASS_2ND:
+    case TOPMASS_2ND:
+    case SOFTWMASS_2ND:
+    case SOFTTOPMASS_2ND:
+      for (int i = 0; i < IDIM*IDIM; ++i) s.M[i] = 0;
+      if (iq == WMASS_2ND)       s.wmass->add2ndDerivativesToMatrix (s.M, IDIM, 1., s.scratch);
+      if (iq == TOPMASS_2ND)     s.topmass->add2ndDerivativesToMatrix (s.M, IDIM, 1., s.scratch);
+      if (iq == SOFTWMASS_2ND)   s.softwmass->add2ndDerivativesToMatrix (s.M, IDIM, s.scratch);
+      if (iq == SOFTTOPMASS_2ND) s.softtopmass->add2ndDerivativesToMatrix (s.M, IDIM, s.scratch);
+      for (int i = 0; i < IDIM*IDIM; ++i) out[i] = s.M[i];
+      return IDIM*IDIM;
+  }
+  return 0;
+}
+
+// median time per call of quantity iq in ns
+static double timeQuantity (Setup& s, int iq, int ncalls, int nrep, double *out) {
+  std::vector<double> times;
+  for (int irep = 0; irep < nrep; ++irep) {
+    double start = now();
+    for (int icall = 0; icall < ncalls; ++icall) calculate (s, iq, out);
+    times.push_back (now() - start);
+  }
+  std::sort (times.begin(), times.end());
+  return 1E9*times[nrep/2]/ncalls;
+}
+
+static void usage (const char *prog) {
+  cerr << "usage: " << prog << " [-n ncalls] [-r nrep] [-s seed]\n"
+       << "  -n  number of calls per repetition (default 100000)\n"
+       << "  -r  number of repetitions, the median time is reported (default 5)\n"
+       << "  -s  seed of the jet parameters and derivatives (default 4357)\n";
+}
+
+int main (int argc, char **argv) {
+  int ncalls = 100000;
+  int nrep = 5;
+  long seed = 4357;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string opt (argv[i]);
+    if (i+1 >= argc || opt.size() != 2 || opt[0] != '-') {
+      usage (argv[0]);
+      return 1;
+    }
+    const char *arg = argv[++i];
+    switch (opt[1]) {
+      case 'n': ncalls = std::atoi (arg); break;
+      case 'r': nrep = std::atoi (arg); break;
+      case 's': seed = std::atol (arg); break;
+      default:
+        usage (argv[0]);
+        return 1;
+    }
+  }
+  if (ncalls <= 0 || nrep <= 0) {
+    usage (argv[0]);
+    return 1;
+  }
+
+  Setup s;
+  srand48 (seed);
+  for (int i = 0; i < 16; ++i) s.d2GdPidPj[i] = 2*drand48() - 1;
+  for (int i = 0; i < 4*MAXPAR; ++i) s.dPidAk[i] = 2*drand48() - 1;
+  for (int i = 0; i < 4*MAXPAR; ++i) s.dPjdAl[i] = 2*drand48() - 1;
+
+  static const char *jetname[NJETS] = {"j1", "j2", "j3", "j4", "j5", "j6"};
+  for (int i = 0; i < NJETS; ++i) {
+    double E     = 20 + 130*drand48();
+    double theta = 0.3 + (M_PI - 0.6)*drand48();
+    double phi   = M_PI*(2*drand48() - 1);
+    double m     = 10*drand48();
+    s.jets.push_back (new JetFitObject (E, theta, phi, 0.1*E, 0.1, 0.1, m));
+    s.jets[i]->setName (jetname[i]);
+    for (int ilocal = 0; ilocal < 3; ++ilocal) s.jets[i]->setGlobalParNum (ilocal, 3*i + ilocal);
+  }
+  MassConstraint *wmass = new MassConstraint (80.4);
+  MassConstraint *topmass = new MassConstraint (0.);
+  SoftGaussMassConstraint *softwmass = new SoftGaussMassConstraint (2.1, 80.4);
+  SoftGaussMassConstraint *softtopmass = new SoftGaussMassConstraint (1.5, 0.);
+  wmass->addToFOList (*s.jets[0]);
+  wmass->addToFOList (*s.jets[1]);
+  softwmass->addToFOList (*s.jets[0]);
+  softwmass->addToFOList (*s.jets[1]);
+  for (int i = 0; i < NJETS; ++i) {
+    topmass->addToFOList (*s.jets[i], i < 3 ? 1 : 2);
+    softtopmass->addToFOList (*s.jets[i], i < 3 ? 1 : 2);
+  }
+  s.wmass = wmass;
+  s.topmass = topmass;
+  s.softwmass = softwmass;
+  s.softtopmass = softtopmass;
+
+  std::vector<ChainRuleKernels::Kernel> kernels;
+  kernels.push_back (ChainRuleKernels::SCALAR);
+  if (ChainRuleKernels::isAvailable (ChainRuleKernels::AVX)) kernels.push_back (ChainRuleKernels::AVX);
+
+  cout << "quantity,kernel,ncalls,nrep,ns_per_call,over_scalar,max_abs_diff" << endl;
+
+  std::vector<double> outscalar (IDIM*IDIM), out (IDIM*IDIM);
+  for (int iq = 0; iq < NQUANTITIES; ++iq) {
+    double tscalar = 0;
+    for (unsigned int ik = 0; ik < kernels.size(); ++ik) {
+      bool ok = ChainRuleKernels::setKernel (kernels[ik]);
+      assert (ok);
+      std::fill (out.begin(), out.end(), 0.);
+      int n = calculate (s, iq, &out[0]);
+      if (ik == 0) outscalar = out;
+      double maxabs = 0;
+      for (int i = 0; i < n; ++i) maxabs = std::max (maxabs, std::abs (out[i] - outscalar[i]));
+
+      double t = timeQuantity (s, iq, ncalls, nrep, &out[0]);
+      if (ik == 0) tscalar = t;
+
+      cout << quantityname[iq] << ","
+           << ChainRuleKernels::getKernelName() << ","
+           << ncalls << ","
+           << nrep << ","
+           << t << ","
+           << (tscalar > 0 ? t/tscalar : 0) << ","
+           << maxabs << endl;
+    }
+  }
+  ChainRuleKernels::setKernel (ChainRuleKernels::AUTO);
+
+  for (int i = 0; i < NJETS; ++i) delete s.jets[i];
+  delete wmass;
+  delete topmass;
+  delete softwmass;
+  delete softtopmass;
+  return 0;
+}
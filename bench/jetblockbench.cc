@@ -0,0 +1,185 @@
+/*! \file
+ *  \brief Benchmark of the caches of JetFitObjectBlock
+ *
+ * Compares the calculation of the caches of n jets (sin and cos of theta
+ * and phi, the momentum and its derivatives) by n JetFitObjects,
+ * one at a time, with JetFitObjectBlock (scalar and, if the CPU supports it,
+ * AVX), for random jets with a fixed seed.
+ *
+ * Usage:
+ * \code
+ * jetblockbench [-n ncalls] [-r nrep] [-s seed] [-j njets,...]
+ * \endcode
+ *
+ * For each number of jets and version, the caches of all jets are
+ * invalidated and used again (which calculates them) ncalls times,
+ * nrep times, and the median time is reported.
+ * Columns of the output, one line per number of jets and version:
+ * - ns_per_jet: median time per jet in ns
+ * - over_jetfitobject: time relative to single JetFitObjects
+ * - max_rel_diff: largest relative difference of px, py, pz and their
+ *   derivatives to single JetFitObjects
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ * - 16.10.2026 Jets of the block as ParticleFitObjects
+ *
+ */
+
+#include "JetFitObjectBlock.h"
+#include "JetFitObject.h"
+#include "ChainRuleKernels.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <time.h>
+
+#undef NDEBUG
+#include <cassert>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+// wall clock time in seconds
+static double now () {
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1E-9*ts.tv_nsec;
+}
+
+enum {SINGLE, BLOCK_SCALAR, BLOCK_AVX, NVERSIONS};
+
+static const char *versionname[NVERSIONS] = {"jetfitobject", "block_scalar", "block_avx"};
+
+// invalidate the caches of all jets and use them again, as after a fit iteration;
+// for jets of a block, the first one calculates the caches of all
+static double calculate (std::vector<ParticleFitObject *>& jets) {
+  for (unsigned int i = 0; i < jets.size(); ++i) jets[i]->invalidateCache();
+  double sum = 0;
+  for (unsigned int i = 0; i < jets.size(); ++i) sum += jets[i]->getPx();
+  return sum;
+}
+
+// the cached quantities of a jet that the constraints use
+static void getCache (const ParticleFitObject *jet, double *out) {
+  out[0] = jet->getPx();
+  out[1] = jet->getPy();
+  out[2] = jet->getPz();
+  for (int ilocal = 0; ilocal < 3; ++ilocal) {
+    out[3+3*ilocal] = jet->getDPx (ilocal);
+    out[4+3*ilocal] = jet->getDPy (ilocal);
+    out[5+3*ilocal] = jet->getDPz (ilocal);
+  }
+}
+enum {NCACHE = 12};
+
+static void usage (const char *prog) {
+  cerr << "usage: " << prog << " [-n ncalls] [-r nrep] [-s seed] [-j njets,...]\n"
+       << "  -n  number of calls per repetition (default 20000)\n"
+       << "  -r  number of repetitions, the median time is reported (default 5)\n"
+       << "  -s  seed of the jet parameters (default 4357)\n"
+       << "  -j  comma separated numbers of jets (default 4,6,10,40)\n";
+}
+
+int main (int argc, char **argv) {
+  int ncalls = 20000;
+  int nrep = 5;
+  long seed = 4357;
+  std::string njetslist ("4,6,10,40");
+
+  for (int i = 1; i < argc; ++i) {
+    std::string opt (argv[i]);
+    if (i+1 >= argc || opt.size() != 2 || opt[0] != '-') {
+      usage (argv[0]);
+      return 1;
+    }
+    const char *arg = argv[++i];
+    switch (opt[1]) {
+      case 'n': ncalls = std::atoi (arg); break;
+      case 'r': nrep = std::atoi (arg); break;
+      case 's': seed = std::atol (arg); break;
+      case 'j': njetslist = arg; break;
+      default:
+        usage (argv[0]);
+        return 1;
+    }
+  }
+  std::vector<int> njetsvalues;
+  std::istringstream is (njetslist);
+  std::string item;
+  while (std::getline (is, item, ',')) njetsvalues.push_back (std::atoi (item.c_str()));
+  if (ncalls <= 0 || nrep <= 0 || njetsvalues.empty() ||
+      *std::min_element (njetsvalues.begin(), njetsvalues.end()) <= 0) {
+    usage (argv[0]);
+    return 1;
+  }
+
+  cout << "njets,version,ncalls,nrep,ns_per_jet,over_jetfitobject,max_rel_diff" << endl;
+
+  double checksum = 0;
+  srand48 (seed);
+  for (unsigned int in = 0; in < njetsvalues.size(); ++in) {
+    int njets = njetsvalues[in];
+    std::vector<ParticleFitObject *> single, blockjets;
+    JetFitObjectBlock block;
+    for (int i = 0; i < njets; ++i) {
+      double E     = 20 + 130*drand48();
+      double theta = 0.3 + (M_PI - 0.6)*drand48();
+      double phi   = M_PI*(2*drand48() - 1);
+      double m     = 10*drand48();
+      single.push_back (new JetFitObject (E, theta, phi, 0.1*E, 0.1, 0.1, m));
+      blockjets.push_back (block.addJet (E, theta, phi, 0.1*E, 0.1, 0.1, m));
+    }
+
+    std::vector<double> ref (NCACHE*njets), out (NCACHE*njets);
+    calculate (single);
+    for (int i = 0; i < njets; ++i) getCache (single[i], &ref[NCACHE*i]);
+
+    double tsingle = 0;
+    for (int iv = 0; iv < NVERSIONS; ++iv) {
+      std::vector<ParticleFitObject *> *jets = &single;
+      if (iv != SINGLE) {
+        ChainRuleKernels::Kernel kernel = (iv == BLOCK_AVX) ? ChainRuleKernels::AVX : ChainRuleKernels::SCALAR;
+        if (!JetFitObjectBlock::setKernel (kernel)) continue;
+        jets = &blockjets;
+      }
+      calculate (*jets);
+      double maxrel = 0;
+      for (int i = 0; i < njets; ++i) {
+        getCache ((*jets)[i], &out[NCACHE*i]);
+        for (int k = NCACHE*i; k < NCACHE*(i+1); ++k) {
+          if (ref[k] != out[k]) maxrel = std::max (maxrel, std::abs (out[k] - ref[k])/std::abs (ref[k]));
+        }
+      }
+
+      std::vector<double> times;
+      for (int irep = 0; irep < nrep; ++irep) {
+        double start = now();
+        for (int icall = 0; icall < ncalls; ++icall) checksum += calculate (*jets);
+        times.push_back (now() - start);
+      }
+      std::sort (times.begin(), times.end());
+      double t = 1E9*times[nrep/2]/ncalls/njets;
+      if (iv == SINGLE) tsingle = t;
+
+      cout << njets << ","
+           << versionname[iv] << ","
+           << ncalls << ","
+           << nrep << ","
+           << t << ","
+           << t/tsingle << ","
+           << maxrel << endl;
+    }
+    JetFitObjectBlock::setKernel (ChainRuleKernels::AUTO);
+    for (int i = 0; i < njets; ++i) delete single[i];
+  }
+  // keep the calculations from being optimized away
+  if (checksum == 42) cerr << "checksum " << checksum << endl;
+  return 0;
+}
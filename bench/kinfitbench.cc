@@ -0,0 +1,202 @@
+/*! \file
+ *  \brief Fit throughput benchmark on toy MC events
+ *
+ * Generates toy MC events with TopEventILC (fully hadronic and semileptonic
+ * ttbar) and DijetEventILC with a fixed seed, fits them with NewFitterGSL,
+ * NewtonFitterGSL and OPALFitterGSL on one or more numbers of threads,
+ * and writes one CSV line per topology, fitter and number of threads.
+ *
+ * Usage:
+ * \code
+ * kinfitbench [-n nevents] [-r nrep] [-t nthreads[,nthreads...]] [-s seed]
+ * \endcode
+ *
+ * For each topology, fitter and number of threads the same events are
+ * generated (the random number generator is reset to the seed before each
+ * repetition) and fitted nrep times; only the fits are timed,
+ * not the event generation.
+ * The events of a topology are created once, as an EventBatch, and
+ * generated again in place for each repetition.
+ * Columns of the output:
+ * - fits_per_s: number of events divided by the median wall clock time
+ * - wall_s: median wall clock time of one repetition in seconds
+ * - speedup: fits_per_s relative to the first number of threads in the list
+ * - mean_iterations: mean number of iterations per fit
+ * - failure_rate: fraction of fits with an error code other than 0
+ * - peak_rss_kb: peak resident memory of the process so far, in kB
+ *
+ * The GSL error handler is switched off, so that GSL errors in a fit
+ * count as failures.
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ * - 16.10.2026 Reuse the events of each topology (EventBatch)
+ *
+ */
+
+#include "TopEventILC.h"
+#include "DijetEventILC.h"
+#include "EventBatch.h"
+#include "ParallelFitDriver.h"
+#include "NewFitterGSL.h"
+#include "NewtonFitterGSL.h"
+#include "OPALFitterGSL.h"
+
+#include <gsl/gsl_errno.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <time.h>
+#include <sys/resource.h>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+enum {TOP_HADRONIC, TOP_SEMILEPTONIC, DIJET, NTOPOLOGIES};
+enum {FITTER_NEW, FITTER_NEWTON, FITTER_OPAL, NFITTERS};
+
+static const char *topologyname[NTOPOLOGIES] = {"top_hadronic", "top_semileptonic", "dijet"};
+static const char *fittername[NFITTERS] = {"NewFitterGSL", "NewtonFitterGSL", "OPALFitterGSL"};
+
+// wall clock time in seconds
+static double now () {
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1E-9*ts.tv_nsec;
+}
+
+// peak resident memory of the process in kB
+static long peakRSS () {
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+// events of all topologies, created once
+struct Batches {
+  Batches (int nevents)
+  : top (nevents), dijet (nevents)
+  {}
+  EventBatch<TopEventILC> top;
+  EventBatch<DijetEventILC> dijet;
+};
+
+// generate the events of a topology again, starting from seed
+static std::vector<BaseEvent *>& genEvents (Batches& batches, int topology, unsigned int seed) {
+  if (topology == DIJET) {
+    DijetEventILC::setSeed (seed);
+    return batches.dijet.next();
+  }
+  TopEventILC::setSeed (seed);
+  for (int iev = 0; iev < batches.top.getSize(); ++iev) {
+    TopEventILC& event = batches.top.getEvent (iev);
+    event.softmasses = false;
+    event.leptonic = (topology == TOP_SEMILEPTONIC);
+  }
+  return batches.top.next();
+}
+
+static ParallelFitDriver *createDriver (int fitter, int nthreads) {
+  switch (fitter) {
+    case FITTER_NEW:    return new ParallelFitDriverT<NewFitterGSL> (nthreads);
+    case FITTER_NEWTON: return new ParallelFitDriverT<NewtonFitterGSL> (nthreads);
+    case FITTER_OPAL:   return new ParallelFitDriverT<OPALFitterGSL> (nthreads);
+  }
+  return 0;
+}
+
+static void usage (const char *prog) {
+  cerr << "usage: " << prog << " [-n nevents] [-r nrep] [-t nthreads[,nthreads...]] [-s seed]\n"
+       << "  -n  number of events per topology (default 1000)\n"
+       << "  -r  number of repetitions, the median time is reported (default 3)\n"
+       << "  -t  comma separated list of numbers of threads, 0: one per core (default 1)\n"
+       << "  -s  seed of the toy MC, must not be 0 (default 4357)\n";
+}
+
+int main (int argc, char **argv) {
+  int nevents = 1000;
+  int nrep = 3;
+  unsigned int seed = 4357;
+  std::vector<int> threadlist;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string opt (argv[i]);
+    if (i+1 >= argc || opt.size() != 2 || opt[0] != '-') {
+      usage (argv[0]);
+      return 1;
+    }
+    const char *arg = argv[++i];
+    switch (opt[1]) {
+      case 'n': nevents = std::atoi (arg); break;
+      case 'r': nrep = std::atoi (arg); break;
+      case 's': seed = std::strtoul (arg, 0, 10); break;
+      case 't': {
+        std::istringstream is (arg);
+        std::string item;
+        while (std::getline (is, item, ',')) threadlist.push_back (std::atoi (item.c_str()));
+        break;
+      }
+      default:
+        usage (argv[0]);
+        return 1;
+    }
+  }
+  if (threadlist.empty()) threadlist.push_back (1);
+  if (nevents <= 0 || nrep <= 0 || seed == 0) {
+    usage (argv[0]);
+    return 1;
+  }
+
+  // a singular matrix in a single fit counts as a failure instead of aborting the run
+  gsl_set_error_handler_off();
+
+  cout << "topology,fitter,nthreads,nevents,nrep,fits_per_s,wall_s,speedup,mean_iterations,failure_rate,peak_rss_kb" << endl;
+
+  Batches batches (nevents);
+  for (int topology = 0; topology < NTOPOLOGIES; ++topology) {
+    for (int fitter = 0; fitter < NFITTERS; ++fitter) {
+      double refrate = 0;
+      for (unsigned int ith = 0; ith < threadlist.size(); ++ith) {
+        ParallelFitDriver *driver = createDriver (fitter, threadlist[ith]);
+        std::vector<double> walltimes;
+        long nit = 0, nfail = 0;
+        for (int irep = 0; irep < nrep; ++irep) {
+          std::vector<BaseEvent *>& events = genEvents (batches, topology, seed);
+          double start = now();
+          driver->fitEvents (events);
+          walltimes.push_back (now() - start);
+          // the events and the fits are the same in every repetition
+          if (irep == 0) {
+            for (int iev = 0; iev < nevents; ++iev) {
+              nit += driver->getIterations (iev);
+              if (driver->getError (iev) != 0) ++nfail;
+            }
+          }
+        }
+        std::sort (walltimes.begin(), walltimes.end());
+        double wall = walltimes[nrep/2];
+        double rate = wall > 0 ? nevents/wall : 0;
+        if (ith == 0) refrate = rate;
+
+        cout << topologyname[topology] << ","
+             << fittername[fitter] << ","
+             << driver->getNThreads() << ","
+             << nevents << ","
+             << nrep << ","
+             << rate << ","
+             << wall << ","
+             << (refrate > 0 ? rate/refrate : 0) << ","
+             << double (nit)/nevents << ","
+             << double (nfail)/nevents << ","
+             << peakRSS() << endl;
+        delete driver;
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,267 @@
+/*! \file
+ *  \brief Benchmark of the dense factorizations of the Newton steps
+ *
+ * Compares the symmetric indefinite LDL^T factorization with Bunch-Kaufman
+ * pivoting of NewFitterGSL with LU decompositions with partial pivoting,
+ * on random KKT matrices M = (H A^T; A 0) with a fixed seed,
+ * H positive definite with npar rows, A with ncon rows.
+ *
+ * Usage:
+ * \code
+ * ldlbench [-n ncalls] [-r nrep] [-s seed]
+ * \endcode
+ *
+ * For each dimension and method, M is copied, factorized and
+ * M*x = b is solved ncalls times, nrep times, and the median time
+ * per call is reported.
+ * Methods:
+ * - bunchkaufman: NewFitterGSL::bunchKaufmanDecomp and bunchKaufmanSolve
+ * - lu: unblocked LU decomposition with partial pivoting, written
+ *   like the Bunch-Kaufman code (raw arrays, same loop structure),
+ *   i.e. the comparison of the operation counts
+ * - gsl_lu: gsl_linalg_LU_decomp and gsl_linalg_LU_solve,
+ *   which NewFitterGSL used before
+ * Columns of the output, one line per dimension and method:
+ * - ns_per_call: median time per call in ns
+ * - over_lu: time relative to the method lu
+ * - max_residual: largest absolute element of M*x - b
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#include "NewFitterGSL.h"
+
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_permutation.h>
+#include <gsl/gsl_linalg.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <time.h>
+
+#undef NDEBUG
+#include <cassert>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+// wall clock time in seconds
+static double now () {
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1E-9*ts.tv_nsec;
+}
+
+enum {BUNCHKAUFMAN, LU, GSL_LU, NMETHODS};
+
+static const char *methodname[NMETHODS] = {"bunchkaufman", "lu", "gsl_lu"};
+
+// number of parameters and constraints of the test matrices
+static const int nparlist[] = {18, 24, 40, 80};
+static const int nconlist[] = { 5,  7, 10, 20};
+enum {NSIZES = sizeof (nparlist)/sizeof (nparlist[0])};
+
+// the input and work space of one dimension
+struct Setup {
+  Setup (int npar, int ncon);
+  ~Setup ();
+  int n;
+  gsl_matrix *M;
+  gsl_vector *b;
+  gsl_matrix *W;
+  gsl_vector *x;
+  gsl_permutation *perm;
+  std::vector<int> ipiv;
+};
+
+Setup::Setup (int npar, int ncon)
+: n (npar + ncon), M (gsl_matrix_calloc (n, n)), b (gsl_vector_alloc (n)),
+  W (gsl_matrix_alloc (n, n)), x (gsl_vector_alloc (n)), perm (gsl_permutation_alloc (n)),
+  ipiv (n)
+{
+  // H = B*B^T + npar*1 is positive definite
+  std::vector<double> B (npar*npar);
+  for (int i = 0; i < npar*npar; ++i) B[i] = 2*drand48() - 1;
+  for (int i = 0; i < npar; ++i) {
+    for (int j = 0; j <= i; ++j) {
+      double h = (i == j) ? npar : 0;
+      for (int k = 0; k < npar; ++k) h += B[i*npar+k]*B[j*npar+k];
+      gsl_matrix_set (M, i, j, h);
+      gsl_matrix_set (M, j, i, h);
+    }
+  }
+  for (int i = npar; i < n; ++i) {
+    for (int j = 0; j < npar; ++j) {
+      double a = 2*drand48() - 1;
+      gsl_matrix_set (M, i, j, a);
+      gsl_matrix_set (M, j, i, a);
+    }
+  }
+  for (int i = 0; i < n; ++i) gsl_vector_set (b, i, 2*drand48() - 1);
+}
+
+Setup::~Setup () {
+  gsl_matrix_free (M);
+  gsl_vector_free (b);
+  gsl_matrix_free (W);
+  gsl_vector_free (x);
+  gsl_permutation_free (perm);
+}
+
+// LU decomposition with partial pivoting and solution, like LAPACK dgetf2 and dgetrs
+static int luSolve (double *A, int n, int lda, int *ipiv, double *x) {
+  for (int k = 0; k < n; ++k) {
+    int kp = k;
+    double colmax = std::fabs (A[k*lda+k]);
+    for (int i = k+1; i < n; ++i) {
+      double a = std::fabs (A[i*lda+k]);
+      if (a > colmax) {
+        colmax = a;
+        kp = i;
+      }
+    }
+    ipiv[k] = kp;
+    if (colmax == 0) return k+1;
+    if (kp != k) {
+      double *ak = A + k*lda;
+      double *akp = A + kp*lda;
+      for (int j = 0; j < n; ++j) std::swap (ak[j], akp[j]);
+    }
+    const double *ak = A + k*lda;
+    double r1 = 1/ak[k];
+    for (int i = k+1; i < n; ++i) {
+      double *ai = A + i*lda;
+      double t = (ai[k] *= r1);
+      if (t == 0) continue;
+      for (int j = k+1; j < n; ++j) ai[j] -= t*ak[j];
+    }
+  }
+  for (int k = 0; k < n; ++k) {
+    if (ipiv[k] != k) std::swap (x[k], x[ipiv[k]]);
+  }
+  for (int i = 0; i < n; ++i) {
+    const double *ai = A + i*lda;
+    double s = x[i];
+    for (int j = 0; j < i; ++j) s -= ai[j]*x[j];
+    x[i] = s;
+  }
+  for (int i = n-1; i >= 0; --i) {
+    const double *ai = A + i*lda;
+    double s = x[i];
+    for (int j = i+1; j < n; ++j) s -= ai[j]*x[j];
+    x[i] = s/ai[i];
+  }
+  return 0;
+}
+
+// factorize M and solve M*x = b with method im
+static void calculate (Setup& s, int im) {
+  gsl_matrix_memcpy (s.W, s.M);
+  gsl_vector_memcpy (s.x, s.b);
+  switch (im) {
+    case BUNCHKAUFMAN:
+      NewFitterGSL::bunchKaufmanDecomp (s.W->data, s.n, s.W->tda, &s.ipiv[0]);
+      NewFitterGSL::bunchKaufmanSolve (s.W->data, s.n, s.W->tda, &s.ipiv[0], s.x->data);
+      break;
+    case LU:
+      luSolve (s.W->data, s.n, s.W->tda, &s.ipiv[0], s.x->data);
+      break;
+    case GSL_LU: {
+      int signum;
+      gsl_linalg_LU_decomp (s.W, s.perm, &signum);
+      gsl_linalg_LU_solve (s.W, s.perm, s.b, s.x);
+      break;
+    }
+  }
+}
+
+// largest absolute element of M*x - b
+static double maxResidual (const Setup& s) {
+  double maxabs = 0;
+  for (int i = 0; i < s.n; ++i) {
+    double r = -gsl_vector_get (s.b, i);
+    for (int j = 0; j < s.n; ++j) r += gsl_matrix_get (s.M, i, j)*gsl_vector_get (s.x, j);
+    maxabs = std::max (maxabs, std::fabs (r));
+  }
+  return maxabs;
+}
+
+// median time per call of method im in ns
+static double timeMethod (Setup& s, int im, int ncalls, int nrep) {
+  std::vector<double> times;
+  for (int irep = 0; irep < nrep; ++irep) {
+    double start = now();
+    for (int icall = 0; icall < ncalls; ++icall) calculate (s, im);
+    times.push_back (now() - start);
+  }
+  std::sort (times.begin(), times.end());
+  return 1E9*times[nrep/2]/ncalls;
+}
+
+static void usage (const char *prog) {
+  cerr << "usage: " << prog << " [-n ncalls] [-r nrep] [-s seed]\n"
+       << "  -n  number of calls per repetition (default 10000)\n"
+       << "  -r  number of repetitions, the median time is reported (default 5)\n"
+       << "  -s  seed of the matrices (default 4357)\n";
+}
+
+int main (int argc, char **argv) {
+  int ncalls = 10000;
+  int nrep = 5;
+  long seed = 4357;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string opt (argv[i]);
+    if (i+1 >= argc || opt.size() != 2 || opt[0] != '-') {
+      usage (argv[0]);
+      return 1;
+    }
+    const char *arg = argv[++i];
+    switch (opt[1]) {
+      case 'n': ncalls = std::atoi (arg); break;
+      case 'r': nrep = std::atoi (arg); break;
+      case 's': seed = std::atol (arg); break;
+      default:
+        usage (argv[0]);
+        return 1;
+    }
+  }
+  if (ncalls <= 0 || nrep <= 0) {
+    usage (argv[0]);
+    return 1;
+  }
+
+  srand48 (seed);
+  cout << "npar,ncon,n,method,ncalls,nrep,ns_per_call,over_lu,max_residual" << endl;
+
+  for (int isize = 0; isize < NSIZES; ++isize) {
+    Setup s (nparlist[isize], nconlist[isize]);
+    double t[NMETHODS];
+    double residual[NMETHODS];
+    for (int im = 0; im < NMETHODS; ++im) {
+      calculate (s, im);
+      residual[im] = maxResidual (s);
+      t[im] = timeMethod (s, im, ncalls, nrep);
+    }
+    for (int im = 0; im < NMETHODS; ++im) {
+      cout << nparlist[isize] << ","
+           << nconlist[isize] << ","
+           << s.n << ","
+           << methodname[im] << ","
+           << ncalls << ","
+           << nrep << ","
+           << t[im] << ","
+           << t[im]/t[LU] << ","
+           << residual[im] << endl;
+    }
+  }
+  return 0;
+}
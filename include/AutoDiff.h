@@ -0,0 +1,326 @@
+/*! \file
+ *  \brief Declares the forward mode automatic differentiation types Dual and HyperDual
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#ifndef __AUTODIFF_H
+#define __AUTODIFF_H
+
+#include <cmath>
+
+//  Class template Dual
+/// Number with first derivatives w.r.t. N variables (forward mode automatic differentiation)
+/**
+ * A Dual<N> carries a value and its first derivatives w.r.t. N variables.
+ * Arithmetic operations and the functions below propagate the derivatives
+ * with the chain rule, so a function that is written as a template
+ * in the number type T, e.g.
+ * \code
+ * template <class T> T mass (const T& E, const T& px, const T& py, const T& pz) {
+ *   using std::sqrt;
+ *   return sqrt (E*E - px*px - py*py - pz*pz);
+ * }
+ * \endcode
+ * returns its value for T = double, and additionally its derivatives
+ * for T = Dual<N> or (with second derivatives) T = HyperDual<N>,
+ * when the arguments are created with variable().
+ * Call the mathematical functions unqualified, after "using std::sqrt;"
+ * etc., so that the overloads for Dual and HyperDual are found.
+ *
+ * Comparisons only compare the values; branches in the function are
+ * therefore differentiated piecewise.
+ *
+ */
+
+template <int N>
+class Dual {
+  public:
+    /// Constructor for a constant
+    Dual (double v_ = 0): v (v_) {
+      for (int i = 0; i < N; ++i) d[i] = 0;
+    }
+    /// Create variable number i with value v_
+    static Dual variable (double v_,   ///< The value
+                          int i        ///< The variable number, 0 <= i < N
+                         ) {
+      Dual r (v_);
+      r.d[i] = 1;
+      return r;
+    }
+
+    /// Get the value
+    double getValue () const {return v;}
+    /// Get the derivative w.r.t. variable i
+    double getDerivative (int i) const {return d[i];}
+
+    Dual& operator+= (const Dual& b) {
+      v += b.v;
+      for (int i = 0; i < N; ++i) d[i] += b.d[i];
+      return *this;
+    }
+    Dual& operator-= (const Dual& b) {
+      v -= b.v;
+      for (int i = 0; i < N; ++i) d[i] -= b.d[i];
+      return *this;
+    }
+    Dual& operator*= (const Dual& b) {
+      for (int i = 0; i < N; ++i) d[i] = d[i]*b.v + v*b.d[i];
+      v *= b.v;
+      return *this;
+    }
+    Dual& operator/= (const Dual& b) {
+      double binv = 1/b.v;
+      v *= binv;
+      for (int i = 0; i < N; ++i) d[i] = (d[i] - v*b.d[i])*binv;
+      return *this;
+    }
+    Dual& operator+= (double b) {v += b; return *this;}
+    Dual& operator-= (double b) {v -= b; return *this;}
+    Dual& operator*= (double b) {
+      v *= b;
+      for (int i = 0; i < N; ++i) d[i] *= b;
+      return *this;
+    }
+    Dual& operator/= (double b) {return *this *= 1/b;}
+
+    /// Result of a function f(u) with f(u.v) = f, f'(u.v) = f1
+    static Dual chain (const Dual& u, double f, double f1) {
+      Dual r (f);
+      for (int i = 0; i < N; ++i) r.d[i] = f1*u.d[i];
+      return r;
+    }
+
+    double v;          ///< The value
+    double d[N];       ///< The first derivatives
+};
+
+//  Class template HyperDual
+/// Number with first and second derivatives w.r.t. N variables (forward mode automatic differentiation)
+/**
+ * A HyperDual<N> carries a value, its gradient and its Hessian w.r.t.
+ * N variables, so that one evaluation of a function gives the value
+ * and all first and second derivatives.
+ * The Hessian is symmetric and stored as its upper triangle,
+ * row by row; index(i, j) gives the position of element (i, j).
+ * See Dual for the usage.
+ *
+ */
+
+template <int N>
+class HyperDual {
+  public:
+    /// Number of stored second derivatives
+    enum {NH = N*(N+1)/2};
+
+    /// Constructor for a constant
+    HyperDual (double v_ = 0): v (v_) {
+      for (int i = 0; i < N; ++i) d[i] = 0;
+      for (int k = 0; k < NH; ++k) h[k] = 0;
+    }
+    /// Create variable number i with value v_
+    static HyperDual variable (double v_,   ///< The value
+                               int i        ///< The variable number, 0 <= i < N
+                              ) {
+      HyperDual r (v_);
+      r.d[i] = 1;
+      return r;
+    }
+    /// Position of the second derivative w.r.t. variables i and j in h
+    static int index (int i, int j) {
+      if (i > j) {
+        int t = i;
+        i = j;
+        j = t;
+      }
+      return i*N - i*(i-1)/2 + j - i;
+    }
+
+    /// Get the value
+    double getValue () const {return v;}
+    /// Get the derivative w.r.t. variable i
+    double getDerivative (int i) const {return d[i];}
+    /// Get the second derivative w.r.t. variables i and j
+    double getDerivative (int i, int j) const {return h[index (i, j)];}
+
+    HyperDual& operator+= (const HyperDual& b) {
+      v += b.v;
+      for (int i = 0; i < N; ++i) d[i] += b.d[i];
+      for (int k = 0; k < NH; ++k) h[k] += b.h[k];
+      return *this;
+    }
+    HyperDual& operator-= (const HyperDual& b) {
+      v -= b.v;
+      for (int i = 0; i < N; ++i) d[i] -= b.d[i];
+      for (int k = 0; k < NH; ++k) h[k] -= b.h[k];
+      return *this;
+    }
+    HyperDual& operator*= (const HyperDual& b) {
+      int k = 0;
+      for (int i = 0; i < N; ++i) {
+        for (int j = i; j < N; ++j, ++k) {
+          h[k] = h[k]*b.v + v*b.h[k] + d[i]*b.d[j] + d[j]*b.d[i];
+        }
+      }
+      for (int i = 0; i < N; ++i) d[i] = d[i]*b.v + v*b.d[i];
+      v *= b.v;
+      return *this;
+    }
+    HyperDual& operator/= (const HyperDual& b) {
+      double binv = 1/b.v;
+      return *this *= chain (b, binv, -binv*binv, 2*binv*binv*binv);
+    }
+    HyperDual& operator+= (double b) {v += b; return *this;}
+    HyperDual& operator-= (double b) {v -= b; return *this;}
+    HyperDual& operator*= (double b) {
+      v *= b;
+      for (int i = 0; i < N; ++i) d[i] *= b;
+      for (int k = 0; k < NH; ++k) h[k] *= b;
+      return *this;
+    }
+    HyperDual& operator/= (double b) {return *this *= 1/b;}
+
+    /// Result of a function f(u) with f(u.v) = f, f'(u.v) = f1, f''(u.v) = f2
+    static HyperDual chain (const HyperDual& u, double f, double f1, double f2) {
+      HyperDual r (f);
+      for (int i = 0; i < N; ++i) r.d[i] = f1*u.d[i];
+      int k = 0;
+      for (int i = 0; i < N; ++i) {
+        for (int j = i; j < N; ++j, ++k) r.h[k] = f1*u.h[k] + f2*u.d[i]*u.d[j];
+      }
+      return r;
+    }
+
+    double v;          ///< The value
+    double d[N];       ///< The first derivatives
+    double h[NH];      ///< The second derivatives, upper triangle
+};
+
+// Arithmetic operators
+
+template <int N> inline Dual<N> operator+ (const Dual<N>& a) {return a;}
+template <int N> inline Dual<N> operator- (const Dual<N>& a) {Dual<N> r (a); r *= -1.; return r;}
+template <int N> inline Dual<N> operator+ (Dual<N> a, const Dual<N>& b) {return a += b;}
+template <int N> inline Dual<N> operator- (Dual<N> a, const Dual<N>& b) {return a -= b;}
+template <int N> inline Dual<N> operator* (Dual<N> a, const Dual<N>& b) {return a *= b;}
+template <int N> inline Dual<N> operator/ (Dual<N> a, const Dual<N>& b) {return a /= b;}
+template <int N> inline Dual<N> operator+ (Dual<N> a, double b) {return a += b;}
+template <int N> inline Dual<N> operator- (Dual<N> a, double b) {return a -= b;}
+template <int N> inline Dual<N> operator* (Dual<N> a, double b) {return a *= b;}
+template <int N> inline Dual<N> operator/ (Dual<N> a, double b) {return a /= b;}
+template <int N> inline Dual<N> operator+ (double a, Dual<N> b) {return b += a;}
+template <int N> inline Dual<N> operator- (double a, const Dual<N>& b) {Dual<N> r (-b); return r += a;}
+template <int N> inline Dual<N> operator* (double a, Dual<N> b) {return b *= a;}
+template <int N> inline Dual<N> operator/ (double a, const Dual<N>& b) {return Dual<N>::chain (b, a/b.v, -a/(b.v*b.v));}
+
+template <int N> inline HyperDual<N> operator+ (const HyperDual<N>& a) {return a;}
+template <int N> inline HyperDual<N> operator- (const HyperDual<N>& a) {HyperDual<N> r (a); r *= -1.; return r;}
+template <int N> inline HyperDual<N> operator+ (HyperDual<N> a, const HyperDual<N>& b) {return a += b;}
+template <int N> inline HyperDual<N> operator- (HyperDual<N> a, const HyperDual<N>& b) {return a -= b;}
+template <int N> inline HyperDual<N> operator* (HyperDual<N> a, const HyperDual<N>& b) {return a *= b;}
+template <int N> inline HyperDual<N> operator/ (HyperDual<N> a, const HyperDual<N>& b) {return a /= b;}
+template <int N> inline HyperDual<N> operator+ (HyperDual<N> a, double b) {return a += b;}
+template <int N> inline HyperDual<N> operator- (HyperDual<N> a, double b) {return a -= b;}
+template <int N> inline HyperDual<N> operator* (HyperDual<N> a, double b) {return a *= b;}
+template <int N> inline HyperDual<N> operator/ (HyperDual<N> a, double b) {return a /= b;}
+template <int N> inline HyperDual<N> operator+ (double a, HyperDual<N> b) {return b += a;}
+template <int N> inline HyperDual<N> operator- (double a, const HyperDual<N>& b) {HyperDual<N> r (-b); return r += a;}
+template <int N> inline HyperDual<N> operator* (double a, HyperDual<N> b) {return b *= a;}
+template <int N> inline HyperDual<N> operator/ (double a, const HyperDual<N>& b) {
+  double binv = 1/b.v;
+  return HyperDual<N>::chain (b, a*binv, -a*binv*binv, 2*a*binv*binv*binv);
+}
+
+// Comparisons: values only
+
+#define AUTODIFF_COMPARISON(OP) \
+template <int N> inline bool operator OP (const Dual<N>& a, const Dual<N>& b) {return a.v OP b.v;} \
+template <int N> inline bool operator OP (const Dual<N>& a, double b) {return a.v OP b;} \
+template <int N> inline bool operator OP (double a, const Dual<N>& b) {return a OP b.v;} \
+template <int N> inline bool operator OP (const HyperDual<N>& a, const HyperDual<N>& b) {return a.v OP b.v;} \
+template <int N> inline bool operator OP (const HyperDual<N>& a, double b) {return a.v OP b;} \
+template <int N> inline bool operator OP (double a, const HyperDual<N>& b) {return a OP b.v;}
+
+AUTODIFF_COMPARISON(<)
+AUTODIFF_COMPARISON(>)
+AUTODIFF_COMPARISON(<=)
+AUTODIFF_COMPARISON(>=)
+AUTODIFF_COMPARISON(==)
+AUTODIFF_COMPARISON(!=)
+
+#undef AUTODIFF_COMPARISON
+
+// Mathematical functions
+
+/// Value of a number, for double, Dual and HyperDual
+inline double value (double x) {return x;}
+template <int N> inline double value (const Dual<N>& x) {return x.v;}
+template <int N> inline double value (const HyperDual<N>& x) {return x.v;}
+
+template <int N> inline Dual<N> sqrt (const Dual<N>& u) {
+  double s = std::sqrt (u.v);
+  return Dual<N>::chain (u, s, 0.5/s);
+}
+template <int N> inline HyperDual<N> sqrt (const HyperDual<N>& u) {
+  double s = std::sqrt (u.v);
+  return HyperDual<N>::chain (u, s, 0.5/s, -0.25/(s*u.v));
+}
+
+template <int N> inline Dual<N> abs (const Dual<N>& u) {return u.v < 0 ? -u : u;}
+template <int N> inline HyperDual<N> abs (const HyperDual<N>& u) {return u.v < 0 ? -u : u;}
+template <int N> inline Dual<N> fabs (const Dual<N>& u) {return abs (u);}
+template <int N> inline HyperDual<N> fabs (const HyperDual<N>& u) {return abs (u);}
+
+template <int N> inline Dual<N> sin (const Dual<N>& u) {
+  return Dual<N>::chain (u, std::sin (u.v), std::cos (u.v));
+}
+template <int N> inline HyperDual<N> sin (const HyperDual<N>& u) {
+  double s = std::sin (u.v);
+  return HyperDual<N>::chain (u, s, std::cos (u.v), -s);
+}
+
+template <int N> inline Dual<N> cos (const Dual<N>& u) {
+  return Dual<N>::chain (u, std::cos (u.v), -std::sin (u.v));
+}
+template <int N> inline HyperDual<N> cos (const HyperDual<N>& u) {
+  double c = std::cos (u.v);
+  return HyperDual<N>::chain (u, c, -std::sin (u.v), -c);
+}
+
+template <int N> inline Dual<N> exp (const Dual<N>& u) {
+  double e = std::exp (u.v);
+  return Dual<N>::chain (u, e, e);
+}
+template <int N> inline HyperDual<N> exp (const HyperDual<N>& u) {
+  double e = std::exp (u.v);
+  return HyperDual<N>::chain (u, e, e, e);
+}
+
+template <int N> inline Dual<N> log (const Dual<N>& u) {
+  return Dual<N>::chain (u, std::log (u.v), 1/u.v);
+}
+template <int N> inline HyperDual<N> log (const HyperDual<N>& u) {
+  double uinv = 1/u.v;
+  return HyperDual<N>::chain (u, std::log (u.v), uinv, -uinv*uinv);
+}
+
+template <int N> inline Dual<N> pow (const Dual<N>& u, double a) {
+  double p = std::pow (u.v, a - 1);
+  return Dual<N>::chain (u, p*u.v, a*p);
+}
+template <int N> inline HyperDual<N> pow (const HyperDual<N>& u, double a) {
+  double p = std::pow (u.v, a - 2);
+  return HyperDual<N>::chain (u, p*u.v*u.v, a*p*u.v, a*(a - 1)*p);
+}
+
+template <int N> inline Dual<N> atan (const Dual<N>& u) {
+  return Dual<N>::chain (u, std::atan (u.v), 1/(1 + u.v*u.v));
+}
+template <int N> inline HyperDual<N> atan (const HyperDual<N>& u) {
+  double q = 1/(1 + u.v*u.v);
+  return HyperDual<N>::chain (u, std::atan (u.v), q, -2*u.v*q*q);
+}
+
+#endif // __AUTODIFF_H
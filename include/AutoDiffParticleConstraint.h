@@ -0,0 +1,269 @@
+/*! \file
+ *  \brief Declares class template AutoDiffParticleConstraint
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ * - 16.10.2026 One evaluation per assembly pass, derivatives cached
+ *
+ */
+
+#ifndef __AUTODIFFPARTICLECONSTRAINT_H
+#define __AUTODIFFPARTICLECONSTRAINT_H
+
+#include "ParticleConstraint.h"
+#include "ParticleFitObject.h"
+#include "AutoDiff.h"
+
+#include <vector>
+#include <cassert>
+
+//  Class template AutoDiffParticleConstraint
+/// Constraint on the four-momenta of particles, with derivatives from automatic differentiation
+/**
+ * A constraint class Derived only implements the constraint function,
+ * as a template in the number type T:
+ * \code
+ * template <class T> T evaluate (const T p[]) const;
+ * \endcode
+ * where p[4*k] ... p[4*k+3] are E, px, py, pz of fit object k, in the
+ * order of the fit object list; the flags of the fit objects are available
+ * as usual. The class then derives from
+ * AutoDiffParticleConstraint<Derived> (evaluate must be public, or
+ * AutoDiffParticleConstraint<Derived> must be a friend).
+ *
+ * getValue evaluates the function with T = double; firstDerivatives
+ * and secondDerivatives evaluate it with T = Dual<4> or HyperDual<4>
+ * (HyperDual<8> for two different fit objects), with the four-momentum
+ * of the requested fit objects as variables, so that the derivatives
+ * w.r.t. E, px, py, pz need not be written by hand.
+ * The fitters, and the numerical checks test1stDerivatives
+ * and test2ndDerivatives, are used unchanged.
+ *
+ * Within an assembly pass (an Evaluation, see ParticleConstraint), the
+ * derivatives w.r.t. all fit objects are calculated on first use and cached:
+ * the gradient takes one evaluation with Dual<4> per fit object;
+ * for up to 6 fit objects, one evaluation with HyperDual<4*n>
+ * gives the whole Hessian (and the gradient), for more fit objects the
+ * Hessian takes n*(n+1)/2 evaluations with HyperDual<8>, one per pair.
+ * Calls outside of an Evaluation evaluate the function for the requested
+ * fit objects only.
+ *
+ * The derivatives are those of the function as written: special cases
+ * that a hand-written constraint treats separately (e.g. a vanishing
+ * invariant mass) must be handled in evaluate.
+ *
+ */
+
+template <class Derived>
+class AutoDiffParticleConstraint: public ParticleConstraint {
+  public:
+    /// Virtual destructor
+    virtual ~AutoDiffParticleConstraint() {}
+
+    /// Returns the value of the constraint
+    virtual double getValue() const {
+      fillFourMomenta (pval);
+      return derived().evaluate (&pval[0]);
+    }
+
+    /// Get first order derivatives.
+    /// Call this with a predefined array "der" with the necessary number of entries!
+    virtual void getDerivatives (int idim,      ///< First dimension of the array
+                                 double der[]   ///< Array of derivatives, at least idim x idim
+                                ) const {
+      Evaluation evaluation (*this);
+      double dderivatives[4];
+      for (unsigned int i = 0; i < fitobjects.size(); ++i) {
+        bool nonzero = firstDerivatives (i, dderivatives);
+        for (int ilocal = 0; ilocal < fitobjects[i]->getNPar(); ++ilocal) {
+          if (!fitobjects[i]->isParamFixed (ilocal)) {
+            int iglobal = fitobjects[i]->getGlobalParNum (ilocal);
+            assert (iglobal >= 0 && iglobal < idim);
+            double d = 0;
+            if (nonzero) {
+              for (int ii = 0; ii < 4; ++ii) {
+                d += dderivatives[ii]*fitobjects[i]->getFirstDerivative_Meta_Local (ii, ilocal, 0);
+              }
+            }
+            der[iglobal] = d;
+          }
+        }
+      }
+    }
+
+    virtual int getVarBasis() const {return VAR_BASIS;}
+
+  protected:
+    /// Only derived classes can be created
+    AutoDiffParticleConstraint(): gradvalid (false), hessvalid (false) {}
+
+    /// Invalidates the cached derivatives at the start of an Evaluation
+    virtual void evaluate() const {
+      gradvalid = false;
+      hessvalid = false;
+    }
+
+    /// Second derivatives with respect to the meta-variables of Fit objects i and j; result false if all derivatives are zero
+    virtual bool secondDerivatives (int i,                        ///< number of 1st FitObject
+                                    int j,                        ///< number of 2nd FitObject
+                                    double *dderivatives          ///< The result 4x4 matrix
+                                   ) const {
+      assert (dderivatives);
+      bool nonzero = false;
+      if (isEvaluated()) {
+        if (!hessvalid) calcHessian();
+        const int nv = 4*fitobjects.size();
+        for (int ii = 0; ii < 4; ++ii) {
+          for (int jj = 0; jj < 4; ++jj) {
+            dderivatives[4*ii+jj] = hess[(4*i+ii)*nv+4*j+jj];
+            if (dderivatives[4*ii+jj] != 0) nonzero = true;
+          }
+        }
+      }
+      else if (i == j) {
+        fillFourMomenta (phd4);
+        for (int ii = 0; ii < 4; ++ii) phd4[4*i+ii].d[ii] = 1;
+        HyperDual<4> r = derived().evaluate (&phd4[0]);
+        for (int ii = 0; ii < 4; ++ii) {
+          for (int jj = 0; jj < 4; ++jj) {
+            dderivatives[4*ii+jj] = r.getDerivative (ii, jj);
+            if (dderivatives[4*ii+jj] != 0) nonzero = true;
+          }
+        }
+      }
+      else {
+        fillFourMomenta (phd8);
+        for (int ii = 0; ii < 4; ++ii) {
+          phd8[4*i+ii].d[ii]   = 1;
+          phd8[4*j+ii].d[4+ii] = 1;
+        }
+        HyperDual<8> r = derived().evaluate (&phd8[0]);
+        for (int ii = 0; ii < 4; ++ii) {
+          for (int jj = 0; jj < 4; ++jj) {
+            dderivatives[4*ii+jj] = r.getDerivative (ii, 4+jj);
+            if (dderivatives[4*ii+jj] != 0) nonzero = true;
+          }
+        }
+      }
+      return nonzero;
+    }
+
+    /// First derivatives with respect to the meta-variables of Fit objects i; result false if all derivatives are zero
+    virtual bool firstDerivatives (int i,                        ///< number of 1st FitObject
+                                   double *dderivatives          ///< The result 4-vector
+                                  ) const {
+      assert (dderivatives);
+      bool nonzero = false;
+      if (isEvaluated()) {
+        if (!gradvalid) calcGradient();
+        for (int ii = 0; ii < 4; ++ii) {
+          dderivatives[ii] = grad[4*i+ii];
+          if (dderivatives[ii] != 0) nonzero = true;
+        }
+        return nonzero;
+      }
+      fillFourMomenta (pdual);
+      for (int ii = 0; ii < 4; ++ii) pdual[4*i+ii].d[ii] = 1;
+      Dual<4> r = derived().evaluate (&pdual[0]);
+      for (int ii = 0; ii < 4; ++ii) {
+        dderivatives[ii] = r.getDerivative (ii);
+        if (dderivatives[ii] != 0) nonzero = true;
+      }
+      return nonzero;
+    }
+
+    /// Calculate the gradient w.r.t. the four-momenta of all fit objects into grad, one evaluation per fit object
+    void calcGradient() const {
+      const int n = fitobjects.size();
+      grad.resize (4*n);
+      for (int i = 0; i < n; ++i) {
+        fillFourMomenta (pdual);
+        for (int ii = 0; ii < 4; ++ii) pdual[4*i+ii].d[ii] = 1;
+        Dual<4> r = derived().evaluate (&pdual[0]);
+        for (int ii = 0; ii < 4; ++ii) grad[4*i+ii] = r.getDerivative (ii);
+      }
+      gradvalid = true;
+    }
+
+    /// Calculate the Hessian w.r.t. the four-momenta of all fit objects into hess, for up to 6 fit objects also the gradient
+    void calcHessian() const {
+      switch (fitobjects.size()) {
+        case 1: calcHessianSeeded<4>(); break;
+        case 2: calcHessianSeeded<8>(); break;
+        case 3: calcHessianSeeded<12>(); break;
+        case 4: calcHessianSeeded<16>(); break;
+        case 5: calcHessianSeeded<20>(); break;
+        case 6: calcHessianSeeded<24>(); break;
+        default: {
+          // one evaluation per pair of fit objects
+          const int n = fitobjects.size();
+          const int nv = 4*n;
+          hess.resize (nv*nv);
+          for (int i = 0; i < n; ++i) {
+            for (int j = i; j < n; ++j) {
+              fillFourMomenta (phd8);
+              for (int ii = 0; ii < 4; ++ii) {
+                phd8[4*i+ii].d[ii]   = 1;
+                phd8[4*j+ii].d[4+ii] = 1;
+              }
+              HyperDual<8> r = derived().evaluate (&phd8[0]);
+              for (int ii = 0; ii < 4; ++ii) {
+                for (int jj = 0; jj < 4; ++jj) {
+                  hess[(4*i+ii)*nv+4*j+jj] = hess[(4*j+jj)*nv+4*i+ii] = r.getDerivative (ii, 4+jj);
+                }
+              }
+            }
+          }
+        }
+      }
+      hessvalid = true;
+    }
+
+    /// Calculate the Hessian and the gradient with one evaluation, with all NV = 4*n four-momentum components as variables
+    template <int NV>
+    void calcHessianSeeded() const {
+      assert (4*fitobjects.size() == NV);
+      fillFourMomenta (pval);
+      // on the heap: for NV = 24, the variables take 60kB
+      std::vector<HyperDual<NV> > p (NV);
+      for (int k = 0; k < NV; ++k) p[k] = HyperDual<NV>::variable (pval[k], k);
+      HyperDual<NV> r = derived().evaluate (&p[0]);
+      grad.resize (NV);
+      hess.resize (NV*NV);
+      for (int k = 0; k < NV; ++k) {
+        grad[k] = r.getDerivative (k);
+        for (int l = 0; l < NV; ++l) hess[k*NV+l] = r.getDerivative (k, l);
+      }
+      gradvalid = true;
+    }
+
+    /// Fill p with the four-momenta of all fit objects, as constants
+    template <class T>
+    void fillFourMomenta (std::vector<T>& p) const {
+      p.resize (4*fitobjects.size());
+      for (unsigned int k = 0; k < fitobjects.size(); ++k) {
+        const ParticleFitObject *fok = dynamic_cast < ParticleFitObject* > ( fitobjects[k] );
+        assert (fok);
+        p[4*k]   = T (fok->getE());
+        p[4*k+1] = T (fok->getPx());
+        p[4*k+2] = T (fok->getPy());
+        p[4*k+3] = T (fok->getPz());
+      }
+    }
+
+    /// The derived class
+    const Derived& derived () const {return static_cast<const Derived&>(*this);}
+
+    enum {VAR_BASIS=0}; // this means that the constraint knows about E,px,py,pz
+
+    mutable std::vector<double> pval;             ///< Four-momenta for getValue
+    mutable std::vector<Dual<4> > pdual;          ///< Four-momenta for firstDerivatives
+    mutable std::vector<HyperDual<4> > phd4;      ///< Four-momenta for secondDerivatives of one fit object
+    mutable std::vector<HyperDual<8> > phd8;      ///< Four-momenta for secondDerivatives of two fit objects
+    mutable std::vector<double> grad;             ///< Cached gradient w.r.t. all four-momenta, 4*n entries
+    mutable std::vector<double> hess;             ///< Cached Hessian w.r.t. all four-momenta, 4*n x 4*n entries
+    mutable bool gradvalid;                       ///< Whether grad is valid in the current Evaluation
+    mutable bool hessvalid;                       ///< Whether hess is valid in the current Evaluation
+};
+
+#endif // __AUTODIFFPARTICLECONSTRAINT_H
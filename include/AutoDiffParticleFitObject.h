@@ -0,0 +1,93 @@
+/*! \file
+ *  \brief Declares class template AutoDiffParticleFitObject
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#ifndef __AUTODIFFPARTICLEFITOBJECT_H
+#define __AUTODIFFPARTICLEFITOBJECT_H
+
+#include "ParticleFitObject.h"
+#include "AutoDiff.h"
+
+#include <cassert>
+
+//  Class template AutoDiffParticleFitObject
+/// Particle fit object with derivatives from automatic differentiation
+/**
+ * A fit object class Derived with NPARAM parameters only implements
+ * the four-momentum as a function of the parameters, as a template
+ * in the number type T:
+ * \code
+ * template <class T> void evaluate (const T par[], T meta[4]) const;
+ * \endcode
+ * which sets meta[0] ... meta[3] to E, px, py, pz. The class then derives
+ * from AutoDiffParticleFitObject<Derived, NPARAM> (evaluate must be public,
+ * or AutoDiffParticleFitObject<Derived, NPARAM> must be a friend),
+ * and implements copy, assign and getParamName, and if needed
+ * updateParams, like any other fit object.
+ *
+ * updateCache evaluates the function once with T = HyperDual<NPARAM>
+ * and stores the four-momentum and all first and second derivatives
+ * of E, px, py, pz w.r.t. the parameters, which are returned by getDE etc.
+ * and the Meta_Local methods.
+ *
+ */
+
+template <class Derived, int NPARAM>
+class AutoDiffParticleFitObject: public ParticleFitObject {
+  public:
+    /// Virtual destructor
+    virtual ~AutoDiffParticleFitObject() {}
+
+    virtual int getNPar() const {return NPARAM;}
+
+    virtual double getDE (int ilocal) const {return getFirstDerivative_Meta_Local (0, ilocal, 0);}
+    virtual double getDPx (int ilocal) const {return getFirstDerivative_Meta_Local (1, ilocal, 0);}
+    virtual double getDPy (int ilocal) const {return getFirstDerivative_Meta_Local (2, ilocal, 0);}
+    virtual double getDPz (int ilocal) const {return getFirstDerivative_Meta_Local (3, ilocal, 0);}
+
+    virtual double getFirstDerivative_Meta_Local (int iMeta, int ilocal, int metaSet) const {
+      assert (metaSet == 0);
+      assert (iMeta >= 0 && iMeta < 4);
+      assert (ilocal >= 0 && ilocal < NPARAM);
+      if (!cachevalid) updateCacheTraced();
+      return dmeta[iMeta][ilocal];
+    }
+    virtual double getSecondDerivative_Meta_Local (int iMeta, int ilocal, int jlocal, int metaSet) const {
+      assert (metaSet == 0);
+      assert (iMeta >= 0 && iMeta < 4);
+      assert (ilocal >= 0 && ilocal < NPARAM);
+      assert (jlocal >= 0 && jlocal < NPARAM);
+      if (!cachevalid) updateCacheTraced();
+      return d2meta[iMeta][HyperDual<NPARAM>::index (ilocal, jlocal)];
+    }
+
+  protected:
+    /// Only derived classes can be created
+    AutoDiffParticleFitObject(): ParticleFitObject (paramstorage) {
+      assert (int(NPARAM) <= int(BaseDefs::MAXPAR));
+    }
+
+    /// Evaluate the four-momentum and its derivatives at the current parameters
+    virtual void updateCache() const {
+      HyperDual<NPARAM> x[NPARAM];
+      for (int i = 0; i < NPARAM; ++i) x[i] = HyperDual<NPARAM>::variable (par[i], i);
+      HyperDual<NPARAM> meta[4];
+      static_cast<const Derived&>(*this).evaluate (x, meta);
+      fourMomentum.setValues (meta[0].v, meta[1].v, meta[2].v, meta[3].v);
+      for (int iMeta = 0; iMeta < 4; ++iMeta) {
+        for (int i = 0; i < NPARAM; ++i) dmeta[iMeta][i] = meta[iMeta].d[i];
+        for (int k = 0; k < HyperDual<NPARAM>::NH; ++k) d2meta[iMeta][k] = meta[iMeta].h[k];
+      }
+      cachevalid = true;
+    }
+
+    ParamStorage<NPARAM> paramstorage;                      ///< Parameters, flags and covariance matrices, see BaseFitObject
+    mutable double dmeta[4][NPARAM];                        ///< First derivatives of E, px, py, pz
+    mutable double d2meta[4][HyperDual<NPARAM>::NH];        ///< Second derivatives of E, px, py, pz, upper triangle (HyperDual::index)
+};
+
+#endif // __AUTODIFFPARTICLEFITOBJECT_H
@@ -3,6 +3,8 @@
  *
  * \b Changelog:
  * - 7.6.04 JB: First doxygen docu
+ * - 16.10.2026 Parameters and covariance matrices stored with the size of the derived class
+ * - 16.10.2026 Cache updates reported to the active phase tracer of the thread
  *
  * \b CVS Log messages:
  * - $Log: BaseFitObject.h,v $
@@ -47,6 +49,8 @@
 
 #include "BaseDefs.h"
 
+class SparseSymMatrix;
+
 // Class BaseFitObject
 /// Abstract base class for particle objects of kinematic fits
 /**
@@ -84,6 +88,19 @@
  * Global numbers can be assigned by the BaseFitter using
  * setGlobalParNum. 
  *
+ * The parameters, their flags and the covariance matrix and its inverse
+ * are stored in a ParamStorage<NPAR>, a data member of the derived class
+ * with the actual number of parameters, which the derived class passes to
+ * the constructor; a jet with 3 parameters thus needs about 220 bytes
+ * for them instead of 1.8 kB for BaseDefs::MAXPAR parameters.
+ * Derived classes that use the default constructor get storage for
+ * BaseDefs::MAXPAR parameters from the heap.
+ *
+ * Derived classes update their cache on first use with
+ * "if (!cachevalid) updateCacheTraced();", which reports the update
+ * as BaseTracer::PHASE_UPDATECACHE to the tracer that the fitter
+ * has made active with a PhaseTracerScope, during the fit.
+ *
  * The class WWFitter needs the following routines from BaseFitObject:
  * - BaseFitObject::getNPar
  * - BaseFitObject::getMeasured
@@ -300,6 +317,18 @@ class BaseFitObject {
     virtual void addTo2ndDerivatives (double der2[], int idim, double factor[], int metaSet) const;
     virtual void addTo2ndDerivatives (double M[], int idim,  double lambda, double der[], int metaSet) const;
 
+    // the same for sparse global matrices
+
+    /// Add covariance matrix elements to sparse global covariance matrix
+    virtual void addToGlobCov (SparseSymMatrix& glcov   ///< Global covariance matrix
+                               ) const;
+    /// Add 2nd derivatives of chi squared to sparse global derivative matrix
+    virtual void addToGlobalChi2DerMatrix (SparseSymMatrix& M   ///< Global derivative matrix
+                                           ) const;
+    virtual void addTo1stDerivatives (SparseSymMatrix& M, double der[], int kglobal, int metaSet) const;
+    virtual void addTo2ndDerivatives (SparseSymMatrix& M, double factor[], int metaSet) const;
+    virtual void addTo2ndDerivatives (SparseSymMatrix& M, double lambda, double der[], int metaSet) const;
+
     // DANIEL added
     // derivatives of intermediate variables wrt object's local parameters
     // these must be implemented by the derived classes for each type of object
@@ -322,36 +351,75 @@ class BaseFitObject {
 
 
     protected:
+      /// Storage of the parameters, their flags and the covariance matrices of a fit object with N parameters
+      template <int N>
+      struct ParamStorage {
+        double dvalues[2*N*(N+1)];   ///< par, mpar, cov, covinv
+        int ivalues[N];              ///< globalParNum
+        bool bvalues[2*N];           ///< measured, fixed
+      };
+
+      /// A square matrix in the parameter storage: m[i][j] is element (i, j)
+      class ParamMatrix {
+        public:
+          ParamMatrix (): elements (0), n (0) {}
+          double *operator[] (int i) const {return elements + n*i;}
+          double *elements;   ///< The elements, row by row
+          int n;              ///< The number of rows and columns
+      };
+
+      /// Constructor for derived classes with N parameters, which provide the storage for them
+      template <int N>
+      explicit BaseFitObject (ParamStorage<N>& storage   ///< The storage, a data member of the derived class
+                             )
+        : name(0), defaultstorage(0), covinvvalid(false), cachevalid(false) {
+        init (N, storage.dvalues, storage.ivalues, storage.bvalues);
+      }
+
       char *name;  
       const static double eps2;                           
 
       // DANIEL moved all of this stuff to BaseFitObject
-      // it costs some extra memory, since everything has dimension of largest # of parameters
-      // but avoid a lot of almost-duplication in the derived classes
+      // to avoid a lot of almost-duplication in the derived classes;
+      // the storage has the size of the derived class, see ParamStorage
 
       /// Calculate the inverse of the covariance matrix
       virtual bool calculateCovInv() const;
+      
+      /// Call updateCache, within BaseTracer::PHASE_UPDATECACHE if the thread has an active phase tracer
+      void updateCacheTraced() const;
         
+      /// Number of parameters in the storage
+      int nparstorage;
+      /// Storage for BaseDefs::MAXPAR parameters, if the derived class provides none
+      ParamStorage<BaseDefs::MAXPAR> *defaultstorage;
       /// fit parameters
-      double par[BaseDefs::MAXPAR];
+      double *par;
       /// measured parameters
-      double mpar[BaseDefs::MAXPAR];
+      double *mpar;
       /// measured flag
-      bool measured[BaseDefs::MAXPAR];
+      bool *measured;
       /// fixed flag
-      bool fixed[BaseDefs::MAXPAR];
+      bool *fixed;
       /// global paramter number for each parameter
-      int globalParNum [BaseDefs::MAXPAR];
+      int *globalParNum;
       /// local covariance matrix
-      double cov [BaseDefs::MAXPAR][BaseDefs::MAXPAR];    
+      ParamMatrix cov;
       /// inverse pf local covariance matrix
-      mutable double covinv [BaseDefs::MAXPAR][BaseDefs::MAXPAR];    
+      ParamMatrix covinv;
       /// flag for valid inverse covariance matrix
       mutable bool covinvvalid; 
       /// flag for valid cache
       mutable bool cachevalid;
       // end DANIEL adds
 
+    private:
+      /// Set the pointers to the storage for npar parameters and initialise it
+      void init (int npar,            ///< Number of parameters
+                 double *dvalues,     ///< par, mpar, cov, covinv
+                 int *ivalues,        ///< globalParNum
+                 bool *bvalues        ///< measured, fixed
+                );
 };
 
 /** \relates BaseFitObject
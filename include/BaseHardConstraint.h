@@ -3,6 +3,11 @@
  *
  * \b Changelog:
  * - 12.2.08 First version
+ * - 16.10.2026 Work arrays of add2ndDerivativesToMatrix from a ScratchArena
+ * - 16.10.2026 add2ndDerivativesToMatrix only for pairs of fit objects with second derivatives
+ * - 16.10.2026 Arena versions of add2ndDerivativesToMatrix call the versions without arena
+ * - 16.10.2026 Calls between the versions with and without arena through ScratchDispatch
+ * - 16.10.2026 New secondDerivativeBlocks
  *
  * \b CVS Log messages:
  * - $Log: BaseHardConstraint.h,v $
@@ -22,10 +27,13 @@
 #include "BaseDefs.h"
 #include "BaseConstraint.h"
 #include "BaseFitObject.h"
+#include "ScratchArena.h"
 
 #include <vector>
+#include <cstddef>
 
 class BaseFitObject;
+class SparseSymMatrix;
 
 //  Class BasehardConstraint:
 /// Abstract base class for constraints of kinematic fits
@@ -59,6 +67,19 @@ class BaseFitObject;
  * parameters (add1stDerivativesToMatrix, add2ndDerivativesToMatrix). This requires the
  * constraint to know its position in the overall list of constraints (globalNum). 
  * 
+ * The versions of add2ndDerivativesToMatrix with a ScratchArena argument take
+ * their work arrays from the arena, so that a fitter that owns an arena
+ * does not allocate memory in its iterations. The default implementations
+ * of the versions with and without arena call each other once, through the
+ * virtual functions, and then do the work with the arena of the caller
+ * or a temporary one (see ScratchDispatch). Thus a subclass may override either of them, and
+ * may call the implementation of its base class from the override;
+ * all fitters call the override.
+ *
+ * add2ndDerivativesToMatrix calls secondDerivatives only for the pairs
+ * of fit objects for which hasSecondDerivatives is true (by default all pairs).
+ * The list of these pairs is made once after the fit object list has changed;
+ * a subclass that changes fitobjects or flags must call invalidatePairList.
  *
  * Author: Jenny List, Benno List
  * Last update: $Date: 2011/03/03 15:03:02 $
@@ -84,6 +105,27 @@ class BaseHardConstraint: public BaseConstraint {
                                             int idim,       ///< First dimension of array der
                                             double lambda   ///< Lagrange multiplier for this constraint
                                             ) const;
+    /// Adds first order derivatives to sparse global matrix M
+    virtual void add1stDerivativesToMatrix (SparseSymMatrix& M   ///< Global matrix
+                                            ) const;
+    /// Adds second order derivatives to sparse global matrix M
+    virtual void add2ndDerivativesToMatrix (SparseSymMatrix& M,  ///< Global matrix
+                                            double lambda        ///< Lagrange multiplier for this constraint
+                                            ) const;
+    /// Adds second order derivatives to global covariance matrix M, with work arrays from scratch
+    virtual void add2ndDerivativesToMatrix (double *M,              ///< Global covariance matrix, dimension at least idim x idim
+                                            int idim,               ///< First dimension of array der
+                                            double lambda,          ///< Lagrange multiplier for this constraint
+                                            ScratchArena& scratch   ///< Work space
+                                            ) const;
+    /// Adds second order derivatives to sparse global matrix M, with work arrays from scratch
+    virtual void add2ndDerivativesToMatrix (SparseSymMatrix& M,     ///< Global matrix
+                                            double lambda,          ///< Lagrange multiplier for this constraint
+                                            ScratchArena& scratch   ///< Work space
+                                            ) const;
+    /// Number of bytes that add2ndDerivativesToMatrix takes from a ScratchArena
+    virtual std::size_t getScratchSize (int idim   ///< Dimension of the global matrix
+                                       ) const;
     /// Add lambda times derivatives of chi squared to global derivative vector
     virtual void addToGlobalChi2DerVector (double *y,   ///< Vector of chi2 derivatives
                                            int idim,    ///< Vector size 
@@ -161,6 +203,25 @@ class BaseHardConstraint: public BaseConstraint {
 
  protected:
 
+    /// Implementation of add2ndDerivativesToMatrix for dense (DenseMatrixRef) and sparse global matrices
+    template <class Matrix>
+    void add2ndDerivativesToMatrixT (Matrix& M, double lambda, ScratchArena& scratch) const;
+
+    /// Whether secondDerivatives can be nonzero for fit objects i and j; called for all pairs when the fit object list has changed
+    virtual bool hasSecondDerivatives (int i,           ///< number of 1st FitObject
+                                       int j            ///< number of 2nd FitObject
+                                      ) const;
+    /// Get the pairs of fit objects for which hasSecondDerivatives is true: i, j for each pair
+    const std::vector <int>& getSecondDerivativePairs() const;
+    /// Second derivatives for all pairs of fit objects in pairs, called once by add2ndDerivativesToMatrix;
+    /// the default calls secondDerivatives for each pair
+    virtual void secondDerivativeBlocks (const std::vector <int>& pairs,   ///< The pairs, as from getSecondDerivativePairs
+                                         double *blocks,                   ///< The result 4x4 matrices, MAXINTERVARS*MAXINTERVARS entries per pair
+                                         bool *nonzero                     ///< The results of secondDerivatives, one per pair
+                                        ) const;
+    /// Make the list of pairs again before its next use; call this when the fit objects or flags change
+    void invalidatePairList() const {npairobjects = -1;}
+
     /// Vector of pointers to ParticleFitObjects 
     typedef std::vector <BaseFitObject*> FitObjectContainer;    
     /// Iterator through vector of pointers to ParticleFitObjects 
@@ -177,11 +238,19 @@ class BaseHardConstraint: public BaseConstraint {
     
     /// Position of constraint in global constraint list
     int globalNum;
+
+    /// Pairs of fit objects for which hasSecondDerivatives is true, 2 entries per pair
+    mutable std::vector <int> secondDerivativePairs;
+    /// Number of fit objects for which secondDerivativePairs was made, -1 if it must be made again
+    mutable int npairobjects;
+    /// Pending call of add2ndDerivativesToMatrix with or without arena
+    mutable ScratchDispatch dispatch;
                                  
 };
 
 BaseHardConstraint::BaseHardConstraint() 
-: fitobjects( FitObjectContainer() ), derivatives( std::vector <double> () ), flags( std::vector <int> () ), globalNum(0)
+: fitobjects( FitObjectContainer() ), derivatives( std::vector <double> () ), flags( std::vector <int> () ), globalNum(0),
+  secondDerivativePairs( std::vector <int> () ), npairobjects(-1), dispatch()
 {
 }
 
@@ -2,6 +2,8 @@
  *  \brief Declares class BaseSoftConstraint
  *
  * \b Changelog:
+ * - 16.10.2026 add2ndDerivativesToMatrix with work arrays from a ScratchArena
+ * - 16.10.2026 dispatch for the calls between the versions with and without arena
  *
  * \b CVS Log messages:
  * - $Log: BaseSoftConstraint.h,v $
@@ -19,8 +21,12 @@
 #define __BaseSoftConstraint_H
 
 #include "BaseConstraint.h"
+#include "ScratchArena.h"
+
+#include <cstddef>
 
 class BaseFitObject;
+class SparseSymMatrix;
 
 //  Class BaseSoftConstraint:
 /// Abstract base class for soft constraints of kinematic fits
@@ -54,6 +60,17 @@ class BaseFitObject;
  * parameters (add1stDerivativesToMatrix, add2ndDerivativesToMatrix). This requires the
  * constraint to know its position in the overall list of constraints (globalNum). 
  * 
+ * The versions of add2ndDerivativesToMatrix with a ScratchArena argument take
+ * their work arrays from the arena; by default, the dense version calls
+ * the version without arena.
+ * The default sparse version goes through a dense idim x idim work matrix,
+ * which costs O(idim^2); it is only meant for soft constraints outside
+ * this package that implement the dense version only. 
+ * SoftGaussParticleConstraint and SoftBWParticleConstraint, and thus all
+ * soft constraints of this package, add their derivatives directly to 
+ * the sparse matrix; as in BaseHardConstraint, their versions with and
+ * without arena call each other once (see ScratchDispatch), so that
+ * subclasses may override either.
  *
  * Author: Jenny List, Benno List
  * Last update: $Date: 2011/03/03 15:03:02 $
@@ -75,6 +92,23 @@ class BaseSoftConstraint: public BaseConstraint {
     virtual void add2ndDerivativesToMatrix (double *M,      ///< Global covariance matrix, dimension at least idim x idim
                                             int idim        ///< First dimension of array der
                                             ) const = 0;
+    /// Adds second order derivatives to sparse global matrix M
+    /// (the default implementation uses a dense work matrix of the full dimension)
+    virtual void add2ndDerivativesToMatrix (SparseSymMatrix& M   ///< Global matrix
+                                            ) const;
+    /// Adds second order derivatives to global covariance matrix M, with work arrays from scratch
+    virtual void add2ndDerivativesToMatrix (double *M,              ///< Global covariance matrix, dimension at least idim x idim
+                                            int idim,               ///< First dimension of array der
+                                            ScratchArena& scratch   ///< Work space
+                                            ) const;
+    /// Adds second order derivatives to sparse global matrix M, with work arrays from scratch
+    /// (the default implementation uses a dense work matrix of the full dimension)
+    virtual void add2ndDerivativesToMatrix (SparseSymMatrix& M,     ///< Global matrix
+                                            ScratchArena& scratch   ///< Work space
+                                            ) const;
+    /// Number of bytes that add2ndDerivativesToMatrix takes from a ScratchArena
+    virtual std::size_t getScratchSize (int idim   ///< Dimension of the global matrix
+                                       ) const;
     /// Add derivatives of chi squared to global derivative matrix
     virtual void addToGlobalChi2DerVector (double *y,   ///< Vector of chi2 derivatives
                                            int idim     ///< Vector size 
@@ -83,6 +117,8 @@ class BaseSoftConstraint: public BaseConstraint {
                                  
     protected:
       char *name;  
+      /// Pending call of add2ndDerivativesToMatrix with or without arena, see ScratchDispatch
+      mutable ScratchDispatch dispatch;
 };
 
 
@@ -2,7 +2,9 @@
  *  \brief Declares class BaseTracer
  *
  * \b Changelog:
- * - 
+ * - 16.10.2026 Added phase hooks beginPhase and endPhase
+ * - 16.10.2026 Phase for the parameter errors of the scaling
+ * - 16.10.2026 PhaseTracerScope for the cache updates of the fit objects
  *
  * \b CVS Log messages:
  * - $Log: BaseTracer.h,v $
@@ -36,6 +38,15 @@ class BaseSoftConstraint;
  * - and it decouples the fit engine classes from other software
  *   such as Root, which may be used by the tracer.
  *
+ * In addition, fitters can mark the phases of a fit (assembly of the 
+ * matrices, factorization etc) with beginPhase and endPhase, 
+ * e.g. for profiling (see ProfilingTracer). Because these hooks are called 
+ * very often, fitters call them only if tracesPhases() returns true.
+ * PHASE_UPDATECACHE is reported by the fit objects themselves,
+ * when they update their cache on first use, to the tracer that the
+ * fitter has made active on the current thread with a PhaseTracerScope;
+ * it is therefore usually nested in another phase.
+ *
  * Author: Benno List
  * Last update: $Date: 2009/09/01 09:48:12 $
  *          by: $Author: blist $
@@ -62,6 +73,33 @@ class BaseTracer {
     /// Called at the end of a fit
     virtual void finish (BaseFitter& fitter);
     
+    /// Phases of a fit for beginPhase and endPhase
+    enum {PHASE_ASSEMBLY = 0,        ///< Assembly of the matrices and vectors
+          PHASE_SCALING,             ///< Scaling of the matrices and vectors
+          PHASE_FACTORIZATION,       ///< Factorization of the matrix and solution of the Newton equations
+          PHASE_SVD,                 ///< SVD as fallback of the factorization
+          PHASE_LINESEARCH,          ///< Line search or other step length control
+          PHASE_LAMBDAS,             ///< Determination of the Lagrange multipliers
+          PHASE_2NDORDERCORR,        ///< Second order correction
+          PHASE_COVARIANCE,          ///< Calculation of the covariance matrix
+          PHASE_UPDATECACHE,         ///< Update of the cached quantities of the fit objects
+          PHASE_PARERRORS,           ///< Collection of the parameter errors and constraint errors for the scaling
+          NPHASES                    ///< Number of phases
+         };
+    /// Get the name of a phase
+    static const char *getPhaseName (int phase);
+    
+    /// Whether this tracer, or one of the next ones, wants beginPhase and endPhase calls
+    virtual bool tracesPhases () const;
+    /// Called at the start of a phase; phases may be nested
+    virtual void beginPhase (BaseFitter& fitter,
+                             int phase
+                            );
+    /// Called at the end of a phase
+    virtual void endPhase (BaseFitter& fitter,
+                           int phase
+                          );
+    
     virtual void setNextTracer (BaseTracer *next_);
     virtual void setNextTracer (BaseTracer& next_);
     virtual BaseTracer *getNextTracer ();
@@ -79,4 +117,62 @@ class BaseTracer {
     BaseTracer *next;
 };
 
+//  Class TracerPhase
+/// Calls BaseTracer::beginPhase on construction and BaseTracer::endPhase on destruction
+/**
+ * Does nothing if the tracer is 0, so that fitters can write
+ * \code
+ * {
+ *   TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_ASSEMBLY);
+ *   assembleM (M, x);
+ * }
+ * \endcode
+ * with negligible overhead when no phases are traced.
+ */
+class TracerPhase {
+  public:
+    TracerPhase (BaseTracer *tracer_, BaseFitter& fitter_, int phase_)
+    : tracer (tracer_), fitter (fitter_), phase (phase_) {
+      if (tracer) tracer->beginPhase (fitter, phase);
+    }
+    ~TracerPhase () {
+      if (tracer) tracer->endPhase (fitter, phase);
+    }
+  private:
+    TracerPhase (const TracerPhase&);              // not copyable
+    TracerPhase& operator= (const TracerPhase&);   // not assignable
+    BaseTracer *tracer;
+    BaseFitter& fitter;
+    int phase;
+};
+
+//  Class PhaseTracerScope
+/// Makes a tracer the active phase tracer of the current thread for its lifetime
+/**
+ * The fit objects do not know the fitter, so they report their cache
+ * updates (BaseTracer::PHASE_UPDATECACHE) to the active phase tracer
+ * of the current thread, see BaseFitObject::updateCacheTraced.
+ * Fitters open a scope at the start of each public fit method:
+ * \code
+ * PhaseTracerScope scope (phasetracer, *this);
+ * \endcode
+ * The previous tracer is restored on destruction, so scopes may be nested,
+ * and fits on other threads, or interleaved fits of other fitters,
+ * are not affected. A tracer of 0 disables the reports within the scope.
+ */
+class PhaseTracerScope {
+  public:
+    PhaseTracerScope (BaseTracer *tracer_, BaseFitter& fitter_);
+    ~PhaseTracerScope ();
+    /// The active phase tracer of the current thread, or 0
+    static BaseTracer *getTracer ();
+    /// The fitter of the active phase tracer
+    static BaseFitter *getFitter ();
+  private:
+    PhaseTracerScope (const PhaseTracerScope&);              // not copyable
+    PhaseTracerScope& operator= (const PhaseTracerScope&);   // not assignable
+    BaseTracer *oldtracer;
+    BaseFitter *oldfitter;
+};
+
 #endif // __BASETRACER_H
@@ -0,0 +1,77 @@
+/*! \file
+ *  \brief Declares class ChainRuleKernels
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#ifndef __CHAINRULEKERNELS_H
+#define __CHAINRULEKERNELS_H
+
+// Class ChainRuleKernels
+/// Kernels for the chain rule in the second derivatives of the constraints
+/**
+ * The second derivatives of a constraint g w.r.t. the parameters a_k
+ * of fit object i and a_l of fit object j contain the term
+ * $$
+ *    \sum_{ii, jj} \frac{\partial P_{i,ii}}{\partial a_k} \cdot
+ *    \frac{\partial ^2 g}{\partial P_{i,ii} \partial P_{j,jj}} \cdot
+ *    \frac{\partial P_{j,jj}}{\partial a_l},
+ * $$
+ * i.e. the 4x4 matrix of derivatives w.r.t. the four-momenta,
+ * multiplied from both sides with the 4 x npar derivatives of the
+ * four-momenta w.r.t. the parameters.
+ * contract() calculates it for one pair of fit objects; it is used by
+ * BaseHardConstraint, SoftGaussParticleConstraint and SoftBWParticleConstraint.
+ *
+ * There is a portable implementation and one with 256 bit AVX vectors,
+ * which works on four parameters a_l at a time (the remaining ones of a fit
+ * object with a number of parameters that is not a multiple of 4 are done
+ * by the portable implementation); the AVX version is
+ * compiled on x86 with GCC and compatible compilers, independent of the
+ * compiler flags, and is used if the CPU supports it.
+ * Both versions do the same multiplications and additions in the same order
+ * (no fused multiply-add), so the results are identical.
+ * setKernel() selects a version explicitly, e.g. for benchmarks.
+ *
+ */
+
+class ChainRuleKernels {
+  public:
+    /// The implementations
+    enum Kernel {AUTO,      ///< The fastest one available
+                 SCALAR,    ///< Portable implementation
+                 AVX        ///< 256 bit AVX vectors
+                };
+
+    /// Calculate d2GdAkdAl[ldr*k + l] = sum_{ii,jj} dPidAk[4*k+ii] * d2GdPidPj[4*ii+jj] * dPjdAl[4*l+jj]
+    static void contract (const double *d2GdPidPj,  ///< The 4x4 matrix of derivatives w.r.t. P_i and P_j
+                          const double *dPidAk,     ///< Derivatives of P_i, 4 per parameter a_k
+                          int ni,                   ///< Number of parameters a_k
+                          const double *dPjdAl,     ///< Derivatives of P_j, 4 per parameter a_l
+                          int nj,                   ///< Number of parameters a_l
+                          double *d2GdAkdAl,        ///< The result, ni x nj
+                          int ldr                   ///< Row length of d2GdAkdAl, at least nj
+                         ) {
+      contractFunction (d2GdPidPj, dPidAk, ni, dPjdAl, nj, d2GdAkdAl, ldr);
+    }
+
+    /// Select an implementation; returns false (and changes nothing) if it is not available.
+    /// Must not be called while other threads run fits.
+    static bool setKernel (Kernel kernel     ///< The implementation; AUTO selects the fastest
+                          );
+    /// Get the selected implementation
+    static Kernel getKernel();
+    /// Get the name of the selected implementation
+    static const char *getKernelName();
+    /// Whether an implementation can be used on this CPU
+    static bool isAvailable (Kernel kernel   ///< The implementation
+                            );
+
+  private:
+    typedef void ContractFunction (const double *, const double *, int, const double *, int, double *, int);
+    static ContractFunction *contractFunction;     ///< The selected implementation of contract()
+};
+
+#endif // __CHAINRULEKERNELS_H
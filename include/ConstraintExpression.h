@@ -0,0 +1,496 @@
+/*! \file
+ *  \brief Declares the expression language of ExpressionConstraint
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ * - 16.10.2026 Second derivatives of all pairs of fit objects in one call, Hessian stored as full matrix
+ *
+ */
+
+#ifndef __CONSTRAINTEXPRESSION_H
+#define __CONSTRAINTEXPRESSION_H
+
+#include "ParticleFitObject.h"
+#include "AutoDiff.h"
+
+#include <vector>
+#include <utility>
+#include <cmath>
+#include <cassert>
+
+/// Expressions for constraints on sums of four-momenta
+/**
+ * A constraint function is written as an expression of sums of the
+ * four-momenta of the fit objects of the constraint:
+ * \code
+ * using namespace ConstraintDSL;
+ * MomentumSum j1 = particle (0), j2 = particle (1), j3 = particle (2), j4 = particle (3);
+ * mass (j1+j2) - mass (j3+j4)     // equal mass
+ * mass (j1+j2) - 80.4             // W mass
+ * sum (all).px()                  // px balance
+ * sum (all).e() - 500             // energy conservation
+ * \endcode
+ * particle (i) is the four-momentum of fit object number i, in the order
+ * in which the fit objects are added to the constraint; all is the sum
+ * of all fit objects of the constraint.
+ *
+ * Four-momentum sums (MomentumSum) can be added, subtracted and multiplied
+ * by numbers. The functions of a MomentumSum are
+ * e(), px(), py(), pz(), mass(), mass2() and pt(); they give scalar
+ * expressions, which can be combined with +, -, *, / and with numbers.
+ * The type of a scalar expression encodes the whole expression,
+ * so that it is evaluated by inline code, without virtual calls.
+ *
+ * ExpressionConstraint and SoftGaussExpressionConstraint turn an expression
+ * into a hard or soft constraint (newHardConstraint, newSoftGaussConstraint).
+ *
+ */
+
+namespace ConstraintDSL {
+
+  /// Tag for the sum of all fit objects of a constraint
+  enum AllParticles {all};
+
+  template <class F> class MomentumFunction;
+  struct Energy;
+  struct Px;
+  struct Py;
+  struct Pz;
+  struct Mass;
+  struct Mass2;
+  struct Pt;
+
+  //  Class MomentumSum
+  /// Linear combination of the four-momenta of the fit objects of a constraint
+  class MomentumSum {
+    public:
+      /// The empty sum
+      MomentumSum (): allcoeff (0) {}
+      /// The sum of all fit objects
+      MomentumSum (AllParticles): allcoeff (1) {}
+      /// The four-momentum of fit object i
+      static MomentumSum particle (int i) {
+        assert (i >= 0);
+        MomentumSum result;
+        result.terms.push_back (std::make_pair (i, 1.));
+        return result;
+      }
+
+      /// Coefficient of fit object i
+      double getCoefficient (int i) const {
+        double c = allcoeff;
+        for (unsigned int k = 0; k < terms.size(); ++k) {
+          if (terms[k].first == i) c += terms[k].second;
+        }
+        return c;
+      }
+      /// Largest fit object number that is used explicitly, -1 if none
+      int getMaxIndex () const {
+        int result = -1;
+        for (unsigned int k = 0; k < terms.size(); ++k) {
+          if (terms[k].first > result) result = terms[k].first;
+        }
+        return result;
+      }
+
+      MomentumSum& operator+= (const MomentumSum& rhs) {
+        allcoeff += rhs.allcoeff;
+        terms.insert (terms.end(), rhs.terms.begin(), rhs.terms.end());
+        return *this;
+      }
+      MomentumSum& operator*= (double c) {
+        allcoeff *= c;
+        for (unsigned int k = 0; k < terms.size(); ++k) terms[k].second *= c;
+        return *this;
+      }
+      MomentumSum& operator-= (const MomentumSum& rhs) {
+        MomentumSum r (rhs);
+        r *= -1.;
+        return *this += r;
+      }
+
+      /// Energy
+      MomentumFunction<Energy> e () const;
+      /// x component of the momentum
+      MomentumFunction<Px> px () const;
+      /// y component of the momentum
+      MomentumFunction<Py> py () const;
+      /// z component of the momentum
+      MomentumFunction<Pz> pz () const;
+      /// Invariant mass
+      MomentumFunction<Mass> mass () const;
+      /// Invariant mass squared
+      MomentumFunction<Mass2> mass2 () const;
+      /// Transverse momentum
+      MomentumFunction<Pt> pt () const;
+
+    private:
+      double allcoeff;                             ///< Coefficient of all fit objects
+      std::vector<std::pair<int, double> > terms;  ///< Fit object numbers and coefficients
+  };
+
+  inline MomentumSum particle (int i) {return MomentumSum::particle (i);}
+  inline MomentumSum sum (const MomentumSum& p) {return p;}
+  inline MomentumSum operator+ (MomentumSum a, const MomentumSum& b) {return a += b;}
+  inline MomentumSum operator- (MomentumSum a, const MomentumSum& b) {return a -= b;}
+  inline MomentumSum operator- (MomentumSum a) {return a *= -1.;}
+  inline MomentumSum operator* (double c, MomentumSum a) {return a *= c;}
+  inline MomentumSum operator* (MomentumSum a, double c) {return a *= c;}
+
+  //  Class template ScalarExpression
+  /// Base of all scalar expressions E
+  /**
+   * A scalar expression E has
+   * - enum {NGROUPS}: the number of MomentumSum objects that it uses,
+   * - void getGroups (const MomentumSum *groups[]) const: sets groups[0]
+   *   ... groups[NGROUPS-1] to these sums,
+   * - template <class T> T eval (const T*& P) const: the value, where
+   *   P[0] ... P[4*NGROUPS-1] are E, px, py, pz of the sums;
+   *   P is advanced by 4*NGROUPS.
+   */
+  template <class E>
+  struct ScalarExpression {
+    const E& self () const {return static_cast<const E&>(*this);}
+  };
+
+  /// A number
+  class Constant: public ScalarExpression<Constant> {
+    public:
+      enum {NGROUPS = 0};
+      explicit Constant (double c_): c (c_) {}
+      void getGroups (const MomentumSum **) const {}
+      template <class T> T eval (const T*&) const {return T (c);}
+    private:
+      double c;
+  };
+
+  /// Function F of one MomentumSum
+  template <class F>
+  class MomentumFunction: public ScalarExpression<MomentumFunction<F> > {
+    public:
+      enum {NGROUPS = 1};
+      explicit MomentumFunction (const MomentumSum& p_): p (p_) {}
+      void getGroups (const MomentumSum **groups) const {groups[0] = &p;}
+      template <class T> T eval (const T*& P) const {
+        const T *q = P;
+        P += 4;
+        return F::eval (q);
+      }
+    private:
+      MomentumSum p;
+  };
+
+  struct Energy {template <class T> static T eval (const T *q) {return q[0];}};
+  struct Px {template <class T> static T eval (const T *q) {return q[1];}};
+  struct Py {template <class T> static T eval (const T *q) {return q[2];}};
+  struct Pz {template <class T> static T eval (const T *q) {return q[3];}};
+  struct Mass2 {
+    template <class T> static T eval (const T *q) {return q[0]*q[0] - q[1]*q[1] - q[2]*q[2] - q[3]*q[3];}
+  };
+  /// sqrt(abs(m2)), as MassConstraint; an empty sum has mass 0 and no derivatives
+  struct Mass {
+    template <class T> static T eval (const T *q) {
+      using std::sqrt;
+      using std::abs;
+      T m2 = Mass2::eval (q);
+      return m2 != 0 ? sqrt (abs (m2)) : T (0);
+    }
+  };
+  struct Pt {
+    template <class T> static T eval (const T *q) {
+      using std::sqrt;
+      T pt2 = q[1]*q[1] + q[2]*q[2];
+      return pt2 != 0 ? sqrt (pt2) : T (0);
+    }
+  };
+
+  inline MomentumFunction<Energy> MomentumSum::e () const {return MomentumFunction<Energy> (*this);}
+  inline MomentumFunction<Px> MomentumSum::px () const {return MomentumFunction<Px> (*this);}
+  inline MomentumFunction<Py> MomentumSum::py () const {return MomentumFunction<Py> (*this);}
+  inline MomentumFunction<Pz> MomentumSum::pz () const {return MomentumFunction<Pz> (*this);}
+  inline MomentumFunction<Mass> MomentumSum::mass () const {return MomentumFunction<Mass> (*this);}
+  inline MomentumFunction<Mass2> MomentumSum::mass2 () const {return MomentumFunction<Mass2> (*this);}
+  inline MomentumFunction<Pt> MomentumSum::pt () const {return MomentumFunction<Pt> (*this);}
+
+  inline MomentumFunction<Mass> mass (const MomentumSum& p) {return p.mass();}
+  inline MomentumFunction<Mass2> mass2 (const MomentumSum& p) {return p.mass2();}
+  inline MomentumFunction<Pt> pt (const MomentumSum& p) {return p.pt();}
+
+  struct Plus   {template <class T> static T apply (const T& a, const T& b) {return a + b;}};
+  struct Minus  {template <class T> static T apply (const T& a, const T& b) {return a - b;}};
+  struct Times  {template <class T> static T apply (const T& a, const T& b) {return a * b;}};
+  struct Divide {template <class T> static T apply (const T& a, const T& b) {return a / b;}};
+
+  /// Operation Op of two scalar expressions
+  template <class Op, class A, class B>
+  class Binary: public ScalarExpression<Binary<Op, A, B> > {
+    public:
+      enum {NGROUPS = A::NGROUPS + B::NGROUPS};
+      Binary (const A& a_, const B& b_): a (a_), b (b_) {}
+      void getGroups (const MomentumSum **groups) const {
+        a.getGroups (groups);
+        b.getGroups (groups + A::NGROUPS);
+      }
+      template <class T> T eval (const T*& P) const {
+        T x = a.eval (P);
+        T y = b.eval (P);
+        return Op::apply (x, y);
+      }
+    private:
+      A a;
+      B b;
+  };
+
+  /// Negative of a scalar expression
+  template <class A>
+  class Negate: public ScalarExpression<Negate<A> > {
+    public:
+      enum {NGROUPS = A::NGROUPS};
+      explicit Negate (const A& a_): a (a_) {}
+      void getGroups (const MomentumSum **groups) const {a.getGroups (groups);}
+      template <class T> T eval (const T*& P) const {return -a.eval (P);}
+    private:
+      A a;
+  };
+
+  template <class A>
+  inline Negate<A> operator- (const ScalarExpression<A>& a) {return Negate<A> (a.self());}
+
+#define CONSTRAINTDSL_OPERATOR(OP, NAME) \
+  template <class A, class B> \
+  inline Binary<NAME, A, B> operator OP (const ScalarExpression<A>& a, const ScalarExpression<B>& b) { \
+    return Binary<NAME, A, B> (a.self(), b.self()); \
+  } \
+  template <class A> \
+  inline Binary<NAME, A, Constant> operator OP (const ScalarExpression<A>& a, double b) { \
+    return Binary<NAME, A, Constant> (a.self(), Constant (b)); \
+  } \
+  template <class B> \
+  inline Binary<NAME, Constant, B> operator OP (double a, const ScalarExpression<B>& b) { \
+    return Binary<NAME, Constant, B> (Constant (a), b.self()); \
+  }
+
+  CONSTRAINTDSL_OPERATOR(+, Plus)
+  CONSTRAINTDSL_OPERATOR(-, Minus)
+  CONSTRAINTDSL_OPERATOR(*, Times)
+  CONSTRAINTDSL_OPERATOR(/, Divide)
+
+#undef CONSTRAINTDSL_OPERATOR
+
+  //  Class template ExpressionEvaluator
+  /// Value and derivatives of a scalar expression w.r.t. the four-momenta of the fit objects
+  /**
+   * The expression is a function of the NGROUPS four-momentum sums P_g;
+   * one evaluation with HyperDual<4*NGROUPS> gives its value and all
+   * first and second derivatives w.r.t. the P_g. With the coefficients
+   * c_gi of fit object i in sum g, the derivatives w.r.t. the four-momentum
+   * p_i of fit object i are sum_g c_gi df/dP_g, and the second derivatives
+   * sum_gh c_gi c_hj d2f/dP_g dP_h.
+   *
+   * Within the lifetime of a Freeze object the results of one evaluation
+   * are used for all derivatives; otherwise every call evaluates the
+   * expression again. A Freeze for first derivatives only evaluates
+   * with Dual<4*NGROUPS>; the second derivatives are then calculated
+   * when they are first needed.
+   */
+  template <class Expr>
+  class ExpressionEvaluator {
+    public:
+      enum {NGROUPS = Expr::NGROUPS, NVARS = 4*NGROUPS};
+      typedef HyperDual<NVARS> Number;
+
+      explicit ExpressionEvaluator (const Expr& expr_)
+      : expr (expr_), nobjects (-1), frozen (0), order (0), value (0)
+      {
+        // an expression without four-momenta is not a constraint
+        typedef char expression_uses_four_momenta[NGROUPS > 0 ? 1 : -1];
+        (void) sizeof (expression_uses_four_momenta);
+      }
+
+      /// The value of the expression
+      template <class Container>
+      double getValue (const Container& fos) const {
+        if (frozen) return value;
+        double P[NVARS];
+        sumMomenta (fos, P);
+        const double *q = P;
+        return expr.eval (q);
+      }
+
+      /// First derivatives w.r.t. the four-momentum of fit object i; result false if all derivatives are zero
+      template <class Container>
+      bool firstDerivatives (const Container& fos, int i, double *der) const {
+        if (!frozen) update (fos, 1);
+        assert (i >= 0 && i < nobjects);
+        bool nonzero = false;
+        for (int ii = 0; ii < 4; ++ii) {
+          double d = 0;
+          for (int g = 0; g < NGROUPS; ++g) d += coeff[g*nobjects+i]*grad[4*g+ii];
+          der[ii] = d;
+          if (d != 0) nonzero = true;
+        }
+        return nonzero;
+      }
+
+      /// Second derivatives w.r.t. the four-momenta of fit objects i and j; result false if all derivatives are zero
+      template <class Container>
+      bool secondDerivatives (const Container& fos, int i, int j, double *der) const {
+        if (!frozen || order < 2) update (fos, 2);
+        return block (i, j, der);
+      }
+
+      /// Second derivatives for the pairs of fit objects pairs[2*p], pairs[2*p+1], 16 per pair in der; nonzero[p] false if all derivatives of pair p are zero
+      template <class Container>
+      void secondDerivativeBlocks (const Container& fos, const std::vector<int>& pairs, double *der, bool *nonzero) const {
+        if (!frozen || order < 2) update (fos, 2);
+        for (unsigned int p = 0; 2*p < pairs.size(); ++p) nonzero[p] = block (pairs[2*p], pairs[2*p+1], der + 16*p);
+      }
+
+      /// Evaluate the expression and its derivatives once for the lifetime of the object
+      class Freeze {
+        public:
+          template <class Container>
+          Freeze (const ExpressionEvaluator& ev_,   ///< The evaluator
+                  const Container& fos,             ///< The fit objects
+                  int order_ = 2                    ///< 1: first derivatives only, 2: first and second derivatives
+                 )
+          : ev (ev_)
+          {
+            if (ev.frozen++ == 0 || ev.order < order_) ev.update (fos, order_);
+          }
+          ~Freeze () {--ev.frozen;}
+        private:
+          const ExpressionEvaluator& ev;
+      };
+
+    private:
+      /// Second derivatives w.r.t. the four-momenta of fit objects i and j from the last evaluation
+      bool block (int i, int j, double *der) const {
+        assert (i >= 0 && i < nobjects);
+        assert (j >= 0 && j < nobjects);
+        const int gi = onlygroup[i];
+        const int hj = onlygroup[j];
+        if (gi >= 0 && hj >= 0) {
+          // the usual case: each fit object in one sum only
+          if (!hessnonzero[gi*NGROUPS+hj]) return false;
+          double c = coeff[gi*nobjects+i]*coeff[hj*nobjects+j];
+          for (int ii = 0; ii < 4; ++ii) {
+            for (int jj = 0; jj < 4; ++jj) der[4*ii+jj] = c*hess[(4*gi+ii)*NVARS+4*hj+jj];
+          }
+          return true;
+        }
+        for (int k = 0; k < 16; ++k) der[k] = 0;
+        bool nonzero = false;
+        for (int g = 0; g < NGROUPS; ++g) {
+          double cgi = coeff[g*nobjects+i];
+          if (cgi == 0) continue;
+          for (int h = 0; h < NGROUPS; ++h) {
+            double c = cgi*coeff[h*nobjects+j];
+            if (c == 0) continue;
+            for (int ii = 0; ii < 4; ++ii) {
+              for (int jj = 0; jj < 4; ++jj) {
+                der[4*ii+jj] += c*hess[(4*g+ii)*NVARS+4*h+jj];
+              }
+            }
+          }
+        }
+        for (int k = 0; k < 16; ++k) if (der[k] != 0) nonzero = true;
+        return nonzero;
+      }
+
+      static const ParticleFitObject *asParticle (const BaseFitObject *fo) {
+        const ParticleFitObject *pfo = dynamic_cast <const ParticleFitObject*> (fo);
+        assert (pfo);
+        return pfo;
+      }
+      static const ParticleFitObject *asParticle (const ParticleFitObject *fo) {
+        assert (fo);
+        return fo;
+      }
+
+      /// Sums P[4*g] ... P[4*g+3] of the four-momenta for all groups g
+      template <class Container>
+      void sumMomenta (const Container& fos, double P[NVARS]) const {
+        int n = fos.size();
+        if (n != nobjects) {
+          const MomentumSum *groups[NGROUPS];
+          expr.getGroups (groups);
+          coeff.resize (NGROUPS*n);
+          for (int g = 0; g < NGROUPS; ++g) {
+            assert (groups[g]->getMaxIndex() < n);
+            for (int i = 0; i < n; ++i) coeff[g*n+i] = groups[g]->getCoefficient (i);
+          }
+          onlygroup.resize (n);
+          for (int i = 0; i < n; ++i) {
+            onlygroup[i] = -1;
+            for (int g = 0; g < NGROUPS; ++g) {
+              if (coeff[g*n+i] == 0) continue;
+              onlygroup[i] = (onlygroup[i] == -1) ? g : -2;
+            }
+          }
+          nobjects = n;
+        }
+        for (int k = 0; k < NVARS; ++k) P[k] = 0;
+        for (int i = 0; i < n; ++i) {
+          const ParticleFitObject *fo = asParticle (fos[i]);
+          double p[4] = {fo->getE(), fo->getPx(), fo->getPy(), fo->getPz()};
+          for (int g = 0; g < NGROUPS; ++g) {
+            double c = coeff[g*n+i];
+            if (c == 0) continue;
+            for (int ii = 0; ii < 4; ++ii) P[4*g+ii] += c*p[ii];
+          }
+        }
+      }
+
+      /// Evaluate value and derivatives up to order_ (1 or 2)
+      template <class Container>
+      void update (const Container& fos, int order_) const {
+        double P[NVARS];
+        sumMomenta (fos, P);
+        order = order_;
+        if (order == 1) {
+          Dual<NVARS> x[NVARS];
+          for (int k = 0; k < NVARS; ++k) x[k] = Dual<NVARS>::variable (P[k], k);
+          const Dual<NVARS> *q = x;
+          Dual<NVARS> r = expr.eval (q);
+          value = r.v;
+          for (int k = 0; k < NVARS; ++k) grad[k] = r.d[k];
+          return;
+        }
+        Number x[NVARS];
+        for (int k = 0; k < NVARS; ++k) x[k] = Number::variable (P[k], k);
+        const Number *q = x;
+        Number r = expr.eval (q);
+        value = r.v;
+        for (int k = 0; k < NVARS; ++k) grad[k] = r.d[k];
+        for (int k = 0; k < NVARS; ++k) {
+          for (int l = k; l < NVARS; ++l) hess[k*NVARS+l] = hess[l*NVARS+k] = r.getDerivative (k, l);
+        }
+        for (int g = 0; g < NGROUPS; ++g) {
+          for (int h = 0; h < NGROUPS; ++h) {
+            bool nonzero = false;
+            for (int ii = 0; ii < 4; ++ii) {
+              for (int jj = 0; jj < 4; ++jj) {
+                if (hess[(4*g+ii)*NVARS+4*h+jj] != 0) nonzero = true;
+              }
+            }
+            hessnonzero[g*NGROUPS+h] = nonzero;
+          }
+        }
+      }
+
+      Expr expr;                             ///< The expression
+      mutable int nobjects;                  ///< Number of fit objects of the coefficients
+      mutable std::vector<double> coeff;     ///< Coefficient coeff[g*nobjects+i] of fit object i in group g
+      mutable std::vector<int> onlygroup;    ///< The only group with a nonzero coefficient of fit object i, -1 for none, -2 for several
+      mutable int frozen;                    ///< Number of active Freeze objects
+      mutable int order;                     ///< Highest order of the derivatives of the last evaluation
+      mutable double value;                  ///< Value of the last evaluation
+      mutable double grad[NVARS];            ///< First derivatives w.r.t. the group sums
+      mutable double hess[NVARS*NVARS];      ///< Second derivatives w.r.t. the group sums, full matrix
+      mutable bool hessnonzero[NGROUPS*NGROUPS];   ///< Whether the 4x4 block of hess for groups g, h has nonzero elements
+  };
+
+} // namespace ConstraintDSL
+
+#endif // __CONSTRAINTEXPRESSION_H
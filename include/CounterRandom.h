@@ -0,0 +1,88 @@
+/*! \file
+ *  \brief Declares class CounterRandom
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+#ifdef MARLIN_USE_ROOT
+
+#ifndef __COUNTERRANDOM_H
+#define __COUNTERRANDOM_H
+
+#include <stdint.h>
+#include <TRandom.h>
+
+//  Class CounterRandom
+/// Counter-based random number generator with independent streams
+/**
+ * The random numbers are calculated with the Philox4x32-10 function
+ * (J.K. Salmon et al., "Parallel random numbers: as easy as 1, 2, 3",
+ * SC11), which encrypts a 128 bit counter with a 64 bit key.
+ * The key is the seed, and the counter consists of a 64 bit stream number
+ * and the 64 bit number of the block of random numbers within the stream.
+ *
+ * Each stream is a reproducible sequence of random numbers that only
+ * depends on the seed and the stream number, not on which other streams
+ * were used before.
+ * So when every event of a toy MC gets its own stream, e.g. the event
+ * number, an event can be generated on any thread and in any order,
+ * and is always the same:
+ * \code
+ * CounterRandom random (seed);
+ * event.setRandom (&random);
+ * for (long iev = first; iev < last; ++iev) {
+ *   random.setStream (iev);
+ *   event.genEvent();
+ * }
+ * \endcode
+ *
+ * The class derives from TRandom, so that it can be used wherever
+ * a TRandom is expected; Rndm, RndmArray and Gaus are reimplemented,
+ * the other distributions of TRandom use Rndm.
+ * An object must not be used by more than one thread at the same time.
+ *
+ */
+
+class CounterRandom: public TRandom {
+  public:
+    /// Constructor; starts stream 0
+    CounterRandom (unsigned long seed = 4357   ///< The seed (the key), any value
+                  );
+    /// Virtual destructor
+    virtual ~CounterRandom();
+
+    /// Set the seed (the key) and restart stream 0
+    virtual void SetSeed (unsigned long seed = 0  ///< The seed, any value
+                         );
+    /// Start a stream at its first random number
+    virtual void setStream (uint64_t stream   ///< The stream number, e.g. the event number
+                           );
+    /// Get the current stream number
+    virtual uint64_t getStream () const;
+
+    /// Get a uniform random number in ]0, 1[
+    virtual double Rndm ();
+    /// Fill an array with uniform random numbers in ]0, 1[
+    virtual void RndmArray (int n, float *array);
+    /// Fill an array with uniform random numbers in ]0, 1[
+    virtual void RndmArray (int n, double *array);
+    /// Get a Gaussian random number (Box-Muller method, uses two uniform random numbers)
+    virtual double Gaus (double mean = 0, double sigma = 1);
+
+    /// Calculate one block of four 32 bit random numbers with Philox4x32-10
+    static void philox (const uint32_t key[2],    ///< The key
+                        const uint32_t ctr[4],    ///< The counter
+                        uint32_t result[4]        ///< The result
+                       );
+
+  protected:
+    uint32_t key[2];       ///< Key: the seed
+    uint32_t ctr[4];       ///< Counter: block number (ctr[0], ctr[1]) and stream number (ctr[2], ctr[3]) of the next block
+    uint32_t block[4];     ///< The current block of random numbers
+    int nused;             ///< Number of used random numbers of the current block
+};
+
+#endif // __COUNTERRANDOM_H
+
+#endif // MARLIN_USE_ROOT
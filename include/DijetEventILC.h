@@ -18,6 +18,8 @@
 #include "MomentumConstraint.h"
 #include "MassConstraint.h"
 
+class TRandom;
+
 class DijetEventILC : public BaseEvent {
   public: 
     DijetEventILC();
@@ -33,19 +35,32 @@ class DijetEventILC : public BaseEvent {
         
     void setDebug (bool _debug) {debug = _debug;};
     
+    // restart the random number generators of the events of this class
+    // and of FourVector::decayto; the same seed gives the same sequence
+    // of events (seed must not be 0)
+    static void setSeed (unsigned int seed);
+    
+    // use this random number generator for genEvent and its decays,
+    // instead of the one shared by all events of this class (0: shared one);
+    // e.g. a CounterRandom, to generate events on several threads
+    void setRandom (TRandom *random_) {random = random_;};
+    TRandom* getRandom() {return random;};
+    
     ParticleFitObject* getTrueFitObject (int i) {return bfo[i];};
     ParticleFitObject* getStartFitObject (int i) {return bfostart[i];};
     ParticleFitObject* getFittedFitObject (int i) {return bfosmear[i];};
-    FourVector* getTrueFourVector (int i) {return fv[i];};
+    FourVector* getTrueFourVector (int i) {return fv+i;};
+    int getNFitObjects() const {return NBFO;};
     
     bool leptonic, leptonasjet, debug;
     
   protected:
   
     enum {NFV = 3, NBFO = 2};
-    FourVector *fv[NFV];
-    FourVector *fvsmear[NFV];
-    FourVector *fvfinal[NFV];
+    // four-vectors and fit objects are reused by the next genEvent
+    FourVector fv[NFV];
+    FourVector fvsmear[NFV];
+    FourVector fvfinal[NFV];
     ParticleFitObject *bfo[NBFO];
     ParticleFitObject *bfostart[NBFO];
     ParticleFitObject *bfosmear[NBFO];
@@ -56,6 +71,8 @@ class DijetEventILC : public BaseEvent {
     MomentumConstraint ec;    
     MassConstraint mc;
     
+    TRandom *random;
+    
 
 };
 
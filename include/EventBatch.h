@@ -0,0 +1,86 @@
+/*! \file
+ *  \brief Declares class template EventBatch
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#ifndef __EVENTBATCH_H
+#define __EVENTBATCH_H
+
+#include <vector>
+#include <cassert>
+#include "BaseEvent.h"
+
+//  Class template EventBatch
+/// A fixed set of toy MC events that is generated again batch by batch
+/**
+ * The EventBatch owns a fixed number of events of class Event
+ * (e.g. TopEventILC or DijetEventILC), created once.
+ * Each call to next() generates new events into the same objects,
+ * one after the other, so that the sequence of events is the same as
+ * with newly created events, but no memory is allocated after the
+ * first batch.
+ * The returned list can be given directly to ParallelFitDriver::fitEvents;
+ * the next batch must only be generated after the fits of the previous one
+ * are finished, because it overwrites the events.
+ * \code
+ * EventBatch<TopEventILC> batch (1000);
+ * for (int i = 0; i < batch.getSize(); ++i) batch.getEvent(i).leptonic = true;
+ * ParallelFitDriverT<NewFitterGSL> driver;
+ * for (int ibatch = 0; ibatch < nbatches; ++ibatch) {
+ *   driver.fitEvents (batch.next());
+ *   // ... use the results ...
+ * }
+ * \endcode
+ *
+ */
+
+template <class Event>
+class EventBatch {
+  public:
+    /// Constructor, creates the events
+    explicit EventBatch (int size  ///< Number of events per batch
+                        )
+    : events (size, static_cast<BaseEvent *>(0))
+    {
+      assert (size >= 0);
+      for (int i = 0; i < size; ++i) events[i] = new Event();
+    }
+    /// Destructor, deletes the events
+    ~EventBatch() {
+      for (unsigned int i = 0; i < events.size(); ++i) delete events[i];
+    }
+
+    /// Generate the next batch of events, returns the list of events
+    std::vector<BaseEvent *>& next () {
+      for (unsigned int i = 0; i < events.size(); ++i) events[i]->genEvent();
+      return events;
+    }
+
+    /// Get the number of events per batch
+    int getSize () const {
+      return events.size();
+    }
+    /// Get event i, e.g. to set its options or to read the generated values
+    Event& getEvent (int i   ///< Event number, 0 <= i < getSize()
+                    ) {
+      assert (i >= 0 && i < getSize());
+      return *static_cast<Event *>(events[i]);
+    }
+    /// Get the list of events of the current batch
+    std::vector<BaseEvent *>& getEvents () {
+      return events;
+    }
+
+  private:
+    /// No copies: the events are owned by the batch
+    EventBatch (const EventBatch&);
+    /// No assignment: the events are owned by the batch
+    EventBatch& operator= (const EventBatch&);
+
+    std::vector<BaseEvent *> events;   ///< The events
+};
+
+#endif // __EVENTBATCH_H
@@ -0,0 +1,143 @@
+/*! \file
+ *  \brief Declares class template ExpressionConstraint
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ * - 16.10.2026 Second derivatives of all pairs in one call of secondDerivativeBlocks
+ *
+ */
+
+#ifndef __EXPRESSIONCONSTRAINT_H
+#define __EXPRESSIONCONSTRAINT_H
+
+#include "ParticleConstraint.h"
+#include "ConstraintExpression.h"
+
+#include <cassert>
+
+//  Class template ExpressionConstraint
+/// Hard constraint given by an expression of sums of four-momenta
+/**
+ * The constraint function is a scalar expression of ConstraintDSL,
+ * e.g. an equal mass constraint on four jets:
+ * \code
+ * using namespace ConstraintDSL;
+ * MomentumSum j1 = particle (0), j2 = particle (1), j3 = particle (2), j4 = particle (3);
+ * ParticleConstraint *equalmass = newHardConstraint (mass (j1+j2) - mass (j3+j4));
+ * equalmass->addToFOList (jet1);   // particle (0)
+ * equalmass->addToFOList (jet2);   // particle (1)
+ * equalmass->addToFOList (jet3);   // particle (2)
+ * equalmass->addToFOList (jet4);   // particle (3)
+ * ParticleConstraint *pxsum = newHardConstraint (sum (all).px());
+ * \endcode
+ * The flags of addToFOList are not used.
+ *
+ * The value and all first and second derivatives w.r.t. the four-momenta
+ * are calculated in one evaluation of the expression
+ * (ConstraintDSL::ExpressionEvaluator); the methods that add derivatives
+ * of all fit objects to the global matrices use the same evaluation
+ * for all fit objects, and add2ndDerivativesToMatrix gets the second
+ * derivatives of all pairs of fit objects from one call of
+ * secondDerivativeBlocks.
+ *
+ */
+
+template <class Expr>
+class ExpressionConstraint: public ParticleConstraint {
+  public:
+    /// Constructor
+    explicit ExpressionConstraint (const Expr& expr   ///< The constraint function
+                                  )
+    : evaluator (expr)
+    {}
+    /// Virtual destructor
+    virtual ~ExpressionConstraint() {}
+
+    /// Returns the value of the constraint
+    virtual double getValue() const {
+      return evaluator.getValue (fitobjects);
+    }
+
+    /// Get first order derivatives.
+    /// Call this with a predefined array "der" with the necessary number of entries!
+    virtual void getDerivatives (int idim,      ///< First dimension of the array
+                                 double der[]   ///< Array of derivatives, at least idim x idim
+                                ) const {
+      Freeze freeze (evaluator, fitobjects, 1);
+      double dderivatives[4];
+      for (unsigned int i = 0; i < fitobjects.size(); ++i) {
+        bool nonzero = firstDerivatives (i, dderivatives);
+        for (int ilocal = 0; ilocal < fitobjects[i]->getNPar(); ++ilocal) {
+          if (!fitobjects[i]->isParamFixed (ilocal)) {
+            int iglobal = fitobjects[i]->getGlobalParNum (ilocal);
+            assert (iglobal >= 0 && iglobal < idim);
+            double d = 0;
+            if (nonzero) {
+              for (int ii = 0; ii < 4; ++ii) {
+                d += dderivatives[ii]*fitobjects[i]->getFirstDerivative_Meta_Local (ii, ilocal, 0);
+              }
+            }
+            der[iglobal] = d;
+          }
+        }
+      }
+    }
+
+    virtual void add1stDerivativesToMatrix (double *M, int idim) const {
+      Freeze freeze (evaluator, fitobjects, 1);
+      ParticleConstraint::add1stDerivativesToMatrix (M, idim);
+    }
+    virtual void add1stDerivativesToMatrix (SparseSymMatrix& M) const {
+      Freeze freeze (evaluator, fitobjects, 1);
+      ParticleConstraint::add1stDerivativesToMatrix (M);
+    }
+    virtual void add2ndDerivativesToMatrix (double *M, int idim, double lambda, ScratchArena& scratch) const {
+      Freeze freeze (evaluator, fitobjects);
+      ParticleConstraint::add2ndDerivativesToMatrix (M, idim, lambda, scratch);
+    }
+    virtual void add2ndDerivativesToMatrix (SparseSymMatrix& M, double lambda, ScratchArena& scratch) const {
+      Freeze freeze (evaluator, fitobjects);
+      ParticleConstraint::add2ndDerivativesToMatrix (M, lambda, scratch);
+    }
+    // the other overloads of add2ndDerivativesToMatrix call these
+    using ParticleConstraint::add2ndDerivativesToMatrix;
+
+    virtual void addToGlobalChi2DerVector (double *y, int idim, double lambda) const {
+      Freeze freeze (evaluator, fitobjects, 1);
+      ParticleConstraint::addToGlobalChi2DerVector (y, idim, lambda);
+    }
+
+    virtual double getError() const {
+      Freeze freeze (evaluator, fitobjects, 1);
+      return ParticleConstraint::getError();
+    }
+
+    virtual int getVarBasis() const {return VAR_BASIS;}
+
+  protected:
+    typedef typename ConstraintDSL::ExpressionEvaluator<Expr>::Freeze Freeze;
+
+    virtual bool secondDerivatives (int i, int j, double *dderivatives) const {
+      return evaluator.secondDerivatives (fitobjects, i, j, dderivatives);
+    }
+    virtual void secondDerivativeBlocks (const std::vector <int>& pairs, double *blocks, bool *nonzero) const {
+      evaluator.secondDerivativeBlocks (fitobjects, pairs, blocks, nonzero);
+    }
+    virtual bool firstDerivatives (int i, double *dderivatives) const {
+      return evaluator.firstDerivatives (fitobjects, i, dderivatives);
+    }
+
+    enum {VAR_BASIS=0}; // this means that the constraint knows about E,px,py,pz
+
+    ConstraintDSL::ExpressionEvaluator<Expr> evaluator;   ///< Value and derivatives of the expression
+};
+
+namespace ConstraintDSL {
+  /// Create a hard constraint expr = 0; the caller owns it
+  template <class Expr>
+  ExpressionConstraint<Expr> *newHardConstraint (const ScalarExpression<Expr>& expr) {
+    return new ExpressionConstraint<Expr> (expr.self());
+  }
+}
+
+#endif // __EXPRESSIONCONSTRAINT_H
@@ -0,0 +1,1031 @@
+/*! \file
+ *  \brief Declares and implements class template FixedSizeFitter
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ * - 16.10.2026 Work arrays of the constraint derivatives from a ScratchArena
+ * - 16.10.2026 Linear algebra and singular cases with the kernels of NewFitterGSL
+ *
+ */
+
+#ifndef __FIXEDSIZEFITTER_H
+#define __FIXEDSIZEFITTER_H
+
+#include "BaseFitter.h"
+#include "NewFitterGSL.h"
+#include "BaseFitObject.h"
+#include "BaseHardConstraint.h"
+#include "BaseSoftConstraint.h"
+#include "BaseTracer.h"
+#include "ScratchArena.h"
+
+#include <iostream>
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_linalg.h>
+#include <gsl/gsl_cdf.h>
+
+// Class template FixedSizeFitter
+/// A Newton fitter like NewFitterGSL for problems whose size is known at compile time
+/**
+ * The template arguments are the number of free (not fixed) parameters NPAR
+ * and the number of hard constraints NCON; e.g. FixedSizeFitter<12,5>
+ * fits 4 jets with 3 parameters each and 5 constraints.
+ * The number of soft constraints and of unmeasured parameters is free.
+ * initialize() fails (and the fit returns error code 2) if the fit problem
+ * does not have exactly NPAR parameters and NCON constraints.
+ *
+ * FixedSizeFitter<12,5>, FixedSizeFitter<18,7> and FixedSizeFitter<18,4>
+ * are instantiated in the library (FixedSizeFitter.cc).
+ *
+ * The algorithm is the one of NewFitterGSL (dense solver, line search): 
+ * Newton steps with a symmetric indefinite LDL^T factorization of the 
+ * Lagrangian matrix M, optionally a shifted Hessian if M has the wrong inertia,
+ * SVD as fallback, line search with the l1 merit function and second order
+ * correction, error propagation after the fit. The linear algebra is done
+ * by the static kernels of NewFitterGSL (bunchKaufmanDecomp, solveSVD,
+ * solveATA) on the fixed size arrays, so that singular cases are treated
+ * in the same way. The results agree with NewFitterGSL up to rounding.
+ *
+ * All vectors and matrices are fixed size arrays within the fitter object,
+ * i.e. on the stack if the fitter is a local variable, and all loops have
+ * compile-time bounds. The constraints take their work arrays from a
+ * ScratchArena that is made large enough in initialize().
+ * No memory is allocated during a fit, except in the first initialize()
+ * and for the global covariance matrix of BaseFitter when the first fit finishes.
+ *
+ */
+
+template <int NPAR, int NCON>
+class FixedSizeFitter : public BaseFitter {
+  public:
+    enum {IDIM = NPAR+NCON,                 ///< Dimension of M
+          NCONDIM = NCON > 0 ? NCON : 1     ///< Array size for constraint quantities
+         };
+
+    /// Constructor
+    FixedSizeFitter();
+    /// Virtual destructor
+    virtual ~FixedSizeFitter() {}
+
+    /// The fit method, returns  the fit probability
+    virtual double fit();
+
+    /// Prepare a fit: order parameters, get start values and lambdas
+    virtual void startFit();
+    /// Perform one Newton iteration; returns false if the iteration has stopped
+    virtual bool iterate();
+    /// Calculate errors and the fit probability after the last iteration, returns the fit probability
+    virtual double finishFit();
+
+    /// Get the error code of the last fit: 0=OK, 1=failed, 2=wrong problem size, 99=Newton step failed
+    virtual int getError() const {return ierr;}
+    /// Get the fit probability of the last fit
+    virtual double getProbability() const {return fitprob;}
+    /// Get the chi**2 of the last fit
+    virtual double getChi2() const {return chi2;}
+    /// Get the number of degrees of freedom of the last fit
+    virtual int    getDoF() const {return ncon+nsoft-nunm;}
+    /// Get the number of iterations of the last fit
+    virtual int    getIterations() const {return nit;}
+    /// Get the number of hard constraints of the last fit
+    virtual int    getNcon() const {return ncon;}
+    /// Get the number of soft constraints of the last fit
+    virtual int    getNsoft() const {return nsoft;}
+    /// Get the number of all parameters of the last fit
+    virtual int    getNpar() const {return npar;}
+    /// Get the number of unmeasured parameters of the last fit
+    virtual int    getNunm() const {return nunm;}
+
+    /// Initialize the fitter; returns false if the problem size does not match NPAR and NCON
+    virtual bool initialize();
+
+    /// Set the Debug Level
+    virtual void setDebug (int debuglevel) {debug = debuglevel;}
+    /// Set the initial shift for a Newton step with wrong inertia of M (default: 0, no correction), see NewFitterGSL::setInertiaCorrection
+    virtual void setInertiaCorrection (double delta) {assert (delta >= 0); inertiadelta = delta;}
+    /// Get the initial shift for a Newton step with wrong inertia of M
+    virtual double getInertiaCorrection () const {return inertiadelta;}
+
+  protected:
+    /// Calculate the chi2
+    double calcChi2();
+
+    void fillx (double *vecx);
+    void fillperr (double *vece);
+    // Transfer values from vecx to FitObjects
+    bool updateParams (double *vecx);
+
+    // Fill matrix MatM, using lambdas from vecx
+    void assembleM (double *MatM, const double *vecx, bool errorpropagation = false);
+    // Fill vector y, using lambdas from vecx
+    void assembley (double *vecy, const double *vecx);
+    // Fill chi2 derivatives into vector y
+    void assembleChi2Der (double *vecy);
+    // Fill vector y with values of constraints
+    void addConstraints (double *vecy);
+    // Fill constraint derivatives into Matrix M
+    void assembleConstDer (double *MatM);
+
+    /// Determine best lambda values
+    void determineLambdas (double *vecxnew, const double *MatM);
+    /// Calculate 2nd order correction step
+    void calc2ndOrderCorr (double *vecdxhat, const double *MatM);
+    /// Solve (A^T*A)*z = r in place, with the constraint derivatives A from MatM; returns 1 if the SVD was used
+    static int solveATA (double *z, const double *MatM);
+
+    // Calculate Newton step dx, dxscal from current point x and errors perr
+    int calcNewtonDx ();
+    // Calculate limited step xnew after linesearch
+    int calcLimitedDx (double& alpha, double& mu, int imode);
+    // Perform a line search
+    int doLineSearch (double& alpha, int imode, double phi0, double dphi0,
+                      double eta, double zeta, double mu);
+    // Calculate mu for the merit function
+    double calcMu ();
+    // Calculate the merit function at x
+    double meritFunction (double mu, double *vecx);
+    // Calculate the directional derivative of the merit function at the current parameters
+    double meritFunctionDeriv (double mu);
+    double calcpTLp (const double *vecdx, const double *MatM) const;
+
+    /// solve system of equations Mscal*dxscal = yscal
+    int solveSystem (double& detW, double epsLU, double epsSV);
+    /// Solve Mscal*dxscal = yscal with an LDL^T factorization of Mscal into W; returns 0 if successful
+    int solveSystemLDL (const double *MatMscal, double& detW, double epsLU);
+
+    void calcCovMatrix();
+
+    int npar;      ///< total number of parameters
+    int ncon;      ///< total number of hard constraints
+    int nsoft;     ///< total number of soft constraints
+    int nunm;      ///< total number of unmeasured parameters
+    int ierr;      ///< Error status
+    int nit;       ///< Number of iterations
+    bool converged; ///< Convergence flag of the current fit
+
+    double fitprob;   ///< fit probability
+    double chi2;      ///< final chi2
+    double chi2new;
+    double chi2old;
+
+    double x[IDIM];
+    double xold[IDIM];
+    double xnew[IDIM];
+    double dx[IDIM];
+    double dxscal[IDIM];
+    double y[IDIM];
+    double yscal[IDIM];
+    double perr[IDIM];
+    double v1[IDIM];
+    double v2[IDIM];
+
+    double M[IDIM*IDIM];
+    double Mscal[IDIM*IDIM];
+    double W[IDIM*IDIM];
+    double W2[IDIM*IDIM];
+    int ipiv[IDIM];
+    int inertiaPos;           ///< Number of positive eigenvalues of M from the last factorization
+    int inertiaNeg;           ///< Number of negative eigenvalues of M from the last factorization
+    int inertiaZero;          ///< Number of zero eigenvalues of M from the last factorization; -1: unknown
+    double inertiadelta;      ///< Initial shift of the diagonal for a wrong inertia of M; 0: no correction
+    int imeasured[NPAR];      ///< Global numbers of the measured parameters
+    int nmeasured;            ///< Number of measured parameters
+    ScratchArena scratch;     ///< Work space for the derivatives of the constraints
+
+    int imerit;
+    bool try2ndOrderCorr;
+
+    int debug;
+};
+
+template <int NPAR, int NCON>
+FixedSizeFitter<NPAR, NCON>::FixedSizeFitter()
+: npar (0), ncon (0), nsoft (0), nunm (0), ierr (0), nit (0), converged (false),
+  fitprob (0), chi2 (0), chi2new (0), chi2old (0),
+  inertiaPos (0), inertiaNeg (0), inertiaZero (-1), inertiadelta (0), nmeasured (0),
+  imerit (1),
+  try2ndOrderCorr (true),
+  debug (0)
+{}
+
+template <int NPAR, int NCON>
+double FixedSizeFitter<NPAR, NCON>::fit() {
+  startFit();
+  while (iterate()) {}
+  return finishFit();
+}
+
+template <int NPAR, int NCON>
+bool FixedSizeFitter<NPAR, NCON>::initialize() {
+  covValid = false;
+
+  // tell fitobjects the global ordering of their parameters:
+  npar = 0;
+  nunm = 0;
+  nmeasured = 0;
+  for (unsigned int ifitobj = 0; ifitobj < fitobjects.size(); ++ifitobj) {
+    for (int ilocal = 0; ilocal < fitobjects[ifitobj]->getNPar(); ++ilocal) {
+      if (!fitobjects[ifitobj]->isParamFixed(ilocal)) {
+        fitobjects[ifitobj]->setGlobalParNum (ilocal, npar);
+        if (!fitobjects[ifitobj]->isParamMeasured(ilocal)) ++nunm;
+        else if (npar < NPAR) imeasured[nmeasured++] = npar;
+        ++npar;
+      }
+    }
+  }
+
+  // set number of constraints
+  ncon = constraints.size();
+  // Tell the constraints their numbers
+  for (unsigned int icon = 0; icon < constraints.size(); ++icon) {
+    BaseHardConstraint *c = constraints[icon];
+    assert (c);
+    c->setGlobalNum (npar+icon);
+  }
+  nsoft = softconstraints.size();
+
+  if (npar != NPAR || ncon != NCON) {
+    std::cerr << "FixedSizeFitter<" << NPAR << "," << NCON << ">::initialize: fit problem has npar="
+              << npar << ", ncon=" << ncon << std::endl;
+    return false;
+  }
+  if (nunm > ncon+nsoft) {
+    std::cerr << "FixedSizeFitter::initialize: nunm=" << nunm << " > ncon+nsoft="
+              << ncon << "+" << nsoft << std::endl;
+  }
+
+  // work space for the derivatives of the constraints
+  std::size_t scratchsize = 0;
+  for (unsigned int icon = 0; icon < constraints.size(); ++icon)
+    scratchsize = std::max (scratchsize, constraints[icon]->getScratchSize (IDIM));
+  for (unsigned int isoft = 0; isoft < softconstraints.size(); ++isoft)
+    scratchsize = std::max (scratchsize, softconstraints[isoft]->getScratchSize (IDIM));
+  scratch.reserve (scratchsize);
+  return true;
+}
+
+template <int NPAR, int NCON>
+void FixedSizeFitter<NPAR, NCON>::startFit() {
+  converged = false;
+  ierr = 0;
+  nit = 0;
+  chi2new = 0;
+  fitprob = -1;
+
+  // order parameters etc
+  if (!initialize()) {
+    ierr = 2;
+    return;
+  }
+
+  for (int i = 0; i < IDIM; ++i) {
+    x[i] = 0;
+    y[i] = 0;
+    perr[i] = 1;
+  }
+
+  // Store initial x values in x
+  fillx (x);
+  // make sure parameters are consistent
+  updateParams (x);
+  fillx (x);
+
+  assembleConstDer (M);
+  determineLambdas (x, M);
+
+#ifndef FIT_TRACEOFF
+  calcChi2();
+  traceValues["alpha"] = 0;
+  traceValues["phi"] = 0;
+  traceValues["mu"] = 0;
+  traceValues["detW"] = 0;
+  if (tracer) tracer->initialize (*this);
+#endif
+
+  chi2new = calcChi2();
+}
+
+template <int NPAR, int NCON>
+bool FixedSizeFitter<NPAR, NCON>::iterate() {
+  if (ierr) return false;
+#ifndef FIT_TRACEOFF
+  if (tracer) tracer->step (*this);
+#endif
+
+  // Store old x values in xold
+  for (int i = 0; i < IDIM; ++i) xold[i] = x[i];
+  // Fill errors into perr
+  fillperr (perr);
+
+  int ifail = calcNewtonDx();
+  if (ifail) {
+    ierr = 99;
+    if (debug > 0) {
+      std::cout << "FixedSizeFitter::fit: calcNewtonDx error " << ifail << std::endl;
+    }
+    return false;
+  }
+
+  // test convergence:
+  double dxsum = 0;
+  for (int i = 0; i < IDIM; ++i) dxsum += std::fabs (dxscal[i]);
+  if (dxsum < 1E-6*IDIM) {
+    converged = true;
+    return false;
+  }
+
+  double alpha = 1;
+  double mu = 0;
+  int imode = 2;
+
+  calcLimitedDx (alpha, mu, imode);
+
+  for (int i = 0; i < IDIM; ++i) x[i] = xnew[i];
+
+  chi2new = calcChi2();
+
+  ++nit;
+  if (nit > 200) ierr = 1;
+
+  converged = (std::abs (chi2new - chi2old) < 0.0001);
+
+  return !(converged || ierr);
+}
+
+template <int NPAR, int NCON>
+double FixedSizeFitter<NPAR, NCON>::finishFit() {
+
+#ifndef FIT_TRACEOFF
+  if (tracer) tracer->step (*this);
+#endif
+
+  if (!ierr) {
+    calcCovMatrix();
+
+    // update errors in fitobjects
+    if (covValid) {
+      for (unsigned int ifitobj = 0; ifitobj < fitobjects.size(); ++ifitobj) {
+        for (int ilocal = 0; ilocal < fitobjects[ifitobj]->getNPar(); ++ilocal) {
+          int iglobal = fitobjects[ifitobj]->getGlobalParNum (ilocal);
+          for (int jlocal = ilocal; jlocal < fitobjects[ifitobj]->getNPar(); ++jlocal) {
+            int jglobal = fitobjects[ifitobj]->getGlobalParNum (jlocal);
+            if (iglobal >= 0 && jglobal >= 0)
+              fitobjects[ifitobj]->setCov(ilocal, jlocal, cov[iglobal*covDim+jglobal]);
+          }
+        }
+      }
+    }
+  }
+
+  // Turn chisq into probability.
+  fitprob = (chi2new >= 0 && ncon+nsoft-nunm> 0) ? gsl_cdf_chisq_Q(chi2new, ncon+nsoft-nunm) : -1;
+
+#ifndef FIT_TRACEOFF
+  if (tracer) tracer->finish (*this);
+#endif
+
+  if (debug > 0) {
+    std::cout << "FixedSizeFitter::fit: converged=" << converged
+              << ", nit=" << nit << ", fitprob=" << fitprob << std::endl;
+  }
+
+  if (ierr > 0) fitprob = -1;
+
+  return fitprob;
+}
+
+template <int NPAR, int NCON>
+double FixedSizeFitter<NPAR, NCON>::calcChi2() {
+  chi2 = 0;
+  for (FitObjectIterator i = fitobjects.begin(); i != fitobjects.end(); ++i) {
+    BaseFitObject *fo = *i;
+    assert (fo);
+    chi2 += fo->getChi2();
+  }
+  for (SoftConstraintIterator i = softconstraints.begin(); i != softconstraints.end(); ++i) {
+    BaseSoftConstraint *bsc = *i;
+    assert (bsc);
+    chi2 += bsc->getChi2();
+  }
+  return chi2;
+}
+
+template <int NPAR, int NCON>
+void FixedSizeFitter<NPAR, NCON>::fillx (double *vecx) {
+  for (int i = 0; i < IDIM; ++i) vecx[i] = 0;
+  for (FitObjectIterator i = fitobjects.begin(); i != fitobjects.end(); ++i) {
+    BaseFitObject *fo = *i;
+    assert (fo);
+    for (int ilocal = 0; ilocal < fo->getNPar(); ++ilocal) {
+      if (!fo->isParamFixed(ilocal)) {
+        int iglobal = fo->getGlobalParNum (ilocal);
+        assert (iglobal >= 0 && iglobal < NPAR);
+        vecx[iglobal] = fo->getParam (ilocal);
+      }
+    }
+  }
+}
+
+template <int NPAR, int NCON>
+void FixedSizeFitter<NPAR, NCON>::fillperr (double *vece) {
+  for (int i = 0; i < IDIM; ++i) vece[i] = 1;
+  for (FitObjectIterator i = fitobjects.begin(); i != fitobjects.end(); ++i) {
+    BaseFitObject *fo = *i;
+    assert (fo);
+    for (int ilocal = 0; ilocal < fo->getNPar(); ++ilocal) {
+      if (!fo->isParamFixed(ilocal)) {
+        int iglobal = fo->getGlobalParNum (ilocal);
+        assert (iglobal >= 0 && iglobal < NPAR);
+        double e = std::abs(fo->getError (ilocal));
+        vece[iglobal] = e ? e : 1;
+      }
+    }
+  }
+  for (ConstraintIterator i = constraints.begin(); i != constraints.end(); ++i) {
+    BaseHardConstraint *c = *i;
+    assert (c);
+    int iglobal = c->getGlobalNum ();
+    assert (iglobal >= 0 && iglobal < IDIM);
+    double e =  c->getError();
+    vece[iglobal] = e ? 1/e : 1;
+  }
+}
+
+template <int NPAR, int NCON>
+bool FixedSizeFitter<NPAR, NCON>::updateParams (double *vecx) {
+  bool significant = false;
+  for (FitObjectIterator i = fitobjects.begin(); i != fitobjects.end(); ++i) {
+    BaseFitObject *fo = *i;
+    assert (fo);
+    significant |= fo->updateParams (vecx, IDIM);
+  }
+  return significant;
+}
+
+template <int NPAR, int NCON>
+void FixedSizeFitter<NPAR, NCON>::assembleM (double *MatM, const double *vecx, bool errorpropagation) {
+  for (int i = 0; i < IDIM*IDIM; ++i) MatM[i] = 0;
+
+  // First, all terms d^2 chi^2/dx1 dx2
+  for (FitObjectIterator i = fitobjects.begin(); i != fitobjects.end(); ++i) {
+    BaseFitObject *fo = *i;
+    assert (fo);
+    fo->addToGlobalChi2DerMatrix (MatM, IDIM);
+  }
+  // Second, the first derivatives of the contraints,
+  // plus the second derivatives times the lambda values
+  for (unsigned int k = 0; k < constraints.size(); ++k) {
+    BaseHardConstraint *c = constraints[k];
+    assert (c);
+    int kglobal = c->getGlobalNum();
+    assert (kglobal >= 0 && kglobal < IDIM);
+    c->add1stDerivativesToMatrix (MatM, IDIM);
+    // for error propagation after fit,
+    // 2nd derivatives of constraints times lambda should _not_ be included!
+    if (!errorpropagation) c->add2ndDerivativesToMatrix (MatM, IDIM, vecx[kglobal], scratch);
+  }
+  // Finally, treat the soft constraints
+  for (SoftConstraintIterator i = softconstraints.begin(); i != softconstraints.end(); ++i) {
+    BaseSoftConstraint *bsc = *i;
+    assert (bsc);
+    bsc->add2ndDerivativesToMatrix (MatM, IDIM, scratch);
+  }
+}
+
+template <int NPAR, int NCON>
+void FixedSizeFitter<NPAR, NCON>::assembley (double *vecy, const double *vecx) {
+  for (int i = 0; i < IDIM; ++i) vecy[i] = 0;
+  for (FitObjectIterator i = fitobjects.begin(); i != fitobjects.end(); ++i) {
+    BaseFitObject *fo = *i;
+    assert (fo);
+    fo->addToGlobalChi2DerVector (vecy, IDIM);
+  }
+  for (unsigned int k = 0; k < constraints.size(); ++k) {
+    BaseHardConstraint *c = constraints[k];
+    assert (c);
+    int kglobal = c->getGlobalNum();
+    assert (kglobal >= 0 && kglobal < IDIM);
+    c->addToGlobalChi2DerVector (vecy, IDIM, vecx[kglobal]);
+    vecy[kglobal] = c->getValue();
+  }
+  for (SoftConstraintIterator i = softconstraints.begin(); i != softconstraints.end(); ++i) {
+    BaseSoftConstraint *bsc = *i;
+    assert (bsc);
+    bsc->addToGlobalChi2DerVector (vecy, IDIM);
+  }
+}
+
+template <int NPAR, int NCON>
+void FixedSizeFitter<NPAR, NCON>::assembleChi2Der (double *vecy) {
+  for (int i = 0; i < IDIM; ++i) vecy[i] = 0;
+  for (FitObjectIterator i = fitobjects.begin(); i != fitobjects.end(); ++i) {
+    BaseFitObject *fo = *i;
+    assert (fo);
+    fo->addToGlobalChi2DerVector (vecy, IDIM);
+  }
+  for (SoftConstraintIterator i = softconstraints.begin(); i != softconstraints.end(); ++i) {
+    BaseSoftConstraint *bsc = *i;
+    assert (bsc);
+    bsc->addToGlobalChi2DerVector (vecy, IDIM);
+  }
+}
+
+template <int NPAR, int NCON>
+void FixedSizeFitter<NPAR, NCON>::addConstraints (double *vecy) {
+  for (unsigned int k = 0; k < constraints.size(); ++k) {
+    BaseHardConstraint *c = constraints[k];
+    assert (c);
+    vecy[c->getGlobalNum()] = c->getValue();
+  }
+}
+
+template <int NPAR, int NCON>
+void FixedSizeFitter<NPAR, NCON>::assembleConstDer (double *MatM) {
+  for (int i = 0; i < IDIM*IDIM; ++i) MatM[i] = 0;
+  for (ConstraintIterator i = constraints.begin(); i != constraints.end(); ++i) {
+    BaseHardConstraint *c = *i;
+    assert (c);
+    c->add1stDerivativesToMatrix (MatM, IDIM);
+  }
+}
+
+template <int NPAR, int NCON>
+int FixedSizeFitter<NPAR, NCON>::solveATA (double *z, const double *MatM) {
+  if (NCON == 0) return 0;
+  // A = MatM[0:NPAR, NPAR:IDIM]; work space on the stack
+  double ATA[NCONDIM*NCONDIM];
+  double V[NCONDIM*NCONDIM];
+  double s[NCONDIM];
+  gsl_matrix_const_view A = gsl_matrix_const_view_array_with_tda (MatM + NPAR, NPAR, NCON, IDIM);
+  gsl_vector_view zview = gsl_vector_view_array (z, NCON);
+  gsl_matrix_view ATAview = gsl_matrix_view_array (ATA, NCON, NCON);
+  gsl_matrix_view Vview = gsl_matrix_view_array (V, NCON, NCON);
+  gsl_vector_view sview = gsl_vector_view_array (s, NCON);
+  return NewFitterGSL::solveATA (&A.matrix, &zview.vector, &ATAview.matrix, &Vview.matrix, &sview.vector, 0);
+}
+
+template <int NPAR, int NCON>
+void FixedSizeFitter<NPAR, NCON>::determineLambdas (double *vecxnew, const double *MatM) {
+  // lambdanew = -(A^T*A)^-1*A^T*gradf
+  double gradf[IDIM];
+  assembleChi2Der (gradf);
+  double *lambdanew = vecxnew + NPAR;
+  for (int k = 0; k < NCON; ++k) {
+    double s = 0;
+    for (int i = 0; i < NPAR; ++i) s += MatM[i*IDIM+NPAR+k]*gradf[i];
+    lambdanew[k] = -s;
+  }
+  if (solveATA (lambdanew, MatM)) {
+    std::cout << "FixedSizeFitter::determineLambdas: resorting to SVD" << std::endl;
+  }
+}
+
+template <int NPAR, int NCON>
+void FixedSizeFitter<NPAR, NCON>::calc2ndOrderCorr (double *vecdxhat, const double *MatM) {
+  // Calculate 2nd order correction
+  // see Nocedal&Wright (15.36)
+  // phat = -A^T*(A*A^T)^-1*c
+  for (int i = 0; i < IDIM; ++i) vecdxhat[i] = 0;
+  addConstraints (vecdxhat);
+  double AATinvc[NCONDIM];
+  for (int k = 0; k < NCON; ++k) AATinvc[k] = vecdxhat[NPAR+k];
+  if (solveATA (AATinvc, MatM)) {
+    std::cout << "FixedSizeFitter::calc2ndOrderCorr: resorting to SVD" << std::endl;
+  }
+  for (int i = 0; i < NPAR; ++i) {
+    double s = 0;
+    for (int k = 0; k < NCON; ++k) s += MatM[i*IDIM+NPAR+k]*AATinvc[k];
+    vecdxhat[i] = -s;
+  }
+  for (int k = 0; k < NCON; ++k) vecdxhat[NPAR+k] = 0;
+}
+
+template <int NPAR, int NCON>
+int FixedSizeFitter<NPAR, NCON>::calcNewtonDx () {
+  int ncalc = 0;
+  double ptLp = 0;
+
+  do {
+    if (ncalc == 1) {
+      // try to recalculate lambdas
+      assembleConstDer (M);
+      determineLambdas (x, M);
+      if (debug>2) std::cout << "FixedSizeFitter::calcNewtonDx: ptLp=" << ptLp << " with lambdas from last iteration" << std::endl;
+    }
+    else if (ncalc == 2) {
+      // try to set lambdas to zero
+      for (int k = NPAR; k < IDIM; ++k) x[k] = 0;
+      if (debug>2) std::cout << "FixedSizeFitter::calcNewtonDx: ptLp=" << ptLp << " with recalculated lambdas" << std::endl;
+    }
+    else if (ncalc >= 3) {
+      if (debug>2) std::cout << "FixedSizeFitter::calcNewtonDx: ptLp=" << ptLp << " with zero lambdas" << std::endl;
+      break;
+    }
+
+    assembleM (M, x);
+    for (int i = 0; i < IDIM*IDIM; ++i) if (!std::isfinite (M[i])) return 1;
+
+    // Rescale columns and rows by perr
+    for (int i = 0; i < IDIM; ++i)
+      for (int j = 0; j < IDIM; ++j)
+        Mscal[i*IDIM+j] = perr[i]*perr[j]*M[i*IDIM+j];
+    assembley (y, x);
+    for (int i = 0; i < IDIM; ++i) if (!std::isfinite (y[i])) return 2;
+    for (int i = 0; i < IDIM; ++i) yscal[i] = perr[i]*y[i];
+
+    // from x_(n+1) = x_n - y/y' = x_n - M^(-1)*y we have M*(x_n-x_(n+1)) = y,
+    // which we solve for dx = x_n-x_(n+1) and hence x_(n+1) = x_n-dx
+    double epsLU = 1E-12;
+    double epsSV = 1E-3;
+    double detW;
+    solveSystem (detW, epsLU, epsSV);
+
+#ifndef FIT_TRACEOFF
+    traceValues["detW"] = detW;
+#endif
+
+    // step is - computed vector, dx = dxscal*e (component wise)
+    for (int i = 0; i < IDIM; ++i) {
+      dxscal[i] = -dxscal[i];
+      dx[i] = dxscal[i]*perr[i];
+    }
+
+    ptLp = calcpTLp (dx, M);
+    ++ncalc;
+  }
+  while (ptLp < 0);
+
+  return 0;
+}
+
+template <int NPAR, int NCON>
+int FixedSizeFitter<NPAR, NCON>::calcLimitedDx (double& alpha, double& mu, int imode) {
+  double *vecdxhat = v2;
+  alpha = 1;
+  double eta = 0.1;
+  double zeta = 0.5;
+
+  for (int i = 0; i < IDIM; ++i) xnew[i] = x[i] + alpha*dx[i];
+
+  mu = calcMu ();
+
+  updateParams (x);
+
+  double phi0  = meritFunction (mu, x);
+  double dphi0 = meritFunctionDeriv (mu);
+
+#ifndef FIT_TRACEOFF
+  traceValues["alpha"] = 0;
+  traceValues["phi"] = phi0;
+  traceValues["mu"] = mu;
+  if (tracer) tracer->substep (*this, 0);
+#endif
+
+  updateParams (xnew);
+
+  double phiR = meritFunction (mu, xnew);
+
+#ifndef FIT_TRACEOFF
+  traceValues["alpha"] = 1;
+  traceValues["phi"] = phiR;
+  if (tracer) tracer->substep (*this, 0);
+#endif
+
+  // Try Armijo's rule for alpha=1 first, do linesearch only if it fails
+  if (phiR > phi0 + eta*alpha*dphi0) {
+
+    // try second order correction first
+    if (try2ndOrderCorr) {
+      calc2ndOrderCorr (vecdxhat, M);
+      for (int i = 0; i < IDIM; ++i) {
+        v1[i] = xnew[i];
+        xnew[i] += vecdxhat[i];
+      }
+      updateParams (xnew);
+      double phi2ndOrder  = meritFunction (mu, xnew);
+
+#ifndef FIT_TRACEOFF
+      traceValues["alpha"] = 1.5;
+      traceValues["phi"] = phi2ndOrder;
+      if (tracer) tracer->substep (*this, 2);
+#endif
+
+      if (phi2ndOrder <= phi0 + eta*alpha*dphi0) {
+        if (debug > 2)
+          std::cout << "  -> 2nd order correction successfull!"  << std::endl;
+        return 1;
+      }
+      for (int i = 0; i < IDIM; ++i) xnew[i] = v1[i];
+      updateParams (xnew);
+#ifndef FIT_TRACEOFF
+      calcChi2();
+      traceValues["alpha"] = 1;
+      traceValues["phi"] = phiR;
+      if (tracer) tracer->substep (*this, 2);
+#endif
+    }
+
+    doLineSearch (alpha, imode, phi0, dphi0, eta, zeta, mu);
+  }
+
+  return 0;
+}
+
+template <int NPAR, int NCON>
+int FixedSizeFitter<NPAR, NCON>::doLineSearch (double& alpha, int imode,
+                                               double phi0, double dphi0,
+                                               double eta, double zeta, double mu) {
+  // don't do anything for imode = -1
+  if (imode < 0) return -1;
+
+  assert ((imode == 0) || eta<zeta);
+
+  if (dphi0 >= 0) {
+    // Difficult situation: merit function will increase,
+    // thus every step makes it worse
+    // => choose the minimum step and return
+    alpha = 0.001;
+    for (int i = 0; i < IDIM; ++i) xnew[i] = x[i] + alpha*dx[i];
+    updateParams (xnew);
+#ifndef FIT_TRACEOFF
+    traceValues["alpha"] = alpha;
+    traceValues["phi"] = meritFunction (mu, xnew);
+    if (tracer) tracer->substep (*this, 1);
+#endif
+    return 2;
+  }
+
+  // alpha=1 already tried
+  double alphaR = alpha;
+  for (int i = 0; i < IDIM; ++i) xnew[i] = x[i] + alpha*dx[i];
+  updateParams (xnew);
+
+  double alphaL = 0;
+  double phi, dphi;
+  int nitls = 0;
+
+  do {
+    nitls++;
+    // Choose new alpha
+    alpha = 0.5*(alphaL + alphaR);
+
+    for (int i = 0; i < IDIM; ++i) xnew[i] = x[i] + alpha*dx[i];
+    updateParams (xnew);
+
+    phi = meritFunction (mu, xnew);
+
+#ifndef FIT_TRACEOFF
+    traceValues["alpha"] = alpha;
+    traceValues["phi"] = phi;
+    if (tracer) tracer->substep (*this, 1);
+#endif
+
+    // Armijo's rule always holds
+    if (phi >= phi0 + eta*alpha*dphi0) {
+      alphaR = alpha;
+      continue;
+    }
+
+    if (imode == 0) {       // Armijo
+      break;
+    }
+    else if (imode == 1) {  // Wolfe
+      dphi = meritFunctionDeriv (mu);
+      if (dphi < zeta*dphi0) {
+        alphaL = alpha;
+      }
+      else {
+        break;
+      }
+    }
+    else {                  // Goldstein
+      if (phi < phi0 + zeta*alpha*dphi0) {
+        alphaL = alpha;
+      }
+      else {
+        break;
+      }
+    }
+  } while (nitls < 30 && (alphaL == 0 || nitls < 6));
+  if (alphaL > 0) alpha = alphaL;
+  return 1;
+}
+
+template <int NPAR, int NCON>
+double FixedSizeFitter<NPAR, NCON>::calcMu () {
+  double result = 0;
+  switch (imerit) {
+    case 1: // l1 penalty function, Nocedal&Wright Eq. (15.24)
+      {
+        double c[IDIM];
+        for (int i = 0; i < IDIM; ++i) c[i] = 0;
+        addConstraints (c);
+        // ||c||_1, and scaled by 1/(delta e)
+        double cnorm1 = 0;
+        double cnorm1scal = 0;
+        for (int k = NPAR; k < IDIM; ++k) {
+          cnorm1 += std::fabs (c[k]);
+          cnorm1scal += std::fabs (c[k]*perr[k]);
+        }
+
+        double rho = 0.1;
+        double eps = 0.001;
+
+        // calculate grad f^T*p
+        double gradf[IDIM];
+        assembleChi2Der (gradf);
+        double gradfTp = 0;
+        for (int i = 0; i < NPAR; ++i) gradfTp += gradf[i]*dx[i];
+
+        // all constraints very well fulfilled, use max(lambda+1) criterium
+        if (cnorm1scal < ncon*eps || gradfTp <= 0) {
+          for (int kglobal = NPAR; kglobal < IDIM; ++kglobal) {
+            double abslambda = std::fabs (xnew[kglobal]);
+            if (abslambda > result)
+              result = abslambda;
+          }
+          result /= (1-rho);
+        }
+        else {
+          // calculate p^T L p
+          double pTLp = calcpTLp (dx, M);
+          double sigma = (pTLp > 0) ? 1 : 0;
+          // Nocedal&Wright Eq. (18.36)
+          result = (gradfTp + 0.5*sigma*pTLp)/((1-rho)*cnorm1);
+        }
+      }
+      break;
+    case 2: // l1 penalty function, errors scaled, Nocedal&Wright Eq. (15.24)
+      result = 0;
+      for (int kglobal = NPAR; kglobal < IDIM; ++kglobal) {
+        double abslambdascal = std::fabs (x[kglobal]/perr[kglobal]);
+        if (abslambdascal > result)
+          result = abslambdascal;
+      }
+      break;
+    default: assert (0);
+  }
+  return result;
+}
+
+template <int NPAR, int NCON>
+double FixedSizeFitter<NPAR, NCON>::meritFunction (double mu, double *) {
+  double result = calcChi2();
+  for (ConstraintIterator i = constraints.begin(); i != constraints.end(); ++i) {
+    BaseHardConstraint *c = *i;
+    assert (c);
+    switch (imerit) {
+      case 1: // l1 penalty function, Nocedal&Wright Eq. (15.24)
+        result += mu*std::fabs (c->getValue());
+        break;
+      case 2: // l1 penalty function, errors scaled
+        // perr[kglobal] is 1/error for constraint k
+        result += mu*std::fabs (c->getValue()*perr[c->getGlobalNum()]);
+        break;
+      default: assert (0);
+    }
+  }
+  return result;
+}
+
+template <int NPAR, int NCON>
+double FixedSizeFitter<NPAR, NCON>::meritFunctionDeriv (double mu) {
+  // Nocedal&Wright Eq. (15.24), Eq. (18.29)
+  double gradf[IDIM];
+  assembleChi2Der (gradf);
+  double result = 0;
+  for (int i = 0; i < NPAR; ++i) result += dx[i]*gradf[i];
+  for (ConstraintIterator i = constraints.begin(); i != constraints.end(); ++i) {
+    BaseHardConstraint *c = *i;
+    assert (c);
+    switch (imerit) {
+      case 1: result -= mu*std::fabs (c->getValue()); break;
+      case 2: result -= mu*std::fabs (c->getValue())*perr[c->getGlobalNum()]; break;
+      default: assert (0);
+    }
+  }
+  return result;
+}
+
+template <int NPAR, int NCON>
+double FixedSizeFitter<NPAR, NCON>::calcpTLp (const double *vecdx, const double *MatM) const {
+  double result = 0;
+  for (int i = 0; i < NPAR; ++i) {
+    double Lpi = 0;
+    for (int j = 0; j < NPAR; ++j) Lpi += MatM[i*IDIM+j]*vecdx[j];
+    result += vecdx[i]*Lpi;
+  }
+  return result;
+}
+
+template <int NPAR, int NCON>
+int FixedSizeFitter<NPAR, NCON>::solveSystemLDL (const double *MatMscal, double& detW, double epsLU) {
+  for (int i = 0; i < IDIM*IDIM; ++i) W[i] = MatMscal[i];
+  detW = 0;
+  if (NewFitterGSL::bunchKaufmanDecomp (W, IDIM, IDIM, ipiv) != 0) return 1;
+  detW = NewFitterGSL::bunchKaufmanDet (W, IDIM, IDIM, ipiv, inertiaPos, inertiaNeg, inertiaZero);
+  if (std::fabs (detW) < epsLU) return 2;
+  if (!std::isfinite (detW)) return 3;
+  for (int i = 0; i < IDIM; ++i) dxscal[i] = yscal[i];
+  NewFitterGSL::bunchKaufmanSolve (W, IDIM, IDIM, ipiv, dxscal);
+  return 0;
+}
+
+template <int NPAR, int NCON>
+int FixedSizeFitter<NPAR, NCON>::solveSystem (double& detW, double epsLU, double epsSV) {
+  // Same steps as NewFitterGSL: LDL^T factorization of Mscal, 
+  // with the measured diagonal shifted while the inertia is wrong
+  // (see NewFitterGSL::correctInertia), SVD if Mscal is singular
+  inertiaZero = -1;
+  if (solveSystemLDL (Mscal, detW, epsLU) == 0) {
+    if (inertiaNeg == NCON && inertiaZero == 0) return 0;
+    if (inertiadelta > 0) {
+      for (double delta = inertiadelta; delta <= 1E4; delta *= 10) {
+        for (int i = 0; i < IDIM*IDIM; ++i) W2[i] = Mscal[i];
+        for (int i = 0; i < nmeasured; ++i) W2[imeasured[i]*IDIM+imeasured[i]] += delta;
+        if (solveSystemLDL (W2, detW, epsLU) == 0 && inertiaNeg == NCON && inertiaZero == 0) {
+          if (debug>2) std::cout << "FixedSizeFitter::solveSystem: inertia corrected with delta=" << delta << std::endl;
+          return 0;
+        }
+      }
+      // No shift helped: take the unmodified Newton step
+      solveSystemLDL (Mscal, detW, epsLU);
+    }
+    return 0;
+  }
+
+  // SVD of Mscal, on views of the member arrays
+  if (debug>0) std::cout << "FixedSizeFitter::solveSystem: using SVD" << std::endl;
+  inertiaZero = -1;
+  for (int i = 0; i < IDIM*IDIM; ++i) W[i] = Mscal[i];
+  gsl_matrix_view U = gsl_matrix_view_array (W, IDIM, IDIM);
+  gsl_matrix_view V = gsl_matrix_view_array (W2, IDIM, IDIM);
+  gsl_vector_view S = gsl_vector_view_array (v1, IDIM);
+  gsl_vector_const_view yview = gsl_vector_const_view_array (yscal, IDIM);
+  gsl_vector_view xview = gsl_vector_view_array (dxscal, IDIM);
+  NewFitterGSL::solveSVD (&U.matrix, &V.matrix, &S.vector, &yview.vector, &xview.vector, epsSV);
+  return 1;
+}
+
+template <int NPAR, int NCON>
+void FixedSizeFitter<NPAR, NCON>::calcCovMatrix() {
+  // Same error propagation as NewFitterGSL::calcCovMatrix:
+  // M*dadeta + dydeta = 0, with dydeta = -d^2 chi^2 / d a d a,
+  // Cov_a = dadeta*Cov_eta*dadeta^T
+  covValid = false;
+  double H[NPAR*NPAR];
+  double Coveta[NPAR*NPAR];
+  for (int i = 0; i < NPAR*NPAR; ++i) H[i] = Coveta[i] = 0;
+  for (FitObjectIterator i = fitobjects.begin(); i != fitobjects.end(); ++i) {
+    BaseFitObject *fo = *i;
+    assert (fo);
+    fo->addToGlobalChi2DerMatrix (H, NPAR);
+    fo->addToGlobCov (Coveta, NPAR);
+  }
+
+  assembleM (W, x, true);
+  if (NewFitterGSL::bunchKaufmanDecomp (W, IDIM, IDIM, ipiv)) {
+    if (debug > 0) std::cout << "FixedSizeFitter::calcCovMatrix: M is singular" << std::endl;
+    return;
+  }
+
+  // dadeta = M^-1*H (column by column), stored as rows of D
+  double D[NPAR*IDIM];
+  for (int j = 0; j < NPAR; ++j) {
+    double *col = D + j*IDIM;
+    for (int i = 0; i < NPAR; ++i) col[i] = H[i*NPAR+j];
+    for (int i = NPAR; i < IDIM; ++i) col[i] = 0;
+    NewFitterGSL::bunchKaufmanSolve (W, IDIM, IDIM, ipiv, col);
+  }
+  // T = Cov_eta*dadeta^T (first NPAR columns)
+  double T[NPAR*NPAR];
+  for (int k = 0; k < NPAR; ++k) {
+    for (int j = 0; j < NPAR; ++j) {
+      double s = 0;
+      for (int l = 0; l < NPAR; ++l) s += Coveta[k*NPAR+l]*D[l*IDIM+j];
+      T[k*NPAR+j] = s;
+    }
+  }
+
+  if (cov && covDim != NPAR) {
+    delete[] cov;
+    cov = 0;
+  }
+  covDim = NPAR;
+  if (!cov) cov = new double[covDim*covDim];
+  for (int i = 0; i < NPAR; ++i) {
+    for (int j = 0; j < NPAR; ++j) {
+      double s = 0;
+      for (int k = 0; k < NPAR; ++k) s += D[k*IDIM+i]*T[k*NPAR+j];
+      cov[i*covDim+j] = s;
+    }
+  }
+  covValid = true;
+}
+
+#endif // __FIXEDSIZEFITTER_H
@@ -2,6 +2,8 @@
  *  \brief Declares class FourVector
  *
  * \b Changelog:
+ * - 16.10.2026 Available without ROOT; decayto and setSeed moved to the ROOT adapter library
+ * - 16.10.2026 decayto with a given random number generator
  *
  * \b CVS Log messages:
  * - $Log: FourVector.h,v $
@@ -16,8 +18,6 @@
  *
  */ 
  
-#ifdef MARLIN_USE_ROOT
-
 #ifndef __FOURVECTOR_H
 #define __FOURVECTOR_H
 
@@ -27,6 +27,8 @@
 #include <cmath>
 #include <cassert>
 
+class TRandom;
+
 //  Class FourVector:
 /// Yet another four vector class, with metric +---
 /**
@@ -90,7 +92,12 @@ class FourVector {
     inline const ThreeVector& getThreeVector() const { return p;}
     
     FourVector& boost (const FourVector& P);
+    /// Lets this particle decay isotropically into d1 and d2; needs the ROOT adapter library
     void decayto (FourVector& d1, FourVector& d2) const;
+    /// Lets this particle decay isotropically into d1 and d2, with random numbers from random; needs the ROOT adapter library
+    void decayto (FourVector& d1, FourVector& d2, TRandom& random) const;
+    /// Restarts the random number generator of decayto with a seed (must not be 0); needs the ROOT adapter library
+    static void setSeed (unsigned int seed);
     
     inline void setValues (double E_, double px_, double py_, double pz_);
     
@@ -226,5 +233,3 @@ inline std::ostream& operator<< (std::ostream& os,
 
 
 #endif // __FOURVECTOR_H
-
-#endif // MARLIN_USE_ROOT
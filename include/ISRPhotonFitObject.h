@@ -88,6 +88,7 @@ class ISRPhotonFitObject : public ParticleFitObject {
   protected:
     
     enum {NPAR=3}; // well, it's actually 1...Daniel should update
+    ParamStorage<NPAR> paramstorage;   ///< Parameters, flags and covariance matrices, see BaseFitObject
 
     virtual double PgFromPz(double pz);
     
@@ -2,7 +2,9 @@
  *  \brief Declares class JetFitObject
  *
  * \b Changelog:
- * - 
+ * - 16.10.2026 Added setValues, to reuse an object for a new jet
+ * - 16.10.2026 Parameters in storage for NPAR parameters
+ * - 16.10.2026 Cached quantities in an array, calculated by static functions shared with JetFitObjectBlock
  *
  * \b CVS Log messages:
  * - $Log: JetFitObject.h,v $
@@ -60,6 +62,11 @@ class JetFitObject : public ParticleFitObject {
                  double DE, double Dtheta, double Dphi, 
                  double m = 0);
                  
+    /// Set new values and errors, as the constructor does; keeps the name
+    virtual void setValues (double E, double theta, double phi, 
+                            double DE, double Dtheta, double Dphi, 
+                            double m = 0);
+                 
     /// Copy constructor
     JetFitObject (const JetFitObject& rhs              ///< right hand side
                    );
@@ -118,23 +125,41 @@ class JetFitObject : public ParticleFitObject {
     virtual double getFirstDerivative_Meta_Local( int iMeta, int ilocal , int metaSet ) const;
     virtual double getSecondDerivative_Meta_Local( int iMeta, int ilocal , int jlocal , int metaSet ) const;
 
+    /// Indices of the cached quantities in a cache array
+    enum {CTHETA, STHETA, CPHI, SPHI, P2, P, PT, PX, PY, PZ,
+          DPDE, DPTDE, DPXDE, DPYDE, DPZDE, DPXDTHETA, DPYDTHETA, NCACHE};
+
+    // The calculations with the cached quantities of a jet, c[k*stride] for
+    // k = CTHETA ... DPYDTHETA; also used by JetFitObjectBlock, which stores
+    // the cached quantities of several jets interleaved
+
+    /// Calculate the cached quantities of a jet with energy e, angles theta and phi and mass m
+    static void calculateCache (double e, double theta, double phi, double m, double *c, int stride);
+    /// Derivative of px w.r.t. parameter ilocal from the cached quantities
+    static double getDPx (const double *c, int stride, int ilocal);
+    /// Derivative of py w.r.t. parameter ilocal from the cached quantities
+    static double getDPy (const double *c, int stride, int ilocal);
+    /// Derivative of pz w.r.t. parameter ilocal from the cached quantities
+    static double getDPz (const double *c, int stride, int ilocal);
+    /// Second derivative of meta-variable iMeta w.r.t. parameters ilocal and jlocal from the cached quantities and the mass m
+    static double getSecondDerivative_Meta_Local (const double *c, int stride, double m, int iMeta, int ilocal, int jlocal);
+
+    /// Adjust E, theta and phi such that E>=m, 0<=theta<=pi, -pi <= phi < pi; returns true if anything was changed
+    static bool adjustEThetaPhi (double& m, double &E, double& theta, double& phi);
+
     /// Get chi squared from measured and fitted parameters
     //    virtual double getChi2() const;
 
   protected:
     
     enum {NPAR=3};
+    ParamStorage<NPAR> paramstorage;   ///< Parameters, flags and covariance matrices, see BaseFitObject
     
     void updateCache() const;
 
-    mutable double ctheta, stheta, cphi, sphi,
-                   p2, p, pt, px, py, pz, dpdE, dptdE, 
-                   dpxdE, dpydE, dpzdE, dpxdtheta, dpydtheta,
-                   chi2;
+    mutable double cache[NCACHE];   ///< The cached quantities, see calculateCache
+    mutable double chi2;
                    // d2pdE2, d2ptsE2;
-                   
-    /// Adjust E, theta and phi such that E>=m, 0<=theta<=pi, -pi <= phi < pi; returns true if anything was changed             
-    static bool adjustEThetaPhi (double& m, double &E, double& theta, double& phi);
     
     /// Calculate chi2 
     //    double calcChi2 () const;
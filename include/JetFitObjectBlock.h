@@ -0,0 +1,100 @@
+/*! \file
+ *  \brief Declares class JetFitObjectBlock
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ * - 16.10.2026 Parameters and caches stored in the block, the jets are views of them
+ *
+ */
+
+#ifndef __JETFITOBJECTBLOCK_H
+#define __JETFITOBJECTBLOCK_H
+
+#include "JetFitObject.h"
+#include "ChainRuleKernels.h"
+
+#include <vector>
+
+// Class JetFitObjectBlock
+/// A set of jets whose caches are calculated together
+/**
+ * JetFitObject::updateCache calculates sin and cos of theta and phi, p, pt,
+ * the momentum components and their derivatives for one jet.
+ * A JetFitObjectBlock holds many jets, e.g. all jets of an event with many
+ * jets, or of a batch of events, and calculates these quantities for all
+ * of them at once: with AVX, four jets at a time.
+ *
+ * The block stores the parameters, masses and cached quantities of the jets
+ * in chunks of four jets; the cached quantities of a chunk are interleaved,
+ * one vector of four values per quantity (see JetFitObject::calculateCache),
+ * so that the AVX version writes them directly, without copying.
+ * The jets are fit objects with the parametrisation of JetFitObject
+ * (E, theta, phi), created with addJet and owned by the block, which
+ * refer to their place in a chunk; they are used like other fit objects
+ * with constraints and fitters, and copy() returns a JetFitObject.
+ * When the cache of any of them is invalid (e.g. after updateParams),
+ * the next access to it calls updateCache() of the block,
+ * which recalculates the caches of all jets.
+ * \code
+ * JetFitObjectBlock block;
+ * ParticleFitObject *j1 = block.addJet (E1, theta1, phi1, DE1, Dtheta1, Dphi1);
+ * ParticleFitObject *j2 = block.addJet (E2, theta2, phi2, DE2, Dtheta2, Dphi2);
+ * fitter.addFitObject (j1);
+ * fitter.addFitObject (j2);
+ * \endcode
+ *
+ * As with ChainRuleKernels, the AVX version is used if the CPU supports it
+ * (setKernel selects a version explicitly). It calculates sin and cos with
+ * a polynomial, accurate to about 1 ulp (std::sin and std::cos are used for
+ * angles beyond 1E6), so that its results differ from those of JetFitObject
+ * in the last bits. The portable version does the calculation of
+ * JetFitObject for one jet after the other and gives the same results.
+ *
+ */
+
+class JetFitObjectBlock {
+  public:
+    /// Constructor: an empty block
+    JetFitObjectBlock();
+    /// Destructor: deletes the jets
+    ~JetFitObjectBlock();
+
+    /// Add a jet, with the arguments of the JetFitObject constructor; the block owns it
+    ParticleFitObject *addJet (double E, double theta, double phi,
+                               double DE, double Dtheta, double Dphi,
+                               double m = 0);
+
+    /// Get the number of jets
+    int getNJets() const {return jets.size();}
+    /// Get jet i
+    ParticleFitObject *getJet (int i     ///< Number of the jet, in the order of addJet
+                              ) const;
+
+    /// Recalculate the caches of all jets
+    void updateCache() const;
+
+    /// Select the implementation (AUTO, SCALAR or AVX); returns false (and changes nothing) if it is not available.
+    /// Must not be called while other threads run fits.
+    static bool setKernel (ChainRuleKernels::Kernel kernel     ///< The implementation; AUTO selects the fastest
+                          );
+    /// Get the selected implementation
+    static ChainRuleKernels::Kernel getKernel();
+
+  private:
+    class Jet;
+    struct Chunk;
+    friend class Jet;
+
+    enum {NLANES = 4};                   ///< Number of jets in a chunk
+
+    std::vector <Jet *> jets;            ///< The jets
+    std::vector <Chunk *> chunks;        ///< Parameters, masses and cached quantities of the jets, NLANES jets per chunk
+    mutable bool cachevalid;             ///< Whether the cached quantities of all jets are valid
+
+    static ChainRuleKernels::Kernel kernel;   ///< The selected implementation
+
+    JetFitObjectBlock (const JetFitObjectBlock&);              // not copyable
+    JetFitObjectBlock& operator= (const JetFitObjectBlock&);   // not assignable
+};
+
+#endif // __JETFITOBJECTBLOCK_H
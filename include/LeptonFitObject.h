@@ -8,10 +8,11 @@
 #define __LEPTONFITOBJECT_H
 
 #include "ParticleFitObject.h"
-#include "EVENT/Track.h"
-#include "lcio.h"
 
-using namespace lcio ;
+namespace EVENT {
+  class Track;
+  class TrackState;
+}
 
 // Class LeptonFitObject
 // Class for leptons with (q/pt, theta, phi) in kinematic fits
@@ -23,17 +24,22 @@ class LeptonFitObject : public ParticleFitObject {
                   double Dptinv, double Dtheta, double Dphi,
                   double m = 0);
 
+    /// Set new values and errors, as the constructor does; keeps the name
+    virtual void setValues (double ptinv, double theta, double phi,
+                            double Dptinv, double Dtheta, double Dphi,
+                            double m = 0);
+
     /// Extended constructor with correlation coefficients
     LeptonFitObject(double ptinv, double theta, double phi,
                   double Dptinv, double Dtheta, double Dphi,
                   double Rhoptinvtheta, double Rhoptinvphi, double Rhothetaphi,
                   double m = 0);
 
-    /// Extended constructor based simply on LCIO Track
-    LeptonFitObject(Track* track, double Bfield, double m = 0);
+    /// Extended constructor based simply on LCIO Track; defined in the LCIO adapter library
+    LeptonFitObject(EVENT::Track* track, double Bfield, double m = 0);
 
-    /// Extended constructor based on LCIO TrackState
-    LeptonFitObject(const TrackState* trackstate, double Bfield, double m = 0);
+    /// Extended constructor based on LCIO TrackState; defined in the LCIO adapter library
+    LeptonFitObject(const EVENT::TrackState* trackstate, double Bfield, double m = 0);
                  
     /// Copy constructor
     LeptonFitObject (const LeptonFitObject& rhs              ///< right hand side
@@ -89,6 +95,7 @@ class LeptonFitObject : public ParticleFitObject {
     static bool adjustPtinvThetaPhi (double& m, double &ptinv, double& theta, double& phi);
 
     enum {NPAR=3};
+    ParamStorage<NPAR> paramstorage;   ///< Parameters, flags and covariance matrices, see BaseFitObject
 
 };
 
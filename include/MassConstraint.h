@@ -79,12 +79,35 @@ class MassConstraint : public ParticleConstraint {
                                     int j,                        ///< number of 2nd FitObject
                                     double *derivatives           ///< The result 4x4 matrix 
                                    ) const;
+    /// Second derivatives are nonzero only for two fit objects of the same set
+    virtual bool hasSecondDerivatives (int i,           ///< number of 1st FitObject
+                                       int j            ///< number of 2nd FitObject
+                                      ) const;
 
     /// First derivatives with respect to the 4-vector of Fit objects i; result false if all derivatives are zero 
     virtual bool firstDerivatives (int i,                        ///< number of 1st FitObject
                                    double *derivatives           ///< The result 4-vector
                                   ) const;
 
+    /// Calculate the sums of the four-momenta of both sets of fit objects and the value
+    virtual void evaluate() const;
+    /// Calculate the first derivatives for both sets from the sums of evaluate()
+    void evaluate1stDerivatives() const;
+    /// Calculate the second derivatives for both sets from the sums of evaluate()
+    void evaluate2ndDerivatives() const;
+
+    // Results of evaluate(); index 0 is the set with flag 1, index 1 the other fit objects
+    mutable double totE[2];        ///< Sum of the energies
+    mutable double totpx[2];       ///< Sum of px
+    mutable double totpy[2];       ///< Sum of py
+    mutable double totpz[2];       ///< Sum of pz
+    mutable bool nonempty[2];      ///< Whether the set has fit objects
+    mutable double value;          ///< Value of the constraint
+    mutable bool have1st;          ///< Whether dgdp is calculated
+    mutable bool have2nd;          ///< Whether d2gdp2 is calculated
+    mutable double dgdp[2][4];     ///< First derivatives w.r.t. the 4-vector of a fit object of the set
+    mutable double d2gdp2[2][16];  ///< Second derivatives w.r.t. the 4-vectors of two fit objects of the set
+
     enum { VAR_BASIS=0 }; // this means that the constraint knows about E,px,py,pz
 
 };
@@ -76,12 +76,20 @@ class MomentumConstraint : public ParticleConstraint {
     
     mutable bool cachevalid;
     mutable int  nparams;
+    mutable double currentvalue;   ///< Value of the constraint from evaluate()
+  
+    /// Calculate the value; the derivatives are constant
+    virtual void evaluate() const;
   
     /// Second derivatives with respect to the 4-vectors of Fit objects i and j; result false if all derivatives are zero 
     virtual bool secondDerivatives (int i,                        ///< number of 1st FitObject
                                     int j,                        ///< number of 2nd FitObject
                                     double *derivatives           ///< The result 4x4 matrix 
                                    ) const;
+    /// The constraint is linear, there are no second derivatives
+    virtual bool hasSecondDerivatives (int i,           ///< number of 1st FitObject
+                                       int j            ///< number of 2nd FitObject
+                                      ) const;
     /// First derivatives with respect to the 4-vector of Fit objects i; result false if all derivatives are zero 
     virtual bool firstDerivatives (int i,                        ///< number of 1st FitObject
                                    double *derivatives           ///< The result 4-vector
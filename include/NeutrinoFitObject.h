@@ -19,12 +19,17 @@
  * - 30.12.04 BL: addToGlobCov, getDChi2DParam, getDChi2DParam2,
  *            addToGlobalChi2DerMatrix moved up to ParticleFitObject,
  *            getParamName implemented
+ * - 16.10.2026 Parameters in storage for NPAR parameters
  */ 
 class NeutrinoFitObject : public ParticleFitObject {
   public:
     NeutrinoFitObject(double E, double theta, double phi, 
                       double DE=1, double Dtheta=0.1, double Dphi=0.1);
                  
+    /// Set new values and errors, as the constructor does; keeps the name
+    virtual void setValues (double E, double theta, double phi, 
+                            double DE=1, double Dtheta=0.1, double Dphi=0.1);
+                 
     /// Copy constructor
     NeutrinoFitObject (const NeutrinoFitObject& rhs              ///< right hand side
                    );
@@ -65,6 +70,7 @@ class NeutrinoFitObject : public ParticleFitObject {
     void updateCache() const;
     
     enum {NPAR=3};
+    ParamStorage<NPAR> paramstorage;   ///< Parameters, flags and covariance matrices, see BaseFitObject
   
     mutable double ctheta, stheta, cphi, sphi,
                    pt, px, py, pz, dptdE, 
@@ -9,6 +9,17 @@
  *
  * \b Changelog:
  * - 15.11.2010 First version
+ * - 16.10.2026 fit() split into startFit(), iterate() and finishFit()
+ * - 16.10.2026 Added sparse solver for large fit problems
+ * - 16.10.2026 Newton step with symmetric indefinite LDL^T factorization, inertia of M
+ * - 16.10.2026 Warm start from given parameters and Lagrange multipliers
+ * - 16.10.2026 Covariance matrix on demand, and for parts of the parameters
+ * - 16.10.2026 Work arrays of the constraint derivatives from a ScratchArena
+ * - 16.10.2026 Optional trust region step control
+ * - 16.10.2026 Optional quasi-Newton approximation of the Hessian of the Lagrangian
+ * - 16.10.2026 Phase hooks for the tracer
+ * - 16.10.2026 Optional shifted Hessian for Newton steps with wrong inertia
+ * - 16.10.2026 SVD solutions as static kernels, shared with FixedSizeFitter
  *
  * \b CVS Log messages:
  * - $Log: NewFitterGSL.h,v $
@@ -34,6 +45,12 @@
 #include <gsl/gsl_permutation.h>
 #include <gsl/gsl_eigen.h>
 
+#include <vector>
+
+class SparseSymMatrix;
+class SparseLDLSolver;
+class ScratchArena;
+
 // Class NewFitterGSL
 /// A kinematic fitter using the Newton-Raphson method to solve the equations
 /**
@@ -41,6 +58,48 @@
  * to solve the system of equations arising from the Lagrange multiplier
  * method
  *
+ * For large fit problems (many fit objects and constraints, e.g. several
+ * events fitted together), the Newton steps can be computed with a sparse
+ * LDL^T factorization of the KKT matrix M instead of the dense factorization,
+ * see setSolverMode(). In this mode, the dense idim x idim matrices
+ * (M, W etc.) are not allocated; memory and time then grow with the
+ * number of nonzero elements of M. If the sparse factorization fails,
+ * the fitter falls back to the dense solver for that step.
+ *
+ * The dense Newton steps use a symmetric indefinite LDL^T factorization
+ * with Bunch-Kaufman pivoting, which needs half the operations of an LU
+ * decomposition. Both the dense and the sparse factorization give the
+ * inertia of M: if the constraint derivatives have full rank, 
+ * the reduced Hessian is positive definite if and only if M has npar
+ * positive and ncon negative eigenvalues, see getInertia().
+ * Optionally, if the inertia is wrong, the step is computed with a 
+ * shifted Hessian, see setInertiaCorrection().
+ * The LU decomposition that was used before is kept as solveSystemLU,
+ * as a cross-check of the LDL^T solution.
+ *
+ * By default, the length of each Newton step is limited by a line search
+ * on a merit function (calcLimitedDx). Alternatively, a dogleg trust region
+ * on the scaled residual of the Newton equations can be used, 
+ * see setStepControl(). All trial steps of the trust region are 
+ * combinations of the Newton step and the gradient of the residual, 
+ * therefore M is factorized only once per iteration, 
+ * however often the radius has to be reduced.
+ *
+ * The second derivatives of the chi^2 and the constraints, which make up
+ * the upper left npar x npar block of M (the Hessian of the Lagrangian), 
+ * can be approximated by a damped BFGS or a SR1 update from the change of
+ * the gradient of the Lagrangian, see setHessianMode(). The exact second
+ * derivatives are then only calculated in the first iteration and when
+ * the approximation leads to a step with wrong curvature.
+ *
+ * fit() consists of startFit(), iterate() until it returns false, and
+ * finishFit(); calling them directly allows to advance several fits
+ * step by step, e.g. to interleave the fits of several events.
+ * A fitter that is reused for the next event of the same topology
+ * (reset(), then the fit objects and constraints of the new event)
+ * keeps its work space, since initialize() only reallocates vectors
+ * and matrices whose dimension changes.
+ *
  * Author: Benno List
  * Last update: $Date: 2011/05/03 13:16:41 $
  *          by: $Author: blist $
@@ -60,6 +119,13 @@ class NewFitterGSL : public BaseFitter {
     /// The fit method, returns  the fit probability
     virtual double fit();
     
+    /// Prepare a fit: order parameters, get start values and lambdas
+    virtual void startFit();
+    /// Perform one Newton iteration; returns false if the iteration has stopped
+    virtual bool iterate();
+    /// Calculate errors and the fit probability after the last iteration, returns the fit probability
+    virtual double finishFit();
+    
     /// Get the error code of the last fit: 0=OK, 1=failed
     virtual int getError() const;
     
@@ -90,6 +156,145 @@ class NewFitterGSL : public BaseFitter {
     /// Set the Debug Level
     virtual void setDebug (int debuglevel);
     
+    /// Solvers for the Newton steps
+    enum {SOLVER_DENSE = 0,   ///< Dense LDL^T factorization with Bunch-Kaufman pivoting, SVD as fallback
+          SOLVER_SPARSE = 1,  ///< Sparse LDL^T factorization
+          SOLVER_AUTO = 2     ///< Sparse if idim >= SPARSEDIMMIN, dense otherwise
+         };
+    /// Minimum dimension of M for the sparse solver in mode SOLVER_AUTO
+    enum {SPARSEDIMMIN = 50};
+    /// Set the solver mode (default: SOLVER_AUTO); takes effect at the next initialize()
+    virtual void setSolverMode (int mode);
+    /// Get the solver mode
+    virtual int getSolverMode () const;
+    /// Whether the sparse solver is used for the current fit
+    virtual bool usesSparseSolver () const;
+    /// Get the inertia of M from the last Newton step; returns false if it is not known (SVD solution)
+    virtual bool getInertia (int& npos,   ///< Number of positive eigenvalues
+                             int& nneg,   ///< Number of negative eigenvalues
+                             int& nzero   ///< Number of zero eigenvalues
+                            ) const;
+    /// Set the initial shift for a Newton step with wrong inertia of M (default: 0, no correction)
+    /**
+     * The correction changes the Newton steps, and therefore the fit results,
+     * iteration counts and failure rates, compared to fits without it;
+     * it is off by default, and 1E-4 is a sensible value to switch it on.
+     * If M does not have npar positive and ncon negative eigenvalues,
+     * the Newton step need not lead towards a minimum of the chi2.
+     * The diagonal elements of the scaled M that belong to measured
+     * parameters are then increased by delta, 10*delta, ..., up to 1E4,
+     * until the inertia is right (cf. Nocedal/Wright, Sect. 16.2).
+     * If no shift gives the right inertia, the unmodified step is taken;
+     * each shift costs one more factorization of M.
+     */
+    virtual void setInertiaCorrection (double delta);
+    /// Get the initial shift for a Newton step with wrong inertia of M
+    virtual double getInertiaCorrection () const;
+
+    /// Set start values of the parameters and Lagrange multipliers for the next fit (warm start)
+    /**
+     * The values are given in the global numbering of the parameters
+     * and constraints, as returned by getSolution().
+     * They are used only by the next startFit(); they are ignored if the
+     * number of parameters or constraints does not match the fit problem.
+     * If no Lagrange multipliers are given, they are determined from the start
+     * parameters as in a fit without start values.
+     */
+    virtual void setStartValues (int npar_,                  ///< Number of parameters, must be getNpar()
+                                 const double *par,          ///< Start values of the parameters
+                                 int ncon_ = 0,              ///< Number of Lagrange multipliers, 0 or getNcon()
+                                 const double *lambda = 0    ///< Start values of the Lagrange multipliers
+                                );
+    /// Use the result of the last fit as start values for the next fit; returns false if there is no successful fit
+    virtual bool setStartValuesFromLastFit ();
+    /// Get the fitted parameters and Lagrange multipliers of the last fit; returns false if the dimensions don't match
+    virtual bool getSolution (int npar_,                ///< Number of parameters, must be getNpar()
+                              double *par,              ///< Fitted parameters, in the global numbering
+                              int ncon_ = 0,            ///< Number of Lagrange multipliers, 0 or getNcon()
+                              double *lambda = 0        ///< Lagrange multipliers
+                             ) const;
+
+    /// Set whether the covariance matrix is calculated at the end of each fit (default) or on demand
+    /**
+     * In lazy mode, finishFit() does not calculate the covariance matrix,
+     * and the errors of the fit objects are not updated.
+     * The covariance matrix is calculated when it is requested by
+     * getGlobalCovarianceMatrix(), updateFitObjectCov() or getCovarianceBlock(),
+     * which must happen before the fit objects are changed or the next fit is started.
+     * Only the requested rows of the covariance matrix are calculated, with one
+     * solve per parameter using a factorization of M, instead of the inverse of M.
+     *
+     * The eager mode stays the default because the fitted errors of the fit objects
+     * are part of the fit result: code that reads them directly from the fit objects,
+     * like PullStudyDriver or the printout of TopEventILC, would otherwise silently
+     * see the measured errors. Switch on the lazy mode where the errors are
+     * not needed, or are only needed for a few fit objects.
+     */
+    virtual void setLazyCovariance (bool lazy    ///< true: calculate covariance matrix on demand
+                                   );
+    /// Whether the covariance matrix is calculated on demand
+    virtual bool getLazyCovariance () const;
+    /// Get the global covariance matrix of the last fit; calculates it in lazy mode
+    virtual double *getGlobalCovarianceMatrix (int& idim ///< 1st dimension of global covariance matrix
+                                              );
+    /// Get the global covariance matrix of the last fit, if it has been calculated already
+    /**
+     * This version cannot complete a pending calculation in lazy mode;
+     * then it returns 0 and sets idim to 0, as after a failed fit.
+     * It never returns the matrix of an earlier fit, since the matrix
+     * is invalidated at the start of each fit.
+     * Use the non-const version, or getCovarianceBlock(), to calculate the matrix.
+     */
+    virtual const double *getGlobalCovarianceMatrix (int& idim ///< 1st dimension of global covariance matrix
+                                                    ) const;
+    /// Calculate the covariance matrix of the fitted parameters of one fit object and set it there; returns false on failure
+    virtual bool updateFitObjectCov (BaseFitObject *fo   ///< The fit object, must be part of the last fit
+                                    );
+    /// Calculate a block of the covariance matrix of the fitted parameters; returns false on failure
+    virtual bool getCovarianceBlock (int n,              ///< Number of parameters
+                                     const int *index,   ///< Global numbers of the parameters
+                                     double *covblock    ///< Result, n x n
+                                    );
+
+    /// Get the number of work arrays that the constraints used during the last fit
+    /**
+     * The constraints take the work arrays of add2ndDerivativesToMatrix
+     * from a ScratchArena owned by the fitter, which is made large enough in initialize().
+     * Each of these arrays used to be a separate heap allocation.
+     */
+    virtual int getNScratchRequests () const;
+    /// Get the number of heap allocations for work arrays during the last fit (after initialize())
+    virtual int getNScratchAllocations () const;
+    
+    /// Step control of the iterations
+    enum {STEP_LINESEARCH = 0,    ///< Line search on the merit function, see calcLimitedDx()
+          STEP_TRUSTREGION = 1    ///< Dogleg trust region on the residual of the Newton equations, see calcTrustRegionDx()
+         };
+    /// Set the step control (default: STEP_LINESEARCH)
+    virtual void setStepControl (int mode);
+    /// Get the step control
+    virtual int getStepControl () const;
+    /// Get the number of trial points of the last fit (merit function or residual evaluations)
+    virtual int getNTrialPoints () const;
+    
+    /// Calculation of the Hessian of the Lagrangian in the Newton steps
+    enum {HESSIAN_EXACT = 0,      ///< Second derivatives in every iteration
+          HESSIAN_BFGS = 1,       ///< Damped BFGS update, see updateHessian()
+          HESSIAN_SR1 = 2         ///< Symmetric rank one update, see updateHessian()
+         };
+    /// Set the Hessian mode (default: HESSIAN_EXACT); the sparse solver always uses the exact second derivatives
+    virtual void setHessianMode (int mode);
+    /// Get the Hessian mode
+    virtual int getHessianMode () const;
+    /// Set after how many quasi-Newton updates the exact second derivatives are recalculated; 0 (default): only when needed
+    virtual void setHessianRestart (int nupdate);
+    /// Get after how many quasi-Newton updates the exact second derivatives are recalculated
+    virtual int getHessianRestart () const;
+    /// Get the number of Newton steps of the last fit with exact second derivatives
+    virtual int getNExactHessians () const;
+    /// Get the number of Newton steps of the last fit with a quasi-Newton update of the Hessian
+    virtual int getNHessianUpdates () const;
+    
     /// Determine best lambda values
     virtual void determineLambdas (gsl_vector *vecxnew,        ///< vector with new lambda values
                                    const gsl_matrix *MatM,     ///< matrix with constraint derivatives
@@ -107,6 +312,18 @@ class NewFitterGSL : public BaseFitter {
                                          gsl_vector *vecw,     ///< work vector
                                          double eps = 0        ///< Singular values < eps*(max(abs(s_i))) are set to 0
                                   );
+    
+    /// Determine best lambda values, sparse version
+    virtual void determineLambdas (gsl_vector *vecxnew,         ///< vector with new lambda values
+                                   const SparseSymMatrix& MatM, ///< matrix with constraint derivatives
+                                   gsl_vector *vecw             ///< work vector
+                                  );
+
+    /// Calculate 2nd order correction step, sparse version
+    virtual void calc2ndOrderCorr (      gsl_vector *vecdxhat,    ///< the correction step
+                                   const SparseSymMatrix& MatM,   ///< The matrix of the last Newton step
+                                         gsl_vector *vecw         ///< work vector
+                                  );
                                   
     /// Calculate null space of constraints; return value is a matrix view of MatW1, with column vectors spanning null(A)
     virtual gsl_matrix_view calcZ (int& rankA,              ///< rank of A (= number of lin. indep. constraints)
@@ -151,6 +368,29 @@ class NewFitterGSL : public BaseFitter {
     // Fill matrix MatM, using lambdas from vecx
     void assembleM (gsl_matrix *MatM, const gsl_vector *vecx, bool errorpropagation = false);
     
+    // Fill sparse matrix MatM, using lambdas from vecx
+    void assembleM (SparseSymMatrix& MatM, const gsl_vector *vecx, bool errorpropagation = false);
+    
+    /// Fill MatM with the constraint derivatives and the quasi-Newton update of the Hessian of the Lagrangian; returns false if exact second derivatives are needed
+    /**
+     * The update uses s = change of the parameters and
+     * yv = change of the gradient of the Lagrangian since the last Newton step,
+     * both evaluated with the current lambdas.
+     * HESSIAN_BFGS uses Powell's damping (Nocedal&Wright Procedure 18.2),
+     * which keeps the approximation positive definite; HESSIAN_SR1 
+     * skips the update if its denominator is too small (Nocedal&Wright Eq. (6.26)).
+     */
+    bool updateHessian (      gsl_matrix *MatM,       ///< Matrix M
+                        const gsl_vector *vecx,       ///< Current vector x
+                        const gsl_vector *vecy        ///< Vector y at vecx
+                       );
+    /// Store x, the gradient of the Lagrangian and the constraint derivatives for the next quasi-Newton update
+    void storeHessianPoint (const gsl_matrix *MatM,   ///< Matrix M at vecx
+                            const gsl_vector *vecx,   ///< Current vector x
+                            const gsl_vector *vecy,   ///< Vector y at vecx
+                            bool exact                ///< Whether MatM has the exact second derivatives
+                           );
+    
     // Fill matrix MatM with 2nd derivative of Lagrangian, using lambdas from vecx
     void assembleG (gsl_matrix *MatM, const gsl_vector *vecx);
     
@@ -172,6 +412,9 @@ class NewFitterGSL : public BaseFitter {
     // Fill constraint derivatives into Matrix M
     void assembleConstDer(gsl_matrix *MatM);
     
+    // Fill constraint derivatives into sparse Matrix M
+    void assembleConstDer(SparseSymMatrix& MatM);
+    
     // Calculate Newton step update vector vecdx from current point vecx and errors vece
     int calcNewtonDx (      gsl_vector *vecdx,       ///< Result: Update vector dx
                             gsl_vector *vecdxscal,   ///< Result: Update vector dx, scaled
@@ -203,6 +446,31 @@ class NewFitterGSL : public BaseFitter {
                              gsl_vector *vecw         ///< Work vector w1
                       );  
     
+    /// Calculate the step within a dogleg trust region; returns the number of rejected trial steps, or -1 if all were rejected
+    /**
+     * The Newton step vecdxscal minimizes the linearized scaled residual
+     * |yscal + Mscal*p|^2; if it is longer than the trust radius, it is replaced 
+     * by the dogleg path towards the Cauchy point in the direction of the gradient
+     * Mscal*yscal. The ratio of the actual to the predicted reduction of the
+     * residual decides whether the step is taken and how the radius changes.
+     * Newton step, gradient and their images under Mscal are calculated once,
+     * so a reduced radius costs one evaluation of the residual, but no solve.
+     * If no trial step is successful, iterate() limits the step with calcLimitedDx().
+     */
+    int calcTrustRegionDx (      double& alpha,           ///< Output value: length of the step relative to the Newton step
+                                 double& radius,          ///< Trust radius in scaled units; in: 0 for the Newton step length
+                                 gsl_vector *vecxnew,     ///< New vector x
+                           const gsl_vector *vecx,        ///< Current vector x
+                           const gsl_vector *vecdxscal,   ///< Newton step, scaled
+                           const gsl_vector *vece,        ///< Error vector e
+                           const gsl_vector *vecyscal,    ///< Vector y, scaled
+                           const gsl_matrix *MatMscal,    ///< Matrix M, scaled (not used by the sparse solver)
+                                 gsl_vector *vecw1,       ///< Work vector
+                                 gsl_vector *vecw2,       ///< Work vector
+                                 gsl_vector *vecw3,       ///< Work vector
+                                 gsl_vector *vecw4        ///< Work vector
+                          );
+    
     // Perform a line search                
     int doLineSearch (      double& alpha,           ///< Output value alpha
                             gsl_vector *vecxnew,     ///< New vector x
@@ -251,6 +519,24 @@ class NewFitterGSL : public BaseFitter {
   
     void calcCovMatrix(gsl_matrix *MatW, gsl_permutation *permW, gsl_vector *vecx);
     
+    /// Calculate the covariance matrix with the sparse solver; returns 0 if successful
+    int calcCovMatrixSparse (      gsl_vector *vecx,    ///< Current vector x
+                             const gsl_vector *vece,    ///< Current errors x
+                                   gsl_vector *vecw1,   ///< Work vector
+                                   gsl_vector *vecw2    ///< Work vector
+                            );
+    
+    /// Factorize M for the error propagation of the last fit, store d^2 chi^2/da da and Cov_eta; returns 0 if successful
+    int factorizeCovM ();
+    /// Calculate a block of the covariance matrix with the factorization from factorizeCovM; returns 0 if successful
+    int calcCovBlock (int n,              ///< Number of parameters
+                      const int *index,   ///< Global numbers of the parameters
+                      double *covblock,   ///< Result
+                      int ldc             ///< First dimension of covblock
+                     );
+    /// Calculate the complete covariance matrix in lazy mode and update the fit objects; returns true if successful
+    bool calcLazyCovariance ();
+    
     enum {NPARMAX=50, NCONMAX=10, NUNMMAX=10};
     
     int npar;      ///< total number of parameters
@@ -259,6 +545,7 @@ class NewFitterGSL : public BaseFitter {
     int nunm;      ///< total number of unmeasured parameters
     int ierr;      ///< Error status
     int nit;       ///< Number of iterations
+    bool converged; ///< Convergence flag of the current fit
 
     double fitprob;   ///< fit probability
     double chi2;      ///< final chi2
@@ -267,6 +554,70 @@ class NewFitterGSL : public BaseFitter {
     static void ini_gsl_vector (gsl_vector *&v, int unsigned size);
     static void ini_gsl_matrix (gsl_matrix *&m, int unsigned size1, unsigned int size2);
     
+    /// Cholesky decomposition like gsl_linalg_cholesky_decomp, but without calling the GSL error handler; returns 0 or GSL_EDOM
+    static int choleskyDecomp (gsl_matrix *A);
+    /// Cholesky decomposition of a row-major array, see choleskyDecomp(gsl_matrix *)
+    static int choleskyDecomp (double *A,   ///< in: symmetric matrix, out: L in the lower, L^T in the upper triangle
+                               int n,       ///< Dimension
+                               int lda      ///< Row length of A, >= n
+                              );
+    
+    /// Symmetric indefinite factorization P*A*P^T = L*D*L^T with Bunch-Kaufman pivoting, like LAPACK's dsytf2; returns 0, or k+1 if D is singular in block k
+    static int bunchKaufmanDecomp (gsl_matrix *A,   ///< in: symmetric matrix (lower triangle is used), out: L and D in the lower triangle, upper triangle overwritten
+                                   int *ipiv        ///< out: interchanges and block structure of D, dimension n
+                                  );
+    /// Bunch-Kaufman factorization of a row-major array, see bunchKaufmanDecomp(gsl_matrix *, int *)
+    static int bunchKaufmanDecomp (double *A,       ///< in: symmetric matrix (lower triangle is used), out: L and D in the lower triangle, upper triangle overwritten
+                                   int n,           ///< Dimension
+                                   int lda,         ///< Row length of A, >= n
+                                   int *ipiv        ///< out: interchanges and block structure of D, dimension n
+                                  );
+    /// Solve A*x = b in place with the factorization from bunchKaufmanDecomp
+    static void bunchKaufmanSolve (const gsl_matrix *LD,  ///< Factorization from bunchKaufmanDecomp
+                                   const int *ipiv,       ///< Pivots from bunchKaufmanDecomp
+                                   gsl_vector *x          ///< in: b, out: x
+                                  );
+    /// Solve A*x = b in place with the factorization of a row-major array
+    static void bunchKaufmanSolve (const double *LD,      ///< Factorization from bunchKaufmanDecomp
+                                   int n,                 ///< Dimension
+                                   int lda,               ///< Row length of LD, >= n
+                                   const int *ipiv,       ///< Pivots from bunchKaufmanDecomp
+                                   double *x              ///< in: b, out: x
+                                  );
+    /// Determinant and inertia of A from the factorization from bunchKaufmanDecomp
+    static double bunchKaufmanDet (const gsl_matrix *LD,  ///< Factorization from bunchKaufmanDecomp
+                                   const int *ipiv,       ///< Pivots from bunchKaufmanDecomp
+                                   int& npos,             ///< Number of positive eigenvalues
+                                   int& nneg,             ///< Number of negative eigenvalues
+                                   int& nzero             ///< Number of zero eigenvalues
+                                  );
+    /// Determinant and inertia of A from the factorization of a row-major array
+    static double bunchKaufmanDet (const double *LD,      ///< Factorization from bunchKaufmanDecomp
+                                   int n,                 ///< Dimension
+                                   int lda,               ///< Row length of LD, >= n
+                                   const int *ipiv,       ///< Pivots from bunchKaufmanDecomp
+                                   int& npos,             ///< Number of positive eigenvalues
+                                   int& nneg,             ///< Number of negative eigenvalues
+                                   int& nzero             ///< Number of zero eigenvalues
+                                  );
+    
+    /// Solve M*x = y with the SVD of M, singular values below eps times the largest one are set to zero; returns the number of such singular values
+    static int solveSVD (gsl_matrix *U,         ///< in: n x m matrix M, n >= m, out: U of the SVD
+                         gsl_matrix *V,         ///< out: V of the SVD, m x m
+                         gsl_vector *s,         ///< out: singular values, m
+                         const gsl_vector *y,   ///< Right hand side, n
+                         gsl_vector *x,         ///< Result, m
+                         double eps             ///< Relative threshold for the singular values
+                        );
+    /// Solve (A^T*A)*z = r in place, with the Cholesky decomposition or, if A does not have full column rank, the SVD of A^T*A; returns 0, or 1 if the SVD was used
+    static int solveATA (const gsl_matrix *A,   ///< n x m matrix, e.g. the constraint derivatives
+                         gsl_vector *z,         ///< in: r, out: z; dimension m
+                         gsl_matrix *ATA,       ///< Work matrix, m x m
+                         gsl_matrix *V,         ///< Work matrix, m x m
+                         gsl_vector *s,         ///< Work vector, m
+                         double eps             ///< Singular values < eps*(max(abs(s_i))) are set to 0
+                        );
+    
     static void debug_print (const gsl_matrix *m, const char *name);
     static void debug_print (const gsl_vector *v, const char *name);
 
@@ -290,6 +641,9 @@ class NewFitterGSL : public BaseFitter {
                      const gsl_matrix *MatM,           ///< Current matrix M
                            gsl_vector *vecw            ///< Work vector w
                     );
+    double calcpTLp (const gsl_vector *vecdx,          ///< Current step dx
+                     const SparseSymMatrix& MatM       ///< Current matrix M
+                    );
                     
     /// solve system of equations Mscal*dxscal = yscal                
     int solveSystem (      gsl_vector *vecdxscal, 
@@ -303,7 +657,29 @@ class NewFitterGSL : public BaseFitter {
                            double epsSV
                      );
                      
-    /// solve system of equations Mscal*dxscal = yscal using LU decomposition            
+    /// solve system of equations Mscal*dxscal = yscal using a symmetric indefinite LDL^T factorization            
+    int solveSystemLDL (      gsl_vector *vecdxscal, 
+                              double&     detW,
+                        const gsl_vector *vecyscal,
+                        const gsl_matrix *MatMscal,
+                              gsl_matrix *MatW,   
+                              double eps
+                     );
+                     
+    /// Solve Mscal*dxscal = yscal again with the measured diagonal of Mscal shifted until M has the right inertia; returns 0 if successful
+    int correctInertia (      gsl_vector *vecdxscal, 
+                              double&     detW,
+                        const gsl_vector *vecyscal,
+                        const gsl_vector *vece,
+                        const gsl_matrix *MatMscal,   ///< Scaled M of the dense solver, 0 for the sparse solver
+                              gsl_matrix *MatW,   
+                              gsl_matrix *MatW2,   
+                              gsl_vector *vecw,
+                              double epsLU,
+                              double epsSV
+                     );
+                     
+    /// solve system of equations Mscal*dxscal = yscal using LU decomposition; not used in the fit, kept as a cross-check of solveSystemLDL
     int solveSystemLU (      gsl_vector *vecdxscal, 
                              double&     detW,
                        const gsl_vector *vecyscal,
@@ -323,6 +699,23 @@ class NewFitterGSL : public BaseFitter {
                                gsl_vector *vecw,
                                double eps
                      );
+                     
+    /// solve system of equations Mscal*dxscal = yscal using the sparse LDL^T factorization; returns 0 if successful
+    int solveSystem (      gsl_vector *vecdxscal, 
+                           double& detW,
+                     const gsl_vector *vecyscal, 
+                     const SparseSymMatrix& MatMscal,  
+                           gsl_vector *vecw,
+                           double eps
+                     );
+                     
+    /// Solve (A*A^T)*z = r in place, A are the constraint derivatives in MatM; returns 0, or 1 if A*A^T had to be regularised
+    int solveAAT (double *z,                      ///< in: r, out: z; dimension ncon
+                  const SparseSymMatrix& MatM     ///< Matrix with constraint derivatives
+                 );
+
+    /// Allocate the dense matrices with dimension size x size; size=0 frees them
+    void ini_dense_matrices (unsigned int size);
 
   public:
     unsigned int idim;
@@ -338,6 +731,8 @@ class NewFitterGSL : public BaseFitter {
     gsl_vector *perr;
     gsl_vector *v1;
     gsl_vector *v2;
+    gsl_vector *v3;
+    gsl_vector *v4;
 //     gsl_vector *Meval;
   
     gsl_matrix *M;
@@ -355,8 +750,52 @@ class NewFitterGSL : public BaseFitter {
     gsl_matrix *CC;
     gsl_matrix *CC1;
     gsl_matrix *CCinv;
+    
+    // these are only used by the sparse solver
+    SparseSymMatrix *Msparse;
+    SparseSymMatrix *Mscalsparse;
+    SparseSymMatrix *AATsparse;
+    SparseSymMatrix *Hsparse;
+    SparseSymMatrix *Vsparse;
+    SparseLDLSolver *ldl;
+    SparseLDLSolver *ldlAAT;
+    ScratchArena *scratch;     ///< Work space for the derivatives of the constraints
+    BaseTracer *phasetracer;   ///< The tracer, if it traces the phases of the fit, otherwise 0
+    int solvermode;
+    bool usesparse;
 
     gsl_permutation *permW;
+    std::vector<int> ipivW;    ///< Pivots of the LDL^T factorization
+    int inertiaPos;            ///< Number of positive eigenvalues of M from the last factorization
+    int inertiaNeg;            ///< Number of negative eigenvalues of M from the last factorization
+    int inertiaZero;           ///< Number of zero eigenvalues of M from the last factorization; -1: unknown
+    double inertiadelta;       ///< Initial shift of the diagonal for a wrong inertia of M; 0: no correction
+    std::vector<int> imeasured;   ///< Global numbers of the measured parameters
+    std::vector<double> startpar;     ///< Start values of the parameters for the next fit
+    std::vector<double> startlambda;  ///< Start values of the Lagrange multipliers for the next fit
+    bool lazycov;              ///< Whether the covariance matrix is calculated on demand
+    bool covpending;           ///< Covariance matrix of the last fit can be calculated on demand
+    bool covfactorized;        ///< M of the last fit is factorized for the error propagation
+    bool covsparse;            ///< The factorization for the error propagation is the sparse one
+    std::vector<double> covrows;   ///< Rows of d a / d eta for the requested parameters
+    int stepcontrol;           ///< Step control: STEP_LINESEARCH or STEP_TRUSTREGION
+    double trustradius;        ///< Trust radius of the current fit, in scaled units
+    int ntrial;                ///< Number of trial points of the current fit
+    int hessianmode;           ///< HESSIAN_EXACT, HESSIAN_BFGS or HESSIAN_SR1
+    int hessianrestart;        ///< Number of quasi-Newton updates after which the exact Hessian is recalculated; 0: never
+    gsl_matrix *Bqn;           ///< Quasi-Newton approximation of the Hessian of the Lagrangian, npar x npar
+    gsl_matrix *Aqn;           ///< Constraint derivatives at xqn, ncon x npar
+    gsl_vector *xqn;           ///< Parameters and lambdas at the last Newton step
+    gsl_vector *gqn;           ///< Gradient of the Lagrangian at xqn, dimension npar
+    gsl_vector *sqn;           ///< Work vector: change of the parameters and the lambdas, dimension idim
+    gsl_vector *yqn;           ///< Work vector: change of the gradient of the Lagrangian, dimension npar
+    gsl_vector *bsqn;          ///< Work vector: Bqn*s, dimension npar
+    bool qnvalid;              ///< Whether Bqn, xqn etc are set for the current fit
+    bool qnrestart;            ///< Whether the exact Hessian has to be calculated in the next Newton step
+    bool qnused;               ///< Whether the last M was assembled with the quasi-Newton Hessian
+    int nqnage;                ///< Number of quasi-Newton updates since the last exact Hessian
+    int nexacthessian;         ///< Number of Newton steps of the current fit with the exact Hessian
+    int nhessianupdate;        ///< Number of Newton steps of the current fit with an updated Hessian
     gsl_eigen_symm_workspace *eigenws; 
 //    gsl_eigen_symmv_workspace *eigenwsv; 
     unsigned int eigenwsdim;
@@ -10,6 +10,7 @@
  *
  * \b Changelog:
  * - 25.9.08 BL: Added some documentation
+ * - 16.10.2026 Phase hooks for the tracer
  *
  * \b CVS Log messages:
  * - $Log: NewtonFitterGSL.h,v $
@@ -122,6 +123,8 @@ class NewtonFitterGSL : public BaseFitter {
     double fitprob;   ///< fit probability
     double chi2;      ///< final chi2
     
+    BaseTracer *phasetracer;   ///< The tracer, if it traces the phases of the fit, otherwise 0
+    
     static void ini_gsl_permutation (gsl_permutation *&p, unsigned int size);
     static void ini_gsl_vector (gsl_vector *&v, int unsigned size);
     static void ini_gsl_matrix (gsl_matrix *&m, int unsigned size1, unsigned int size2);
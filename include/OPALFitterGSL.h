@@ -10,6 +10,9 @@
  *
  * \b Changelog:
  * - 2.10.08 BL: First version, based on OPALFitter
+ * - 16.10.2026 Warm start from given parameters
+ * - 16.10.2026 Cholesky solver for S and V, V factorized once per fit
+ * - 16.10.2026 Phase hooks for the tracer
  *
  * \b CVS Log messages:
  * - $Log: OPALFitterGSL.h,v $
@@ -140,6 +143,50 @@ class OPALFitterGSL : public BaseFitter {
     /// Set the Debug Level
     virtual void setDebug (int debuglevel);
     
+    /// Set start values of the parameters for the next fit (warm start)
+    /**
+     * The values are given in the global numbering of the parameters
+     * (measured parameters first), as returned by getSolution().
+     * They are used only by the next fit; they are ignored if the
+     * number of parameters does not match the fit problem.
+     * The Lagrange multipliers are recalculated in every iteration
+     * by this fitter, so there are no start values for them: if
+     * ncon_ or lambda is given, all start values are rejected with
+     * an error message, and the next fit starts from the fit objects.
+     */
+    virtual void setStartValues (int npar_,                  ///< Number of parameters, must be getNpar()
+                                 const double *par,          ///< Start values of the parameters
+                                 int ncon_ = 0,              ///< Must be 0
+                                 const double *lambda = 0    ///< Must be 0
+                                );
+    /// Use the result of the last fit as start values for the next fit; returns false if there is no successful fit
+    virtual bool setStartValuesFromLastFit ();
+    /// Get the fitted parameters and Lagrange multipliers of the last fit; returns false if the dimensions don't match
+    virtual bool getSolution (int npar_,                ///< Number of parameters, must be getNpar()
+                              double *par,              ///< Fitted parameters, in the global numbering
+                              int ncon_ = 0,            ///< Number of Lagrange multipliers, 0 or getNcon()
+                              double *lambda = 0        ///< Lagrange multipliers
+                             ) const;
+
+    /// Solvers for the linear systems with S = Feta*V*Feta^T + Fxi*Fxi^T and V
+    enum {SOLVER_LU = 0,        ///< LU decomposition and explicit inverses of S and V, as in the original OPAL fitter
+          SOLVER_CHOLESKY = 1   ///< Cholesky decomposition and triangular solves, no inverses
+         };
+    /// Set the solver mode (default: SOLVER_CHOLESKY)
+    /**
+     * Both matrices are symmetric and positive definite, so that the Cholesky
+     * decomposition L*L^T can be used; instead of forming S^-1 and V^-1, the
+     * products with them are calculated by forward and backward substitution.
+     * In both modes, the covariance matrix V of the measured parameters is
+     * factorized only once per fit, since it does not change during the fit.
+     * If the Cholesky decomposition of V fails, the fit falls back to SOLVER_LU.
+     * SOLVER_LU is kept for cross-checks; the results agree up to rounding.
+     */
+    virtual void setSolverMode (int mode   ///< SOLVER_LU or SOLVER_CHOLESKY
+                               );
+    /// Get the solver mode
+    virtual int getSolverMode () const;
+
   protected:
     
     
@@ -155,11 +202,19 @@ class OPALFitterGSL : public BaseFitter {
 
     double fitprob;   // fit probability
     double chi2;      // final chi2
+
+    std::vector<double> startpar;  ///< Start values of the parameters for the next fit
+    int solvermode;   ///< Solver for S and V: SOLVER_LU or SOLVER_CHOLESKY
+    BaseTracer *phasetracer;   ///< The tracer, if it traces the phases of the fit, otherwise 0
     
     static void ini_gsl_permutation (gsl_permutation *&p, unsigned int size);
     static void ini_gsl_vector (gsl_vector *&v, int unsigned size);
     static void ini_gsl_matrix (gsl_matrix *&m, int unsigned size1, unsigned int size2);
     
+    /// Cholesky decomposition A = L*L^T in place, like gsl_linalg_cholesky_decomp; returns 0 if successful, GSL_EDOM if A is not positive definite
+    static int choleskyDecomp (gsl_matrix *A   ///< in: symmetric matrix, out: L in the lower, L^T in the upper triangle
+                              );
+    
     static void debug_print (gsl_matrix *m, const char *name);
     static void debug_print (gsl_vector *v, const char *name);
     
@@ -0,0 +1,111 @@
+/*! \file
+ *  \brief Declares class ParallelFitDriver
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#ifndef __PARALLELFITDRIVER_H
+#define __PARALLELFITDRIVER_H
+
+#include <vector>
+#include <atomic>
+
+class BaseEvent;
+class BaseFitter;
+
+// Class ParallelFitDriver
+/// Fits a list of events on a pool of threads
+/**
+ * Each worker thread gets its own fitter, created by createFitter(),
+ * and fits events taken from a common queue until all events are done.
+ * The results are stored by event number, and each fit only depends
+ * on its own event, so that the results do not depend on the number
+ * of threads or on the order in which the events are processed.
+ *
+ * Fit objects, constraints and fitters must not be shared between events;
+ * the events must be generated (BaseEvent::genEvent) before calling
+ * fitEvents, because the toy event generators share a random number
+ * generator.
+ *
+ * Use the template ParallelFitDriverT to get a driver for a given fitter class:
+ * \code
+ * ParallelFitDriverT<NewFitterGSL> driver (4);
+ * driver.fitEvents (events);
+ * double prob = driver.getProbability (iev);
+ * \endcode
+ *
+ */
+
+class ParallelFitDriver {
+  public:
+    /// Constructor; nthreads = 0 means one thread per hardware core
+    ParallelFitDriver (int nthreads_ = 0);
+    /// Virtual destructor
+    virtual ~ParallelFitDriver();
+
+    /// Set the number of worker threads; 0 means one thread per hardware core
+    virtual void setNThreads (int nthreads_);
+    /// Get the number of worker threads
+    virtual int getNThreads () const;
+
+    /// Fit all events, returns the number of fits with error code 0
+    virtual int fitEvents (std::vector<BaseEvent *>& events);
+
+    /// Get the number of events of the last call to fitEvents
+    virtual int getNEvents () const;
+    /// Get the return value of BaseEvent::fitEvent for event iev
+    virtual int getResult (int iev) const;
+    /// Get the fit error code of event iev
+    virtual int getError (int iev) const;
+    /// Get the fit probability of event iev
+    virtual double getProbability (int iev) const;
+    /// Get the chi**2 of event iev
+    virtual double getChi2 (int iev) const;
+    /// Get the number of degrees of freedom of event iev
+    virtual int getDoF (int iev) const;
+    /// Get the number of iterations of event iev
+    virtual int getIterations (int iev) const;
+
+  protected:
+    /// Create a new fitter for a worker thread; the driver takes ownership
+    virtual BaseFitter *createFitter () const = 0;
+
+    /// Worker loop: fit events from the queue with fitter
+    void work (std::vector<BaseEvent *>& events, BaseFitter& fitter);
+
+    /// Results of a single fit
+    struct FitResult {
+      int    result;   ///< return value of BaseEvent::fitEvent
+      int    ierr;     ///< fit error code
+      int    dof;      ///< degrees of freedom
+      int    nit;      ///< number of iterations
+      double prob;     ///< fit probability
+      double chi2;     ///< chi**2
+    };
+
+    int nthreads;                      ///< number of worker threads
+    std::vector<FitResult> results;    ///< results by event number
+    std::atomic<int> nextevent;        ///< next event to be fitted
+
+  private:
+    /// Copy constructor disabled
+    ParallelFitDriver (const ParallelFitDriver& rhs);
+    /// Assignment disabled
+    ParallelFitDriver& operator= (const ParallelFitDriver& rhs);
+};
+
+/// ParallelFitDriver that uses fitters of class Fitter
+template <class Fitter>
+class ParallelFitDriverT : public ParallelFitDriver {
+  public:
+    /// Constructor; nthreads = 0 means one thread per hardware core
+    ParallelFitDriverT (int nthreads_ = 0): ParallelFitDriver (nthreads_) {}
+    /// Virtual destructor
+    virtual ~ParallelFitDriverT() {}
+  protected:
+    virtual BaseFitter *createFitter () const {return new Fitter();}
+};
+
+#endif // __PARALLELFITDRIVER_H
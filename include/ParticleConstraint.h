@@ -3,6 +3,8 @@
  *
  * \b Changelog:
  * - 17.11.04 BL: First version (refactured from BaseConstraint)
+ * - 16.10.2026 add2ndDerivativesToMatrix only for pairs of fit objects with second derivatives
+ * - 16.10.2026 Evaluation of value and derivatives in one pass, kept during the derivative assembly
  *
  * \b CVS Log messages:
  * - $Log: ParticleConstraint.h,v $
@@ -79,6 +81,13 @@ class ParticleFitObject;
  * parameters (add1stDerivativesToMatrix, add2ndDerivativesToMatrix). This requires the
  * constraint to know its position in the overall list of constraints (globalNum). 
  * 
+ * A constraint whose value and derivatives need the same sums over all fit objects
+ * (e.g. MassConstraint) can calculate them in one pass in evaluate().
+ * The methods that add the derivatives of all fit objects to the global matrices
+ * or vectors call evaluate() once at their start (with an Evaluation object), and 
+ * firstDerivatives, secondDerivatives and getValue use its results as long as 
+ * isEvaluated() is true; otherwise they call evaluate() themselves.
+ * The default evaluate() does nothing.
  *
  * Author: Jenny List, Benno List
  * $Date: 2008/02/12 16:43:26 $
@@ -100,29 +109,72 @@ class ParticleConstraint: public BaseHardConstraint {
 	fitobjects.push_back (  reinterpret_cast < BaseFitObject* >  ( (*fitobjects_)[i] ) );
         flags.push_back (1);
       }  
+      invalidatePairList();
     }; 
     /// Adds one ParticleFitObject objects to the list
     virtual void addToFOList(ParticleFitObject& fitobject, int flag = 1
                              ){
       fitobjects.push_back ( reinterpret_cast < BaseFitObject* >  ( &fitobject ) );
       flags.push_back (flag);
+      invalidatePairList();
     }; 
     /// Resests ParticleFitObject list
     virtual void resetFOList(){
       fitobjects.resize (0);
       flags.resize (0);
+      invalidatePairList();
     }; 
 
     /// Invalidates any cached values for the next event
     virtual void invalidateCache() const 
     {}
+
+    // The methods that use firstDerivatives and secondDerivatives of all fit objects,
+    // with one evaluation of the constraint
+    virtual void add1stDerivativesToMatrix (double *M, int idim) const;
+    virtual void add1stDerivativesToMatrix (SparseSymMatrix& M) const;
+    virtual void add2ndDerivativesToMatrix (double *M, int idim, double lambda, ScratchArena& scratch) const;
+    virtual void add2ndDerivativesToMatrix (SparseSymMatrix& M, double lambda, ScratchArena& scratch) const;
+    // the other overloads of add2ndDerivativesToMatrix call these
+    using BaseHardConstraint::add2ndDerivativesToMatrix;
+    virtual void addToGlobalChi2DerVector (double *y, int idim, double lambda) const;
+    virtual double getError() const;
       
   protected:
+    /// Calculate the value and what the derivatives need, for all fit objects at once
+    virtual void evaluate() const {}
+    /// Whether the results of evaluate() are valid, i.e. an Evaluation object exists
+    bool isEvaluated() const {return evaluated;}
+
+    // Class ParticleConstraint::Evaluation
+    /// Calls evaluate() and keeps its results valid during its lifetime
+    class Evaluation {
+      public:
+        /// Constructor: evaluates the constraint, unless it is evaluated already
+        explicit Evaluation (const ParticleConstraint& constraint_   ///< The constraint
+                            )
+        : constraint (constraint_), outer (!constraint_.evaluated) {
+          if (outer) {
+            constraint.evaluate();
+            constraint.evaluated = true;
+          }
+        }
+        /// Destructor: the results of the outermost Evaluation are not valid any more
+        ~Evaluation() {
+          if (outer) constraint.evaluated = false;
+        }
+      private:
+        const ParticleConstraint& constraint;   ///< The constraint
+        bool outer;                             ///< Whether this is the outermost Evaluation
+    };
+    friend class Evaluation;
 
+    mutable bool evaluated;    ///< Whether the results of evaluate() are valid
 };
 
 ParticleConstraint::ParticleConstraint() 
 // : fitobjects( FitObjectContainer() ), derivatives( std::vector <double> () ), flags( std::vector <int> () ), globalNum(-999)
+: evaluated (false)
 {
   invalidateCache();
 }
@@ -3,6 +3,7 @@
  *
  * \b Changelog:
  * - 17.11.04 BL: First version (refactured from BaseFitObject)
+ * - 16.10.2026 Constructor for derived classes that provide the parameter storage
  *
  */ 
 
@@ -159,6 +160,16 @@ class ParticleFitObject: public BaseFitObject {
     virtual double getChi2 () const;
 
   protected:
+    /// Constructor for derived classes with N parameters, which provide the storage for them
+    template <int N>
+    explicit ParticleFitObject (ParamStorage<N>& storage   ///< The storage, a data member of the derived class
+                               )
+      : BaseFitObject (storage), mass (0), fourMomentum( FourVector(0,0,0,0) )
+    {
+      for (int i=0; i<BaseDefs::MAXPAR; i++)
+        paramCycl[i]=-1;
+    }
+
     /// mass of particle
     double mass;
 
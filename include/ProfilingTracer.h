@@ -0,0 +1,137 @@
+/*! \file
+ *  \brief Declares class ProfilingTracer
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ * - 16.10.2026 Phases of OPALFitterGSL and NewtonFitterGSL, cache updates on first use
+ *
+ */
+
+#ifndef __PROFILINGTRACER_H
+#define __PROFILINGTRACER_H
+
+#include <iostream>
+#include <vector>
+#include "BaseTracer.h"
+
+class BaseFitter;
+
+//  Class ProfilingTracer
+/// Tracer that measures the time spent in the phases of the fits
+/**
+ * The ProfilingTracer uses the phase hooks (BaseTracer::beginPhase
+ * and BaseTracer::endPhase) to measure the wall clock time and, on x86
+ * processors, the number of CPU cycles spent in each phase of each fit.
+ * Nested phases (e.g. the update of the fit object caches within
+ * the line search) are counted exclusively, i.e. the time of the inner phase
+ * is not counted for the outer one; the time not spent in any phase
+ * is counted as "other".
+ * A fit runs from BaseTracer::initialize (or the first phase before it)
+ * to BaseTracer::finish; covariance calculations on demand after
+ * the end of a fit are counted to that fit.
+ *
+ * The times per fit are stored, and the summary gives their mean
+ * and percentiles, as text in CSV format:
+ * \code
+ * ProfilingTracer profiler;
+ * fitter.setTracer (profiler);
+ * // ... many fits ...
+ * profiler.writeSummary (std::cout);
+ * \endcode
+ *
+ * Without a tracer that traces phases, the fitters do not call the phase hooks,
+ * so the overhead is one pointer comparison per phase.
+ * NewFitterGSL, OPALFitterGSL and NewtonFitterGSL call the phase hooks;
+ * the fit objects report their cache updates where they happen, on first use
+ * (see PhaseTracerScope), so the profiled fits do the same work
+ * as the fits without tracer.
+ *
+ */
+
+class ProfilingTracer: public BaseTracer {
+  public:
+    /// Constructor
+    ProfilingTracer();
+    /// Virtual destructor
+    virtual ~ProfilingTracer();
+
+    /// Called at the start of a new fit (during initialization)
+    virtual void initialize (BaseFitter& fitter);
+    /// Called at the end of a fit
+    virtual void finish (BaseFitter& fitter);
+
+    /// Returns true: this tracer wants the phase hooks
+    virtual bool tracesPhases () const;
+    /// Called at the start of a phase
+    virtual void beginPhase (BaseFitter& fitter,
+                             int phase
+                            );
+    /// Called at the end of a phase
+    virtual void endPhase (BaseFitter& fitter,
+                           int phase
+                          );
+
+    /// Slots for the time outside of all phases and for the total time, in addition to the phases
+    enum {OTHER = NPHASES,   ///< Time not spent in any phase
+          TOTAL,             ///< Total time of the fit
+          NSLOTS             ///< Number of slots
+         };
+
+    /// Clear all measurements
+    virtual void reset();
+    /// Close the measurement of the last fit, so that it is included in the results
+    virtual void flush();
+    /// Get the number of measured fits
+    virtual int getNFits() const;
+    /// Get the number of calls of a phase, summed over all fits
+    virtual long getNCalls (int slot         ///< Phase, OTHER or TOTAL
+                           ) const;
+    /// Get the time in seconds spent in a phase, summed over all fits
+    virtual double getTotalTime (int slot    ///< Phase, OTHER or TOTAL
+                                ) const;
+    /// Get the number of CPU cycles spent in a phase, summed over all fits; 0 if not available
+    virtual double getTotalCycles (int slot  ///< Phase, OTHER or TOTAL
+                                  ) const;
+    /// Get a quantile of the time in seconds per fit spent in a phase
+    virtual double getTimeQuantile (int slot,    ///< Phase, OTHER or TOTAL
+                                    double p     ///< Probability, between 0 and 1; 0.5: median
+                                   ) const;
+    /// Get the name of a slot
+    static const char *getSlotName (int slot);
+
+    /// Write the summary in CSV format, one line per phase; calls flush()
+    virtual void writeSummary (std::ostream& os  ///< The output stream
+                              );
+
+  protected:
+    /// Get the wall clock time in seconds
+    static double now ();
+    /// Get the CPU cycle counter; 0 if not available
+    static double cycles ();
+    /// Add the time since the last call to the innermost active phase
+    void charge (double t, double c);
+    /// Start the measurement of a fit, if none is running
+    void openFit (double t, double c);
+    /// Store the measurements of the current fit
+    void closeFit ();
+
+    enum {MAXDEPTH = 16};                    ///< Maximum nesting depth of phases
+
+    bool infit;                              ///< A fit is running
+    bool pending;                            ///< A fit has finished, but its measurement is not closed
+    double fitstart;                         ///< Start time of the current fit
+    double fitstartcyc;                      ///< Cycle counter at the start of the current fit
+    double lazystart;                        ///< Start time of a phase after the end of the fit
+    double lazystartcyc;                     ///< Cycle counter at the start of a phase after the end of the fit
+    double tlast;                            ///< Time of the last call to charge
+    double clast;                            ///< Cycle counter at the last call to charge
+    int depth;                               ///< Number of active phases
+    int stack[MAXDEPTH];                     ///< Active phases
+    double fittime[NSLOTS];                  ///< Times of the current fit
+    double fitcyc[NSLOTS];                   ///< Cycles of the current fit
+    long ncalls[NSLOTS];                     ///< Number of calls
+    double sumcyc[NSLOTS];                   ///< Cycles, summed over all fits
+    std::vector<double> times[NSLOTS];       ///< Times of all fits
+};
+
+#endif // __PROFILINGTRACER_H
@@ -0,0 +1,211 @@
+/*! \file
+ *  \brief Declares class PullStudyDriver
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+#ifdef MARLIN_USE_ROOT
+
+#ifndef __PULLSTUDYDRIVER_H
+#define __PULLSTUDYDRIVER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+
+class BaseFitter;
+class TopEventILC;
+class CounterRandom;
+
+// Class PullStudyDriver
+/// Runs a toy MC study with TopEventILC on a pool of threads
+/**
+ * Generates and fits TopEventILC events and fills the distributions
+ * of the pulls of all parameters of the fit objects, of the chi2
+ * and of the fit probability.
+ *
+ * Each event gets its own stream of random numbers: event number iev
+ * is generated with a CounterRandom with the seed of the driver,
+ * set to stream iev. The events are processed in chunks of
+ * a fixed number of events; each worker thread takes the next chunk
+ * from a common counter and has its own event, fitter and histograms.
+ * At the end the bin contents of the threads are added, and the sums
+ * for the means and RMS are added chunk by chunk in the order of the
+ * chunks, so that the results are bit-identical for any number
+ * of threads. A study can also be split into several runs
+ * (e.g. batch jobs) with different first event numbers.
+ *
+ * For each parameter k of fit object j there are two pulls:
+ * - the pull (fitted - measured)/sqrt(sigma_measured^2 - sigma_fitted^2),
+ *   for measured parameters,
+ * - the pull vs. true (fitted - true)/sigma_fitted.
+ * Differences of parameters named "phi" are taken modulo 2 pi.
+ *
+ * Only fits without error enter the distributions.
+ * The GSL error handler is not changed; call gsl_set_error_handler_off()
+ * if GSL errors in single fits should count as failures instead of
+ * aborting the program.
+ *
+ * Use the template PullStudyDriverT to get a driver for a given fitter class:
+ * \code
+ * PullStudyDriverT<NewFitterGSL> driver (8);
+ * driver.setSeed (4711);
+ * driver.setLeptonic (true);
+ * driver.run (10000000);
+ * driver.writeSummary (std::cout);
+ * \endcode
+ *
+ */
+
+class PullStudyDriver {
+  public:
+    /// Histogram with fixed bins, underflow and overflow
+    class Histogram {
+      public:
+        /// Constructor
+        Histogram (int nbins_ = 1, double low_ = 0, double high_ = 1);
+        /// Fill a value; values that are not finite are ignored
+        void fill (double x);
+        /// Add the contents of another histogram with the same bins
+        void add (const Histogram& rhs);
+        /// Clear the contents
+        void reset ();
+
+        /// Get the number of bins
+        int getNBins () const;
+        /// Get the lower edge of the first bin
+        double getLow () const;
+        /// Get the upper edge of the last bin
+        double getHigh () const;
+        /// Get the content of a bin; 0: underflow, nbins+1: overflow
+        long getBinContent (int ibin) const;
+        /// Get the number of entries, including underflow and overflow
+        long getEntries () const;
+        /// Get the mean of all entries
+        double getMean () const;
+        /// Get the RMS of all entries
+        double getRMS () const;
+
+      private:
+        friend class PullStudyDriver;
+        int nbins;                  ///< Number of bins
+        double low;                 ///< Lower edge of the first bin
+        double high;                ///< Upper edge of the last bin
+        std::vector<long> bins;     ///< Contents, including underflow and overflow
+        long entries;               ///< Number of entries
+        double sum;                 ///< Sum of the values
+        double sum2;                ///< Sum of the squared values
+    };
+
+    /// Constructor; nthreads = 0 means one thread per hardware core
+    PullStudyDriver (int nthreads_ = 0);
+    /// Virtual destructor
+    virtual ~PullStudyDriver();
+
+    /// Set the number of worker threads; 0 means one thread per hardware core
+    virtual void setNThreads (int nthreads_);
+    /// Get the number of worker threads
+    virtual int getNThreads () const;
+    /// Set the seed of the random numbers (default 4357)
+    virtual void setSeed (unsigned long seed_);
+    /// Get the seed of the random numbers
+    virtual unsigned long getSeed () const;
+    /// Set the number of events per chunk (default 1000); the results depend on it only through rounding of the means and RMS
+    virtual void setChunkSize (int chunksize_);
+    /// Get the number of events per chunk
+    virtual int getChunkSize () const;
+    /// Generate semi-leptonic instead of fully hadronic events (TopEventILC::leptonic)
+    virtual void setLeptonic (bool leptonic_);
+    /// Use soft instead of hard mass constraints (TopEventILC::softmasses)
+    virtual void setSoftMasses (bool softmasses_);
+
+    /// Generate and fit the events firstevent ... firstevent+nevents-1, returns the number of fits with error code 0
+    virtual long run (long nevents,         ///< Number of events
+                      long firstevent = 0   ///< Number of the first event
+                     );
+
+    /// Get the number of events of the last run
+    virtual long getNEvents () const;
+    /// Get the number of failed fits of the last run
+    virtual long getNFailed () const;
+    /// Get the number of pulls, i.e. the number of parameters of all fit objects
+    virtual int getNPulls () const;
+    /// Get the name of pull i, e.g. "b1_E"
+    virtual const std::string& getPullName (int i) const;
+    /// Get the distribution of pull i
+    virtual const Histogram& getPull (int i) const;
+    /// Get the distribution of the pull vs. true of parameter i
+    virtual const Histogram& getTruePull (int i) const;
+    /// Get the distribution of the chi2
+    virtual const Histogram& getChi2 () const;
+    /// Get the distribution of the fit probability
+    virtual const Histogram& getProbability () const;
+
+    /// Write the number of entries, mean and RMS of all distributions in CSV format
+    virtual void writeSummary (std::ostream& os  ///< The output stream
+                              ) const;
+    /// Write the bin contents of all distributions in CSV format, one line per bin
+    virtual void writeHistograms (std::ostream& os  ///< The output stream
+                                 ) const;
+
+  protected:
+    /// Create a new fitter for a worker thread; the driver takes ownership
+    virtual BaseFitter *createFitter () const = 0;
+    /// Create a new event with the options of the driver; the driver takes ownership
+    virtual TopEventILC *createEvent () const;
+
+    /// The objects of one worker thread
+    struct Worker {
+      TopEventILC *event;                 ///< The event
+      BaseFitter *fitter;                 ///< The fitter
+      CounterRandom *random;              ///< The random numbers of the event
+      std::vector<Histogram> hists;       ///< The distributions
+      long nfailed;                       ///< Number of failed fits
+    };
+    /// Fill one value into a histogram of a worker and into the sums of the chunk
+    void fill (Worker& w, int iq, double x, double *chunksum);
+    /// Work on chunks until all events are done
+    void work (Worker& w);
+    /// Get the name of distribution iq
+    std::string getName (int iq) const;
+
+    int nthreads;                        ///< Number of threads
+    unsigned long seed;                  ///< Seed
+    int chunksize;                       ///< Number of events per chunk
+    bool leptonic;                       ///< Generate semi-leptonic events
+    bool softmasses;                     ///< Use soft mass constraints
+
+    long nevents;                        ///< Number of events of the current run
+    long firstevent;                     ///< Number of the first event of the current run
+    long nchunks;                        ///< Number of chunks of the current run
+    std::atomic<long> nextchunk;         ///< Next chunk to process
+    long nfailed;                        ///< Number of failed fits
+    std::vector<std::string> pullnames;  ///< Names of the pulls
+    std::vector<bool> periodic;          ///< Whether a pull is of an azimuthal angle phi, whose differences are taken modulo 2 pi
+    std::vector<Histogram> hists;        ///< Distributions: pulls, pulls vs. true, chi2, probability
+    std::vector<double> chunksums;       ///< Sums and sums of squares of all distributions for each chunk
+
+  private:
+    /// Copy constructor disabled
+    PullStudyDriver (const PullStudyDriver& rhs);
+    /// Assignment disabled
+    PullStudyDriver& operator= (const PullStudyDriver& rhs);
+};
+
+/// PullStudyDriver that uses fitters of class Fitter
+template <class Fitter>
+class PullStudyDriverT : public PullStudyDriver {
+  public:
+    /// Constructor; nthreads = 0 means one thread per hardware core
+    PullStudyDriverT (int nthreads_ = 0): PullStudyDriver (nthreads_) {}
+    /// Virtual destructor
+    virtual ~PullStudyDriverT() {}
+  protected:
+    virtual BaseFitter *createFitter () const {return new Fitter();}
+};
+
+#endif // __PULLSTUDYDRIVER_H
+
+#endif // MARLIN_USE_ROOT
@@ -0,0 +1,186 @@
+/*! \file
+ *  \brief Declares class ScratchArena
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ * - 16.10.2026 ScratchDispatch
+ *
+ */
+
+#ifndef __SCRATCHARENA_H
+#define __SCRATCHARENA_H
+
+#include <vector>
+#include <cstddef>
+
+// Class ScratchArena
+/// Work space for the temporary arrays of the derivative assembly
+/**
+ * The constraints need work arrays whose size depends on the number of
+ * fit objects or on the dimension of the global matrix, for instance
+ * in BaseHardConstraint::add2ndDerivativesToMatrix.
+ * Instead of allocating them on the heap in every call,
+ * they are taken from a ScratchArena that is owned by the fitter
+ * and reused in every iteration.
+ *
+ * Arrays are taken from one contiguous block by increasing a fill mark
+ * (alloc()); they are given back in one go when the Frame object that was
+ * created before them goes out of scope.
+ * A request that does not fit into the block is served by a separate heap
+ * allocation, which is freed at the end of the frame; when the outermost frame
+ * ends, the block is enlarged to the largest fill seen so far, so that later
+ * calls do not allocate any more.
+ * With reserve() the block can be made large enough in advance.
+ *
+ * For monitoring, the arena counts the number of arrays handed out
+ * (getNRequests(); each of them used to be a separate heap allocation)
+ * and the number of heap allocations it actually made (getNAllocations()).
+ *
+ */
+
+class ScratchArena {
+  public:
+    /// Constructor
+    explicit ScratchArena (std::size_t nbytes = 0   ///< Initial size of the block in bytes
+                          );
+    /// Virtual destructor
+    virtual ~ScratchArena();
+
+    /// Make sure that the block holds at least nbytes; must not be called inside a frame
+    void reserve (std::size_t nbytes       ///< Requested size in bytes
+                 );
+    /// Get the size of the block in bytes
+    std::size_t getCapacity() const {return cap;}
+
+    /// Get an uninitialized array of n elements of type T, valid until the end of the current frame
+    template <class T>
+    T *alloc (int n     ///< Number of elements
+             ) {
+      return static_cast<T *>(allocBytes (size<T> (n)));
+    }
+    /// Number of bytes that alloc<T>(n) takes from the arena
+    template <class T>
+    static std::size_t size (int n     ///< Number of elements
+                            ) {
+      return roundUp (n > 0 ? n*sizeof (T) : 0);
+    }
+
+    /// Get the number of arrays handed out since the last resetCounters()
+    int getNRequests() const {return nrequests;}
+    /// Get the number of heap allocations since the last resetCounters()
+    int getNAllocations() const {return nallocations;}
+    /// Reset the counters
+    void resetCounters() {nrequests = 0; nallocations = 0;}
+
+    // Class ScratchArena::Frame
+    /// Gives back all arrays taken from the arena during its lifetime
+    class Frame {
+      public:
+        /// Constructor: remembers the fill mark of the arena
+        explicit Frame (ScratchArena& arena_   ///< The arena
+                       );
+        /// Destructor: restores the fill mark and frees overflow allocations
+        ~Frame();
+      private:
+        Frame (const Frame&);              // not copyable
+        Frame& operator= (const Frame&);   // not assignable
+        ScratchArena& arena;               ///< The arena
+        std::size_t used;                  ///< Fill mark of the block
+        std::size_t demand;                ///< Total number of bytes handed out
+        std::size_t noverflow;             ///< Number of overflow blocks
+    };
+
+  protected:
+    /// Get nbytes from the block or, if it is full, from the heap
+    void *allocBytes (std::size_t nbytes);
+    /// Round nbytes up to the alignment
+    static std::size_t roundUp (std::size_t nbytes) {
+      return (nbytes + (ALIGN-1)) & ~std::size_t(ALIGN-1);
+    }
+
+    enum {ALIGN = 16};                    ///< Alignment of the arrays in bytes
+
+    char *block;                          ///< The block
+    std::size_t cap;                      ///< Size of the block
+    std::size_t used;                     ///< Number of bytes used in the block
+    std::size_t demand;                   ///< Number of bytes handed out, including overflow
+    std::size_t peak;                     ///< Largest demand so far
+    int nframes;                          ///< Number of active frames
+    std::vector<char *> overflow;         ///< Heap allocations that did not fit into the block
+    int nrequests;                        ///< Number of arrays handed out
+    int nallocations;                     ///< Number of heap allocations
+
+  private:
+    ScratchArena (const ScratchArena&);              // not copyable
+    ScratchArena& operator= (const ScratchArena&);   // not assignable
+};
+
+// Class ScratchDispatch
+/// Lets the versions of a virtual function with and without ScratchArena call each other once
+/**
+ * Constraints have add2ndDerivativesToMatrix with and without a ScratchArena
+ * argument; the fitters call the version with arena, but a subclass may 
+ * override either. The default implementations of both versions therefore
+ * call the other version once, through the virtual function, and the second
+ * call does the work, with the arena of the caller or a temporary one.
+ * A ScratchDispatch, a data member of the class, remembers the pending call:
+ * \code
+ * void C::f (double *M, int idim) const {
+ *   ScratchDispatch::Call call (dispatch);
+ *   if (call.first()) f (M, idim, call.makeArena (getScratchSize (idim)));
+ *   else fT (M, idim, call.arena());
+ * }
+ * void C::f (double *M, int idim, ScratchArena& scratch) const {
+ *   ScratchDispatch::Call call (dispatch, scratch);
+ *   if (call.first()) f (M, idim);
+ *   else fT (M, idim, scratch);
+ * }
+ * \endcode
+ * Overrides of either version are called, whichever version the caller uses,
+ * and an override may call the implementation of its base class.
+ *
+ */
+
+class ScratchDispatch {
+  public:
+    /// Constructor
+    ScratchDispatch(): current (0) {}
+    /// Copy constructor: a pending call is not copied
+    ScratchDispatch (const ScratchDispatch&): current (0) {}
+    /// Assignment: a pending call is not copied
+    ScratchDispatch& operator= (const ScratchDispatch&) {return *this;}
+
+    // Class ScratchDispatch::Call
+    /// One call of a version with or without arena, for its duration
+    class Call {
+      public:
+        /// Constructor for the version without arena
+        explicit Call (ScratchDispatch& dispatch_   ///< The dispatch of the object
+                      );
+        /// Constructor for the version with arena
+        Call (ScratchDispatch& dispatch_,   ///< The dispatch of the object
+              ScratchArena& scratch_        ///< The arena of the call
+             );
+        /// Destructor: ends the pending call, if this call started it
+        ~Call();
+        /// Whether this is the first call, which must call the other version
+        bool first() const {return isfirst;}
+        /// The arena of the pending call; not for the first call without arena
+        ScratchArena& arena() const {return *scratch;}
+        /// First call without arena: make a temporary arena with nbytes, for the call of the other version
+        ScratchArena& makeArena (std::size_t nbytes   ///< Size of the arena in bytes
+                                );
+      private:
+        Call (const Call&);                // not copyable
+        Call& operator= (const Call&);     // not assignable
+        ScratchDispatch& dispatch;         ///< The dispatch of the object
+        ScratchArena *scratch;             ///< The arena of the pending call
+        ScratchArena *own;                 ///< The temporary arena, if this call made one
+        bool isfirst;                      ///< Whether this is the first call
+    };
+
+  private:
+    ScratchArena *current;                 ///< The arena of the pending call, or 0
+};
+
+#endif // __SCRATCHARENA_H
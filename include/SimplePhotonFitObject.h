@@ -80,6 +80,7 @@ class SimplePhotonFitObject : public ParticleFitObject {
                    chi2;
 
     enum {NPAR=3};
+    ParamStorage<NPAR> paramstorage;   ///< Parameters, flags and covariance matrices, see BaseFitObject
 
 };
 
@@ -0,0 +1,113 @@
+/*! \file
+ *  \brief Declares class template SoftGaussExpressionConstraint
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#ifndef __SOFTGAUSSEXPRESSIONCONSTRAINT_H
+#define __SOFTGAUSSEXPRESSIONCONSTRAINT_H
+
+#include "SoftGaussParticleConstraint.h"
+#include "ConstraintExpression.h"
+
+#include <cassert>
+
+//  Class template SoftGaussExpressionConstraint
+/// Soft constraint with a Gaussian distribution, given by an expression of sums of four-momenta
+/**
+ * As ExpressionConstraint, for a soft constraint with chi2 = (value/sigma)^2,
+ * e.g. a W mass with a width of 2.1 GeV:
+ * \code
+ * using namespace ConstraintDSL;
+ * SoftGaussParticleConstraint *wmass = newSoftGaussConstraint (mass (particle (0) + particle (1)) - 80.4, 2.1);
+ * \endcode
+ *
+ */
+
+template <class Expr>
+class SoftGaussExpressionConstraint: public SoftGaussParticleConstraint {
+  public:
+    /// Constructor
+    SoftGaussExpressionConstraint (const Expr& expr,   ///< The constraint function
+                                   double sigma_       ///< The sigma value
+                                  )
+    : SoftGaussParticleConstraint (sigma_), evaluator (expr)
+    {}
+    /// Virtual destructor
+    virtual ~SoftGaussExpressionConstraint() {}
+
+    /// Returns the value of the constraint function
+    virtual double getValue() const {
+      return evaluator.getValue (fitobjects);
+    }
+
+    /// Get first order derivatives.
+    /// Call this with a predefined array "der" with the necessary number of entries!
+    virtual void getDerivatives (int idim,      ///< First dimension of the array
+                                 double der[]   ///< Array of derivatives, at least idim x idim
+                                ) const {
+      Freeze freeze (evaluator, fitobjects, 1);
+      double dderivatives[4];
+      for (unsigned int i = 0; i < fitobjects.size(); ++i) {
+        bool nonzero = firstDerivatives (i, dderivatives);
+        for (int ilocal = 0; ilocal < fitobjects[i]->getNPar(); ++ilocal) {
+          if (!fitobjects[i]->isParamFixed (ilocal)) {
+            int iglobal = fitobjects[i]->getGlobalParNum (ilocal);
+            assert (iglobal >= 0 && iglobal < idim);
+            double d = 0;
+            if (nonzero) {
+              for (int ii = 0; ii < 4; ++ii) {
+                d += dderivatives[ii]*fitobjects[i]->getFirstDerivative_Meta_Local (ii, ilocal, 0);
+              }
+            }
+            der[iglobal] = d;
+          }
+        }
+      }
+    }
+
+    virtual void add2ndDerivativesToMatrix (double *M, int idim, ScratchArena& scratch) const {
+      Freeze freeze (evaluator, fitobjects);
+      SoftGaussParticleConstraint::add2ndDerivativesToMatrix (M, idim, scratch);
+    }
+    virtual void add2ndDerivativesToMatrix (SparseSymMatrix& M, ScratchArena& scratch) const {
+      Freeze freeze (evaluator, fitobjects);
+      SoftGaussParticleConstraint::add2ndDerivativesToMatrix (M, scratch);
+    }
+    // the other overloads of add2ndDerivativesToMatrix call these
+    using SoftGaussParticleConstraint::add2ndDerivativesToMatrix;
+
+    virtual void addToGlobalChi2DerVector (double *y, int idim) const {
+      Freeze freeze (evaluator, fitobjects, 1);
+      SoftGaussParticleConstraint::addToGlobalChi2DerVector (y, idim);
+    }
+
+    virtual double getError() const {
+      Freeze freeze (evaluator, fitobjects, 1);
+      return SoftGaussParticleConstraint::getError();
+    }
+
+  protected:
+    typedef typename ConstraintDSL::ExpressionEvaluator<Expr>::Freeze Freeze;
+
+    virtual bool secondDerivatives (int i, int j, double *dderivatives) const {
+      return evaluator.secondDerivatives (fitobjects, i, j, dderivatives);
+    }
+    virtual bool firstDerivatives (int i, double *dderivatives) const {
+      return evaluator.firstDerivatives (fitobjects, i, dderivatives);
+    }
+
+    ConstraintDSL::ExpressionEvaluator<Expr> evaluator;   ///< Value and derivatives of the expression
+};
+
+namespace ConstraintDSL {
+  /// Create a soft constraint with a Gaussian distribution of expr with width sigma; the caller owns it
+  template <class Expr>
+  SoftGaussExpressionConstraint<Expr> *newSoftGaussConstraint (const ScalarExpression<Expr>& expr, double sigma) {
+    return new SoftGaussExpressionConstraint<Expr> (expr.self(), sigma);
+  }
+}
+
+#endif // __SOFTGAUSSEXPRESSIONCONSTRAINT_H
@@ -3,6 +3,9 @@
  *
  * \b Changelog:
  * - 12.2.08 BL: First version
+ * - 16.10.2026 Work arrays of add2ndDerivativesToMatrix from a ScratchArena
+ * - 16.10.2026 add2ndDerivativesToMatrix only for pairs of fit objects with second derivatives
+ * - 16.10.2026 Evaluation of value and derivatives in one pass, kept during the derivative assembly
  *
  * \b CVS Log messages:
  * - $Log: SoftGaussParticleConstraint.h,v $
@@ -25,6 +28,8 @@
 #include "BaseFitObject.h"
 
 class ParticleFitObject;
+class SparseSymMatrix;
+class ScratchArena;
 
 //  Class SoftGaussParticleConstraint:
 /// Abstract base class for constraints of kinematic fits
@@ -58,6 +63,12 @@ class ParticleFitObject;
  * parameters (add1stDerivativesToMatrix, add2ndDerivativesToMatrix). This requires the
  * constraint to know its position in the overall list of constraints (globalNum). 
  * 
+ * As in BaseHardConstraint, add2ndDerivativesToMatrix calls secondDerivatives
+ * only for the pairs of fit objects for which hasSecondDerivatives is true,
+ * and a subclass may override the versions with or without ScratchArena.
+ * As in ParticleConstraint, getError, add2ndDerivativesToMatrix and addToGlobalChi2DerVector
+ * call evaluate() once (with an Evaluation object), and the derivatives
+ * of all fit objects can use its results.
  *
  * Author: Jenny List, Benno List
  * $Date: 2008/02/13 12:37:38 $
@@ -80,17 +91,20 @@ class SoftGaussParticleConstraint: public BaseSoftConstraint {
         fitobjects.push_back ((*fitobjects_)[i]);
         flags.push_back (1);
       }  
+      invalidatePairList();
     }; 
     /// Adds one ParticleFitObject objects to the list
     virtual void addToFOList(ParticleFitObject& fitobject, int flag = 1
                              ){
       fitobjects.push_back (&fitobject);
       flags.push_back (flag);
+      invalidatePairList();
     }; 
     /// Resests ParticleFitObject list
     virtual void resetFOList(){
       fitobjects.resize (0);
       flags.resize (0);
+      invalidatePairList();
     }; 
     
     /// Returns the value of the constraint function
@@ -118,6 +132,21 @@ class SoftGaussParticleConstraint: public BaseSoftConstraint {
     virtual void add2ndDerivativesToMatrix(double *M,     ///< Covariance matrix, at least idim x idim 
                                            int idim       ///< First dimension of the array
                                           ) const;
+    /// Adds second order derivatives to sparse global matrix M
+    virtual void add2ndDerivativesToMatrix(SparseSymMatrix& M   ///< Global matrix
+                                          ) const;
+    /// Adds second order derivatives to global covariance matrix M, with work arrays from scratch
+    virtual void add2ndDerivativesToMatrix(double *M,              ///< Covariance matrix, at least idim x idim 
+                                           int idim,               ///< First dimension of the array
+                                           ScratchArena& scratch   ///< Work space
+                                          ) const;
+    /// Adds second order derivatives to sparse global matrix M, with work arrays from scratch
+    virtual void add2ndDerivativesToMatrix(SparseSymMatrix& M,     ///< Global matrix
+                                           ScratchArena& scratch   ///< Work space
+                                          ) const;
+    /// Number of bytes that add2ndDerivativesToMatrix takes from a ScratchArena
+    virtual std::size_t getScratchSize (int idim   ///< Dimension of the global matrix
+                                       ) const;
 
     /// Add derivatives of chi squared to global derivative matrix
     virtual void addToGlobalChi2DerVector (double *y,   ///< Vector of chi2 derivatives
@@ -149,6 +178,12 @@ class SoftGaussParticleConstraint: public BaseSoftConstraint {
     int getVarBasis() const;
   
   protected:
+
+    /// Implementation of add2ndDerivativesToMatrix for dense (DenseMatrixRef) and sparse global matrices
+    template <class Matrix>
+    void add2ndDerivativesToMatrixT (Matrix& M, ScratchArena& scratch) const;
+    /// Total number of parameters of all fit objects
+    int getNParTotal() const;
   
     /// Second derivatives with respect to the 4-vectors of Fit objects i and j; result false if all derivatives are zero 
     virtual bool secondDerivatives (int i,                        ///< number of 1st FitObject
@@ -159,6 +194,43 @@ class SoftGaussParticleConstraint: public BaseSoftConstraint {
     virtual bool firstDerivatives (int i,                        ///< number of 1st FitObject
                                    double *derivatives           ///< The result 4-vector
                                   ) const = 0;
+
+    /// Whether secondDerivatives can be nonzero for fit objects i and j; called for all pairs when the fit object list has changed
+    virtual bool hasSecondDerivatives (int i,           ///< number of 1st FitObject
+                                       int j            ///< number of 2nd FitObject
+                                      ) const;
+    /// Get the pairs of fit objects for which hasSecondDerivatives is true: i, j for each pair
+    const std::vector <int>& getSecondDerivativePairs() const;
+    /// Make the list of pairs again before its next use; call this when the fit objects or flags change
+    void invalidatePairList() const {npairobjects = -1;}
+
+    /// Calculate the value and what the derivatives need, for all fit objects at once
+    virtual void evaluate() const {}
+    /// Whether the results of evaluate() are valid, i.e. an Evaluation object exists
+    bool isEvaluated() const {return evaluated;}
+
+    // Class SoftGaussParticleConstraint::Evaluation
+    /// Calls evaluate() and keeps its results valid during its lifetime
+    class Evaluation {
+      public:
+        /// Constructor: evaluates the constraint, unless it is evaluated already
+        explicit Evaluation (const SoftGaussParticleConstraint& constraint_   ///< The constraint
+                            )
+        : constraint (constraint_), outer (!constraint_.evaluated) {
+          if (outer) {
+            constraint.evaluate();
+            constraint.evaluated = true;
+          }
+        }
+        /// Destructor: the results of the outermost Evaluation are not valid any more
+        ~Evaluation() {
+          if (outer) constraint.evaluated = false;
+        }
+      private:
+        const SoftGaussParticleConstraint& constraint;   ///< The constraint
+        bool outer;                                      ///< Whether this is the outermost Evaluation
+    };
+    friend class Evaluation;
   
   
     /// Vector of pointers to ParticleFitObjects 
@@ -178,6 +250,13 @@ class SoftGaussParticleConstraint: public BaseSoftConstraint {
     /// The sigma of the Gaussian
     double sigma;
 
+    /// Pairs of fit objects for which hasSecondDerivatives is true, 2 entries per pair
+    mutable std::vector <int> secondDerivativePairs;
+    /// Number of fit objects for which secondDerivativePairs was made, -1 if it must be made again
+    mutable int npairobjects;
+    /// Whether the results of evaluate() are valid
+    mutable bool evaluated;
+
     enum { VAR_BASIS=BaseDefs::VARBASIS_EPXYZ }; // this means that the constraint knows about E,px,py,pz
 
 };
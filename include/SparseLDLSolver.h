@@ -0,0 +1,112 @@
+/*! \file
+ *  \brief Declares class SparseLDLSolver
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#ifndef __SPARSELDLSOLVER_H
+#define __SPARSELDLSOLVER_H
+
+#include <vector>
+
+class SparseSymMatrix;
+
+// Class SparseLDLSolver
+/// Solves A*x = b for a sparse symmetric matrix A with an LDL^T factorization
+/**
+ * The matrix is factorized as P*A*P^T = L*D*L^T, with a unit lower triangular
+ * matrix L, a diagonal matrix D and a fill reducing permutation P.
+ * No pivoting for stability is done, therefore A must be quasi-definite
+ * in the chosen elimination order; this is the case for the KKT matrices
+ * of the kinematic fit
+ * \f[
+ *   M = \left( \begin{array}{cc} H & A^T \\ A & 0 \end{array} \right)
+ * \f]
+ * if the measured parameters (with a positive definite chi^2 Hessian)
+ * are eliminated first, followed by the Lagrange multipliers and finally
+ * the unmeasured parameters. This order is imposed by assigning elimination
+ * phases to the rows with setPhases(); within a phase, the rows are ordered by
+ * the minimum degree heuristic.
+ *
+ * The ordering and the symbolic factorization (elimination tree, pattern of L)
+ * are recalculated only if the sparsity pattern of the matrix
+ * or the phases change, so that the iterations of a fit only perform the
+ * numerical factorization.
+ * Memory and time grow with the number of nonzero elements of L,
+ * not with the square of the dimension.
+ *
+ * factorize() fails if a pivot is smaller than pivtol times the largest matrix
+ * element; the caller then has to fall back to a pivoting dense solver.
+ *
+ * The factorization follows T.A. Davis, ACM Trans. Math. Softw. 31 (2005) 587.
+ *
+ */
+
+class SparseLDLSolver {
+  public:
+    /// Constructor
+    SparseLDLSolver();
+    /// Virtual destructor
+    virtual ~SparseLDLSolver();
+
+    /// Set the elimination phases: rows with smaller phase are eliminated first; empty vector: no phases
+    void setPhases (const std::vector<int>& phase_);
+
+    /// Factorize A; returns 0 if successful, k+1 if pivot k is too small
+    int factorize (const SparseSymMatrix& A,   ///< The matrix
+                   double pivtol = 1E-12       ///< Relative pivot tolerance
+                  );
+    /// Solve A*x = b in place, using the last factorization
+    void solve (double *x     ///< in: right hand side b, out: solution x; dimension n
+               ) const;
+
+    /// Get the dimension of the last factorization
+    int getDim() const {return n;}
+    /// Get the number of nonzero off-diagonal elements of L
+    int getNNZL() const;
+    /// Get the determinant of A from the last factorization
+    double getDeterminant() const;
+    /// Get the number of positive eigenvalues of A from the last factorization
+    int getNPositive() const;
+    /// Get the number of negative eigenvalues of A from the last factorization
+    int getNNegative() const;
+
+  protected:
+    /// Calculate the ordering and the symbolic factorization for A
+    void analyze (const SparseSymMatrix& A);
+    /// Calculate the minimum degree ordering perm, respecting the phases
+    void order (const SparseSymMatrix& A);
+
+    const SparseSymMatrix *matrix;   ///< Matrix of the last analysis
+    int version;                     ///< Pattern version of the last analysis
+    bool analyzed;                   ///< Analysis is valid
+    bool factorized;                 ///< Last factorization was successful
+
+    int n;                           ///< Dimension
+    std::vector<int> phase;          ///< Elimination phases
+    std::vector<int> perm;           ///< perm[k]: row of A that is eliminated in step k
+    std::vector<int> pinv;           ///< Inverse of perm
+
+    // permuted upper triangle of A, column by column
+    std::vector<int> Cp;             ///< Column pointers
+    std::vector<int> Ci;             ///< Row numbers
+    std::vector<double> Cx;          ///< Values
+    std::vector<int> Cmap;           ///< Position in Cx of the stored elements of A, column by column
+
+    // the factorization
+    std::vector<int> parent;         ///< Elimination tree
+    std::vector<int> Lp;             ///< Column pointers of L
+    std::vector<int> Li;             ///< Row numbers of L
+    std::vector<double> Lx;          ///< Values of L
+    std::vector<double> D;           ///< Diagonal matrix D
+
+    // work space
+    std::vector<int> Lnz;            ///< Number of elements per column of L
+    std::vector<int> flag;           ///< Work space
+    std::vector<int> pattern;        ///< Work space
+    mutable std::vector<double> y;   ///< Work space
+};
+
+#endif // __SPARSELDLSOLVER_H
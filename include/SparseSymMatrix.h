@@ -0,0 +1,127 @@
+/*! \file
+ *  \brief Declares class SparseSymMatrix
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#ifndef __SPARSESYMMATRIX_H
+#define __SPARSESYMMATRIX_H
+
+#include <vector>
+
+// Class SparseSymMatrix
+/// A sparse symmetric matrix for the global matrices of the fitters
+/**
+ * Only the upper triangle (row <= column) is stored, column by column,
+ * with the row numbers of each column in ascending order.
+ *
+ * The fit objects and constraints add their contributions to the global
+ * matrices always symmetrically, i.e. to element (i,j) and (j,i).
+ * Therefore add(i, j, x) ignores elements of the lower triangle, i > j.
+ *
+ * Elements are inserted by add() when they are first used and stay in the
+ * sparsity pattern when the matrix is set to zero; this way the pattern of
+ * a global matrix is built up in the first iteration of a fit,
+ * and stays the same afterwards.
+ * Each change of the pattern increments the pattern version, which
+ * allows a solver (SparseLDLSolver) to reuse its symbolic factorization.
+ *
+ */
+
+class SparseSymMatrix {
+  public:
+    /// Constructor
+    SparseSymMatrix (int n_ = 0    ///< Dimension
+                    );
+    /// Virtual destructor
+    virtual ~SparseSymMatrix();
+
+    /// Set the dimension and remove all elements from the pattern
+    void resize (int n_);
+    /// Get the dimension
+    int getDim() const {return n;}
+    /// Get the number of stored elements (upper triangle and diagonal)
+    int getNNZ() const {return nnz;}
+    /// Get the pattern version, which changes whenever the sparsity pattern changes
+    int getPatternVersion() const {return version;}
+
+    /// Set all elements to zero, keeping the sparsity pattern
+    void setZero();
+    /// Add x to element (i, j); elements of the lower triangle (i > j) are ignored
+    void add (int i, int j, double x) {
+      if (i <= j) element (i, j) += x;
+    }
+    /// Get element (i, j)
+    double get (int i, int j) const;
+
+    /// Set this matrix to diag(e)*source*diag(e)
+    void assignScaled (const SparseSymMatrix& source,   ///< The source matrix
+                       const double *e                  ///< Scale factors, dimension n
+                      );
+    /// Calculate y = A*x
+    void multiply (double *y,         ///< Result vector, dimension n
+                   const double *x    ///< Input vector, dimension n
+                  ) const;
+    /// Calculate x^T*A*x for the leading m x m block of A
+    double quadraticForm (const double *x,   ///< Input vector, dimension m
+                          int m              ///< Dimension of the block
+                         ) const;
+    /// Copy into a dense matrix, both triangles are filled
+    void copyTo (double *M,   ///< Dense matrix, at least n x n
+                 int tda      ///< First dimension of M
+                ) const;
+    /// Check whether all elements are finite
+    bool isfinite() const;
+    /// Get the largest absolute value of all elements
+    double getMaxAbs() const;
+
+    /// Get the number of stored elements in column j
+    int getColSize (int j) const {return cols[j].size();}
+    /// Get the row number of the k-th stored element in column j
+    int getRow (int j, int k) const {return cols[j][k].row;}
+    /// Get the value of the k-th stored element in column j
+    double getValue (int j, int k) const {return cols[j][k].val;}
+
+  protected:
+    /// Get a reference to element (i, j) with i <= j, inserting it if necessary
+    double& element (int i, int j);
+
+    /// A stored element
+    struct Element {
+      int    row;   ///< Row number
+      double val;   ///< Value
+    };
+    typedef std::vector<Element> Column;
+
+    int n;                      ///< Dimension
+    int nnz;                    ///< Number of stored elements
+    int version;                ///< Pattern version
+    std::vector<Column> cols;   ///< Stored elements, column by column
+};
+
+// Class DenseMatrixRef
+/// Reference to a dense idim x idim matrix with the interface of SparseSymMatrix::add
+/**
+ * Allows to write code that fills the global matrices only once,
+ * as a template for dense and sparse matrices.
+ * In contrast to SparseSymMatrix, all elements are stored.
+ */
+
+class DenseMatrixRef {
+  public:
+    /// Constructor
+    DenseMatrixRef (double *M_,   ///< The matrix, at least idim x idim
+                    int idim_     ///< First dimension of M
+                   ): M (M_), idim (idim_) {}
+    /// Get the dimension
+    int getDim() const {return idim;}
+    /// Add x to element (i, j)
+    void add (int i, int j, double x) {M[idim*i+j] += x;}
+
+    double *M;    ///< The matrix
+    int idim;     ///< First dimension of M
+};
+
+#endif // __SPARSESYMMATRIX_H
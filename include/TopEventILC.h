@@ -19,6 +19,8 @@
 #include "MassConstraint.h"
 #include "SoftGaussMassConstraint.h"
 
+class TRandom;
+
 class TopEventILC : public BaseEvent {
   public: 
     TopEventILC();
@@ -39,24 +41,37 @@ class TopEventILC : public BaseEvent {
     double getW1Mass()  {return softmasses ? w1.getMass() : sw1.getMass();};
     double getW2Mass()  {return softmasses ? w2.getMass() : sw2.getMass();};
     double getTopMass(int flag)  {return softmasses ? w.getMass(flag) : sw.getMass();};
-    double getTop1Mass()  {return fvsmear[1]->getM();};
-    double getTop2Mass()  {return fvsmear[2]->getM();};
+    double getTop1Mass()  {return fvsmear[1].getM();};
+    double getTop2Mass()  {return fvsmear[2].getM();};
     
     void setDebug (bool _debug) {debug = _debug;};
     
+    // restart the random number generators of the events of this class
+    // and of FourVector::decayto; the same seed gives the same sequence
+    // of events (seed must not be 0)
+    static void setSeed (unsigned int seed);
+    
+    // use this random number generator for genEvent and its decays,
+    // instead of the one shared by all events of this class (0: shared one);
+    // e.g. a CounterRandom, to generate events on several threads
+    void setRandom (TRandom *random_) {random = random_;};
+    TRandom* getRandom() {return random;};
+    
     ParticleFitObject* getTrueFitObject (int i) {return bfo[i];};
     ParticleFitObject* getStartFitObject (int i) {return bfostart[i];};
     ParticleFitObject* getFittedFitObject (int i) {return bfosmear[i];};
-    FourVector* getTrueFourVector (int i) {return fv[i];};
+    FourVector* getTrueFourVector (int i) {return fv+i;};
+    int getNFitObjects() const {return NBFO;};
     
     bool softmasses, leptonic, leptonasjet, debug;
     
   protected:
   
     enum {NFV = 11, NBFO = 6};
-    FourVector *fv[NFV];
-    FourVector *fvsmear[NFV];
-    FourVector *fvfinal[NFV];
+    // four-vectors and fit objects are reused by the next genEvent
+    FourVector fv[NFV];
+    FourVector fvsmear[NFV];
+    FourVector fvfinal[NFV];
     ParticleFitObject *bfo[NBFO];
     ParticleFitObject *bfostart[NBFO];
     ParticleFitObject *bfosmear[NBFO];
@@ -72,6 +87,8 @@ class TopEventILC : public BaseEvent {
     SoftGaussMassConstraint sw2;
     SoftGaussMassConstraint sw;
     
+    TRandom *random;
+    
     
 
 };
@@ -14,12 +14,15 @@
 #undef NDEBUG
 #include <cassert>
 
-#include "EVENT/TrackState.h"
-#include "EVENT/Track.h"
+namespace EVENT {
+  class Track;
+  class TrackState;
+}
 
 class TrackParticleFitObject : public ParticleFitObject {
  public:
 
+  // the LCIO constructors are defined in the LCIO adapter library
   TrackParticleFitObject( const EVENT::Track*      trk, double m);
   TrackParticleFitObject( const EVENT::TrackState* trk, double m);
   TrackParticleFitObject( const double* _ppars, const double* _cov, double m, const double* refPt_=0);
@@ -66,12 +69,25 @@ class TrackParticleFitObject : public ParticleFitObject {
 
   virtual int getCharge() const;
 
-  /// Set the B field for all tracks
+  /// Set the B field for all tracks that have no B field of their own
+  /**
+   * The new value is used by all these tracks, including existing ones,
+   * when they recalculate their cache. Must not be called while other 
+   * threads run fits; tracks in different fields can be fitted in parallel
+   * with setTrackBfield.
+   */
   static double setBfield (double bfield_             ///< New Value of B field (in Tesla)
 			   );
   
-  /// Get the B field for all tracks (in Tesla)
-  inline static double getBfield ();
+  /// Get the B field for all tracks that have no B field of their own (in Tesla)
+  static double getBfield ();
+  
+  /// Set a B field for this track only, which replaces the global one
+  virtual double setTrackBfield (double bfield_       ///< New Value of B field (in Tesla)
+                                 );
+  
+  /// Get the B field of this track: its own if set, otherwise the global one (in Tesla)
+  virtual double getTrackBfield () const;
   
   /// Global B field in Tesla(!)
   static double bfield;
@@ -138,9 +154,28 @@ class TrackParticleFitObject : public ParticleFitObject {
 
   static const double parfact[NPAR];
 
+  ParamStorage<NPAR> paramstorage;   ///< Parameters, flags and covariance matrices, see BaseFitObject
+
+  /// Number of independent elements of a symmetric NPAR x NPAR matrix
+  enum {NSYM = NPAR*(NPAR+1)/2};
+
+  /// Index of element (j, k) of a symmetric matrix in packed storage (the triangle with j >= k, row by row)
+  static int symIndex (int j, int k) {
+    return j >= k ? j*(j+1)/2 + k : k*(k+1)/2 + j;
+  }
+
   virtual void initialise( const double* _pars, const double* _cov, double m);
 
+  /// Calculate the parameters in physical units, chi2, the four-momentum and the points on the trajectory;
+  /// the derivatives are calculated on demand, in three groups, by the following functions
   void updateCache() const;
+  /// Make the derivatives of the four-momentum (VARBASIS_EPXYZ) valid
+  void updateMomentumCache() const;
+  /// Make the derivatives of the track plane normal (VARBASIS_TRKNORMAL), the normal and the PCA vector valid
+  void updateNormalCache() const;
+  /// Make the derivatives of the start and end points of the trajectory valid
+  void updateTrajectoryCache() const;
+
   void updateMomentumDerivatives() const;
   void updateNormalDerivatives() const;
   void updateTrajectoryDerivatives() const;
@@ -158,16 +193,14 @@ class TrackParticleFitObject : public ParticleFitObject {
   mutable ThreeVector momentumAtEnd;
 
   mutable double momentumFirstDerivatives[4][NPAR];
-  mutable double momentumSecondDerivatives[4][NPAR][NPAR];
+  mutable double momentumSecondDerivatives[4][NSYM];   ///< Packed, see symIndex
 
   mutable double normalFirstDerivatives[3][NPAR];
-  mutable double normalSecondDerivatives[3][NPAR][NPAR];
+  mutable double normalSecondDerivatives[3][NSYM];     ///< Packed, see symIndex
 
+  // only first derivatives: no constraint uses second derivatives of the trajectory
   mutable double trajectoryStartFirstDerivatives[3][NPAR];
-  mutable double trajectoryStartSecondDerivatives[3][NPAR][NPAR];
-
   mutable double trajectoryEndFirstDerivatives[3][NPAR];
-  mutable double trajectoryEndSecondDerivatives[3][NPAR][NPAR];
 
   mutable double phi0  ;
   mutable double omega ;
@@ -179,6 +212,15 @@ class TrackParticleFitObject : public ParticleFitObject {
 
   mutable double chi2;
 
+  mutable bool momentumDerivativesValid;     ///< Whether the momentum derivatives are valid (if cachevalid is true)
+  mutable bool normalDerivativesValid;       ///< Whether the normal derivatives are valid (if cachevalid is true)
+  mutable bool trajectoryDerivativesValid;   ///< Whether the trajectory derivatives are valid (if cachevalid is true)
+
+  /// B field of this track in Tesla, if useTrackBfield is set
+  double trackBfield;
+  /// Whether trackBfield replaces the global B field
+  bool useTrackBfield;
+
   void   resetMomentumFirstDerivatives() const;
   void   resetMomentumSecondDerivatives() const;
 
@@ -186,7 +228,6 @@ class TrackParticleFitObject : public ParticleFitObject {
   void   resetNormalSecondDerivatives() const;
 
   void   resetTrajectoryFirstDerivatives() const;
-  void   resetTrajectorySecondDerivatives() const;
 
   void   setMomentumFirstDerivatives (int iMeta, int jLocal, double x) const;
   void   setMomentumSecondDerivatives(int iMeta, int jLocal, int kLocal, double x) const;
@@ -195,10 +236,8 @@ class TrackParticleFitObject : public ParticleFitObject {
   void   setNormalSecondDerivatives(int iMeta, int jLocal, int kLocal, double x) const;
 
   void   setTrajectoryStartFirstDerivatives (int iMeta, int jLocal, double x) const;
-  void   setTrajectoryStartSecondDerivatives(int iMeta, int jLocal, int kLocal, double x) const;
 
   void   setTrajectoryEndFirstDerivatives (int iMeta, int jLocal, double x) const;
-  void   setTrajectoryEndSecondDerivatives(int iMeta, int jLocal, int kLocal, double x) const;
 
   virtual double getMomentumFirstDerivatives (int iMeta, int jLocal) const;
   virtual double getMomentumSecondDerivatives(int iMeta, int jLocal, int kLocal) const;
@@ -207,10 +246,8 @@ class TrackParticleFitObject : public ParticleFitObject {
   virtual double getNormalSecondDerivatives(int iMeta, int jLocal, int kLocal) const;
 
   virtual double getTrajectoryStartFirstDerivatives (int iMeta, int jLocal) const;
-  virtual double getTrajectoryStartSecondDerivatives(int iMeta, int jLocal, int kLocal) const;
 
   virtual double getTrajectoryEndFirstDerivatives (int iMeta, int jLocal) const;
-  virtual double getTrajectoryEndSecondDerivatives(int iMeta, int jLocal, int kLocal) const;
 
 };
 
@@ -3,6 +3,7 @@
  *
  * \b Changelog:
  * - 6.12.04 BL First version
+ * - 16.10.2026 Parameters in storage for NPAR parameters
  *
  * \b CVS Log messages:
  * - $Log: VertexFitObject.h,v $
@@ -257,6 +258,7 @@ class VertexFitObject: public BaseFitObject {
   
     /// Number of parameters
     enum {NPAR = 3};
+    ParamStorage<NPAR> paramstorage;   ///< Parameters, flags and covariance matrices, see BaseFitObject
     
 //    /// fit parameters
 //    double par[NPAR];
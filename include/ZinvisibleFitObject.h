@@ -68,6 +68,7 @@ class ZinvisibleFitObject : public ParticleFitObject {
     void updateCache() const;
 
     enum {NPAR=3};
+    ParamStorage<NPAR> paramstorage;   ///< Parameters, flags and covariance matrices, see BaseFitObject
   
     mutable bool cachevalid;
     
@@ -2,6 +2,9 @@
  *  \brief Implements class BaseFitObject
  *
  * \b Changelog:
+ * - 16.10.2026 setName reuses the name buffer, assign no longer leaks the old name
+ * - 16.10.2026 Parameters and covariance matrices in storage provided by the derived class
+ * - 16.10.2026 Cache updates reported to the active phase tracer of the thread
  *
  * \b CVS Log messages:
  * - $Log: BaseFitObject.cc,v $
@@ -27,6 +30,8 @@
  */ 
  
 #include "BaseFitObject.h"
+#include "SparseSymMatrix.h"
+#include "BaseTracer.h"
 
 #undef NDEBUG
 #include <cassert>
@@ -36,27 +41,47 @@
 #include <cmath>
 using std::isfinite;
 
-#include <gsl/gsl_matrix.h>
-#include <gsl/gsl_linalg.h>
+BaseFitObject::BaseFitObject()
+  : name(0), defaultstorage (new ParamStorage<BaseDefs::MAXPAR>), covinvvalid(false), cachevalid(false)
+{
+  init (BaseDefs::MAXPAR, defaultstorage->dvalues, defaultstorage->ivalues, defaultstorage->bvalues);
+}
+
+BaseFitObject::BaseFitObject (const BaseFitObject& rhs)
+  : name(0), defaultstorage (new ParamStorage<BaseDefs::MAXPAR>), covinvvalid(false), cachevalid(false)
+{
+  init (BaseDefs::MAXPAR, defaultstorage->dvalues, defaultstorage->ivalues, defaultstorage->bvalues);
+  //std::cout << "copying BaseFitObject with name" << rhs.name << std::endl;
+  BaseFitObject::assign (rhs);
+}
+
+void BaseFitObject::init (int npar, double *dvalues, int *ivalues, bool *bvalues) {
+  assert (npar > 0 && npar <= BaseDefs::MAXPAR);
+  nparstorage = npar;
+  par          = dvalues;
+  mpar         = dvalues + npar;
+  cov.elements = dvalues + 2*npar;
+  cov.n        = npar;
+  covinv.elements = dvalues + npar*(npar+2);
+  covinv.n        = npar;
+  globalParNum = ivalues;
+  measured     = bvalues;
+  fixed        = bvalues + npar;
 
-BaseFitObject::BaseFitObject(): name(0), covinvvalid(false), cachevalid(false) {
   setName ("???");
   invalidateCache();
 
-  for (int ilocal = 0; ilocal < BaseDefs::MAXPAR; ++ilocal) {
+  for (int ilocal = 0; ilocal < npar; ++ilocal) {
+    par[ilocal] = 0;
+    mpar[ilocal] = 0;
     globalParNum[ilocal] = -1;
+    measured[ilocal] = false;
     fixed[ilocal] = false;
-    for (int jlocal = 0; jlocal < BaseDefs::MAXPAR; ++jlocal) 
+    for (int jlocal = 0; jlocal < npar; ++jlocal) {
       cov[ilocal][jlocal] = 0; 
+      covinv[ilocal][jlocal] = 0; 
+    }
   }
-
-}
-
-BaseFitObject::BaseFitObject (const BaseFitObject& rhs)
-  : name(0), covinvvalid(false), cachevalid(false)
-{
-  //std::cout << "copying BaseFitObject with name" << rhs.name << std::endl;
-  BaseFitObject::assign (rhs);
 }
 
 BaseFitObject& BaseFitObject::operator= (const BaseFitObject& rhs) {
@@ -69,15 +94,16 @@ BaseFitObject& BaseFitObject::operator= (const BaseFitObject& rhs) {
     
 BaseFitObject& BaseFitObject::assign (const BaseFitObject& source) {
   if (&source != this) {
-    name = 0; 
     setName(source.name);
-    for (int i =0; i < BaseDefs::MAXPAR; ++i) {
+    // source and target are of the same type, or the target has storage for BaseDefs::MAXPAR parameters
+    assert (nparstorage >= source.nparstorage);
+    for (int i =0; i < source.nparstorage; ++i) {
       par[i]          = source.par[i];
       mpar[i]         = source.mpar[i];
       measured[i]     = source.measured[i];
       fixed[i]        = source.fixed[i];
       globalParNum[i] = source.globalParNum[i];
-      for (int j = 0; j < BaseDefs::MAXPAR; ++j) 
+      for (int j = 0; j < source.nparstorage; ++j) 
         cov[i][j] = source.cov[i][j];
     }  
     covinvvalid = false;
@@ -86,10 +112,20 @@ BaseFitObject& BaseFitObject::assign (const BaseFitObject& source) {
   return *this;
 }
 
+void BaseFitObject::updateCacheTraced() const {
+  BaseTracer *phasetracer = PhaseTracerScope::getTracer();
+  if (phasetracer) {
+    assert (PhaseTracerScope::getFitter());
+    TracerPhase phase (phasetracer, *PhaseTracerScope::getFitter(), BaseTracer::PHASE_UPDATECACHE);
+    updateCache();
+  }
+  else updateCache();
+}
     
 BaseFitObject::~BaseFitObject() {
   //std::cout << "destroying BaseFitObject with name" << name << std::endl;
   delete[] name;
+  delete defaultstorage;
 }
 
 //const double BaseFitObject::eps2 = 0.00001;
@@ -98,8 +134,11 @@ const double BaseFitObject::eps2 = 0.0001; // changed to 1^-4, then sqrt(eps2) c
 void  BaseFitObject::setName (const char * name_) {
   if (name_ == 0) return;
   size_t l = strlen(name_);
-  if (name) delete[] name;
-  name = new char[l+1];
+  // reuse the buffer if it is large enough, so that renaming a reused object does not allocate
+  if (name == 0 || strlen(name) < l) {
+    delete[] name;
+    name = new char[l+1];
+  }
   strcpy (name, name_);
 }
 
@@ -228,30 +267,55 @@ bool BaseFitObject::calculateCovInv() const {
   //  std::cout << "hello from BaseFitObject::calculateCovInv()" << std::endl;
 
   int n = getNPar();
+  assert (n <= BaseDefs::MAXPAR);
 
-  gsl_matrix *covm = gsl_matrix_alloc (n, n);
-  gsl_matrix_set_identity (covm);
-  
+  // local copy of cov, with unit matrix for unmeasured parameters
+  double l[BaseDefs::MAXPAR][BaseDefs::MAXPAR];
   for (int i = 0; i < n; ++i) {
-    if (isParamMeasured (i)) {
-      for (int j = 0; j < n; ++j) {
-        if (isParamMeasured (j)) {
-	  gsl_matrix_set (covm, i, j, cov[i][j]);
-	  // std::cout << "BaseFitObject::calculateCovInv getting from cov " << i << " " << j << " " << cov[i][j] << std::endl;
-	}
-      }
+    for (int j = 0; j < n; ++j) {
+      l[i][j] = (isParamMeasured (i) && isParamMeasured (j)) ? cov[i][j] : static_cast<double>(i == j);
     }
   }
-  gsl_error_handler_t *e = gsl_set_error_handler_off ();
-  int result = gsl_linalg_cholesky_decomp (covm);
-  if (result == 0) result = gsl_linalg_cholesky_invert (covm);
-  gsl_set_error_handler (e);
-  
-  for (int i = 0; i < n; ++i) {
-    for (int j = 0; j < i; ++j) {
-      covinv[i][j] = covinv[j][i] = gsl_matrix_get (covm, i, j);
+
+  // Cholesky decomposition cov = L L^T, in place in the lower triangle of l.
+  // Done by hand rather than with gsl_linalg_cholesky_decomp, because that
+  // would require switching off the process-wide GSL error handler,
+  // which is not thread safe.
+  int result = 0;
+  for (int j = 0; j < n; ++j) {
+    double s = l[j][j];
+    for (int k = 0; k < j; ++k) s -= l[j][k]*l[j][k];
+    if (!(s > 0)) {
+      result = 1;
+      break;
+    }
+    l[j][j] = std::sqrt (s);
+    for (int i = j+1; i < n; ++i) {
+      double t = l[i][j];
+      for (int k = 0; k < j; ++k) t -= l[i][k]*l[j][k];
+      l[i][j] = t/l[j][j];
+    }
+  }
+
+  if (result == 0) {
+    // linv = L^-1 (lower triangular)
+    double linv[BaseDefs::MAXPAR][BaseDefs::MAXPAR];
+    for (int j = 0; j < n; ++j) {
+      linv[j][j] = 1/l[j][j];
+      for (int i = j+1; i < n; ++i) {
+        double t = 0;
+        for (int k = j; k < i; ++k) t -= l[i][k]*linv[k][j];
+        linv[i][j] = t/l[i][i];
+      }
+    }
+    // covinv = L^-T L^-1
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j <= i; ++j) {
+        double t = 0;
+        for (int k = i; k < n; ++k) t += linv[k][i]*linv[k][j];
+        covinv[i][j] = covinv[j][i] = t;
+      }
     }
-    covinv[i][i] = gsl_matrix_get (covm, i, i);
   }
 
 //  //std::cout << "cov matrix:" << std::endl;
@@ -278,7 +342,6 @@ bool BaseFitObject::calculateCovInv() const {
 //    std::cout << std::endl;
 //  }
 
-  gsl_matrix_free(covm);
   covinvvalid = (result == 0);
 
   if (!covinvvalid) {
@@ -433,8 +496,8 @@ double BaseFitObject::getChi2() const {
   if (!covinvvalid) calculateCovInv();
   if (!covinvvalid) return -1;
   double chi2 = 0;
-  static double resid[BaseDefs::MAXPAR];
-  static bool chi2contr[BaseDefs::MAXPAR];
+  double resid[BaseDefs::MAXPAR];
+  bool chi2contr[BaseDefs::MAXPAR];
   for (int i = 0; i < getNPar(); ++i) {
     resid[i] = par[i]-mpar[i];
 
@@ -519,7 +582,7 @@ void BaseFitObject::addToGlobalChi2DerVector (double *y, int idim,
 					      double lambda, double der[], int metaSet ) const {
   // DANIEL moved to BaseFitObject 
   // this adds the lambda * dConst/dpar piece
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   for (int ilocal=0; ilocal<getNPar(); ilocal++) {
     int iglobal = globalParNum[ilocal];
     if ( iglobal>=0 ) {
@@ -534,7 +597,7 @@ void BaseFitObject::addToGlobalChi2DerVector (double *y, int idim,
 void BaseFitObject::addTo1stDerivatives (double M[], int idim, 
 					 double der[], int kglobal, int metaSet) const {
   // DANIEL moved to BaseFitObject 
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   for (int ilocal=0; ilocal<getNPar(); ilocal++) {
     int iglobal = globalParNum[ilocal];
     if (iglobal>=0) {
@@ -557,7 +620,7 @@ void   BaseFitObject::addTo2ndDerivatives (double der2[], int idim,
 					   ) const {
 
   // DANIEL moved to BaseFitObject 
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   for ( int ilocal=0; ilocal<getNPar(); ilocal++) {
     int iglobal = getGlobalParNum(ilocal);
     if ( iglobal<0 ) continue;
@@ -584,12 +647,84 @@ void   BaseFitObject::addTo2ndDerivatives (double M[], int idim,  double lambda,
   return;
 }
 
+void BaseFitObject::addToGlobCov (SparseSymMatrix& globCov) const {
+  for (int ilocal = 0; ilocal < getNPar(); ++ilocal) {
+    if (!isParamFixed(ilocal) && isParamMeasured(ilocal)) {
+      int iglobal = getGlobalParNum (ilocal);
+      assert (iglobal >= 0 && iglobal < globCov.getDim());
+      for (int jlocal = 0; jlocal < getNPar(); ++jlocal) {
+        if (!isParamFixed(jlocal) && isParamMeasured(jlocal)) {
+          int jglobal = getGlobalParNum (jlocal);
+          assert (jglobal >= 0 && jglobal < globCov.getDim());
+          globCov.add (iglobal, jglobal, getCov(ilocal,jlocal));
+        }
+      }
+    }
+  }
+}
+
+void BaseFitObject::addToGlobalChi2DerMatrix (SparseSymMatrix& M) const {
+  if (!covinvvalid) calculateCovInv();
+  assert( covinvvalid );
+  for (int ilocal = 0; ilocal < getNPar(); ++ilocal) {
+    if (!isParamFixed(ilocal) && isParamMeasured(ilocal)) {
+      int iglobal = getGlobalParNum (ilocal);
+      assert (iglobal >= 0 && iglobal < M.getDim());
+      for (int jlocal = 0; jlocal < getNPar(); ++jlocal) {
+        if (!isParamFixed(jlocal) && isParamMeasured(jlocal)) {
+          int jglobal = getGlobalParNum (jlocal);
+          assert (jglobal >= 0 && jglobal < M.getDim());
+          M.add (iglobal, jglobal, getD2Chi2DParam2(ilocal, jlocal));
+        }
+      }
+    }
+  }
+}
+
+void BaseFitObject::addTo1stDerivatives (SparseSymMatrix& M, double der[], int kglobal, int metaSet) const {
+  if (!cachevalid) updateCacheTraced();
+  for (int ilocal=0; ilocal<getNPar(); ilocal++) {
+    int iglobal = globalParNum[ilocal];
+    if (iglobal>=0) {
+      for (int j=0; j<BaseDefs::nMetaVars[metaSet]; j++) {
+        double x = der[j] * getFirstDerivative_Meta_Local( j, ilocal , metaSet);
+        M.add (iglobal, kglobal, x);
+        M.add (kglobal, iglobal, x);
+      }
+    }
+  }
+}
+
+void BaseFitObject::addTo2ndDerivatives (SparseSymMatrix& M, double factor[], int metaSet) const {
+  if (!cachevalid) updateCacheTraced();
+  for ( int ilocal=0; ilocal<getNPar(); ilocal++) {
+    int iglobal = getGlobalParNum(ilocal);
+    if ( iglobal<0 ) continue;
+    for ( int jlocal=ilocal; jlocal<getNPar(); jlocal++) {
+      int jglobal = getGlobalParNum(jlocal);
+      if ( jglobal<0 ) continue;
+      double sum(0);
+      for ( int imeta=0; imeta<BaseDefs::nMetaVars[metaSet]; imeta++) {
+        sum+=factor[imeta]*getSecondDerivative_Meta_Local( imeta, ilocal , jlocal , metaSet );
+      }
+      M.add (iglobal, jglobal, sum);
+      if ( iglobal!=jglobal ) M.add (jglobal, iglobal, sum);
+    }
+  }
+}
+
+void BaseFitObject::addTo2ndDerivatives (SparseSymMatrix& M, double lambda, double der[], int metaSet) const {
+  double factor[BaseDefs::MAXINTERVARS];
+  for (int i=0; i<BaseDefs::nMetaVars[metaSet]; i++) factor[i]=lambda*der[i];
+  addTo2ndDerivatives (M, factor, metaSet );
+}
+
 // seems not used
 // void BaseFitObject::addToDerivatives (double der[], int idim, 
 // 				      double factor[], int metaSet
 // 				      ) const {
 //   // DANIEL moved to BaseFitObject 
-//   if (!cachevalid) updateCache();
+//   if (!cachevalid) updateCacheTraced();
 //   for (int ilocal=0; ilocal<getNPar(); ilocal++) {
 //     int iglobal = globalParNum[ilocal];
 //     if ( iglobal >= 0 ) {
@@ -616,7 +751,7 @@ void BaseFitObject::initCov()  {
 
 double BaseFitObject::getError2 (double der[], int metaSet) const {
   // DANIEL moved to BaseFitObject 
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   double totError(0);
   for (int i=0; i<BaseDefs::nMetaVars[metaSet]; i++) {
     for (int j=0; j<BaseDefs::nMetaVars[metaSet]; j++) {
@@ -3,6 +3,12 @@
  *
  * \b Changelog:
  * - 15.11.2010 First version
+ * - 16.10.2026 Work arrays of add2ndDerivativesToMatrix from a ScratchArena
+ * - 16.10.2026 Chain rule of add2ndDerivativesToMatrix in ChainRuleKernels
+ * - 16.10.2026 add2ndDerivativesToMatrix only for pairs of fit objects with second derivatives
+ * - 16.10.2026 Arena versions of add2ndDerivativesToMatrix call the versions without arena
+ * - 16.10.2026 Calls between the versions with and without arena through ScratchDispatch
+ * - 16.10.2026 Second derivatives of all pairs from one call of secondDerivativeBlocks
  *
  *
  * \b CVS Log messages:
@@ -14,6 +20,9 @@
  */ 
  
 #include "BaseHardConstraint.h"
+#include "SparseSymMatrix.h"
+#include "ScratchArena.h"
+#include "ChainRuleKernels.h"
 
 #undef NDEBUG
 #include <cassert>
@@ -25,6 +34,15 @@
 using std::cout;
 using std::endl;
 
+namespace {
+  void addTo2ndDerivatives (const BaseFitObject *fo, DenseMatrixRef& M, double lambda, double der[], int metaSet) {
+    fo->addTo2ndDerivatives (M.M, M.idim, lambda, der, metaSet);
+  }
+  void addTo2ndDerivatives (const BaseFitObject *fo, SparseSymMatrix& M, double lambda, double der[], int metaSet) {
+    fo->addTo2ndDerivatives (M, lambda, der, metaSet);
+  }
+}
+
 BaseHardConstraint::~BaseHardConstraint()
 {}
 
@@ -40,6 +58,17 @@ void BaseHardConstraint::add1stDerivativesToMatrix(double *M, int idim) const {
   }
 }
 
+void BaseHardConstraint::add1stDerivativesToMatrix (SparseSymMatrix& M) const {
+  double dgdpi[BaseDefs::MAXINTERVARS];
+  for (unsigned int i = 0; i < fitobjects.size(); ++i) {
+    const BaseFitObject *foi = fitobjects[i];
+    assert (foi);
+    if (firstDerivatives (i, dgdpi)) {
+      foi->addTo1stDerivatives (M, dgdpi, getGlobalNum(), getVarBasis());
+    }
+  }
+}
+
 
 /**
  * Calculates the second derivative of the constraint g w.r.t. the various parameters,
@@ -66,8 +95,10 @@ void BaseHardConstraint::add1stDerivativesToMatrix(double *M, int idim) const {
  */
  
  
-void BaseHardConstraint::add2ndDerivativesToMatrix (double *M, int idim, double lambda ) const
+template <class Matrix>
+void BaseHardConstraint::add2ndDerivativesToMatrixT (Matrix& M, double lambda, ScratchArena& scratch) const
 {
+  ScratchArena::Frame frame (scratch);
 
   /** First, treat the part 
    * $$
@@ -75,29 +106,22 @@ void BaseHardConstraint::add2ndDerivativesToMatrix (double *M, int idim, double
    *     \frac{\partial P_i}{\partial a_k} \cdot \frac{\partial P_j}{\partial a_l}
    * $$
    */
-  // Derivatives $\frac{\partial ^2 g}{\partial P_i \partial P_j}$ at fixed i, j
-  // d2GdPidPj[4*ii+jj] is derivative w.r.t. P_i,ii and P_j,jj, where ii=0,1,2,3 for E,px,py,pz
-  double d2GdPidPj[BaseDefs::MAXINTERVARS*BaseDefs::MAXINTERVARS];
-
   // Derivatives $\frac {\partial P_i}{\partial a_k}$ for all i; 
   // k is local parameter number
   // dPidAk[KMAX*4*i + 4*k + ii] is $\frac {\partial P_{i,ii}}{\partial a_k}$,
   // with ii=0, 1, 2, 3 for E, px, py, pz
   const int n = fitobjects.size();
-  double *dPidAk = new double[n*BaseDefs::MAXPAR*BaseDefs::MAXINTERVARS];
-  bool *dPidAkval = new bool[n];
+  double *dPidAk = scratch.alloc<double> (n*BaseDefs::MAXPAR*BaseDefs::MAXINTERVARS);
+  bool *dPidAkval = scratch.alloc<bool> (n);
   
   for (int i = 0; i < n; ++i) dPidAkval[i] = false;
   
-  // Derivatives $\frac{\partial ^2 g}{\partial P_i \partial a_l}$ at fixed i
-  // d2GdPdAl[4*l + ii] is $\frac{\partial ^2 g}{\partial P_{i,ii} \partial a_l}$
-  double d2GdPdAl[BaseDefs::MAXINTERVARS*BaseDefs::MAXPAR];
   // Derivatives $\frac{\partial ^2 g}{\partial a_k \partial a_l}$ 
   double d2GdAkdAl[BaseDefs::MAXPAR*BaseDefs::MAXPAR];
   
   // Global parameter numbers: parglobal[BaseDefs::MAXPAR*i+klocal] 
   // is global parameter number of local parameter klocal of i-th Fit object
-  int *parglobal = new int[BaseDefs::MAXPAR*n];
+  int *parglobal = scratch.alloc<int> (BaseDefs::MAXPAR*n);
   
   for (int i = 0; i < n; ++i) {
     const BaseFitObject *foi =  fitobjects[i];
@@ -108,61 +132,50 @@ void BaseHardConstraint::add2ndDerivativesToMatrix (double *M, int idim, double
   }
   
   
-  for (int i = 0; i < n; ++i) {
+  // Only pairs of fit objects that can have second derivatives
+  const std::vector <int>& pairs = getSecondDerivativePairs();
+  const int npairs = pairs.size()/2;
+
+  // Derivatives $\frac{\partial ^2 g}{\partial P_i \partial P_j}$ of all pairs
+  // d2GdPidPj[4*ii+jj] is derivative w.r.t. P_i,ii and P_j,jj, where ii=0,1,2,3 for E,px,py,pz
+  double *blocks = scratch.alloc<double> (npairs*BaseDefs::MAXINTERVARS*BaseDefs::MAXINTERVARS);
+  bool *blocknonzero = scratch.alloc<bool> (npairs);
+  secondDerivativeBlocks (pairs, blocks, blocknonzero);
+
+  for (int ipair = 0; ipair < npairs; ++ipair) {
+    int i = pairs[2*ipair];
+    int j = pairs[2*ipair+1];
     const BaseFitObject *foi =  fitobjects[i];
     assert (foi);
-    for (int j = 0; j < n; ++j) {
-      const BaseFitObject *foj =  fitobjects[j];
-      assert (foj);
-      if (secondDerivatives (i, j, d2GdPidPj)) {
-        if (!dPidAkval[i]) {
-          foi->getDerivatives (dPidAk+i*(BaseDefs::MAXPAR*BaseDefs::MAXINTERVARS), BaseDefs::MAXPAR*BaseDefs::MAXINTERVARS);
-          dPidAkval[i] = true;
-        }
-        if (!dPidAkval[j]) {
-          foj->getDerivatives (dPidAk+j*(BaseDefs::MAXPAR*BaseDefs::MAXINTERVARS), BaseDefs::MAXPAR*BaseDefs::MAXINTERVARS);
-          dPidAkval[j] = true;
-        }
-        // Now sum over E/px/Py/Pz for object j:
-        // $$\frac{\partial ^2 g}{\partial P_{i,ii} \partial a_l}
-        //   = (sum_{j}) sum_{jj} frac{\partial ^2 g}{\partial P_{i,ii} \partial P_{j,jj}}  
-        //     \cdot \frac{\partial P_{j,jj}}{\partial a_l}
-        // We're summing over jj here
+    const BaseFitObject *foj =  fitobjects[j];
+    assert (foj);
+    const double *d2GdPidPj = blocks + ipair*BaseDefs::MAXINTERVARS*BaseDefs::MAXINTERVARS;
+    if (blocknonzero[ipair]) {
+      if (!dPidAkval[i]) {
+        foi->getDerivatives (dPidAk+i*(BaseDefs::MAXPAR*BaseDefs::MAXINTERVARS), BaseDefs::MAXPAR*BaseDefs::MAXINTERVARS);
+        dPidAkval[i] = true;
+      }
+      if (!dPidAkval[j]) {
+        foj->getDerivatives (dPidAk+j*(BaseDefs::MAXPAR*BaseDefs::MAXINTERVARS), BaseDefs::MAXPAR*BaseDefs::MAXINTERVARS);
+        dPidAkval[j] = true;
+      }
+      // Now sum over E/px/Py/Pz for object j and for object i:
+      // $$
+      // \frac{\partial ^2 g}{\partial a_k \partial a_l}
+      //      = \sum_{ii} \sum_{jj} \frac{\partial P_{i,ii}}{\partial a_k} \cdot
+      //        \frac{\partial ^2 g}{\partial P_{i,ii} \partial P_{j,jj}} \cdot
+      //        \frac{\partial P_{j,jj}}{\partial a_l}
+      // $$
+      ChainRuleKernels::contract (d2GdPidPj, dPidAk+(BaseDefs::MAXPAR*BaseDefs::MAXINTERVARS)*i, foi->getNPar(),
+                                  dPidAk+(BaseDefs::MAXPAR*BaseDefs::MAXINTERVARS)*j, foj->getNPar(), d2GdAkdAl, BaseDefs::MAXPAR);
+      // Now expand the local parameter numbers to global ones
+      for (int klocal = 0; klocal < foi->getNPar(); ++klocal) {
+        int kglobal = parglobal [BaseDefs::MAXPAR*i + klocal];
+        if (kglobal < 0) continue;
         for (int llocal = 0; llocal < foj->getNPar(); ++llocal) {
-          for (int ii = 0; ii < BaseDefs::MAXINTERVARS; ++ii) {
-            int ind1 = BaseDefs::MAXINTERVARS*ii;
-            int ind2 = (BaseDefs::MAXPAR*BaseDefs::MAXINTERVARS)*j + BaseDefs::MAXINTERVARS*llocal;
-            double& r = d2GdPdAl[BaseDefs::MAXINTERVARS*llocal + ii];
-            r  = d2GdPidPj[  ind1] * dPidAk[  ind2];   // E
-            r += d2GdPidPj[++ind1] * dPidAk[++ind2];   // px
-            r += d2GdPidPj[++ind1] * dPidAk[++ind2];   // py
-            r += d2GdPidPj[++ind1] * dPidAk[++ind2];   // pz
-          }
-        }
-        // Now sum over E/px/Py/Pz for object i, i.e. sum over ii:
-        // $$
-        // \frac{\partial ^2 g}{\partial a_k \partial a_l}
-        //      = \sum_{ii} \frac{\partial ^2 g}{\partial P_{i,ii} \partial a_l} \cdot 
-        //        \frac{\partial P_{i,ii}}{\partial a_k}
-        // $$
-        for (int klocal = 0; klocal < foi->getNPar(); ++klocal) {
-          for (int llocal = 0; llocal < foj->getNPar(); ++llocal) {
-            int ind1 = BaseDefs::MAXINTERVARS*llocal;
-            int ind2 = (BaseDefs::MAXPAR*BaseDefs::MAXINTERVARS)*i + BaseDefs::MAXINTERVARS*klocal;
-            double& r = d2GdAkdAl[BaseDefs::MAXPAR*klocal+llocal];
-            r  = d2GdPdAl[  ind1] * dPidAk[  ind2];    //E
-            r += d2GdPdAl[++ind1] * dPidAk[++ind2];   // px
-            r += d2GdPdAl[++ind1] * dPidAk[++ind2];   // py
-            r += d2GdPdAl[++ind1] * dPidAk[++ind2];   // pz
-          }
-        }
-        // Now expand the local parameter numbers to global ones
-        for (int klocal = 0; klocal < foi->getNPar(); ++klocal) {
-          int kglobal = parglobal [BaseDefs::MAXPAR*i + klocal];
-          for (int llocal = 0; llocal < foj->getNPar(); ++llocal) {
-            int lglobal = parglobal [BaseDefs::MAXPAR*j + llocal];
-            M [idim*kglobal+lglobal] += lambda*d2GdAkdAl[BaseDefs::MAXPAR*klocal+llocal];
-          }
+          int lglobal = parglobal [BaseDefs::MAXPAR*j + llocal];
+          if (lglobal < 0) continue;
+          M.add (kglobal, lglobal, lambda*d2GdAkdAl[BaseDefs::MAXPAR*klocal+llocal]);
         }
       }
     }
@@ -181,13 +194,95 @@ void BaseHardConstraint::add2ndDerivativesToMatrix (double *M, int idim, double
     const BaseFitObject *foi = fitobjects[i];
     assert (foi);
     if (firstDerivatives (i, dgdpi)) {
-      foi->addTo2ndDerivatives (M, idim, lambda, dgdpi, getVarBasis());
+      addTo2ndDerivatives (foi, M, lambda, dgdpi, getVarBasis());
     }
   }
-  
-  delete[] dPidAk;
-  delete[] dPidAkval;
-  delete[] parglobal;
+}
+
+// The versions with and without arena call each other once through the
+// virtual functions, so that overrides of either are called, see ScratchDispatch
+void BaseHardConstraint::add2ndDerivativesToMatrix (double *M, int idim, double lambda ) const
+{
+  ScratchDispatch::Call call (dispatch);
+  if (call.first()) {
+    add2ndDerivativesToMatrix (M, idim, lambda, call.makeArena (getScratchSize (idim)));
+  }
+  else {
+    DenseMatrixRef Mref (M, idim);
+    add2ndDerivativesToMatrixT (Mref, lambda, call.arena());
+  }
+}
+
+void BaseHardConstraint::add2ndDerivativesToMatrix (SparseSymMatrix& M, double lambda ) const
+{
+  ScratchDispatch::Call call (dispatch);
+  if (call.first()) {
+    add2ndDerivativesToMatrix (M, lambda, call.makeArena (getScratchSize (M.getDim())));
+  }
+  else {
+    add2ndDerivativesToMatrixT (M, lambda, call.arena());
+  }
+}
+
+void BaseHardConstraint::add2ndDerivativesToMatrix (double *M, int idim, double lambda, ScratchArena& scratch) const
+{
+  ScratchDispatch::Call call (dispatch, scratch);
+  if (call.first()) {
+    add2ndDerivativesToMatrix (M, idim, lambda);
+  }
+  else {
+    DenseMatrixRef Mref (M, idim);
+    add2ndDerivativesToMatrixT (Mref, lambda, scratch);
+  }
+}
+
+void BaseHardConstraint::add2ndDerivativesToMatrix (SparseSymMatrix& M, double lambda, ScratchArena& scratch) const
+{
+  ScratchDispatch::Call call (dispatch, scratch);
+  if (call.first()) {
+    add2ndDerivativesToMatrix (M, lambda);
+  }
+  else {
+    add2ndDerivativesToMatrixT (M, lambda, scratch);
+  }
+}
+
+bool BaseHardConstraint::hasSecondDerivatives (int, int) const {
+  return true;
+}
+
+const std::vector <int>& BaseHardConstraint::getSecondDerivativePairs() const {
+  const int n = fitobjects.size();
+  if (npairobjects != n) {
+    secondDerivativePairs.resize (0);
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+        if (hasSecondDerivatives (i, j)) {
+          secondDerivativePairs.push_back (i);
+          secondDerivativePairs.push_back (j);
+        }
+      }
+    }
+    npairobjects = n;
+  }
+  return secondDerivativePairs;
+}
+
+void BaseHardConstraint::secondDerivativeBlocks (const std::vector <int>& pairs, double *blocks, bool *nonzero) const {
+  for (unsigned int ipair = 0; 2*ipair < pairs.size(); ++ipair) {
+    nonzero[ipair] = secondDerivatives (pairs[2*ipair], pairs[2*ipair+1],
+                                        blocks + ipair*BaseDefs::MAXINTERVARS*BaseDefs::MAXINTERVARS);
+  }
+}
+
+std::size_t BaseHardConstraint::getScratchSize (int) const {
+  const int n = fitobjects.size();
+  const int npairs = getSecondDerivativePairs().size()/2;
+  return ScratchArena::size<double> (n*BaseDefs::MAXPAR*BaseDefs::MAXINTERVARS)
+       + ScratchArena::size<bool> (n)
+       + ScratchArena::size<int> (BaseDefs::MAXPAR*n)
+       + ScratchArena::size<double> (npairs*BaseDefs::MAXINTERVARS*BaseDefs::MAXINTERVARS)
+       + ScratchArena::size<bool> (npairs);
 }
 
 void BaseHardConstraint::addToGlobalChi2DerVector (double *y, int idim, double lambda) const {
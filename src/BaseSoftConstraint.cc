@@ -3,6 +3,7 @@
  *
  * \b Changelog:
  * - 17.11.2010 First version
+ * - 16.10.2026 add2ndDerivativesToMatrix with work arrays from a ScratchArena
  *
  *
  * \b CVS Log messages:
@@ -14,7 +15,33 @@
  */ 
  
 #include "BaseSoftConstraint.h"
+#include "SparseSymMatrix.h"
+#include "ScratchArena.h"
 
 BaseSoftConstraint::~BaseSoftConstraint()
 {}
 
+void BaseSoftConstraint::add2ndDerivativesToMatrix (SparseSymMatrix& M) const {
+  ScratchArena scratch (getScratchSize (M.getDim()));
+  add2ndDerivativesToMatrix (M, scratch);
+}
+
+void BaseSoftConstraint::add2ndDerivativesToMatrix (double *M, int idim, ScratchArena&) const {
+  add2ndDerivativesToMatrix (M, idim);
+}
+
+void BaseSoftConstraint::add2ndDerivativesToMatrix (SparseSymMatrix& M, ScratchArena& scratch) const {
+  ScratchArena::Frame frame (scratch);
+  int idim = M.getDim();
+  double *Mdense = scratch.alloc<double> (idim*idim);
+  for (int i = 0; i < idim*idim; ++i) Mdense[i] = 0;
+  add2ndDerivativesToMatrix (Mdense, idim, scratch);
+  for (int i = 0; i < idim; ++i) 
+    for (int j = i; j < idim; ++j) 
+      if (Mdense[i*idim+j]) M.add (i, j, Mdense[i*idim+j]);
+}
+
+std::size_t BaseSoftConstraint::getScratchSize (int idim) const {
+  return ScratchArena::size<double> (idim*idim);
+}
+
@@ -2,7 +2,9 @@
  *  \brief Implements class BaseTracer
  *
  * \b Changelog:
- * - 
+ * - 16.10.2026 Added phase hooks beginPhase and endPhase
+ * - 16.10.2026 Phase for the parameter errors of the scaling
+ * - 16.10.2026 PhaseTracerScope for the cache updates of the fit objects
  *
  * \b CVS Log messages:
  * - $Log: BaseTracer.cc,v $
@@ -15,6 +17,18 @@
 
 #include "BaseTracer.h"
 
+#if __cplusplus >= 201103L
+#define PHASETRACER_THREADLOCAL thread_local
+#else
+#define PHASETRACER_THREADLOCAL __thread
+#endif
+
+namespace {
+  // Active phase tracer of the current thread, set by PhaseTracerScope
+  PHASETRACER_THREADLOCAL BaseTracer *activetracer = 0;
+  PHASETRACER_THREADLOCAL BaseFitter *activefitter = 0;
+}
+
 BaseTracer::BaseTracer(): next (0) {}
 
 BaseTracer::~BaseTracer() {}
@@ -35,6 +49,26 @@ void BaseTracer::finish (BaseFitter& fitter) {
   if (next) next->finish (fitter);
 }
 
+const char *BaseTracer::getPhaseName (int phase) {
+  static const char *names[NPHASES] = {
+    "assembly", "scaling", "factorization", "svd", "linesearch", 
+    "lambdas", "2ndordercorr", "covariance", "updatecache", "parerrors"
+  };
+  return (phase >= 0 && phase < NPHASES) ? names[phase] : "unknown";
+}
+
+bool BaseTracer::tracesPhases () const {
+  return next ? next->tracesPhases() : false;
+}
+
+void BaseTracer::beginPhase (BaseFitter& fitter, int phase) {
+  if (next) next->beginPhase (fitter, phase);
+}
+
+void BaseTracer::endPhase (BaseFitter& fitter, int phase) {
+  if (next) next->endPhase (fitter, phase);
+}
+
 void BaseTracer::setNextTracer (BaseTracer *next_) {
   next = next_;
 }
@@ -46,3 +80,22 @@ void BaseTracer::setNextTracer (BaseTracer& next_) {
 BaseTracer *BaseTracer::getNextTracer () {
   return next;
 }
+
+PhaseTracerScope::PhaseTracerScope (BaseTracer *tracer_, BaseFitter& fitter_)
+: oldtracer (activetracer), oldfitter (activefitter) {
+  activetracer = tracer_;
+  activefitter = tracer_ ? &fitter_ : 0;
+}
+
+PhaseTracerScope::~PhaseTracerScope () {
+  activetracer = oldtracer;
+  activefitter = oldfitter;
+}
+
+BaseTracer *PhaseTracerScope::getTracer () {
+  return activetracer;
+}
+
+BaseFitter *PhaseTracerScope::getFitter () {
+  return activefitter;
+}
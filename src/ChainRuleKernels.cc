@@ -0,0 +1,155 @@
+/*! \file
+ *  \brief Implements class ChainRuleKernels
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#include "ChainRuleKernels.h"
+
+#undef NDEBUG
+#include <cassert>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CHAINRULEKERNELS_AVX
+#include <immintrin.h>
+#endif
+
+namespace {
+
+  // The portable version: first contract over jj,
+  // d2GdPdAl[4*l + ii] = sum_jj d2GdPidPj[4*ii+jj] * dPjdAl[4*l+jj],
+  // then over ii
+  void contractScalar (const double *d2GdPidPj, const double *dPidAk, int ni,
+                       const double *dPjdAl, int nj, double *d2GdAkdAl, int ldr) {
+    double d2GdPdAl[4];
+    for (int l = 0; l < nj; ++l) {
+      const double *a = dPjdAl + 4*l;
+      for (int ii = 0; ii < 4; ++ii) {
+        const double *d = d2GdPidPj + 4*ii;
+        double r;
+        r  = d[0]*a[0];   // E
+        r += d[1]*a[1];   // px
+        r += d[2]*a[2];   // py
+        r += d[3]*a[3];   // pz
+        d2GdPdAl[ii] = r;
+      }
+      for (int k = 0; k < ni; ++k) {
+        const double *b = dPidAk + 4*k;
+        double r;
+        r  = d2GdPdAl[0]*b[0];   // E
+        r += d2GdPdAl[1]*b[1];   // px
+        r += d2GdPdAl[2]*b[2];   // py
+        r += d2GdPdAl[3]*b[3];   // pz
+        d2GdAkdAl[ldr*k + l] = r;
+      }
+    }
+  }
+
+#ifdef CHAINRULEKERNELS_AVX
+  // The AVX version: the four lanes are four parameters a_l, a_{l+1}, ...;
+  // the 4x4 blocks of dPjdAl are transposed so that
+  // column jj holds the derivatives of P_{j,jj}.
+  // Multiplications and additions are separate and in the same order
+  // as in contractScalar, so that the results are identical.
+  // The last nj%4 parameters a_l are done by contractScalar
+  // (padding them to a full vector costs more than it saves).
+  __attribute__ ((target ("avx")))
+  void contractAVX (const double *d2GdPidPj, const double *dPidAk, int ni,
+                    const double *dPjdAl, int nj, double *d2GdAkdAl, int ldr) {
+    int l0 = 0;
+    for (; l0 + 4 <= nj; l0 += 4) {
+      const double *a = dPjdAl + 4*l0;
+      __m256d r0 = _mm256_loadu_pd (a);
+      __m256d r1 = _mm256_loadu_pd (a + 4);
+      __m256d r2 = _mm256_loadu_pd (a + 8);
+      __m256d r3 = _mm256_loadu_pd (a + 12);
+      __m256d t0 = _mm256_unpacklo_pd (r0, r1);
+      __m256d t1 = _mm256_unpackhi_pd (r0, r1);
+      __m256d t2 = _mm256_unpacklo_pd (r2, r3);
+      __m256d t3 = _mm256_unpackhi_pd (r2, r3);
+      __m256d c0 = _mm256_permute2f128_pd (t0, t2, 0x20);
+      __m256d c1 = _mm256_permute2f128_pd (t1, t3, 0x20);
+      __m256d c2 = _mm256_permute2f128_pd (t0, t2, 0x31);
+      __m256d c3 = _mm256_permute2f128_pd (t1, t3, 0x31);
+
+      // d2GdPdAl[ii]: lane q is the derivative w.r.t. P_{i,ii} and a_{l0+q}
+      __m256d d2GdPdAl[4];
+      for (int ii = 0; ii < 4; ++ii) {
+        const double *d = d2GdPidPj + 4*ii;
+        __m256d r =               _mm256_mul_pd (_mm256_broadcast_sd (d),     c0);
+        r = _mm256_add_pd (r, _mm256_mul_pd (_mm256_broadcast_sd (d + 1), c1));
+        r = _mm256_add_pd (r, _mm256_mul_pd (_mm256_broadcast_sd (d + 2), c2));
+        r = _mm256_add_pd (r, _mm256_mul_pd (_mm256_broadcast_sd (d + 3), c3));
+        d2GdPdAl[ii] = r;
+      }
+
+      for (int k = 0; k < ni; ++k) {
+        const double *b = dPidAk + 4*k;
+        __m256d r =               _mm256_mul_pd (d2GdPdAl[0], _mm256_broadcast_sd (b));
+        r = _mm256_add_pd (r, _mm256_mul_pd (d2GdPdAl[1], _mm256_broadcast_sd (b + 1)));
+        r = _mm256_add_pd (r, _mm256_mul_pd (d2GdPdAl[2], _mm256_broadcast_sd (b + 2)));
+        r = _mm256_add_pd (r, _mm256_mul_pd (d2GdPdAl[3], _mm256_broadcast_sd (b + 3)));
+        _mm256_storeu_pd (d2GdAkdAl + ldr*k + l0, r);
+      }
+    }
+    // avoid the penalty for mixing AVX and SSE code in the caller;
+    // compilers only insert this by themselves with higher optimization
+    _mm256_zeroupper();
+    if (l0 < nj) contractScalar (d2GdPidPj, dPidAk, ni, dPjdAl + 4*l0, nj - l0, d2GdAkdAl + l0, ldr);
+  }
+#endif
+
+  ChainRuleKernels::Kernel selected = ChainRuleKernels::SCALAR;
+}
+
+ChainRuleKernels::ContractFunction *ChainRuleKernels::contractFunction = &contractScalar;
+
+namespace {
+  // Select the fastest version already when the library is loaded,
+  // before any fits run on several threads
+  const bool initialized = ChainRuleKernels::setKernel (ChainRuleKernels::AUTO);
+}
+
+bool ChainRuleKernels::setKernel (Kernel kernel) {
+  if (kernel == AUTO) kernel = isAvailable (AVX) ? AVX : SCALAR;
+  if (!isAvailable (kernel)) return false;
+  selected = kernel;
+#ifdef CHAINRULEKERNELS_AVX
+  if (kernel == AVX) {
+    contractFunction = &contractAVX;
+    return true;
+  }
+#endif
+  contractFunction = &contractScalar;
+  return true;
+}
+
+ChainRuleKernels::Kernel ChainRuleKernels::getKernel() {
+  return selected;
+}
+
+const char *ChainRuleKernels::getKernelName() {
+  switch (selected) {
+    case AVX: return "AVX";
+    default:  return "scalar";
+  }
+}
+
+bool ChainRuleKernels::isAvailable (Kernel kernel) {
+  switch (kernel) {
+    case AUTO:
+    case SCALAR:
+      return true;
+    case AVX:
+#ifdef CHAINRULEKERNELS_AVX
+      __builtin_cpu_init();
+      return __builtin_cpu_supports ("avx");
+#else
+      return false;
+#endif
+  }
+  assert (0);
+  return false;
+}
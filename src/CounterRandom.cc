@@ -0,0 +1,100 @@
+/*! \file
+ *  \brief Implements class CounterRandom
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+#ifdef MARLIN_USE_ROOT
+
+#include "CounterRandom.h"
+
+#include <cmath>
+
+#undef NDEBUG
+#include <cassert>
+
+// constants of Philox4x32
+static const uint32_t PHILOX_M0 = 0xD2511F53;
+static const uint32_t PHILOX_M1 = 0xCD9E8D57;
+static const uint32_t PHILOX_W0 = 0x9E3779B9;
+static const uint32_t PHILOX_W1 = 0xBB67AE85;
+
+CounterRandom::CounterRandom (unsigned long seed)
+{
+  SetSeed (seed);
+}
+
+CounterRandom::~CounterRandom()
+{}
+
+void CounterRandom::SetSeed (unsigned long seed) {
+  uint64_t s = seed;
+  key[0] = static_cast<uint32_t>(s);
+  key[1] = static_cast<uint32_t>(s >> 32);
+  setStream (0);
+}
+
+void CounterRandom::setStream (uint64_t stream) {
+  ctr[0] = ctr[1] = 0;
+  ctr[2] = static_cast<uint32_t>(stream);
+  ctr[3] = static_cast<uint32_t>(stream >> 32);
+  nused = 4;
+}
+
+uint64_t CounterRandom::getStream () const {
+  return (static_cast<uint64_t>(ctr[3]) << 32) | ctr[2];
+}
+
+void CounterRandom::philox (const uint32_t key[2], const uint32_t ctr[4], uint32_t result[4]) {
+  uint32_t k0 = key[0], k1 = key[1];
+  uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+  for (int round = 0; round < 10; ++round) {
+    if (round > 0) {
+      k0 += PHILOX_W0;
+      k1 += PHILOX_W1;
+    }
+    uint64_t p0 = static_cast<uint64_t>(PHILOX_M0)*c0;
+    uint64_t p1 = static_cast<uint64_t>(PHILOX_M1)*c2;
+    c0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+    c1 = static_cast<uint32_t>(p1);
+    c2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+    c3 = static_cast<uint32_t>(p0);
+  }
+  result[0] = c0;
+  result[1] = c1;
+  result[2] = c2;
+  result[3] = c3;
+}
+
+double CounterRandom::Rndm () {
+  if (nused == 4) {
+    philox (key, ctr, block);
+    // the 64 bit block number must not overflow into the stream number
+    if (++ctr[0] == 0) {
+      ++ctr[1];
+      assert (ctr[1] != 0);
+    }
+    nused = 0;
+  }
+  // 53 bits from two 32 bit numbers; the offset of half a step keeps the result away from 0 and 1
+  uint32_t a = block[nused++] >> 5;
+  uint32_t b = block[nused++] >> 6;
+  return (a*67108864.0 + b + 0.5)*(1.0/9007199254740992.0);
+}
+
+void CounterRandom::RndmArray (int n, float *array) {
+  for (int i = 0; i < n; ++i) array[i] = Rndm();
+}
+
+void CounterRandom::RndmArray (int n, double *array) {
+  for (int i = 0; i < n; ++i) array[i] = Rndm();
+}
+
+double CounterRandom::Gaus (double mean, double sigma) {
+  double r = std::sqrt (-2*std::log (Rndm()));
+  double phi = 2*M_PI*Rndm();
+  return mean + sigma*r*std::cos (phi);
+}
+
+#endif // MARLIN_USE_ROOT
@@ -27,6 +27,13 @@ using std::sqrt;
 using std::cos;
 using std::sin;
 
+// set the seed of the random number generator
+void DijetEventILC::setSeed (unsigned int seed) {
+  if (rnd == 0) rnd = new TRandom3 (seed);
+  else rnd->SetSeed (seed);
+  FourVector::setSeed (seed);
+}
+
 // constructor: 
 DijetEventILC::DijetEventILC()
 : leptonic (false), leptonasjet (false), debug (false),
@@ -34,10 +41,10 @@ DijetEventILC::DijetEventILC()
   pyc (0, 0, 1, 0, 0),
   pzc (0, 0, 0, 1, 0),
   ec  (1, 0, 0, 0, 500),
-  mc( MassConstraint() )
+  mc( MassConstraint() ),
+  random (0)
   {
-  for (int i = 0; i < NFV; ++i) fv[i] = 0;
-  for (int i = 0; i < NBFO; ++i) bfo[i] = bfosmear[i] = 0;
+  for (int i = 0; i < NBFO; ++i) bfo[i] = bfosmear[i] = bfostart[i] = 0;
   mc.setMass (500);
   pxc.setName ("px");
   pyc.setName ("py");
@@ -48,13 +55,43 @@ DijetEventILC::DijetEventILC()
 
 //destructor: 
 DijetEventILC::~DijetEventILC() {
-  for (int i = 0; i < NFV; ++i) delete fv[i];
   for (int i = 0; i < NBFO; ++i) {
     delete bfo[i];
     delete bfosmear[i];
+    delete bfostart[i];
   }  
 }
 
+// Fit objects are reused from event to event: if the slot already holds
+// an object of the right type, it gets the new values, otherwise
+// it is replaced (e.g. after switching to leptonic events)
+static void reuseJet (ParticleFitObject*& fo, double E, double theta, double phi,
+                      double DE, double Dtheta, double Dphi, double m) {
+  if (JetFitObject *jet = dynamic_cast<JetFitObject *>(fo)) {
+    jet->setValues (E, theta, phi, DE, Dtheta, Dphi, m);
+  }
+  else {
+    delete fo;
+    fo = new JetFitObject (E, theta, phi, DE, Dtheta, Dphi, m);
+  }
+}
+
+static void reuseLepton (ParticleFitObject*& fo, double ptinv, double theta, double phi,
+                         double Dptinv, double Dtheta, double Dphi, double m) {
+  if (LeptonFitObject *lepton = dynamic_cast<LeptonFitObject *>(fo)) {
+    lepton->setValues (ptinv, theta, phi, Dptinv, Dtheta, Dphi, m);
+  }
+  else {
+    delete fo;
+    fo = new LeptonFitObject (ptinv, theta, phi, Dptinv, Dtheta, Dphi, m);
+  }
+}
+
+// decay with the random number generator of the event, if it has one
+static void decay (const FourVector& mother, FourVector& d1, FourVector& d2, TRandom *random) {
+  if (random) mother.decayto (d1, d2, *random);
+  else mother.decayto (d1, d2);
+}
 
 // generate four vectors
 void DijetEventILC::genEvent(){
@@ -74,10 +111,15 @@ void DijetEventILC::genEvent(){
   double Ecm = 500.;
       
   double rw[4];
-  if (rnd == 0) rnd = new TRandom3();
-  rnd->RndmArray (4, rw);
+  TRandom *r = random;
+  if (r == 0) {
+    if (rnd == 0) rnd = new TRandom3();
+    r = rnd;
+  }
+  r->RndmArray (4, rw);
   
-  FourVector *jetpair = fv[0] = new FourVector (Ecm, 0., 0., 0.);
+  FourVector *jetpair = &fv[0];
+  jetpair->setValues (Ecm, 0., 0., 0.);
   if (debug) {
     cout << "jetpair: m = " << jetpair->getM() << endl;
   }  
@@ -86,10 +128,12 @@ void DijetEventILC::genEvent(){
   // do something random later
   double mjet1 = mj;
   double mjet2 = mj;
-  FourVector *jet1 = fv[1] = new FourVector (mjet1, 0, 0, 0);
-  FourVector *jet2 = fv[2] = new FourVector (mjet2, 0, 0, 0);
+  FourVector *jet1 = &fv[1];
+  jet1->setValues (mjet1, 0, 0, 0);
+  FourVector *jet2 = &fv[2];
+  jet2->setValues (mjet2, 0, 0, 0);
   
-  jetpair->decayto (*jet1, *jet2);
+  decay (*jetpair, *jet1, *jet2, random);
   if (debug) {
     cout << "jet 1: m=" << mjet1 << " = " << jet1->getM() << endl;
     cout << "jet 2: m=" << mjet2 << " = " << jet2->getM() << endl;
@@ -109,10 +153,10 @@ void DijetEventILC::genEvent(){
   
   for (int j = 0; j < 2; ++j) {
     int i = j+1;
-    double E = fv[i]->getE();
-    double theta = fv[i]->getTheta();
-    double phi = fv[i]->getPhi();
-    double ptinv = 1/(fv[i]->getPt());
+    double E = fv[i].getE();
+    double theta = fv[i].getTheta();
+    double phi = fv[i].getPhi();
+    double ptinv = 1/(fv[i].getPt());
     //double EError = (j==4 && leptonic) ? Eresolem*sqrt(E) : Eresolhad*sqrt(E);
     //double EError = Eresolhad*sqrt(E);  // for jets
     double EError = Eresolhad*sqrt(Ecm/2);  // use a fixed resolution, should be equivalent to jet energy for di-jet events! 
@@ -130,7 +174,7 @@ void DijetEventILC::genEvent(){
     static const char *names[] = {"j1", "j2"};
     // Create fit object with true quantities for later comparisons
     if (!leptonic || leptonasjet) {
-      bfo[j] = new JetFitObject (E, theta, phi, EError, thetaResol, phiResol, mj);
+      reuseJet (bfo[j], E, theta, phi, EError, thetaResol, phiResol, mj);
       bfo[j]->setName (names[j]);
       if (debug) {
         cout << "true jet " << j << ": E = " << bfo[j]->getParam(0) << " +- " << bfo[j]->getError(0)
@@ -140,7 +184,7 @@ void DijetEventILC::genEvent(){
       }
     }  
     else if (leptonic && !leptonasjet) {
-      bfo[j] = new LeptonFitObject (ptinv, theta, phi, ptinvError, thetaResolTrack, phiResol, 0);
+      reuseLepton (bfo[j], ptinv, theta, phi, ptinvError, thetaResolTrack, phiResol, 0);
       bfo[j]->setName (names[j]);
       if (debug) {
         cout << " true Lepton: E = " << bfo[j]->getE() << ", px = " << bfo[j]->getPx() << ", py = " << bfo[j]->getPy() 
@@ -153,8 +197,7 @@ void DijetEventILC::genEvent(){
     }  
     
     double randoms[3];
-    if (rnd == 0) rnd = new TRandom3();
-    for (int irnd = 0; irnd < 3; ++irnd) randoms[irnd] = rnd->Gaus();
+    for (int irnd = 0; irnd < 3; ++irnd) randoms[irnd] = r->Gaus();
     
     // Create fit object with smeared quantities as fit input
     double ESmear = E + EError*randoms[0];
@@ -171,9 +214,9 @@ void DijetEventILC::genEvent(){
     
     
     if (!leptonic || leptonasjet) {
-      bfosmear[j] = new JetFitObject (ESmear, thetaSmear, phiSmear, EError, thetaResol, phiResol, mj);
+      reuseJet (bfosmear[j], ESmear, thetaSmear, phiSmear, EError, thetaResol, phiResol, mj);
       bfosmear[j]->setName (names[j]);
-      bfostart[j] = new JetFitObject (ESmear, thetaSmear, phiSmear, EError, thetaResol, phiResol, mj);
+      reuseJet (bfostart[j], ESmear, thetaSmear, phiSmear, EError, thetaResol, phiResol, mj);
       bfostart[j]->setName (names[j]);
       Etot  += bfosmear[j]->getE();
       pxtot += bfosmear[j]->getPx();
@@ -187,9 +230,9 @@ void DijetEventILC::genEvent(){
       }
     }
     else if (leptonic && !leptonasjet) {
-      bfosmear[j] = new LeptonFitObject (ptinvSmear, thetaSmearTrack, phiSmearTrack, ptinvError, thetaResolTrack, phiResolTrack, 0.);
+      reuseLepton (bfosmear[j], ptinvSmear, thetaSmearTrack, phiSmearTrack, ptinvError, thetaResolTrack, phiResolTrack, 0.);
       bfosmear[j]->setName (names[j]);
-      bfostart[j] = new LeptonFitObject (ptinvSmear, thetaSmearTrack, phiSmearTrack, ptinvError, thetaResolTrack, phiResolTrack, 0.);
+      reuseLepton (bfostart[j], ptinvSmear, thetaSmearTrack, phiSmearTrack, ptinvError, thetaResolTrack, phiResolTrack, 0.);
       bfostart[j]->setName (names[j]);
       Etot  += bfosmear[j]->getE();
       pxtot += bfosmear[j]->getPx();
@@ -209,9 +252,9 @@ void DijetEventILC::genEvent(){
       }       
     }
     
-    fvsmear[i] = new FourVector (bfosmear[j]->getE(), bfosmear[j]->getPx(), bfosmear[j]->getPy(), bfosmear[j]->getPz());
+    fvsmear[i].setValues (bfosmear[j]->getE(), bfosmear[j]->getPx(), bfosmear[j]->getPy(), bfosmear[j]->getPz());
     if (debug) {
-      cout << "jet " << i << ": m = " << fvsmear[i]->getM() << endl;
+      cout << "jet " << i << ": m = " << fvsmear[i].getM() << endl;
     }  
     
     
@@ -222,9 +265,9 @@ void DijetEventILC::genEvent(){
     mc.addToFOList (*bfosmear[j]);
       
   }
-  fvsmear[0] = new FourVector (*fvsmear[1]+*fvsmear[2]);
+  fvsmear[0] = fvsmear[1]+fvsmear[2];
   if (debug) {
-    cout << "jet 0: m = " << fvsmear[0]->getM() << endl;
+    cout << "jet 0: m = " << fvsmear[0].getM() << endl;
   }  
     
 }
@@ -253,14 +296,14 @@ int DijetEventILC::fitEvent (BaseFitter& fitter){
       cout << bfosmear[i]->getName() << ": " << *bfosmear[i] << endl;
     }
     cout << "Total: \n";
-    cout << "gen:   " << *fv[0] << ", m=" << fv[0]->getM() << endl;
-    cout << "smear: " << *fvsmear[0] << ", m=" << fvsmear[0]->getM() << endl;
+    cout << "gen:   " << fv[0] << ", m=" << fv[0].getM() << endl;
+    cout << "smear: " << fvsmear[0] << ", m=" << fvsmear[0].getM() << endl;
     cout << "Jet1: \n";
-    cout << "gen:   " << *fv[1] << ", m=" << fv[1]->getM() << endl;
-    cout << "smear: " << *fvsmear[1] << ", m=" << fvsmear[1]->getM() << endl;
+    cout << "gen:   " << fv[1] << ", m=" << fv[1].getM() << endl;
+    cout << "smear: " << fvsmear[1] << ", m=" << fvsmear[1].getM() << endl;
     cout << "Jet2: \n";
-    cout << "gen:   " << *fv[2] << ", m=" << fv[2]->getM() << endl;
-    cout << "smear: " << *fvsmear[2] << ", m=" << fvsmear[2]->getM() << endl;
+    cout << "gen:   " << fv[2] << ", m=" << fv[2].getM() << endl;
+    cout << "smear: " << fvsmear[2] << ", m=" << fvsmear[2].getM() << endl;
   }
   
    
@@ -294,10 +337,10 @@ int DijetEventILC::fitEvent (BaseFitter& fitter){
 
   for (int j = 0; j < 2; ++j) {
     int i = j+1;
-    fvfinal[i] = new FourVector (bfosmear[j]->getE(), bfosmear[j]->getPx(), bfosmear[j]->getPy(), bfosmear[j]->getPz());
+    fvfinal[i].setValues (bfosmear[j]->getE(), bfosmear[j]->getPx(), bfosmear[j]->getPy(), bfosmear[j]->getPz());
   }
   
-  fvfinal[0] = new FourVector (*fvfinal[1]+*fvfinal[2]);
+  fvfinal[0] = fvfinal[1]+fvfinal[2];
   
   if (debug) {
     cout << "===============After Fiting ===================================\n";
@@ -318,14 +361,14 @@ int DijetEventILC::fitEvent (BaseFitter& fitter){
       }       
     }
     cout << "Total: \n";
-    cout << "gen:   " << *fv[0] << ", m=" << fv[0]->getM() << endl;
-    cout << "final: " << *fvfinal[0] << ", m=" << fvfinal[0]->getM() << endl;
+    cout << "gen:   " << fv[0] << ", m=" << fv[0].getM() << endl;
+    cout << "final: " << fvfinal[0] << ", m=" << fvfinal[0].getM() << endl;
     cout << "Jet1: \n";
-    cout << "gen:   " << *fv[1] << ", m=" << fv[1]->getM() << endl;
-    cout << "final: " << *fvfinal[1] << ", m=" << fvfinal[1]->getM() << endl;
+    cout << "gen:   " << fv[1] << ", m=" << fv[1].getM() << endl;
+    cout << "final: " << fvfinal[1] << ", m=" << fvfinal[1].getM() << endl;
     cout << "Jet2: \n";
-    cout << "gen:   " << *fv[2] << ", m=" << fv[2]->getM() << endl;
-    cout << "final: " << *fvfinal[2] << ", m=" << fvfinal[2]->getM() << endl;
+    cout << "gen:   " << fv[2] << ", m=" << fv[2].getM() << endl;
+    cout << "final: " << fvfinal[2] << ", m=" << fvfinal[2].getM() << endl;
     cout << "================================================\n";
   }
   
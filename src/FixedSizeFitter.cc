@@ -0,0 +1,19 @@
+/*! \file
+ *  \brief Explicit instantiations of class template FixedSizeFitter
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#undef NDEBUG
+
+#include "FixedSizeFitter.h"
+
+// The standard topologies, compiled into the library:
+// WW -> 4 jets with 5 constraints
+template class FixedSizeFitter<12, 5>;
+// ttbar -> 6 jets (or 4 jets, lepton and neutrino) with 7 constraints
+template class FixedSizeFitter<18, 7>;
+// ttbar -> 6 jets with 4 constraints and soft mass constraints
+template class FixedSizeFitter<18, 4>;
@@ -0,0 +1,83 @@
+/*! \file
+ *  \brief Implements FourVector::decayto, which needs the ROOT random number generator
+ *
+ * This file is part of the ROOT adapter library,
+ * so that the core library does not depend on ROOT.
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version, moved here from FourVector.cc
+ * - 16.10.2026 decayto with a given random number generator
+ *
+ */
+#ifdef MARLIN_USE_ROOT
+
+#include "FourVector.h"
+
+#include <cmath>
+
+#undef NDEBUG
+#include <cassert>
+
+#include <TRandom3.h>
+
+static TRandom *rnd = 0;
+
+void FourVector::setSeed (unsigned int seed) {
+  if (rnd == 0) rnd = new TRandom3 (seed);
+  else rnd->SetSeed (seed);
+}
+
+void FourVector::decayto (FourVector& d1, FourVector& d2) const {
+  if (rnd == 0) rnd = new TRandom3();
+  decayto (d1, d2, *rnd);
+}
+
+void FourVector::decayto (FourVector& d1, FourVector& d2, TRandom& random) const {
+  // Let this particle decay isotropically into 4-vectors d1 and d2;
+  // d1 and d2 must have definite mass at beginning
+  using std::abs;
+  using std::sqrt; 
+  using std::pow;
+
+  double M2 = getM2();
+  double M  = getM();;
+  double m1 = d1.getM();
+  double m2 = d2.getM();
+  
+  double randoms[2];
+//  FInteger ilen = 2;
+//  ranmar_ (randoms, &ilen);
+//  ranmar (randoms, 2);
+  random.RndmArray (2, randoms);
+  
+  
+  assert (m1+m2<=M);
+  
+  double pstar = 0.5*sqrt (abs((M2-pow(m1+m2,2))*(M2-pow(m1-m2,2))))/M;
+  double phistar = 2*M_PI*randoms[0];
+  double costhetastar = 2*randoms[1]-1;
+  double sinthetastar = sqrt(abs (1-costhetastar*costhetastar));
+  double E1 = sqrt(m1*m1+pstar*pstar);
+  double E2 = sqrt(m2*m2+pstar*pstar);
+  
+//  cout << "pstar=" << pstar << ", E1=" << E1 << ", E2=" << E2 << endl;
+  
+  
+          
+  d1 = FourVector (E1, pstar*sinthetastar*cos(phistar), 
+                       pstar*sinthetastar*sin(phistar),  
+                       pstar*costhetastar);
+  d2 = FourVector (E2, -pstar*sinthetastar*cos(phistar),  
+                       -pstar*sinthetastar*sin(phistar),  
+                       -pstar*costhetastar);
+                       
+//   cout << "d1 = " << d1 << "\nd2 = " << d2 << "\nsum= " << d1+d2 << ", mass: " << (d1+d2).getM() << endl;
+  d1.boost (*this);
+  d2.boost (*this);
+  
+//   std::cout << "Decay of " << mother 
+//             << "\nto  " << d1 
+//             << "\nand " << d2 
+//             << "\n:   " << mother-(d1+d2) << endl;
+}
+#endif // MARLIN_USE_ROOT
@@ -70,7 +70,7 @@ static const double pi_ = M_PI, // 3.14159265358979323846264338328,
 // constructor
 ISRPhotonFitObject::ISRPhotonFitObject(double px, double py, double ppz,
                                          double b_, double PzMaxB_, double PzMinB_) 
-  : cachevalid(false),    
+  : ParticleFitObject (paramstorage), cachevalid(false),    
     pt2(0), p2(0), p(0), pz(0),
     dpx0(0), dpy0(0), dpz0(0), dE0(0), dpx1(0), dpy1(0), dpz1(0), dE1(0),
     dpx2(0), dpy2(0), dpz2(0), dE2(0), d2pz22(0), d2E22(0),
@@ -117,7 +117,7 @@ ISRPhotonFitObject::~ISRPhotonFitObject() {}
 
 
 ISRPhotonFitObject::ISRPhotonFitObject (const ISRPhotonFitObject& rhs)
-  : cachevalid(false),    
+  : ParticleFitObject (paramstorage), cachevalid(false),    
     pt2(0), p2(0), p(0), pz(0),
     dpx0(0), dpy0(0), dpz0(0), dE0(0), dpx1(0), dpy1(0), dpz1(0), dE1(0),
     dpx2(0), dpy2(0), dpz2(0), dE2(0), d2pz22(0), d2E22(0),
@@ -176,7 +176,7 @@ bool ISRPhotonFitObject::updateParams (double pp[], int idim) {
 
 double ISRPhotonFitObject::getDPx(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
     case 0: return dpx0;
     case 1: return dpx1;
@@ -187,7 +187,7 @@ double ISRPhotonFitObject::getDPx(int ilocal) const {
 
 double ISRPhotonFitObject::getDPy(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
     case 0: return dpy0;
     case 1: return dpy1;
@@ -198,7 +198,7 @@ double ISRPhotonFitObject::getDPy(int ilocal) const {
 
 double ISRPhotonFitObject::getDPz(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
     case 0: return dpz0;
     case 1: return dpz1;
@@ -209,7 +209,7 @@ double ISRPhotonFitObject::getDPz(int ilocal) const {
 
 double ISRPhotonFitObject::getDE(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
     case 0: return dE0;
     case 1: return dE1;
@@ -242,7 +242,7 @@ double ISRPhotonFitObject::getFirstDerivative_Meta_Local( int iMeta, int ilocal
 
 double ISRPhotonFitObject::getSecondDerivative_Meta_Local( int iMeta, int ilocal , int jlocal, int metaSet ) const {
   assert ( metaSet==0 );
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
 
   if ( jlocal<ilocal ) {
     int temp=jlocal;
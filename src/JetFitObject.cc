@@ -3,6 +3,8 @@
  *
  * \b Changelog:
  * - 26.09.2008 mbeckman: Minor bug fixes, dodged possible division by zero
+ * - 16.10.2026 Added setValues, used by the constructor
+ * - 16.10.2026 Cache calculation and derivatives in static functions, shared with JetFitObjectBlock
  *
  * \b CVS Log messages:
  * - $Log: JetFitObject.cc,v $
@@ -79,13 +81,22 @@ using std::endl;
 JetFitObject::JetFitObject(double E, double theta, double phi,  
                            double DE, double Dtheta, double Dphi, 
                            double m)
-  : ctheta(0), stheta(0), cphi(0), sphi(0),
-    p2(0), p(0), pt(0), px(0), py(0), pz(0), dpdE(0), dptdE(0), 
-    dpxdE(0), dpydE(0), dpzdE(0), dpxdtheta(0), dpydtheta(0), chi2(0)
+  : ParticleFitObject (paramstorage), chi2(0)
 {
+  for (int k = 0; k < NCACHE; ++k) cache[k] = 0;
 
   assert( int(NPAR) <= int(BaseDefs::MAXPAR) );
 
+  setValues (E, theta, phi, DE, Dtheta, Dphi, m);
+//   std::cout << "JetFitObject::JetFitObject: E = " << E << std::endl;
+//   std::cout << "JetFitObject::JetFitObject: getParam(0) = " << getParam(0) << std::endl;
+//   std::cout << "JetFitObject::JetFitObject: " << *this << std::endl;
+//   std::cout << "mpar= " << mpar[0] << ", " << mpar[1] << ", " << mpar[2] << std::endl;
+}
+
+void JetFitObject::setValues (double E, double theta, double phi,  
+                              double DE, double Dtheta, double Dphi, 
+                              double m) {
   initCov();                         
 //  assert( !isinf(E) );        assert( !isnan(E) );
 //  assert( !isinf(theta) );    assert( !isnan(theta) );
@@ -110,20 +121,15 @@ JetFitObject::JetFitObject(double E, double theta, double phi,
   paramCycl[2]=2.*M_PI;
 
   invalidateCache();
-//   std::cout << "JetFitObject::JetFitObject: E = " << E << std::endl;
-//   std::cout << "JetFitObject::JetFitObject: getParam(0) = " << getParam(0) << std::endl;
-//   std::cout << "JetFitObject::JetFitObject: " << *this << std::endl;
-//   std::cout << "mpar= " << mpar[0] << ", " << mpar[1] << ", " << mpar[2] << std::endl;
 }
 
 // destructor
 JetFitObject::~JetFitObject() {}
 
 JetFitObject::JetFitObject (const JetFitObject& rhs)
-  : ctheta(0), stheta(0), cphi(0), sphi(0),
-    p2(0), p(0), pt(0), px(0), py(0), pz(0), dpdE(0), dptdE(0), 
-    dpxdE(0), dpydE(0), dpzdE(0), dpxdtheta(0), dpydtheta(0), chi2(0)
+  : ParticleFitObject (paramstorage), chi2(0)
 {
+  for (int k = 0; k < NCACHE; ++k) cache[k] = 0;
   //std::cout << "copying JetFitObject with name " << rhs.name << std::endl;
   JetFitObject::assign (rhs);
 }
@@ -201,32 +207,44 @@ bool JetFitObject::updateParams (double pp[], int idim) {
 
 double JetFitObject::getDPx(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
+  return getDPx (cache, 1, ilocal);
+}
+
+double JetFitObject::getDPy(int ilocal) const {
+  assert (ilocal >= 0 && ilocal < NPAR);
+  if (!cachevalid) updateCacheTraced();
+  return getDPy (cache, 1, ilocal);
+}
+
+double JetFitObject::getDPz(int ilocal) const {
+  assert (ilocal >= 0 && ilocal < NPAR);
+  if (!cachevalid) updateCacheTraced();
+  return getDPz (cache, 1, ilocal);
+}
+
+double JetFitObject::getDPx (const double *c, int stride, int ilocal) {
   switch (ilocal) {
-    case 0: return dpxdE;
-    case 1: return dpxdtheta;
-    case 2: return -py;
+    case 0: return c[DPXDE*stride];
+    case 1: return c[DPXDTHETA*stride];
+    case 2: return -c[PY*stride];
   }
   return 0; 
 }
 
-double JetFitObject::getDPy(int ilocal) const {
-  assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+double JetFitObject::getDPy (const double *c, int stride, int ilocal) {
   switch (ilocal) {
-    case 0: return dpydE;
-    case 1: return dpydtheta;
-    case 2: return px;
+    case 0: return c[DPYDE*stride];
+    case 1: return c[DPYDTHETA*stride];
+    case 2: return c[PX*stride];
   }
   return 0; 
 }
 
-double JetFitObject::getDPz(int ilocal) const {
-  assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+double JetFitObject::getDPz (const double *c, int stride, int ilocal) {
   switch (ilocal) {
-    case 0: return dpzdE;
-    case 1: return -pt;
+    case 0: return c[DPZDE*stride];
+    case 1: return -c[PT*stride];
     case 2: return 0;
   }
   return 0; 
@@ -264,7 +282,7 @@ double JetFitObject::getCov (int ilocal, int jlocal) const {
 //  assert (i_theta >= 0 && i_theta < idim);
 //  assert (i_phi   >= 0 && i_phi   < idim);
 //  
-//  if (!cachevalid) updateCache();
+//  if (!cachevalid) updateCacheTraced();
 //  // for numerical accuracy, add up derivatives first,
 //  // then add them to global vector
 //  double der_E = efact;
@@ -304,7 +322,17 @@ double JetFitObject::getFirstDerivative_Meta_Local( int iMeta, int ilocal , int
 
 double JetFitObject::getSecondDerivative_Meta_Local( int iMeta, int ilocal , int jlocal , int metaSet ) const {
   assert ( metaSet==0 );
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
+  return getSecondDerivative_Meta_Local (cache, 1, mass, iMeta, ilocal, jlocal);
+}
+
+double JetFitObject::getSecondDerivative_Meta_Local (const double *c, int stride, double m, 
+                                                     int iMeta, int ilocal, int jlocal) {
+  const double p      = c[P*stride];
+  const double ctheta = c[CTHETA*stride];
+  const double stheta = c[STHETA*stride];
+  const double cphi   = c[CPHI*stride];
+  const double sphi   = c[SPHI*stride];
 
   if ( jlocal<ilocal ) {
     int temp=jlocal;
@@ -312,7 +340,7 @@ double JetFitObject::getSecondDerivative_Meta_Local( int iMeta, int ilocal , int
     ilocal=temp;
   }
 
-  double d2pdE2 = (mass != 0) ? -mass*mass/(p*p*p) : 0;
+  double d2pdE2 = (m != 0) ? -m*m/(p*p*p) : 0;
   double d2ptdE2 = d2pdE2*stheta;
   
   // daniel hasn't checked these, copied from orig code
@@ -323,26 +351,26 @@ double JetFitObject::getSecondDerivative_Meta_Local( int iMeta, int ilocal , int
     break;
   case 1:
     if      ( ilocal==0 && jlocal==0 ) return  d2ptdE2*cphi;
-    else if ( ilocal==0 && jlocal==1 ) return  dpzdE*cphi;
-    else if ( ilocal==0 && jlocal==2 ) return -dpydE;
-    else if ( ilocal==1 && jlocal==1 ) return -px;
-    else if ( ilocal==1 && jlocal==2 ) return -dpydtheta;
-    else if ( ilocal==2 && jlocal==2 ) return -px;
+    else if ( ilocal==0 && jlocal==1 ) return  c[DPZDE*stride]*cphi;
+    else if ( ilocal==0 && jlocal==2 ) return -c[DPYDE*stride];
+    else if ( ilocal==1 && jlocal==1 ) return -c[PX*stride];
+    else if ( ilocal==1 && jlocal==2 ) return -c[DPYDTHETA*stride];
+    else if ( ilocal==2 && jlocal==2 ) return -c[PX*stride];
     break;
   case 2:
     if      ( ilocal==0 && jlocal==0 ) return  d2ptdE2*sphi;
-    else if ( ilocal==0 && jlocal==1 ) return  dpzdE*sphi;
-    else if ( ilocal==0 && jlocal==2 ) return  dpxdE;
-    else if ( ilocal==1 && jlocal==1 ) return -py;
-    else if ( ilocal==1 && jlocal==2 ) return  dpxdtheta;
-    else if ( ilocal==2 && jlocal==2 ) return -py;
+    else if ( ilocal==0 && jlocal==1 ) return  c[DPZDE*stride]*sphi;
+    else if ( ilocal==0 && jlocal==2 ) return  c[DPXDE*stride];
+    else if ( ilocal==1 && jlocal==1 ) return -c[PY*stride];
+    else if ( ilocal==1 && jlocal==2 ) return  c[DPXDTHETA*stride];
+    else if ( ilocal==2 && jlocal==2 ) return -c[PY*stride];
     break;
   case 3:
     if      ( ilocal==0 && jlocal==0 ) return d2pdE2*ctheta;
     //    else if ( ilocal==0 && jlocal==1 ) return dptdE;
-    else if ( ilocal==0 && jlocal==1 ) return -dptdE; // this is "-" in the orig JetFitObject, DJ fixed 2015may27
+    else if ( ilocal==0 && jlocal==1 ) return -c[DPTDE*stride]; // this is "-" in the orig JetFitObject, DJ fixed 2015may27
     else if ( ilocal==0 && jlocal==2 ) return 0;
-    else if ( ilocal==1 && jlocal==1 ) return -pz;
+    else if ( ilocal==1 && jlocal==1 ) return -c[PZ*stride];
     else if ( ilocal==1 && jlocal==2 ) return 0;
     else if ( ilocal==2 && jlocal==2 ) return 0;
     break;
@@ -356,42 +384,56 @@ double JetFitObject::getSecondDerivative_Meta_Local( int iMeta, int ilocal , int
 
 void JetFitObject::updateCache() const {
 
-  double e     = par[0];
-  double theta = par[1];
-  double phi   = par[2];
+  calculateCache (par[0], par[1], par[2], mass, cache, 1);
+  fourMomentum.setValues(par[0], cache[PX], cache[PY], cache[PZ]);
+  
+  cachevalid = true;
+
+}
 
-  ctheta = cos(theta);
-  stheta = sin(theta);
-  cphi   = cos(phi);
-  sphi   = sin(phi);
+void JetFitObject::calculateCache (double e, double theta, double phi, double m, 
+                                   double *c, int stride) {
 
-  p2 = std::abs(e*e-mass*mass);
-  p = std::sqrt(p2);
+  double ctheta = cos(theta);
+  double stheta = sin(theta);
+  double cphi   = cos(phi);
+  double sphi   = sin(phi);
+
+  double p2 = std::abs(e*e-m*m);
+  double p = std::sqrt(p2);
   assert (p != 0);
 
-  pt = p*stheta;
+  double pt = p*stheta;
 
-  px = pt*cphi;
-  py = pt*sphi;
-  pz = p*ctheta;
+  double px = pt*cphi;
+  double py = pt*sphi;
+  double pz = p*ctheta;
 
-  fourMomentum.setValues(e, px, py, pz);
-  
-  dpdE = e/p;
-  dptdE = dpdE*stheta;
-  dpxdE = dptdE*cphi;
-  dpydE = dptdE*sphi;
-  dpzdE = dpdE*ctheta;
+  double dpdE = e/p;
+  double dptdE = dpdE*stheta;
   
-  dpxdtheta = pz*cphi;
-  dpydtheta = pz*sphi;
-  
-  cachevalid = true;
+  c[CTHETA*stride]    = ctheta;
+  c[STHETA*stride]    = stheta;
+  c[CPHI*stride]      = cphi;
+  c[SPHI*stride]      = sphi;
+  c[P2*stride]        = p2;
+  c[P*stride]         = p;
+  c[PT*stride]        = pt;
+  c[PX*stride]        = px;
+  c[PY*stride]        = py;
+  c[PZ*stride]        = pz;
+  c[DPDE*stride]      = dpdE;
+  c[DPTDE*stride]     = dptdE;
+  c[DPXDE*stride]     = dptdE*cphi;
+  c[DPYDE*stride]     = dptdE*sphi;
+  c[DPZDE*stride]     = dpdE*ctheta;
+  c[DPXDTHETA*stride] = pz*cphi;
+  c[DPYDTHETA*stride] = pz*sphi;
 
 }
 
 //double JetFitObject::getChi2 () const {
-//  if (!cachevalid) updateCache();
+//  if (!cachevalid) updateCacheTraced();
 //  return chi2;
 //}
 //
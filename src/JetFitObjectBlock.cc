@@ -0,0 +1,428 @@
+/*! \file
+ *  \brief Implements class JetFitObjectBlock
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ * - 16.10.2026 Parameters and caches stored in chunks of the block
+ *
+ */
+
+#include "JetFitObjectBlock.h"
+
+#include <cmath>
+#include <algorithm>
+
+#undef NDEBUG
+#include <cassert>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define JETFITOBJECTBLOCK_AVX
+#include <immintrin.h>
+#endif
+
+// A jet of the block, with the parametrisation of JetFitObject: a view of its
+// parameters and cached quantities in a chunk, at position lane
+class JetFitObjectBlock::Jet: public ParticleFitObject {
+  public:
+    enum {NPAR=3};
+    typedef ParamStorage<NPAR> Storage;
+
+    Jet (const JetFitObjectBlock& block_, Chunk& chunk_, int lane_,
+         double E, double theta, double phi,
+         double DE, double Dtheta, double Dphi,
+         double m);
+    virtual ~Jet() {}
+
+    /// Return a new JetFitObject with the values of this jet
+    virtual JetFitObject *copy() const;
+    /// Assign from a JetFitObject or a jet of a block
+    virtual Jet& assign (const BaseFitObject& source);
+
+    virtual const char *getParamName (int ilocal) const;
+    virtual bool updateParams (double p[], int idim);
+    virtual int getNPar() const {return NPAR;}
+
+    /// Set the mass, also in the chunk
+    virtual bool setMass (double mass_);
+
+    virtual FourVector getFourMomentum() const;
+    virtual double getE() const;
+    virtual double getPx() const;
+    virtual double getPy() const;
+    virtual double getPz() const;
+
+    virtual double getDPx (int ilocal) const;
+    virtual double getDPy (int ilocal) const;
+    virtual double getDPz (int ilocal) const;
+    virtual double getDE (int ilocal) const;
+
+    virtual double getFirstDerivative_Meta_Local (int iMeta, int ilocal, int metaSet) const;
+    virtual double getSecondDerivative_Meta_Local (int iMeta, int ilocal, int jlocal, int metaSet) const;
+
+    /// Invalidates also the caches of the block
+    virtual void invalidateCache() const;
+    /// Calculates the caches of all jets of the block, if they are invalid
+    virtual void updateCache() const;
+
+  private:
+    /// The cached quantities of this jet, quantity k at k*NLANES
+    const double *getCache() const;
+
+    const JetFitObjectBlock& block;   ///< The block that owns this jet
+    Chunk& chunk;                     ///< The chunk with its parameters and cached quantities
+    int lane;                         ///< The position in the chunk
+};
+
+// The parameters, masses and cached quantities of NLANES jets;
+// cache[NLANES*k + lane] is quantity k (JetFitObject::CTHETA ... DPYDTHETA) of jet lane.
+// Lanes without a jet hold a jet with E = 1, which has p != 0.
+struct JetFitObjectBlock::Chunk {
+  Chunk() {
+    for (int lane = 0; lane < NLANES; ++lane) {
+      storage[lane].dvalues[0] = 1;
+      storage[lane].dvalues[1] = 0;
+      storage[lane].dvalues[2] = 0;
+      mass[lane] = 0;
+    }
+    for (int k = 0; k < JetFitObject::NCACHE*NLANES; ++k) cache[k] = 0;
+  }
+  /// The parameters of jet lane, par[0] ... par[2] = E, theta, phi
+  const double *getParams (int lane) const {return storage[lane].dvalues;}
+
+  Jet::Storage storage[NLANES];                 ///< Parameters, flags and covariance matrices
+  double mass[NLANES];                          ///< The masses
+  double cache[JetFitObject::NCACHE*NLANES];    ///< The cached quantities
+};
+
+#ifdef JETFITOBJECTBLOCK_AVX
+namespace {
+
+  // Up to this angle, the polynomial sin and cos are accurate to about 1 ulp
+  const double MAXANGLE = 1E6;
+
+  // Adding and subtracting 1.5*2^52 rounds to an integer
+  const double ROUND = 6755399441055744.0;
+
+  // pi/2 in three parts, the first two exact in fewer than 53 bits (Cephes)
+  const double PIO2_1 = 1.57079625129699707031E0;
+  const double PIO2_2 = 7.54978941586159635335E-8;
+  const double PIO2_3 = 5.39030285815811905290E-15;
+
+  // Coefficients of sin(z) = z + z^3*S(z^2) and cos(z) = 1 - z^2/2 + z^4*C(z^2)
+  // for |z| <= pi/4 (Cephes)
+  const double S[6] = { 1.58962301576546568060E-10, -2.50507477628578072866E-8,
+                        2.75573136213857245213E-6,  -1.98412698295895385996E-4,
+                        8.33333333332211858878E-3,  -1.66666666666666307295E-1};
+  const double C[6] = {-1.13585365213876817300E-11,  2.08757008419747316778E-9,
+                       -2.75573141792967388112E-7,   2.48015872888517045348E-5,
+                       -1.38888888888730564116E-3,   4.16666666666665929218E-2};
+
+  // sin and cos of four angles: x = y*pi/2 + z, with y = q = 0, 1, 2, 3 modulo 4,
+  // then sin(x) = s, c, -s, -c and cos(x) = c, -s, -c, s
+  __attribute__ ((target ("avx")))
+  inline void sinCosAVX (__m256d x, __m256d& sinx, __m256d& cosx) {
+    const __m256d half = _mm256_set1_pd (0.5);
+    const __m256d one = _mm256_set1_pd (1);
+    const __m256d signbit = _mm256_set1_pd (-0.0);
+    const __m256d round = _mm256_set1_pd (ROUND);
+    __m256d y = _mm256_sub_pd (_mm256_add_pd (_mm256_mul_pd (x, _mm256_set1_pd (M_2_PI)), round), round);
+    __m256d z = _mm256_sub_pd (x, _mm256_mul_pd (y, _mm256_set1_pd (PIO2_1)));
+    z = _mm256_sub_pd (z, _mm256_mul_pd (y, _mm256_set1_pd (PIO2_2)));
+    z = _mm256_sub_pd (z, _mm256_mul_pd (y, _mm256_set1_pd (PIO2_3)));
+    __m256d zz = _mm256_mul_pd (z, z);
+    __m256d ps = _mm256_set1_pd (S[0]);
+    __m256d pc = _mm256_set1_pd (C[0]);
+    for (int k = 1; k < 6; ++k) {
+      ps = _mm256_add_pd (_mm256_mul_pd (ps, zz), _mm256_set1_pd (S[k]));
+      pc = _mm256_add_pd (_mm256_mul_pd (pc, zz), _mm256_set1_pd (C[k]));
+    }
+    __m256d s = _mm256_add_pd (z, _mm256_mul_pd (_mm256_mul_pd (z, zz), ps));
+    __m256d c = _mm256_add_pd (_mm256_sub_pd (one, _mm256_mul_pd (half, zz)), _mm256_mul_pd (_mm256_mul_pd (zz, zz), pc));
+    __m256d four = _mm256_set1_pd (4);
+    __m256d q = _mm256_sub_pd (y, _mm256_mul_pd (four, _mm256_sub_pd (_mm256_add_pd (_mm256_mul_pd (_mm256_set1_pd (0.25), y), round), round)));
+    q = _mm256_add_pd (q, _mm256_and_pd (_mm256_cmp_pd (q, _mm256_setzero_pd(), _CMP_LT_OQ), four));
+    __m256d odd = _mm256_or_pd (_mm256_cmp_pd (q, one, _CMP_EQ_OQ), _mm256_cmp_pd (q, _mm256_set1_pd (3), _CMP_EQ_OQ));
+    __m256d neg = _mm256_cmp_pd (q, _mm256_set1_pd (2), _CMP_GE_OQ);
+    sinx = _mm256_xor_pd (_mm256_blendv_pd (s, c, odd), _mm256_and_pd (neg, signbit));
+    cosx = _mm256_xor_pd (_mm256_blendv_pd (c, s, odd), _mm256_and_pd (_mm256_xor_pd (odd, neg), signbit));
+  }
+
+  // The AVX version for the four jets of a chunk, with parameters par[lane] and masses mass[lane];
+  // stores quantity k of the four jets at cache + 4*k
+  __attribute__ ((target ("avx")))
+  void updateAVX (const double *const par[4], const double *mass, double *cache) {
+    const __m256d signbit = _mm256_set1_pd (-0.0);
+    __m256d stheta, ctheta, sphi, cphi;
+    sinCosAVX (_mm256_set_pd (par[3][1], par[2][1], par[1][1], par[0][1]), stheta, ctheta);
+    sinCosAVX (_mm256_set_pd (par[3][2], par[2][2], par[1][2], par[0][2]), sphi, cphi);
+    __m256d e = _mm256_set_pd (par[3][0], par[2][0], par[1][0], par[0][0]);
+    __m256d m = _mm256_loadu_pd (mass);
+    __m256d p2 = _mm256_andnot_pd (signbit, _mm256_sub_pd (_mm256_mul_pd (e, e), _mm256_mul_pd (m, m)));
+    __m256d p = _mm256_sqrt_pd (p2);
+    __m256d pt = _mm256_mul_pd (p, stheta);
+    __m256d pz = _mm256_mul_pd (p, ctheta);
+    __m256d dpdE = _mm256_div_pd (e, p);
+    __m256d dptdE = _mm256_mul_pd (dpdE, stheta);
+    _mm256_storeu_pd (cache + 4*JetFitObject::CTHETA, ctheta);
+    _mm256_storeu_pd (cache + 4*JetFitObject::STHETA, stheta);
+    _mm256_storeu_pd (cache + 4*JetFitObject::CPHI, cphi);
+    _mm256_storeu_pd (cache + 4*JetFitObject::SPHI, sphi);
+    _mm256_storeu_pd (cache + 4*JetFitObject::P2, p2);
+    _mm256_storeu_pd (cache + 4*JetFitObject::P, p);
+    _mm256_storeu_pd (cache + 4*JetFitObject::PT, pt);
+    _mm256_storeu_pd (cache + 4*JetFitObject::PX, _mm256_mul_pd (pt, cphi));
+    _mm256_storeu_pd (cache + 4*JetFitObject::PY, _mm256_mul_pd (pt, sphi));
+    _mm256_storeu_pd (cache + 4*JetFitObject::PZ, pz);
+    _mm256_storeu_pd (cache + 4*JetFitObject::DPDE, dpdE);
+    _mm256_storeu_pd (cache + 4*JetFitObject::DPTDE, dptdE);
+    _mm256_storeu_pd (cache + 4*JetFitObject::DPXDE, _mm256_mul_pd (dptdE, cphi));
+    _mm256_storeu_pd (cache + 4*JetFitObject::DPYDE, _mm256_mul_pd (dptdE, sphi));
+    _mm256_storeu_pd (cache + 4*JetFitObject::DPZDE, _mm256_mul_pd (dpdE, ctheta));
+    _mm256_storeu_pd (cache + 4*JetFitObject::DPXDTHETA, _mm256_mul_pd (pz, cphi));
+    _mm256_storeu_pd (cache + 4*JetFitObject::DPYDTHETA, _mm256_mul_pd (pz, sphi));
+    // avoid the penalty for mixing AVX and SSE code in the caller
+    _mm256_zeroupper();
+  }
+}
+#endif
+
+JetFitObjectBlock::Jet::Jet (const JetFitObjectBlock& block_, Chunk& chunk_, int lane_,
+                             double E, double theta, double phi,
+                             double DE, double Dtheta, double Dphi,
+                             double m)
+: ParticleFitObject (chunk_.storage[lane_]), block (block_), chunk (chunk_), lane (lane_)
+{
+  // as JetFitObject::setValues
+  initCov();
+  setMass (m);
+  JetFitObject::adjustEThetaPhi (m, E, theta, phi);
+  setParam (0, E, true);
+  setParam (1, theta, true);
+  setParam (2, phi, true);
+  setMParam (0, E);
+  setMParam (1, theta);
+  setMParam (2, phi);
+  setError (0, DE);
+  setError (1, Dtheta);
+  setError (2, Dphi);
+
+  // parameter 2 repeats every 2*pi
+  paramCycl[2]=2.*M_PI;
+
+  invalidateCache();
+}
+
+JetFitObject *JetFitObjectBlock::Jet::copy() const {
+  JetFitObject *result = new JetFitObject (par[0], par[1], par[2], 1, 1, 1, mass);
+  result->ParticleFitObject::assign (*this);
+  return result;
+}
+
+JetFitObjectBlock::Jet& JetFitObjectBlock::Jet::assign (const BaseFitObject& source) {
+  if (dynamic_cast<const JetFitObject *>(&source) || dynamic_cast<const Jet *>(&source)) {
+    if (&source != this) {
+      ParticleFitObject::assign (source);
+      chunk.mass[lane] = mass;
+      invalidateCache();
+    }
+  }
+  else {
+    assert (0);
+  }
+  return *this;
+}
+
+const char *JetFitObjectBlock::Jet::getParamName (int ilocal) const {
+  switch (ilocal) {
+    case 0: return "E";
+    case 1: return "theta";
+    case 2: return "phi";
+  }
+  return "undefined";
+}
+
+// as JetFitObject::updateParams
+bool JetFitObjectBlock::Jet::updateParams (double pp[], int idim) {
+  invalidateCache();
+  
+  int iE  = getGlobalParNum(0);
+  int ith = getGlobalParNum(1);
+  int iph = getGlobalParNum(2);
+  assert (iE  >= 0 && iE  < idim);
+  assert (ith >= 0 && ith < idim);
+  assert (iph >= 0 && iph < idim);
+  
+  double e  = pp[iE];
+  double th = pp[ith];
+  double ph = pp[iph];
+  
+  if (e<0) {
+    e  = -e;
+    th = M_PI-th;
+    ph = M_PI+ph;
+  }
+  
+  double massPlusEpsilon = mass*(1.0000001);
+  if (e < massPlusEpsilon) e = massPlusEpsilon;
+  
+  bool result = ((e -par[0])*(e -par[0]) > eps2*cov[0][0]) ||
+                ((th-par[1])*(th-par[1]) > eps2*cov[1][1]) ||
+                ((ph-par[2])*(ph-par[2]) > eps2*cov[2][2]);
+                
+  par[0] = e;
+  par[1] = th;
+  par[2] = ph;
+  pp[iE]  = par[0];         
+  pp[ith] = par[1];         
+  pp[iph] = par[2];         
+  return result;
+}  
+
+bool JetFitObjectBlock::Jet::setMass (double mass_) {
+  bool result = ParticleFitObject::setMass (mass_);
+  chunk.mass[lane] = mass;
+  return result;
+}
+
+const double *JetFitObjectBlock::Jet::getCache() const {
+  if (!cachevalid) updateCacheTraced();
+  return chunk.cache + lane;
+}
+
+FourVector JetFitObjectBlock::Jet::getFourMomentum() const {
+  const double *c = getCache();
+  return FourVector (par[0], c[JetFitObject::PX*NLANES], c[JetFitObject::PY*NLANES], c[JetFitObject::PZ*NLANES]);
+}
+
+double JetFitObjectBlock::Jet::getE() const {
+  return par[0];
+}
+
+double JetFitObjectBlock::Jet::getPx() const {
+  return getCache()[JetFitObject::PX*NLANES];
+}
+
+double JetFitObjectBlock::Jet::getPy() const {
+  return getCache()[JetFitObject::PY*NLANES];
+}
+
+double JetFitObjectBlock::Jet::getPz() const {
+  return getCache()[JetFitObject::PZ*NLANES];
+}
+
+double JetFitObjectBlock::Jet::getDPx (int ilocal) const {
+  assert (ilocal >= 0 && ilocal < NPAR);
+  return JetFitObject::getDPx (getCache(), NLANES, ilocal);
+}
+
+double JetFitObjectBlock::Jet::getDPy (int ilocal) const {
+  assert (ilocal >= 0 && ilocal < NPAR);
+  return JetFitObject::getDPy (getCache(), NLANES, ilocal);
+}
+
+double JetFitObjectBlock::Jet::getDPz (int ilocal) const {
+  assert (ilocal >= 0 && ilocal < NPAR);
+  return JetFitObject::getDPz (getCache(), NLANES, ilocal);
+}
+
+double JetFitObjectBlock::Jet::getDE (int ilocal) const {
+  assert (ilocal >= 0 && ilocal < NPAR);
+  return (ilocal == 0) ? 1 : 0;
+}
+
+double JetFitObjectBlock::Jet::getFirstDerivative_Meta_Local (int iMeta, int ilocal, int metaSet) const {
+  assert (metaSet == 0);
+  switch (iMeta) {
+    case 0: return getDE (ilocal);
+    case 1: return getDPx (ilocal);
+    case 2: return getDPy (ilocal);
+    case 3: return getDPz (ilocal);
+    default: assert (0);
+  }
+  return -999;
+}
+
+double JetFitObjectBlock::Jet::getSecondDerivative_Meta_Local (int iMeta, int ilocal, int jlocal, int metaSet) const {
+  assert (metaSet == 0);
+  return JetFitObject::getSecondDerivative_Meta_Local (getCache(), NLANES, mass, iMeta, ilocal, jlocal);
+}
+
+void JetFitObjectBlock::Jet::invalidateCache() const {
+  cachevalid = false;
+  block.cachevalid = false;
+}
+
+void JetFitObjectBlock::Jet::updateCache() const {
+  if (!block.cachevalid) block.updateCache();
+  cachevalid = true;
+}
+
+ChainRuleKernels::Kernel JetFitObjectBlock::kernel =
+  ChainRuleKernels::isAvailable (ChainRuleKernels::AVX) ? ChainRuleKernels::AVX : ChainRuleKernels::SCALAR;
+
+JetFitObjectBlock::JetFitObjectBlock()
+: jets (std::vector <Jet *> ()), chunks (std::vector <Chunk *> ()), cachevalid (false)
+{}
+
+JetFitObjectBlock::~JetFitObjectBlock() {
+  for (unsigned int i = 0; i < jets.size(); ++i) delete jets[i];
+  for (unsigned int i = 0; i < chunks.size(); ++i) delete chunks[i];
+}
+
+ParticleFitObject *JetFitObjectBlock::addJet (double E, double theta, double phi,
+                                              double DE, double Dtheta, double Dphi,
+                                              double m) {
+  int lane = jets.size() % NLANES;
+  if (lane == 0) chunks.push_back (new Chunk);
+  jets.push_back (new Jet (*this, *chunks.back(), lane, E, theta, phi, DE, Dtheta, Dphi, m));
+  cachevalid = false;
+  return jets.back();
+}
+
+ParticleFitObject *JetFitObjectBlock::getJet (int i) const {
+  assert (i >= 0 && i < getNJets());
+  return jets[i];
+}
+
+void JetFitObjectBlock::updateCache() const {
+  for (unsigned int ic = 0; ic < chunks.size(); ++ic) {
+    Chunk& chunk = *chunks[ic];
+    // the number of jets in this chunk
+    int n = std::min (int (NLANES), int (jets.size() - NLANES*ic));
+#ifdef JETFITOBJECTBLOCK_AVX
+    if (kernel == ChainRuleKernels::AVX) {
+      const double *par[NLANES];
+      for (int lane = 0; lane < NLANES; ++lane) par[lane] = chunk.getParams (lane);
+      updateAVX (par, chunk.mass, chunk.cache);
+      for (int lane = 0; lane < n; ++lane) {
+        // large angles (and NaN) with the sin and cos of the standard library
+        if (!(std::abs (par[lane][1]) <= MAXANGLE && std::abs (par[lane][2]) <= MAXANGLE)) {
+          JetFitObject::calculateCache (par[lane][0], par[lane][1], par[lane][2], chunk.mass[lane],
+                                        chunk.cache + lane, NLANES);
+        }
+        assert (chunk.cache[JetFitObject::P*NLANES + lane] != 0);
+      }
+      continue;
+    }
+#endif
+    // the portable version: the calculation of JetFitObject, for one jet after the other
+    for (int lane = 0; lane < n; ++lane) {
+      const double *par = chunk.getParams (lane);
+      JetFitObject::calculateCache (par[0], par[1], par[2], chunk.mass[lane], chunk.cache + lane, NLANES);
+    }
+  }
+  cachevalid = true;
+}
+
+bool JetFitObjectBlock::setKernel (ChainRuleKernels::Kernel kernel_) {
+  if (kernel_ == ChainRuleKernels::AUTO) {
+    kernel_ = ChainRuleKernels::isAvailable (ChainRuleKernels::AVX) ? ChainRuleKernels::AVX : ChainRuleKernels::SCALAR;
+  }
+  if (!ChainRuleKernels::isAvailable (kernel_)) return false;
+  kernel = kernel_;
+  return true;
+}
+
+ChainRuleKernels::Kernel JetFitObjectBlock::getKernel() {
+  return kernel;
+}
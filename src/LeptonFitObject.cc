@@ -7,8 +7,6 @@
  */ 
 
 #include "LeptonFitObject.h"
-#include "EVENT/Track.h"
-#include "lcio.h"
 #include <cmath>
 
 #undef NDEBUG
@@ -22,13 +20,11 @@ using std::cos;
 using std::cout; 
 using std::endl;
 
-using namespace lcio;
-
 // constructor
 LeptonFitObject::LeptonFitObject(double ptinv, double theta, double phi,  
                            double Dptinv, double Dtheta, double Dphi, 
                            double m) 
-  : ctheta(0), stheta(0), stheta2(0), cphi(0), sphi(0), cottheta(0),
+  : ParticleFitObject (paramstorage), ctheta(0), stheta(0), stheta2(0), cphi(0), sphi(0), cottheta(0),
     p2(0), p(0), e(0), e2(0), pt(0), pt2(0), pt3(0), px(0), py(0), pz(0), dpdptinv(0), dpdtheta(0), dptdptinv(0),
     dpxdptinv(0), dpydptinv(0), dpzdptinv(0), dpxdtheta(0), dpydtheta(0), dpzdtheta(0), dpxdphi(0), dpydphi(0), dpzdphi(0),
     chi2(0), dEdptinv(0), dEdtheta(0), dEdp(0), qsign(0), ptinv2(0)
@@ -36,6 +32,12 @@ LeptonFitObject::LeptonFitObject(double ptinv, double theta, double phi,
 
   assert( int(NPAR) <= int(BaseDefs::MAXPAR) );
 
+  setValues (ptinv, theta, phi, Dptinv, Dtheta, Dphi, m);
+}
+
+void LeptonFitObject::setValues (double ptinv, double theta, double phi,  
+                                 double Dptinv, double Dtheta, double Dphi, 
+                                 double m) {
   initCov();                         
   setMass (m);
   adjustPtinvThetaPhi (m, ptinv, theta, phi);
@@ -60,7 +62,7 @@ LeptonFitObject::LeptonFitObject(double ptinv, double theta, double phi,
 				 double Dptinv, double Dtheta, double Dphi,
 				 double Rhoptinvtheta, double Rhoptinvphi, double Rhothetaphi, 
 				 double m)  
-  : ctheta(0), stheta(0), stheta2(0), cphi(0), sphi(0), cottheta(0),
+  : ParticleFitObject (paramstorage), ctheta(0), stheta(0), stheta2(0), cphi(0), sphi(0), cottheta(0),
     p2(0), p(0), e(0), e2(0), pt(0), pt2(0), pt3(0), px(0), py(0), pz(0), dpdptinv(0), dpdtheta(0), dptdptinv(0),
     dpxdptinv(0), dpydptinv(0), dpzdptinv(0), dpxdtheta(0), dpydtheta(0), dpzdtheta(0), dpxdphi(0), dpydphi(0), dpzdphi(0),
     chi2(0), dEdptinv(0), dEdtheta(0), dEdp(0), qsign(0), ptinv2(0)
@@ -68,138 +70,17 @@ LeptonFitObject::LeptonFitObject(double ptinv, double theta, double phi,
 
   assert( int(NPAR) <= int(BaseDefs::MAXPAR) );
 
-  initCov();                         
-  setMass (m);
-  adjustPtinvThetaPhi (m, ptinv, theta, phi);
-  setParam (0, ptinv, true);
-  setParam (1, theta, true);
-  setParam (2, phi, true);
-  setMParam (0, ptinv);
-  setMParam (1, theta);
-  setMParam (2, phi);
-  setError (0, Dptinv);
-  setError (1, Dtheta);
-  setError (2, Dphi);
+  setValues (ptinv, theta, phi, Dptinv, Dtheta, Dphi, m);
   setCov (0, 1, Rhoptinvtheta*Dptinv*Dtheta);
   setCov (0, 2, Rhoptinvphi*Dptinv*Dphi);
   setCov (1, 2, Rhothetaphi*Dtheta*Dphi);
-
-  // parameter 2 repeats every 2*pi
-  paramCycl[2]=2.*M_PI;
-
-  invalidateCache();
 }
 
-// constructor based on Track
-LeptonFitObject::LeptonFitObject(Track* track, double Bfield, double m) 
-  : ctheta(0), stheta(0), stheta2(0), cphi(0), sphi(0), cottheta(0),
-    p2(0), p(0), e(0), e2(0), pt(0), pt2(0), pt3(0), px(0), py(0), pz(0), dpdptinv(0), dpdtheta(0), dptdptinv(0),
-    dpxdptinv(0), dpydptinv(0), dpzdptinv(0), dpxdtheta(0), dpydtheta(0), dpzdtheta(0), dpxdphi(0), dpydphi(0), dpzdphi(0),
-    chi2(0), dEdptinv(0), dEdtheta(0), dEdp(0), qsign(0), ptinv2(0)
-{
-
-  assert( int(NPAR) <= int(BaseDefs::MAXPAR) );
-
-  const double c = 2.99792458e8; // m*s^-1
-//  const double Bfield = 3.5;          // Tesla       should not be hard-coded here
-  const double mm2m = 1e-3;
-  const double eV2GeV = 1e-9;
-  const double eB = Bfield*c*mm2m*eV2GeV;
-
-  double omega = track->getOmega();
-  double ptinv = omega/eB;                   // signed q/pT in GeV^-1
-  double tanl = track->getTanLambda();
-  double theta = std::atan(1.0/tanl);  
-  if (theta<0.0) theta += M_PI;
-  double phi = track->getPhi();
-
-  double d3 = 1.0/eB;                        // d(ptinv)/dOmega
-  double d5 = -(1.0/(1.0+tanl*tanl));        // d(theta)/d(tanl)  
-
-  FloatVec covT(15, 0.0);
-  covT = track->getCovMatrix();
-
-  initCov();                         
-  setMass (m);
-  adjustPtinvThetaPhi (m, ptinv, theta, phi);
-  setParam (0, ptinv, true);
-  setParam (1, theta, true);
-  setParam (2, phi, true);
-  setMParam (0, ptinv);
-  setMParam (1, theta);
-  setMParam (2, phi);
-
-  setError (0, d3*std::sqrt(covT[5]) );
-  setError (1, d5*std::sqrt(covT[14]) );
-  setError (2, std::sqrt(covT[2]) );
-  setCov (0, 1, d3*d5*covT[12] );            
-  setCov (0, 2, d3*covT[4] );
-  setCov (1, 2, d5*covT[11] );
-
-  // parameter 2 repeats every 2*pi
-  paramCycl[2]=2.*M_PI;
-
-  invalidateCache();
-}
-
-// constructor based on TrackState
-LeptonFitObject::LeptonFitObject(const TrackState* trackstate, double Bfield, double m) 
-  : ctheta(0), stheta(0), stheta2(0), cphi(0), sphi(0), cottheta(0),
-    p2(0), p(0), e(0), e2(0), pt(0), pt2(0), pt3(0), px(0), py(0), pz(0), dpdptinv(0), dpdtheta(0), dptdptinv(0),
-    dpxdptinv(0), dpydptinv(0), dpzdptinv(0), dpxdtheta(0), dpydtheta(0), dpzdtheta(0), dpxdphi(0), dpydphi(0), dpzdphi(0),
-    chi2(0), dEdptinv(0), dEdtheta(0), dEdp(0), qsign(0), ptinv2(0)
-{
-
-  assert( int(NPAR) <= int(BaseDefs::MAXPAR) );
-
-  const double c = 2.99792458e8; // m*s^-1
-//  const double Bfield = 3.5;          // Tesla       should not be hard-coded here
-  const double mm2m = 1e-3;
-  const double eV2GeV = 1e-9;
-  const double eB = Bfield*c*mm2m*eV2GeV;
-
-  double omega = trackstate->getOmega();
-  double ptinv = omega/eB;                   // signed q/pT in GeV^-1
-  double tanl = trackstate->getTanLambda();
-  double theta = std::atan(1.0/tanl);  
-  if (theta<0.0) theta += M_PI;
-  double phi = trackstate->getPhi();
-
-  double d3 = 1.0/eB;                        // d(ptinv)/dOmega
-  double d5 = -(1.0/(1.0+tanl*tanl));        // d(theta)/d(tanl)  
-
-  FloatVec covT(15, 0.0);
-  covT = trackstate->getCovMatrix();
-
-  initCov();                         
-  setMass (m);
-  adjustPtinvThetaPhi (m, ptinv, theta, phi);
-  setParam (0, ptinv, true);
-  setParam (1, theta, true);
-  setParam (2, phi, true);
-  setMParam (0, ptinv);
-  setMParam (1, theta);
-  setMParam (2, phi);
-
-  setError (0, d3*std::sqrt(covT[5]) );
-  setError (1, d5*std::sqrt(covT[14]) );
-  setError (2, std::sqrt(covT[2]) );
-  setCov (0, 1, d3*d5*covT[12] );            
-  setCov (0, 2, d3*covT[4] );
-  setCov (1, 2, d5*covT[11] );
-
-  // parameter 2 repeats every 2*pi
-  paramCycl[2]=2.*M_PI;
-
-  invalidateCache();
-}
-
-
 // destructor
 LeptonFitObject::~LeptonFitObject() {}
 
 LeptonFitObject::LeptonFitObject (const LeptonFitObject& rhs)
-  : ctheta(0), stheta(0), stheta2(0), cphi(0), sphi(0), cottheta(0),
+  : ParticleFitObject (paramstorage), ctheta(0), stheta(0), stheta2(0), cphi(0), sphi(0), cottheta(0),
     p2(0), p(0), e(0), e2(0), pt(0), pt2(0), pt3(0), px(0), py(0), pz(0), dpdptinv(0), dpdtheta(0), dptdptinv(0),
     dpxdptinv(0), dpydptinv(0), dpzdptinv(0), dpxdtheta(0), dpydtheta(0), dpzdtheta(0), dpxdphi(0), dpydphi(0), dpzdphi(0),
     chi2(0), dEdptinv(0), dEdtheta(0), dEdp(0), qsign(0), ptinv2(0)
@@ -277,7 +158,7 @@ bool LeptonFitObject::updateParams (double pp[], int idim) {
 
 double LeptonFitObject::getDPx(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
     case 0: return dpxdptinv;
     case 1: return 0;            // dpxdtheta = 0
@@ -288,7 +169,7 @@ double LeptonFitObject::getDPx(int ilocal) const {
 
 double LeptonFitObject::getDPy(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
     case 0: return dpydptinv;
     case 1: return 0;            // dpydtheta = 0
@@ -299,7 +180,7 @@ double LeptonFitObject::getDPy(int ilocal) const {
 
 double LeptonFitObject::getDPz(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
     case 0: return dpzdptinv; 
     case 1: return dpzdtheta;
@@ -310,7 +191,7 @@ double LeptonFitObject::getDPz(int ilocal) const {
 
 double LeptonFitObject::getDE(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR); 
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
     case 0: return dEdptinv;
     case 1: return dEdtheta;
@@ -347,7 +228,7 @@ double LeptonFitObject::getFirstDerivative_Meta_Local( int iMeta, int ilocal , i
 
 double LeptonFitObject::getSecondDerivative_Meta_Local( int iMeta, int ilocal, int jlocal, int metaSet ) const {
   assert ( metaSet==0 );
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   if ( jlocal<ilocal ) {
     int temp=jlocal; 
     jlocal=ilocal;   
@@ -448,7 +329,7 @@ void LeptonFitObject::updateCache() const {
 }
 
 //double LeptonFitObject::getChi2 () const {
-//  if (!cachevalid) updateCache();
+//  if (!cachevalid) updateCacheTraced();
 //  return chi2;
 //}
 
@@ -31,7 +31,8 @@ MomentumConstraint::MomentumConstraint (double efact_, double pxfact_, double py
   pzfact (pzfact_),
   value (value_),
   cachevalid(false),
-  nparams(0)
+  nparams(0),
+  currentvalue(0)
 {}
 
 // destructor
@@ -40,7 +41,7 @@ MomentumConstraint::~MomentumConstraint () {
 }
 
 // calculate current value of constraint function
-double MomentumConstraint::getValue() const {
+void MomentumConstraint::evaluate() const {
   double totpx = 0;
   double totpy = 0;
   double totpz = 0;
@@ -55,7 +56,12 @@ double MomentumConstraint::getValue() const {
     if (pzfact != 0) totpz += foi->getPz(); 
     if (efact  != 0) totE  += foi->getE(); 
   }
-  return pxfact*totpx + pyfact*totpy + pzfact*totpz + efact*totE - value;
+  currentvalue = pxfact*totpx + pyfact*totpy + pzfact*totpz + efact*totE - value;
+}
+
+double MomentumConstraint::getValue() const {
+  if (!isEvaluated()) evaluate();
+  return currentvalue;
 }
 
 // calculate vector/array of derivatives of this contraint 
@@ -104,6 +110,10 @@ bool MomentumConstraint::secondDerivatives (int i, int j, double *dderivatives)
   return false;
 }  
   
+bool MomentumConstraint::hasSecondDerivatives (int, int) const {
+  return false;
+}
+
 bool MomentumConstraint::firstDerivatives (int i, double *dderivatives) const {
   dderivatives[0] = efact;
   dderivatives[1] = pxfact;
@@ -26,12 +26,18 @@ using std::endl;
 // constructor
 NeutrinoFitObject::NeutrinoFitObject(double E, double theta, double phi, 
                                      double DE, double Dtheta, double Dphi) 
-  : ctheta(0), stheta(0), cphi(0), sphi(0), pt(0), px(0), py(0), pz(0), dptdE(0), 
+  : ParticleFitObject (paramstorage), ctheta(0), stheta(0), cphi(0), sphi(0), pt(0), px(0), py(0), pz(0), dptdE(0), 
     dpxdE(0), dpydE(0), dpxdtheta(0), dpydtheta(0), chi2(0)
 {
 
   assert( int(NPAR) <= int(BaseDefs::MAXPAR) );
 
+  setValues (E, theta, phi, DE, Dtheta, Dphi);
+}
+
+void NeutrinoFitObject::setValues (double E, double theta, double phi, 
+                                   double DE, double Dtheta, double Dphi) {
+  initCov();
   setMass (0);
   setParam (0, E, false);
   setParam (1, theta, false);
@@ -46,7 +52,7 @@ NeutrinoFitObject::NeutrinoFitObject(double E, double theta, double phi,
 NeutrinoFitObject::~NeutrinoFitObject() {}
 
 NeutrinoFitObject::NeutrinoFitObject (const NeutrinoFitObject& rhs)
-  : ctheta(0), stheta(0), cphi(0), sphi(0), pt(0), px(0), py(0), pz(0), dptdE(0), 
+  : ParticleFitObject (paramstorage), ctheta(0), stheta(0), cphi(0), sphi(0), pt(0), px(0), py(0), pz(0), dptdE(0), 
     dpxdE(0), dpydE(0), dpxdtheta(0), dpydtheta(0), chi2(0)
 {
   //std::cout << "copying NeutrinoFitObject with name" << rhs.name << std::endl;
@@ -130,7 +136,7 @@ bool NeutrinoFitObject::updateParams (double pp[], int idim) {
 // these depend on actual parametrisation!
 double NeutrinoFitObject::getDPx(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
     case 0: return dpxdE;
     case 1: return dpxdtheta;
@@ -141,7 +147,7 @@ double NeutrinoFitObject::getDPx(int ilocal) const {
 
 double NeutrinoFitObject::getDPy(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
     case 0: return dpydE;
     case 1: return dpydtheta;
@@ -152,7 +158,7 @@ double NeutrinoFitObject::getDPy(int ilocal) const {
 
 double NeutrinoFitObject::getDPz(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
     case 0: return ctheta;
     case 1: return -pt;
@@ -200,7 +206,7 @@ double NeutrinoFitObject::getFirstDerivative_Meta_Local( int iMeta, int ilocal ,
 
 double NeutrinoFitObject::getSecondDerivative_Meta_Local( int iMeta, int ilocal , int jlocal , int metaSet ) const {
   assert ( metaSet==0 );
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
 
   if ( jlocal<ilocal ) {
     int temp=jlocal;
@@ -7,6 +7,16 @@
  *
  * \b Changelog:
  * - 15.11.2010 First version
+ * - 16.10.2026 Added sparse solver for large fit problems
+ * - 16.10.2026 Newton step with symmetric indefinite LDL^T factorization, inertia of M
+ * - 16.10.2026 Warm start from given parameters and Lagrange multipliers
+ * - 16.10.2026 Covariance matrix on demand, and for parts of the parameters
+ * - 16.10.2026 Work arrays of the constraint derivatives from a ScratchArena
+ * - 16.10.2026 Optional trust region step control
+ * - 16.10.2026 Optional quasi-Newton approximation of the Hessian of the Lagrangian
+ * - 16.10.2026 Phase hooks for the tracer
+ * - 16.10.2026 Shifted Hessian for Newton steps with wrong inertia
+ * - 16.10.2026 SVD solutions as static kernels, shared with FixedSizeFitter
  *
  * \b CVS Log messages:
  * - $Log: NewFitterGSL.cc,v $
@@ -30,11 +40,16 @@
 #include<cmath>
 #include<cassert>
 #include<limits>
+#include<vector>
+#include<algorithm>
 
 #include "BaseFitObject.h"
 #include "BaseHardConstraint.h"
 #include "BaseSoftConstraint.h"
 #include "BaseTracer.h"
+#include "SparseSymMatrix.h"
+#include "SparseLDLSolver.h"
+#include "ScratchArena.h"
 
 #include <gsl/gsl_block.h>
 #include <gsl/gsl_vector.h>
@@ -43,6 +58,7 @@
 #include <gsl/gsl_linalg.h>
 #include <gsl/gsl_blas.h>
 #include <gsl/gsl_cdf.h>
+#include <gsl/gsl_errno.h>
 
 using std::cout;
 using std::cerr;
@@ -62,14 +78,28 @@ NewFitterGSL::NewFitterGSL()
   dx(0), dxscal (0), 
   //grad(0), 
   y(0), yscal(0), 
-  perr(0), v1 (0), v2(0), 
+  perr(0), v1 (0), v2(0), v3 (0), v4 (0), 
   //Meval (0),
   M(0), Mscal (0), W(0), W2 (0), W3 (0),
   M1(0), M2 (0), M3 (0), M4 (0), M5 (0), 
   //Mevec (0), 
   CC (0), CC1 (0), CCinv (0), 
+  Msparse (new SparseSymMatrix), Mscalsparse (new SparseSymMatrix), AATsparse (new SparseSymMatrix),
+  Hsparse (new SparseSymMatrix), Vsparse (new SparseSymMatrix),
+  ldl (new SparseLDLSolver), ldlAAT (new SparseLDLSolver),
+  scratch (new ScratchArena), phasetracer (0),
+  solvermode (SOLVER_AUTO), usesparse (false),
   permW(0), 
+  inertiaPos (0), inertiaNeg (0), inertiaZero (-1), inertiadelta (0),
+  lazycov (false), covpending (false), covfactorized (false), covsparse (false),
+  stepcontrol (STEP_LINESEARCH), trustradius (0), ntrial (0),
+  hessianmode (HESSIAN_EXACT), hessianrestart (0), 
+  Bqn (0), Aqn (0), xqn (0), gqn (0), sqn (0), yqn (0), bsqn (0),
+  qnvalid (false), qnrestart (false), qnused (false), 
+  nqnage (0), nexacthessian (0), nhessianupdate (0),
+  
   eigenws(0), eigenwsdim (0),
+  chi2best (0), chi2new (0), chi2old (0), fvalbest (0),
   imerit (1),
   try2ndOrderCorr (true),
   debug (debuglevel)
@@ -90,6 +120,8 @@ NewFitterGSL::~NewFitterGSL() {
   if (perr) gsl_vector_free (perr);         perr=0;
   if (v1) gsl_vector_free (v1);             v1=0;
   if (v2) gsl_vector_free (v2);             v2=0;
+  if (v3) gsl_vector_free (v3);             v3=0;
+  if (v4) gsl_vector_free (v4);             v4=0;
 //   if (Meval) gsl_vector_free (Meval);       Meval=0;
   if (M) gsl_matrix_free (M);               M=0;
   if (Mscal) gsl_matrix_free (Mscal);       Mscal=0;
@@ -105,6 +137,21 @@ NewFitterGSL::~NewFitterGSL() {
   if (CC) gsl_matrix_free (CC);             CC=0;
   if (CC1) gsl_matrix_free (CC1);           CC1=0;
   if (CCinv) gsl_matrix_free (CCinv);       CCinv=0;
+  delete Msparse;                           Msparse=0;
+  delete Mscalsparse;                       Mscalsparse=0;
+  delete AATsparse;                         AATsparse=0;
+  delete Hsparse;                           Hsparse=0;
+  delete Vsparse;                           Vsparse=0;
+  delete ldl;                               ldl=0;
+  delete ldlAAT;                            ldlAAT=0;
+  delete scratch;                           scratch=0;
+  if (Bqn) gsl_matrix_free (Bqn);           Bqn=0;
+  if (Aqn) gsl_matrix_free (Aqn);           Aqn=0;
+  if (xqn) gsl_vector_free (xqn);           xqn=0;
+  if (gqn) gsl_vector_free (gqn);           gqn=0;
+  if (sqn) gsl_vector_free (sqn);           sqn=0;
+  if (yqn) gsl_vector_free (yqn);           yqn=0;
+  if (bsqn) gsl_vector_free (bsqn);         bsqn=0;
   if (permW) gsl_permutation_free (permW);  permW=0;
   if (eigenws) gsl_eigen_symm_free (eigenws); eigenws=0; eigenwsdim=0;
 }
@@ -113,8 +160,36 @@ NewFitterGSL::~NewFitterGSL() {
 
 double NewFitterGSL::fit() {
 
+  startFit();
+  
+  while (iterate()) {}
+  
+  return finishFit();
+    
+}
+
+void NewFitterGSL::startFit() {
+
+#ifndef FIT_TRACEOFF
+  phasetracer = (tracer && tracer->tracesPhases()) ? tracer : 0;
+#endif   
+
+  // the fit objects report their cache updates to the tracer
+  PhaseTracerScope scope (phasetracer, *this);
+
   // order parameters etc
   initialize();
+  covpending = false;
+  covfactorized = false;
+  scratch->resetCounters();
+  trustradius = 0;
+  ntrial = 0;
+  qnvalid = false;
+  qnrestart = false;
+  qnused = false;
+  nqnage = 0;
+  nexacthessian = 0;
+  nhessianupdate = 0;
   
   // initialize eta, etasv, y   
   assert (x && x->size == idim);
@@ -126,10 +201,10 @@ double NewFitterGSL::fit() {
   assert (v1 && v1->size == idim);
   assert (v2 && v2->size == idim);
 //   assert (Meval && Meval->size == idim);
-  assert (M && M->size1 == idim && M->size1 == idim);
-  assert (W && W->size1 == idim && W->size1 == idim);
-  assert (W2 && W2->size1 == idim && W2->size1 == idim);
-  assert (M1 && M1->size1 == idim && M1->size1 == idim);
+  assert (usesparse || (M && M->size1 == idim && M->size1 == idim));
+  assert (usesparse || (W && W->size1 == idim && W->size1 == idim));
+  assert (usesparse || (W2 && W2->size1 == idim && W2->size1 == idim));
+  assert (usesparse || (M1 && M1->size1 == idim && M1->size1 == idim));
 //   assert (Mevec && Mevec->size1 == idim && Mevec->size1 == idim);
   assert (permW && permW->size == idim);
   
@@ -147,8 +222,38 @@ double NewFitterGSL::fit() {
   updateParams (x);
   fillx(x);    
   
-  assembleConstDer (M);
-  determineLambdas (x, M, x, W, v1); 
+  // Warm start: take parameters and lambdas from setStartValues
+  bool havelambdas = false;
+  if (startpar.size() > 0) {
+    if ((int)startpar.size() == npar && (startlambda.size() == 0 || (int)startlambda.size() == ncon)) {
+      for (int i = 0; i < npar; ++i) gsl_vector_set (x, i, startpar[i]);
+      updateParams (x);
+      fillx(x);
+      for (unsigned int k = 0; k < startlambda.size(); ++k) gsl_vector_set (x, npar+k, startlambda[k]);
+      havelambdas = (startlambda.size() > 0);
+      if (debug>1) cout << "NewFitterGSL::startFit: warm start, lambdas " << (havelambdas ? "given" : "recalculated") << endl;
+    }
+    else {
+      cerr << "NewFitterGSL::startFit: start values for npar=" << startpar.size() << ", ncon=" << startlambda.size()
+           << " do not match npar=" << npar << ", ncon=" << ncon << " => ignored" << endl;
+    }
+    startpar.clear();
+    startlambda.clear();
+  }
+  
+  if (havelambdas) {
+    // lambdas are known already
+  }
+  else if (usesparse) {
+    TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_LAMBDAS);
+    assembleConstDer (*Msparse);
+    determineLambdas (x, *Msparse, v1);
+  }
+  else {
+    TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_LAMBDAS);
+    assembleConstDer (M);
+    determineLambdas (x, M, x, W, v1); 
+  }
   
   // Get starting values into x
 //  gsl_vector_memcpy (x, xold);  
@@ -162,62 +267,75 @@ double NewFitterGSL::fit() {
   traceValues["phi"] = 0;
   traceValues["mu"] = 0;
   traceValues["detW"] = 0;
+  traceValues["radius"] = 0;
+  traceValues["hessian"] = 0;
   if (tracer) tracer->initialize (*this);
 #endif   
   
-  bool converged = 0;
+  converged = false;
   ierr = 0;
   
-  double chi2new = calcChi2();
+  chi2new = calcChi2();
   nit = 0;
-  
-  do {
+}
+
+bool NewFitterGSL::iterate() {
+  PhaseTracerScope scope (phasetracer, *this);
 #ifndef FIT_TRACEOFF
-    if (tracer) tracer->step (*this);
+  if (tracer) tracer->step (*this);
 #endif  
       
-    // Store old x values in xold
-    gsl_blas_dcopy (x, xold);    
-    // Fill errors into perr
+  // Store old x values in xold
+  gsl_blas_dcopy (x, xold);    
+  // Fill errors into perr
+  {
+    TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_PARERRORS);
     fillperr(perr);    
+  }
 
-    // Now, calculate the result vector y with the values of the derivatives
-    // d chi^2/d x
-    int ifail = calcNewtonDx(dx, dxscal, x, perr, M, Mscal, y, yscal, W, W2, permW, v1);
-    
-    if (ifail) {
-      ierr = 99;
-      if (debug > 0) {
-        std::cout << "NewFitterGSL::fit: calcNewtonDx error " << ifail << std::endl;
-      }
-      
-      break;
+  // Now, calculate the result vector y with the values of the derivatives
+  // d chi^2/d x
+  int ifail = calcNewtonDx(dx, dxscal, x, perr, M, Mscal, y, yscal, W, W2, permW, v1);
+  
+  if (ifail) {
+    ierr = 99;
+    if (debug > 0) {
+      std::cout << "NewFitterGSL::fit: calcNewtonDx error " << ifail << std::endl;
     }
     
-    // test convergence: 
-    if (gsl_blas_dasum (dxscal) < 1E-6*idim) {
-      converged = true;
-      break;
+    return false;
+  }
+  
+  // test convergence: 
+  if (gsl_blas_dasum (dxscal) < 1E-6*idim) {
+    converged = true;
+    return false;
+  }
+  
+  double alpha = 1;
+  double mu = 0;
+  int imode = 2;
+  
+  {
+    TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_LINESEARCH);
+    if (stepcontrol != STEP_TRUSTREGION || 
+        calcTrustRegionDx (alpha, trustradius, xnew, x, dxscal, perr, yscal, Mscal, v1, v2, v3, v4) < 0) {
+      calcLimitedDx (alpha, mu, xnew, imode, x, v2, dx, dxscal, perr, M, Mscal, W, v1);
     }
-    
-    double alpha = 1;
-    double mu = 0;
-    int imode = 2;
-    
-    calcLimitedDx (alpha, mu, xnew, imode, x, v2, dx, dxscal, perr, M, Mscal, W, v1);
+  }
 
-    gsl_blas_dcopy (xnew, x);    
+  gsl_blas_dcopy (xnew, x);    
 
-    chi2new = calcChi2();
-    //cout << "chi2: " << chi2old << " -> " << chi2new << endl;
-    
+  chi2new = calcChi2();
+  //cout << "chi2: " << chi2old << " -> " << chi2new << endl;
+  
 //   *-- Convergence criteria 
 
-    ++nit;
-    if (nit > 200) ierr = 1;
-    
-    converged = (abs (chi2new - chi2old) < 0.0001);
-                
+  ++nit;
+  if (nit > 200) ierr = 1;
+  
+  converged = (abs (chi2new - chi2old) < 0.0001);
+              
 //     if (abs (chi2new - chi2old) >= 0.001)
 //       cout << "abs (chi2new - chi2old)=" << abs (chi2new - chi2old) << " -> try again\n";      
 //     if (fvalbest >= 1E-3)
@@ -228,13 +346,17 @@ double NewFitterGSL::fit() {
 //     if (stepbest >= 1E-3)
 //       cout << "stepbest=" << stepbest << " -> try again\n";      
 //     cout << "converged=" << converged << endl;
-    if (debug > 2 && converged) {
-      cout << "abs (chi2new - chi2old)=" << abs (chi2new - chi2old) << "\n"      
-           << "fvalbest=" << fvalbest << "\n"
-           << "abs(fvals[0]-fvalbest)=" << abs(fvals[0]-fvalbest)<< "\n";      
-    } 
- 
-  } while (!(converged || ierr));
+  if (debug > 2 && converged) {
+    cout << "abs (chi2new - chi2old)=" << abs (chi2new - chi2old) << "\n"      
+         << "fvalbest=" << fvalbest << "\n"
+         << "abs(fvals[0]-fvalbest)=" << abs(fvals[0]-fvalbest)<< "\n";      
+  } 
+  
+  return !(converged || ierr);
+}
+
+double NewFitterGSL::finishFit() {
+  PhaseTracerScope scope (phasetracer, *this);
   
 #ifndef FIT_TRACEOFF
   if (tracer) tracer->step (*this);
@@ -244,9 +366,20 @@ double NewFitterGSL::fit() {
 
 // ERROR CALCULATION 
 
-  if (!ierr) {
+  if (!ierr && lazycov) {
+    // the covariance matrix is calculated when it is requested
+    covpending = true;
+  }
+  else if (!ierr) {
+    TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_COVARIANCE);
 
-    calcCovMatrix(W, permW, x);  
+    if (!usesparse || calcCovMatrixSparse (x, perr, v1, v2)) {
+      if (usesparse) {
+        if (debug > 0) cout << "NewFitterGSL::finishFit: sparse error propagation failed, using dense matrices" << endl;
+        ini_dense_matrices (idim);
+      }
+      calcCovMatrix(W, permW, x);  
+    }
 
     // update errors in fitobjects
     for (unsigned int ifitobj = 0; ifitobj < fitobjects.size(); ++ifitobj) {
@@ -255,7 +388,7 @@ double NewFitterGSL::fit() {
         for (int jlocal = ilocal; jlocal < fitobjects[ifitobj]->getNPar(); ++jlocal) {
           int jglobal = fitobjects[ifitobj]->getGlobalParNum (jlocal); 
           if (iglobal >= 0 && jglobal >= 0) 
-          fitobjects[ifitobj]->setCov(ilocal, jlocal, gsl_matrix_get (CCinv, iglobal, jglobal)); 
+          fitobjects[ifitobj]->setCov(ilocal, jlocal, cov[iglobal*covDim+jglobal]); 
         }
       }
     }
@@ -304,13 +437,15 @@ bool NewFitterGSL::initialize() {
   // tell fitobjects the global ordering of their parameters:
   npar = 0;
   nunm = 0;
+  imeasured.clear();
   // 
   for (unsigned int ifitobj = 0; ifitobj < fitobjects.size(); ++ifitobj) {
     for (int ilocal = 0; ilocal < fitobjects[ifitobj]->getNPar(); ++ilocal) {
       if (!fitobjects[ifitobj]->isParamFixed(ilocal)) {
         fitobjects[ifitobj]->setGlobalParNum (ilocal, npar);
+        if (fitobjects[ifitobj]->isParamMeasured(ilocal)) imeasured.push_back (npar);
+        else ++nunm;
         ++npar;
-        if (!fitobjects[ifitobj]->isParamMeasured(ilocal)) ++nunm;
       }
     }
   }
@@ -348,24 +483,51 @@ bool NewFitterGSL::initialize() {
   ini_gsl_vector (perr, idim);
   ini_gsl_vector (v1, idim);
   ini_gsl_vector (v2, idim);
+  ini_gsl_vector (v3, idim);
+  ini_gsl_vector (v4, idim);
 //   ini_gsl_vector (Meval, idim);
   
-  ini_gsl_matrix (M, idim, idim);
-  ini_gsl_matrix (Mscal, idim, idim);
-  ini_gsl_matrix (W, idim, idim);
-  ini_gsl_matrix (W2, idim, idim);
-  ini_gsl_matrix (W3, idim, idim);
-  ini_gsl_matrix (M1, idim, idim);
-  ini_gsl_matrix (M2, idim, idim);
-  ini_gsl_matrix (M3, idim, idim);
-  ini_gsl_matrix (M4, idim, idim);
-  ini_gsl_matrix (M5, idim, idim);
-//   ini_gsl_matrix (Mevec, idim, idim);
-  ini_gsl_matrix (CC, idim, idim);
-  ini_gsl_matrix (CC1, idim, idim);
-  ini_gsl_matrix (CCinv, idim, idim);
+  usesparse = (solvermode == SOLVER_SPARSE) || 
+              (solvermode == SOLVER_AUTO && idim >= SPARSEDIMMIN);
+  
+  // the dense matrices are not needed for the sparse solver
+  ini_dense_matrices (usesparse ? 0 : idim);
+  
+  if (usesparse) {
+    Msparse->resize (idim);
+    AATsparse->resize (ncon);
+    // Eliminate the measured parameters first, then the lambdas,
+    // finally the unmeasured parameters, which have no chi2 term
+    std::vector<int> phases (idim, 1);
+    for (unsigned int ifitobj = 0; ifitobj < fitobjects.size(); ++ifitobj) {
+      for (int ilocal = 0; ilocal < fitobjects[ifitobj]->getNPar(); ++ilocal) {
+        int iglobal = fitobjects[ifitobj]->getGlobalParNum (ilocal);
+        if (iglobal >= 0) phases[iglobal] = fitobjects[ifitobj]->isParamMeasured(ilocal) ? 0 : 2;
+      }
+    }
+    ldl->setPhases (phases);
+  }
   
   ini_gsl_permutation (permW, idim);
+  ipivW.resize (idim);
+  
+  // quasi-Newton approximation of the Hessian, only for the dense solver
+  unsigned int nqn = (hessianmode != HESSIAN_EXACT && !usesparse) ? npar : 0;
+  ini_gsl_matrix (Bqn, nqn, nqn);
+  ini_gsl_matrix (Aqn, nqn ? ncon : 0, nqn);
+  ini_gsl_vector (xqn, nqn ? idim : 0);
+  ini_gsl_vector (gqn, nqn);
+  ini_gsl_vector (sqn, nqn ? idim : 0);
+  ini_gsl_vector (yqn, nqn);
+  ini_gsl_vector (bsqn, nqn);
+  
+  // work space for the derivatives of the constraints
+  std::size_t scratchsize = 0;
+  for (unsigned int icon = 0; icon < constraints.size(); ++icon) 
+    scratchsize = std::max (scratchsize, constraints[icon]->getScratchSize (idim));
+  for (unsigned int isoft = 0; isoft < softconstraints.size(); ++isoft) 
+    scratchsize = std::max (scratchsize, softconstraints[isoft]->getScratchSize (idim));
+  scratch->reserve (scratchsize);
   
   if (eigenws && eigenwsdim != idim) {
     gsl_eigen_symm_free (eigenws); 
@@ -393,6 +555,139 @@ double NewFitterGSL::calcChi2() {
   return chi2;
 }
 
+void NewFitterGSL::setSolverMode (int mode) {
+  assert (mode == SOLVER_DENSE || mode == SOLVER_SPARSE || mode == SOLVER_AUTO);
+  solvermode = mode;
+}
+
+int NewFitterGSL::getSolverMode () const {return solvermode;}
+bool NewFitterGSL::usesSparseSolver () const {return usesparse;}
+
+bool NewFitterGSL::getInertia (int& npos, int& nneg, int& nzero) const {
+  npos = inertiaPos;
+  nneg = inertiaNeg;
+  nzero = inertiaZero;
+  return inertiaZero >= 0;
+}
+
+void NewFitterGSL::setInertiaCorrection (double delta) {
+  assert (delta >= 0);
+  inertiadelta = delta;
+}
+
+double NewFitterGSL::getInertiaCorrection () const {return inertiadelta;}
+
+void NewFitterGSL::setStartValues (int npar_, const double *par, int ncon_, const double *lambda) {
+  assert (npar_ >= 0 && (npar_ == 0 || par));
+  assert (ncon_ >= 0 && (ncon_ == 0 || lambda));
+  startpar.assign (par, par+npar_);
+  startlambda.assign (lambda, lambda+ncon_);
+}
+
+bool NewFitterGSL::setStartValuesFromLastFit () {
+  if (!x || ierr || npar <= 0 || x->size != idim) return false;
+  startpar.resize (npar);
+  startlambda.resize (ncon);
+  return getSolution (npar, &startpar[0], ncon, ncon ? &startlambda[0] : 0);
+}
+
+bool NewFitterGSL::getSolution (int npar_, double *par, int ncon_, double *lambda) const {
+  if (!x || x->size != idim || npar_ != npar || (ncon_ != 0 && ncon_ != ncon)) return false;
+  assert (par);
+  assert (ncon_ == 0 || lambda);
+  for (int i = 0; i < npar; ++i) par[i] = gsl_vector_get (x, i);
+  for (int k = 0; k < ncon_; ++k) lambda[k] = gsl_vector_get (x, npar+k);
+  return true;
+}
+
+void NewFitterGSL::setLazyCovariance (bool lazy) {
+  lazycov = lazy;
+}
+
+bool NewFitterGSL::getLazyCovariance () const {return lazycov;}
+
+double *NewFitterGSL::getGlobalCovarianceMatrix (int& idim_) {
+  if (covpending) calcLazyCovariance ();
+  return BaseFitter::getGlobalCovarianceMatrix (idim_);
+}
+
+const double *NewFitterGSL::getGlobalCovarianceMatrix (int& idim_) const {
+  // a pending calculation needs the non-const factorization of M,
+  // so in lazy mode this returns 0 until the matrix has been requested
+  return BaseFitter::getGlobalCovarianceMatrix (idim_);
+}
+
+int NewFitterGSL::getNScratchRequests () const {return scratch->getNRequests();}
+int NewFitterGSL::getNScratchAllocations () const {return scratch->getNAllocations();}
+
+void NewFitterGSL::setStepControl (int mode) {
+  assert (mode == STEP_LINESEARCH || mode == STEP_TRUSTREGION);
+  stepcontrol = mode;
+}
+int NewFitterGSL::getStepControl () const {return stepcontrol;}
+int NewFitterGSL::getNTrialPoints () const {return ntrial;}
+
+void NewFitterGSL::setHessianMode (int mode) {
+  assert (mode == HESSIAN_EXACT || mode == HESSIAN_BFGS || mode == HESSIAN_SR1);
+  hessianmode = mode;
+}
+int NewFitterGSL::getHessianMode () const {return hessianmode;}
+void NewFitterGSL::setHessianRestart (int nupdate) {hessianrestart = nupdate;}
+int NewFitterGSL::getHessianRestart () const {return hessianrestart;}
+int NewFitterGSL::getNExactHessians () const {return nexacthessian;}
+int NewFitterGSL::getNHessianUpdates () const {return nhessianupdate;}
+
+bool NewFitterGSL::getCovarianceBlock (int n, const int *index, double *covblock) {
+  assert (n >= 0);
+  assert (n == 0 || (index && covblock));
+  if (covValid && cov) {
+    for (int a = 0; a < n; ++a) {
+      assert (index[a] >= 0 && index[a] < covDim);
+      for (int b = 0; b < n; ++b) covblock[a*n+b] = cov[index[a]*covDim+index[b]];
+    }
+    return true;
+  }
+  if (!covpending) return false;
+  return calcCovBlock (n, index, covblock, n) == 0;
+}
+
+bool NewFitterGSL::updateFitObjectCov (BaseFitObject *fo) {
+  assert (fo);
+  std::vector<int> local, index;
+  for (int ilocal = 0; ilocal < fo->getNPar(); ++ilocal) {
+    int iglobal = fo->getGlobalParNum (ilocal);
+    if (iglobal >= 0 && iglobal < npar) {
+      local.push_back (ilocal);
+      index.push_back (iglobal);
+    }
+  }
+  int n = index.size();
+  if (n == 0) return true;
+  std::vector<double> covblock (n*n);
+  if (!getCovarianceBlock (n, &index[0], &covblock[0])) return false;
+  for (int a = 0; a < n; ++a)
+    for (int b = a; b < n; ++b)
+      fo->setCov (local[a], local[b], covblock[a*n+b]);
+  return true;
+}
+
+void NewFitterGSL::ini_dense_matrices (unsigned int size) {
+  ini_gsl_matrix (M, size, size);
+  ini_gsl_matrix (Mscal, size, size);
+  ini_gsl_matrix (W, size, size);
+  ini_gsl_matrix (W2, size, size);
+  ini_gsl_matrix (W3, size, size);
+  ini_gsl_matrix (M1, size, size);
+  ini_gsl_matrix (M2, size, size);
+  ini_gsl_matrix (M3, size, size);
+  ini_gsl_matrix (M4, size, size);
+  ini_gsl_matrix (M5, size, size);
+//   ini_gsl_matrix (Mevec, size, size);
+  ini_gsl_matrix (CC, size, size);
+  ini_gsl_matrix (CC1, size, size);
+  ini_gsl_matrix (CCinv, size, size);
+}
+
 int NewFitterGSL::getError() const {return ierr;}
 double NewFitterGSL::getProbability() const {return fitprob;}
 double NewFitterGSL::getChi2() const {return chi2;}
@@ -436,6 +731,361 @@ void NewFitterGSL::ini_gsl_matrix (gsl_matrix *&m, unsigned int size1, unsigned
     if (size1*size2 > 0) m = gsl_matrix_alloc (size1, size2);
 }
 
+int NewFitterGSL::choleskyDecomp (gsl_matrix *A) {
+  assert (A && A->size1 == A->size2);
+  return choleskyDecomp (A->data, A->size1, A->tda);
+}
+
+int NewFitterGSL::choleskyDecomp (double *A, int n, int lda) {
+  // Same result as gsl_linalg_cholesky_decomp: L in the lower,
+  // L^T in the upper triangle of A.
+  // Failure is signalled only by the return value; the GSL error handler
+  // is process-wide, so switching it off around the GSL routine
+  // would not be thread safe.
+  assert (A);
+  assert (n >= 0 && lda >= n);
+  for (int j = 0; j < n; ++j) {
+    double *aj = A + j*lda;
+    double s = aj[j];
+    for (int k = 0; k < j; ++k) s -= aj[k]*aj[k];
+    if (!(s > 0)) return GSL_EDOM;
+    double ljj = std::sqrt (s);
+    aj[j] = ljj;
+    for (int i = j+1; i < n; ++i) {
+      double *ai = A + i*lda;
+      double t = ai[j];
+      for (int k = 0; k < j; ++k) t -= ai[k]*aj[k];
+      ai[j] = t/ljj;
+    }
+  }
+  for (int i = 0; i < n; ++i) 
+    for (int j = i+1; j < n; ++j) A[i*lda+j] = A[j*lda+i];
+  return 0;
+}
+
+int NewFitterGSL::bunchKaufmanDecomp (gsl_matrix *A, int *ipiv) {
+  assert (A && A->size1 == A->size2);
+  return bunchKaufmanDecomp (A->data, A->size1, A->tda, ipiv);
+}
+
+int NewFitterGSL::bunchKaufmanDecomp (double *A, int n, int lda, int *ipiv) {
+  // Unblocked Bunch-Kaufman algorithm, lower triangle, 
+  // see LAPACK dsytf2 and Golub/van Loan, Sect. 4.4.
+  // Only the lower triangle is updated, i.e. half the operations of LU.
+  // For a KKT matrix, the zero block of the Lagrange multipliers
+  // leads to 2x2 pivots that couple a multiplier with a parameter.
+  // ipiv[k] = p >= 0: 1x1 block, rows k and p interchanged;
+  // ipiv[k] = ipiv[k+1] = -p-1: 2x2 block, rows k+1 and p interchanged.
+  // Element (i, j) is A[i*lda+j].
+  assert (A);
+  assert (n >= 0 && lda >= n);
+  assert (ipiv);
+  const double alpha = (1 + std::sqrt (17.))/8;
+  int info = 0;
+  
+  int k = 0;
+  while (k < n) {
+    int kstep = 1;
+    int kp = k;
+    double absakk = std::fabs (A[k*lda+k]);
+    // largest off-diagonal element in column k
+    int imax = k;
+    double colmax = 0;
+    for (int i = k+1; i < n; ++i) {
+      double a = std::fabs (A[i*lda+k]);
+      if (a > colmax) {
+        colmax = a;
+        imax = i;
+      }
+    }
+    if (!(absakk > 0 || colmax > 0)) {
+      // column k is zero: D is singular
+      if (info == 0) info = k+1;
+    }
+    else {
+      if (absakk < alpha*colmax) {
+        // largest off-diagonal element in row/column imax
+        double rowmax = 0;
+        const double *aimax = A + imax*lda;
+        for (int j = k; j < imax; ++j) {
+          double a = std::fabs (aimax[j]);
+          if (a > rowmax) rowmax = a;
+        }
+        for (int j = imax+1; j < n; ++j) {
+          double a = std::fabs (A[j*lda+imax]);
+          if (a > rowmax) rowmax = a;
+        }
+        if (absakk >= alpha*colmax*(colmax/rowmax)) {
+          kp = k;
+        }
+        else if (std::fabs (aimax[imax]) >= alpha*rowmax) {
+          kp = imax;
+        }
+        else {
+          kp = imax;
+          kstep = 2;
+        }
+      }
+      
+      // interchange rows and columns kk and kp in the trailing submatrix
+      int kk = k + kstep - 1;
+      if (kp != kk) {
+        double *akk = A + kk*lda;
+        double *akp = A + kp*lda;
+        for (int i = kp+1; i < n; ++i) {
+          double *ai = A + i*lda;
+          double t = ai[kk];
+          ai[kk] = ai[kp];
+          ai[kp] = t;
+        }
+        for (int j = kk+1; j < kp; ++j) {
+          double *aj = A + j*lda;
+          double t = aj[kk];
+          aj[kk] = akp[j];
+          akp[j] = t;
+        }
+        double t = akk[kk];
+        akk[kk] = akp[kp];
+        akp[kp] = t;
+        if (kstep == 2) {
+          double *ak1 = A + (k+1)*lda;
+          t = ak1[k];
+          ak1[k] = akp[k];
+          akp[k] = t;
+        }
+      }
+      
+      // update the trailing submatrix row by row, so that the inner
+      // loops run over contiguous elements; the multipliers are kept
+      // in the (unused) upper triangle of rows k and k+1
+      if (kstep == 1) {
+        // A := A - L(k)*D(k)*L(k)^T, with L(k) = column k / D(k)
+        double *tk = A + k*lda;
+        double r1 = 1/tk[k];
+        for (int j = k+1; j < n; ++j) tk[j] = r1*A[j*lda+k];
+        for (int i = k+1; i < n; ++i) {
+          double *ai = A + i*lda;
+          double aik = ai[k];
+          if (aik != 0) {
+            for (int j = k+1; j <= i; ++j) ai[j] -= aik*tk[j];
+          }
+          ai[k] = tk[i];
+        }
+      }
+      else {
+        // A := A - (L(k) L(k+1))*D(k)*(L(k) L(k+1))^T
+        if (k < n-2) {
+          double *wk = A + k*lda;
+          double *wkp1 = A + (k+1)*lda;
+          double d21 = wkp1[k];
+          double d11 = wkp1[k+1]/d21;
+          double d22 = wk[k]/d21;
+          double t = 1/(d11*d22 - 1);
+          d21 = t/d21;
+          for (int j = k+2; j < n; ++j) {
+            const double *aj = A + j*lda;
+            wk[j]   = d21*(d11*aj[k] - aj[k+1]);
+            wkp1[j] = d21*(d22*aj[k+1] - aj[k]);
+          }
+          for (int i = k+2; i < n; ++i) {
+            double *ai = A + i*lda;
+            double aik = ai[k];
+            double aik1 = ai[k+1];
+            for (int j = k+2; j <= i; ++j) ai[j] = ai[j] - aik*wk[j] - aik1*wkp1[j];
+            ai[k] = wk[i];
+            ai[k+1] = wkp1[i];
+          }
+        }
+      }
+    }
+    if (kstep == 1) {
+      ipiv[k] = kp;
+    }
+    else {
+      ipiv[k] = ipiv[k+1] = -kp-1;
+    }
+    k += kstep;
+  }
+  return info;
+}
+
+void NewFitterGSL::bunchKaufmanSolve (const gsl_matrix *LD, const int *ipiv, gsl_vector *x) {
+  assert (LD && LD->size1 == LD->size2);
+  assert (x && x->size == LD->size1);
+  assert (x->stride == 1);
+  bunchKaufmanSolve (LD->data, LD->size1, LD->tda, ipiv, x->data);
+}
+
+void NewFitterGSL::bunchKaufmanSolve (const double *LD, int n, int lda, const int *ipiv, double *x) {
+  // see LAPACK dsytrs
+  assert (LD);
+  assert (n >= 0 && lda >= n);
+  assert (ipiv);
+  assert (x);
+  
+  // Solve L*D*y = P*b
+  int k = 0;
+  while (k < n) {
+    if (ipiv[k] >= 0) {
+      int kp = ipiv[k];
+      if (kp != k) std::swap (x[k], x[kp]);
+      double xk = x[k];
+      for (int i = k+1; i < n; ++i) x[i] -= LD[i*lda+k]*xk;
+      x[k] = xk/LD[k*lda+k];
+      k += 1;
+    }
+    else {
+      int kp = -ipiv[k]-1;
+      if (kp != k+1) std::swap (x[k+1], x[kp]);
+      double xk  = x[k];
+      double xk1 = x[k+1];
+      for (int i = k+2; i < n; ++i) {
+        const double *ldi = LD + i*lda;
+        x[i] = x[i] - ldi[k]*xk - ldi[k+1]*xk1;
+      }
+      double d21 = LD[(k+1)*lda+k];
+      double d11 = LD[k*lda+k]/d21;
+      double d22 = LD[(k+1)*lda+k+1]/d21;
+      double denom = d11*d22 - 1;
+      double b1 = xk/d21;
+      double b2 = xk1/d21;
+      x[k]   = (d22*b1 - b2)/denom;
+      x[k+1] = (d11*b2 - b1)/denom;
+      k += 2;
+    }
+  }
+  
+  // Solve L^T*P*x = y
+  k = n-1;
+  while (k >= 0) {
+    double s = x[k];
+    for (int i = k+1; i < n; ++i) s -= LD[i*lda+k]*x[i];
+    x[k] = s;
+    if (ipiv[k] >= 0) {
+      int kp = ipiv[k];
+      if (kp != k) std::swap (x[k], x[kp]);
+      k -= 1;
+    }
+    else {
+      s = x[k-1];
+      for (int i = k+1; i < n; ++i) s -= LD[i*lda+k-1]*x[i];
+      x[k-1] = s;
+      int kp = -ipiv[k]-1;
+      if (kp != k) std::swap (x[k], x[kp]);
+      k -= 2;
+    }
+  }
+}
+
+double NewFitterGSL::bunchKaufmanDet (const gsl_matrix *LD, const int *ipiv, 
+                                      int& npos, int& nneg, int& nzero) {
+  assert (LD && LD->size1 == LD->size2);
+  return bunchKaufmanDet (LD->data, LD->size1, LD->tda, ipiv, npos, nneg, nzero);
+}
+
+double NewFitterGSL::bunchKaufmanDet (const double *LD, int n, int lda, const int *ipiv, 
+                                      int& npos, int& nneg, int& nzero) {
+  // Symmetric interchanges do not change the determinant,
+  // and by Sylvester's law of inertia, A and D have the same inertia
+  assert (LD);
+  assert (n >= 0 && lda >= n);
+  assert (ipiv);
+  double det = 1;
+  npos = nneg = nzero = 0;
+  int k = 0;
+  while (k < n) {
+    if (ipiv[k] >= 0) {
+      double d = LD[k*lda+k];
+      det *= d;
+      if (d > 0) ++npos;
+      else if (d < 0) ++nneg;
+      else ++nzero;
+      k += 1;
+    }
+    else {
+      double a = LD[k*lda+k];
+      double b = LD[(k+1)*lda+k];
+      double c = LD[(k+1)*lda+k+1];
+      double d = a*c - b*b;
+      det *= d;
+      if (d < 0) {
+        ++npos;
+        ++nneg;
+      }
+      else if (d > 0) {
+        if (a + c > 0) npos += 2;
+        else nneg += 2;
+      }
+      else {
+        ++nzero;
+        if (a + c > 0) ++npos;
+        else if (a + c < 0) ++nneg;
+        else ++nzero;
+      }
+      k += 2;
+    }
+  }
+  return det;
+}
+
+int NewFitterGSL::solveSVD (gsl_matrix *U, gsl_matrix *V, gsl_vector *s, 
+                            const gsl_vector *y, gsl_vector *x, double eps) {
+  assert (U && V && s && y && x);
+  assert (V->size1 == U->size2 && V->size2 == U->size2);
+  assert (s->size == U->size2);
+  assert (y->size == U->size1 && x->size == U->size2);
+  
+  // SVD decomposition of U
+  gsl_linalg_SV_decomp_jacobi (U, V, s);
+  // set small values to zero
+  int nzero = 0;
+  double mins = eps*std::fabs (gsl_vector_get (s, 0));
+  for (unsigned int i = 0; i < s->size; ++i) {
+    if (std::fabs (gsl_vector_get (s, i)) <= mins) {
+      gsl_vector_set (s, i, 0);
+      ++nzero;
+    }
+  }
+  gsl_linalg_SV_solve (U, V, s, y, x);
+  return nzero;
+}
+
+int NewFitterGSL::solveATA (const gsl_matrix *A, gsl_vector *z, 
+                            gsl_matrix *ATA, gsl_matrix *V, gsl_vector *s, double eps) {
+  assert (A && z && ATA && V && s);
+  unsigned int m = A->size2;
+  assert (z->size == m);
+  assert (ATA->size1 == m && ATA->size2 == m);
+  assert (V->size1 == m && V->size2 == m);
+  assert (s->size == m);
+  
+  // ATA = 1*A^T*A + 0*ATA
+  gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, A, A, 0, ATA);
+  if (choleskyDecomp (ATA) == 0) {
+    gsl_linalg_cholesky_svx (ATA, z);
+    return 0;
+  }
+  
+  // A^T*A is not positive definite, i.e. A does not have full column rank
+  // => z = (A^T*A)^+ * r with the SVD of A^T*A, 
+  // i.e. the solution with the smallest norm of the least squares problem
+  gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, A, A, 0, ATA);
+  gsl_linalg_SV_decomp_jacobi (ATA, V, s);
+  double mins = eps*std::fabs (gsl_vector_get (s, 0));
+  // s := S^+ * U^T * r, then z = V*s
+  for (unsigned int j = 0; j < m; ++j) {
+    double sj = gsl_vector_get (s, j);
+    double t = 0;
+    if (std::fabs (sj) > mins && sj != 0) {
+      for (unsigned int i = 0; i < m; ++i) t += gsl_matrix_get (ATA, i, j)*gsl_vector_get (z, i);
+      t /= sj;
+    }
+    gsl_vector_set (s, j, t);
+  }
+  gsl_blas_dgemv (CblasNoTrans, 1, V, s, 0, z);
+  return 1;
+}
+
 void NewFitterGSL::debug_print (const gsl_matrix *m, const char *name) {
   for (unsigned int  i = 0; i < m->size1; ++i) 
     for (unsigned int j = 0; j < m->size2; ++j)
@@ -587,7 +1237,7 @@ void NewFitterGSL::assembleM(gsl_matrix *MatM, const gsl_vector *vecx, bool erro
     }
     // for error propagation after fit, 
     //2nd derivatives of constraints times lambda should _not_ be included!
-    if (!errorpropagation) c->add2ndDerivativesToMatrix (MatM->block->data, MatM->tda, gsl_vector_get (vecx, kglobal));
+    if (!errorpropagation) c->add2ndDerivativesToMatrix (MatM->block->data, MatM->tda, gsl_vector_get (vecx, kglobal), *scratch);
     if (debug > 0 && !isfinite (MatM)) {
       cout << "NewFitterGSL::assembleM: illegal elements in MatM after adding 2nd derivatives of constraint " << *c << ":\n";
       if (debug > 3) debug_print (MatM, "MatM");
@@ -605,7 +1255,7 @@ void NewFitterGSL::assembleM(gsl_matrix *MatM, const gsl_vector *vecx, bool erro
   for (SoftConstraintIterator i = softconstraints.begin(); i != softconstraints.end(); ++i) {
     BaseSoftConstraint *bsc = *i;
     assert (bsc);
-    bsc->add2ndDerivativesToMatrix (MatM->block->data, MatM->tda);
+    bsc->add2ndDerivativesToMatrix (MatM->block->data, MatM->tda, *scratch);
     if (debug > 0 && !isfinite (MatM)) {
       cout << "NewFitterGSL::assembleM: illegal elements in MatM after adding soft constraint " << *bsc << ":\n";
       if (debug > 3) debug_print (MatM, "M");
@@ -620,6 +1270,153 @@ void NewFitterGSL::assembleM(gsl_matrix *MatM, const gsl_vector *vecx, bool erro
 
 }
 
+void NewFitterGSL::assembleM (SparseSymMatrix& MatM, const gsl_vector *vecx, bool errorpropagation) {
+  assert (MatM.getDim() == (int)idim);
+  assert (vecx);
+  assert (vecx->size == idim);
+  
+  MatM.setZero();
+  
+  // Same as the dense version: chi2 terms, constraint derivatives, soft constraints
+  for (FitObjectIterator i = fitobjects.begin(); i != fitobjects.end(); ++i) {
+    BaseFitObject *fo = *i;
+    assert (fo);
+    fo->addToGlobalChi2DerMatrix (MatM);
+  }
+  for (unsigned int k = 0; k < constraints.size(); ++k) {
+    BaseHardConstraint *c = constraints[k];
+    assert (c);
+    int kglobal = c->getGlobalNum();
+    assert (kglobal >= 0 && kglobal < (int)idim);
+    c->add1stDerivativesToMatrix (MatM);
+    // for error propagation after fit, 
+    //2nd derivatives of constraints times lambda should _not_ be included!
+    if (!errorpropagation) c->add2ndDerivativesToMatrix (MatM, gsl_vector_get (vecx, kglobal), *scratch);
+  }
+  for (SoftConstraintIterator i = softconstraints.begin(); i != softconstraints.end(); ++i) {
+    BaseSoftConstraint *bsc = *i;
+    assert (bsc);
+    bsc->add2ndDerivativesToMatrix (MatM, *scratch);
+  }
+  if (debug > 0 && !MatM.isfinite()) {
+    cout << "NewFitterGSL::assembleM: illegal elements in sparse MatM" << endl;
+  }
+  if (debug > 3) { 
+    cout << "NewFitterGSL::assembleM: sparse MatM with dimension " << MatM.getDim() 
+         << " and " << MatM.getNNZ() << " elements" << endl;
+  }  
+}
+
+bool NewFitterGSL::updateHessian (gsl_matrix *MatM, const gsl_vector *vecx, const gsl_vector *vecy) {
+  assert (MatM);
+  assert (MatM->size1 == idim && MatM->size2 == idim);
+  assert (vecx);
+  assert (vecx->size == idim);
+  assert (vecy);
+  assert (vecy->size == idim);
+  
+  if (!qnvalid || qnrestart || (hessianrestart > 0 && nqnage >= hessianrestart)) return false;
+  assert (Bqn && Bqn->size1 == (unsigned int)npar);
+  assert (ncon == 0 || (Aqn && Aqn->size1 == (unsigned int)ncon));
+  
+  // s = change of parameters and lambdas
+  gsl_vector_memcpy (sqn, vecx);
+  gsl_vector_sub (sqn, xqn);
+  gsl_vector_view s = gsl_vector_subvector (sqn, 0, npar);
+  
+  // yv = grad L(x, lambda) - grad L(xqn, lambda), where
+  // grad L(xqn, lambda) = grad L(xqn, lambdaqn) + Aqn^T*(lambda - lambdaqn)
+  gsl_vector_const_view gradL = gsl_vector_const_subvector (vecy, 0, npar);
+  gsl_vector_memcpy (yqn, &gradL.vector);
+  gsl_vector_sub (yqn, gqn);
+  if (ncon > 0) {
+    gsl_vector_view dlambda = gsl_vector_subvector (sqn, npar, ncon);
+    gsl_blas_dgemv (CblasTrans, -1, Aqn, &dlambda.vector, 1, yqn);
+  }
+  
+  double ss, sy, sBs;
+  gsl_blas_ddot (&s.vector, &s.vector, &ss);
+  gsl_blas_ddot (&s.vector, yqn, &sy);
+  gsl_blas_dsymv (CblasUpper, 1, Bqn, &s.vector, 0, bsqn);
+  gsl_blas_ddot (&s.vector, bsqn, &sBs);
+  
+  bool updated = false;
+  if (ss == 0) {
+    // same parameters as in the last step, only the lambdas may have changed
+  }
+  else if (hessianmode == HESSIAN_BFGS) {
+    if (sBs > 0) {
+      // Powell's damping: r = theta*yv + (1-theta)*B*s with s^T*r >= 0.2*s^T*B*s
+      double theta = (sy >= 0.2*sBs) ? 1 : 0.8*sBs/(sBs - sy);
+      gsl_blas_dscal (theta, yqn);
+      gsl_blas_daxpy (1-theta, bsqn, yqn);
+      double sr;
+      gsl_blas_ddot (&s.vector, yqn, &sr);
+      // B = B - B*s*s^T*B/(s^T*B*s) + r*r^T/(s^T*r)
+      for (int i = 0; i < npar; ++i) {
+        double bsi = gsl_vector_get (bsqn, i);
+        double ri  = gsl_vector_get (yqn, i);
+        for (int j = 0; j < npar; ++j) 
+          *gsl_matrix_ptr (Bqn, i, j) += - bsi*gsl_vector_get (bsqn, j)/sBs 
+                                         + ri*gsl_vector_get (yqn, j)/sr;
+      }
+      updated = true;
+    }
+  }
+  else {
+    // SR1: B = B + v*v^T/(v^T*s) with v = yv - B*s
+    gsl_vector_sub (yqn, bsqn);
+    double vs = sy - sBs;
+    if (std::fabs (vs) >= 1E-8*std::sqrt (ss)*gsl_blas_dnrm2 (yqn)) {
+      for (int i = 0; i < npar; ++i) {
+        double vi = gsl_vector_get (yqn, i);
+        for (int j = 0; j < npar; ++j) 
+          *gsl_matrix_ptr (Bqn, i, j) += vi*gsl_vector_get (yqn, j)/vs;
+      }
+      updated = true;
+    }
+  }
+  if (debug > 2) {
+    cout << "NewFitterGSL::updateHessian: s^T*y=" << sy << ", s^T*B*s=" << sBs 
+         << (updated ? " => updated" : " => not updated") << endl;
+  }
+  
+  // M = (B  A^T)
+  //     (A   0 )
+  assembleConstDer (MatM);
+  gsl_matrix_view H = gsl_matrix_submatrix (MatM, 0, 0, npar, npar);
+  gsl_matrix_memcpy (&H.matrix, Bqn);
+  
+  ++nqnage;
+  ++nhessianupdate;
+  return true;
+}
+
+void NewFitterGSL::storeHessianPoint (const gsl_matrix *MatM, const gsl_vector *vecx, const gsl_vector *vecy, bool exact) {
+  assert (MatM);
+  assert (MatM->size1 == idim && MatM->size2 == idim);
+  assert (vecx);
+  assert (vecx->size == idim);
+  assert (vecy);
+  assert (vecy->size == idim);
+  assert (xqn && xqn->size == idim);
+  
+  if (exact) {
+    gsl_matrix_const_view H = gsl_matrix_const_submatrix (MatM, 0, 0, npar, npar);
+    gsl_matrix_memcpy (Bqn, &H.matrix);
+    qnvalid = true;
+    qnrestart = false;
+    nqnage = 0;
+  }
+  gsl_vector_memcpy (xqn, vecx);
+  gsl_vector_const_view gradL = gsl_vector_const_subvector (vecy, 0, npar);
+  gsl_vector_memcpy (gqn, &gradL.vector);
+  if (ncon > 0) {
+    gsl_matrix_const_view A = gsl_matrix_const_submatrix (MatM, npar, 0, ncon, npar);
+    gsl_matrix_memcpy (Aqn, &A.matrix);
+  }
+}
+
 void NewFitterGSL::assembleG (gsl_matrix *MatM, const gsl_vector *vecx) {
   assert (MatM);
   assert (MatM->size1 == idim && MatM->size2 == idim);
@@ -640,7 +1437,7 @@ void NewFitterGSL::assembleG (gsl_matrix *MatM, const gsl_vector *vecx) {
     assert (c);
     int kglobal = c->getGlobalNum();
     assert (kglobal >= 0 && kglobal < (int)idim);
-    c->add2ndDerivativesToMatrix (MatM->block->data, MatM->tda, gsl_vector_get (vecx, kglobal));
+    c->add2ndDerivativesToMatrix (MatM->block->data, MatM->tda, gsl_vector_get (vecx, kglobal), *scratch);
   }
   
   // Finally, treat the soft constraints
@@ -648,7 +1445,7 @@ void NewFitterGSL::assembleG (gsl_matrix *MatM, const gsl_vector *vecx) {
   for (SoftConstraintIterator i = softconstraints.begin(); i != softconstraints.end(); ++i) {
     BaseSoftConstraint *bsc = *i;
     assert (bsc);
-    bsc->add2ndDerivativesToMatrix (MatM->block->data, MatM->tda);
+    bsc->add2ndDerivativesToMatrix (MatM->block->data, MatM->tda, *scratch);
   }
 }
 
@@ -764,6 +1561,21 @@ void NewFitterGSL::assembleConstDer (gsl_matrix *MatM) {
   }
 }
 
+void NewFitterGSL::assembleConstDer (SparseSymMatrix& MatM) {
+  assert (MatM.getDim() == (int)idim);
+
+  MatM.setZero();
+  
+  // The first derivatives of the contraints,
+  for (ConstraintIterator i = constraints.begin(); i != constraints.end(); ++i) {
+    BaseHardConstraint *c = *i;    
+    assert (c);
+    int kglobal = c->getGlobalNum();
+    assert (kglobal >= 0 && kglobal < (int)idim);
+    c->add1stDerivativesToMatrix (MatM);
+  }
+}
+
 int NewFitterGSL::calcNewtonDx (gsl_vector *vecdx, gsl_vector *vecdxscal, 
                                 gsl_vector *vecx, const gsl_vector *vece,      
                                 gsl_matrix *MatM, gsl_matrix *MatMscal,  
@@ -780,18 +1592,19 @@ int NewFitterGSL::calcNewtonDx (gsl_vector *vecdx, gsl_vector *vecdxscal,
   assert (vecx->size == idim);
   assert (vece);
   assert (vece->size == idim);
-  assert (MatM);
-  assert (MatM->size1 == idim && MatM->size2 == idim);
-  assert (MatMscal);
-  assert (MatMscal->size1 == idim && MatMscal->size2 == idim);
+  // the dense matrices are not allocated for the sparse solver
+  assert (usesparse || MatM);
+  assert (usesparse || (MatM->size1 == idim && MatM->size2 == idim));
+  assert (usesparse || MatMscal);
+  assert (usesparse || (MatMscal->size1 == idim && MatMscal->size2 == idim));
   assert (vecy);
   assert (vecy->size == idim);
   assert (vecyscal);
   assert (vecyscal->size == idim);
-  assert (MatW);
-  assert (MatW->size1 == idim && MatW->size2 == idim);
-  assert (MatW2);
-  assert (MatW2->size1 == idim && MatW2->size2 == idim);
+  assert (usesparse || MatW);
+  assert (usesparse || (MatW->size1 == idim && MatW->size2 == idim));
+  assert (usesparse || MatW2);
+  assert (usesparse || (MatW2->size1 == idim && MatW2->size2 == idim));
   assert (permW);
   assert (permW->size == idim);
   assert (vecw);
@@ -803,8 +1616,15 @@ int NewFitterGSL::calcNewtonDx (gsl_vector *vecdx, gsl_vector *vecdxscal,
   do {
     if (ncalc == 1) {
       // try to recalculate lambdas
-      assembleConstDer (MatM);
-      determineLambdas (vecx, MatM, vecx, MatW, vecw); 
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_LAMBDAS);
+      if (usesparse) {
+        assembleConstDer (*Msparse);
+        determineLambdas (vecx, *Msparse, vecw);
+      }
+      else {
+        assembleConstDer (MatM);
+        determineLambdas (vecx, MatM, vecx, MatW, vecw); 
+      }
       if (debug>2) cout << "NewFitterGSL::calcNewtonDx: ptLp=" << ptLp << " with lambdas from last iteration" << endl;
     }
     else if (ncalc == 2) {
@@ -823,15 +1643,46 @@ int NewFitterGSL::calcNewtonDx (gsl_vector *vecdx, gsl_vector *vecdxscal,
       debug_print (vecx, "x");
     }
          
-    assembleM (MatM, vecx);
-    if (!isfinite (MatM)) return 1;
-    
-    scaleM  (MatMscal, MatM, vece);
-    assembley (vecy, vecx);
+    // y first, the quasi-Newton update of M needs it
+    {
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_ASSEMBLY);
+      assembley (vecy, vecx);
+    }
     if (!isfinite (vecy)) return 2;
-    scaley (vecyscal, vecy, vece);
+    {
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_SCALING);
+      scaley (vecyscal, vecy, vece);
+    }
+    
+    if (usesparse) {
+      {
+        TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_ASSEMBLY);
+        assembleM (*Msparse, vecx);
+        ++nexacthessian;
+      }
+      if (!Msparse->isfinite()) return 1;
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_SCALING);
+      Mscalsparse->assignScaled (*Msparse, vece->block->data);
+    }
+    else {
+      {
+        TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_ASSEMBLY);
+        qnused = (hessianmode != HESSIAN_EXACT) && ncalc == 0 && updateHessian (MatM, vecx, vecy);
+        if (!qnused) {
+          assembleM (MatM, vecx);
+          ++nexacthessian;
+        }
+      }
+      if (!isfinite (MatM)) return 1;
+      if (hessianmode != HESSIAN_EXACT) storeHessianPoint (MatM, vecx, vecy, !qnused);
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_SCALING);
+      scaleM  (MatMscal, MatM, vece);
+    }
+#ifndef FIT_TRACEOFF
+    traceValues["hessian"] = qnused;
+#endif  
       
-    if (debug>5) {
+    if (debug>5 && !usesparse) {
       cout << "calcNewtonDx: After setting up equations: \n";
       debug_print (MatM, "M");
       debug_print (MatMscal, "Mscal");
@@ -848,12 +1699,50 @@ int NewFitterGSL::calcNewtonDx (gsl_vector *vecdx, gsl_vector *vecdxscal,
     double epsLU = 1E-12;
     double epsSV = 1E-3;
     double detW;
-    solveSystem (vecdxscal, detW, vecyscal, MatMscal, MatW, MatW2, vecw, epsLU, epsSV);
+    // the matrices of the dense solver, if it is used for this step
+    bool densestep = !usesparse;
+    gsl_matrix *MatMs = MatMscal;
+    gsl_matrix *MatWs = MatW;
+    gsl_matrix *MatW2s = MatW2;
+    if (!usesparse) {
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_FACTORIZATION);
+      solveSystem (vecdxscal, detW, vecyscal, MatMscal, MatW, MatW2, vecw, epsLU, epsSV);
+    }
+    else {
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_FACTORIZATION);
+      if (solveSystem (vecdxscal, detW, vecyscal, *Mscalsparse, vecw, epsLU)) {
+        // The sparse factorization without pivoting has failed,
+        // solve this step with the dense matrices instead
+        if (debug>1) cout << "NewFitterGSL::calcNewtonDx: sparse solver failed, using dense solver" << endl;
+        ini_gsl_matrix (Mscal, idim, idim);
+        ini_gsl_matrix (W, idim, idim);
+        ini_gsl_matrix (W2, idim, idim);
+        Mscalsparse->copyTo (Mscal->block->data, Mscal->tda);
+        solveSystem (vecdxscal, detW, vecyscal, Mscal, W, W2, vecw, epsLU, epsSV);
+        densestep = true;
+        MatMs = Mscal;
+        MatWs = W;
+        MatW2s = W2;
+      }
+    }
     
 
 #ifndef FIT_TRACEOFF
     traceValues["detW"] = detW;
 #endif  
+    
+    // With constraint derivatives of full rank, the reduced Hessian 
+    // is positive definite iff M has npar positive and ncon negative eigenvalues
+    bool wronginertia = inertiaZero >= 0 && (inertiaNeg != ncon || inertiaZero > 0);
+    if (debug>2 && wronginertia) {
+      cout << "NewFitterGSL::calcNewtonDx: inertia of M is (" << inertiaPos << ", " 
+           << inertiaNeg << ", " << inertiaZero << "), ncon=" << ncon 
+           << " => wrong curvature" << endl;
+    }
+    if (wronginertia && inertiadelta > 0) {
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_FACTORIZATION);
+      correctInertia (vecdxscal, detW, vecyscal, vece, densestep ? MatMs : 0, MatWs, MatW2s, vecw, epsLU, epsSV);
+    }
   
     // step is - computed vector
     gsl_blas_dscal (-1, dxscal);
@@ -869,7 +1758,14 @@ int NewFitterGSL::calcNewtonDx (gsl_vector *vecdx, gsl_vector *vecdxscal,
     }              
 
     
-    ptLp = calcpTLp (dx, M, v1);
+    ptLp = usesparse ? calcpTLp (dx, *Msparse) : calcpTLp (dx, M, v1);
+    if (ptLp < 0 && qnused) {
+      // wrong curvature with the approximated Hessian:
+      // try again with the exact second derivatives
+      if (debug>2) cout << "NewFitterGSL::calcNewtonDx: ptLp=" << ptLp << " with quasi-Newton Hessian" << endl;
+      qnrestart = true;
+      continue;
+    }
     ++ncalc;
   }
   while (ptLp < 0);
@@ -892,17 +1788,17 @@ int NewFitterGSL::calcLimitedDx (double& alpha, double& mu, gsl_vector *vecxnew,
   assert (vecdxhat);
   assert (vecdxhat->size == idim);
   assert (vecdx);
-  assert (vecdx->size == idim);
-  assert (vecdxscal);
-  assert (vecdxscal->size == idim);
-  assert (vece);
-  assert (vece->size == idim);
-  assert (MatM);
-  assert (MatM->size1 == idim && MatM->size2 == idim);
-  assert (MatMscal);
-  assert (MatMscal->size1 == idim && MatMscal->size2 == idim);
-  assert (MatW);
-  assert (MatW->size1 == idim && MatW->size2 == idim);
+  assert (vecdx->size == idim);
+  assert (vecdxscal);
+  assert (vecdxscal->size == idim);
+  assert (vece);
+  assert (vece->size == idim);
+  assert (usesparse || MatM);
+  assert (usesparse || (MatM->size1 == idim && MatM->size2 == idim));
+  assert (usesparse || MatMscal);
+  assert (usesparse || (MatMscal->size1 == idim && MatMscal->size2 == idim));
+  assert (usesparse || MatW);
+  assert (usesparse || (MatW->size1 == idim && MatW->size2 == idim));
   assert (vecw);
   assert (vecw->size == idim);
     
@@ -972,7 +1868,11 @@ int NewFitterGSL::calcLimitedDx (double& alpha, double& mu, gsl_vector *vecxnew,
   
     // try second order correction first
     if (try2ndOrderCorr) {
-      calc2ndOrderCorr (vecdxhat, vecxnew, MatM, MatW, vecw);
+      {
+        TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_2NDORDERCORR);
+        if (usesparse) calc2ndOrderCorr (vecdxhat, *Msparse, vecw);
+        else calc2ndOrderCorr (vecdxhat, vecxnew, MatM, MatW, vecw);
+      }
       gsl_blas_dcopy (vecxnew, vecw);
       add (vecxnew, vecxnew, 1, vecdxhat);
       updateParams (vecxnew);
@@ -1015,6 +1915,138 @@ int NewFitterGSL::calcLimitedDx (double& alpha, double& mu, gsl_vector *vecxnew,
   return 0;
 }
                 
+int NewFitterGSL::calcTrustRegionDx (double& alpha, double& radius, gsl_vector *vecxnew, 
+                                     const gsl_vector *vecx, const gsl_vector *vecdxscal,
+                                     const gsl_vector *vece, const gsl_vector *vecyscal,
+                                     const gsl_matrix *MatMscal,
+                                     gsl_vector *vecw1, gsl_vector *vecw2, 
+                                     gsl_vector *vecw3, gsl_vector *vecw4
+                                    ) {
+  assert (vecxnew);
+  assert (vecxnew->size == idim);
+  assert (vecx);
+  assert (vecx->size == idim);
+  assert (vecdxscal);
+  assert (vecdxscal->size == idim);
+  assert (vece);
+  assert (vece->size == idim);
+  assert (vecyscal);
+  assert (vecyscal->size == idim);
+  assert (usesparse || MatMscal);
+  assert (usesparse || (MatMscal->size1 == idim && MatMscal->size2 == idim));
+  assert (vecw1 && vecw1->size == idim);
+  assert (vecw2 && vecw2->size == idim);
+  assert (vecw3 && vecw3->size == idim);
+  assert (vecw4 && vecw4->size == idim);
+  
+  // Minimize F(p) = 1/2 |yscal(x+e*p)|^2; its linear model 
+  // 1/2 |yscal + Mscal*p|^2 has the gradient g = Mscal*yscal at p=0
+  // (M is symmetric), and its minimum is the Newton step pN = dxscal.
+  // All trial steps are p = a*pN + b*g, so that
+  // Mscal*p = a*Mscal*pN + b*Mscal*g needs no further matrix operations.
+  gsl_vector *vecg   = vecw1;
+  gsl_vector *vecMg  = vecw2;
+  gsl_vector *vecMpN = vecw3;
+  gsl_vector *vecr   = vecw4;
+  if (usesparse) {
+    Mscalsparse->multiply (vecg->data, vecyscal->data);
+    Mscalsparse->multiply (vecMg->data, vecg->data);
+    Mscalsparse->multiply (vecMpN->data, vecdxscal->data);
+  }
+  else {
+    gsl_blas_dsymv (CblasUpper, 1, MatMscal, vecyscal, 0, vecg);
+    gsl_blas_dsymv (CblasUpper, 1, MatMscal, vecg, 0, vecMg);
+    gsl_blas_dsymv (CblasUpper, 1, MatMscal, vecdxscal, 0, vecMpN);
+  }
+  
+  double F0 = 0.5*std::pow (gsl_blas_dnrm2 (vecyscal), 2);
+  double normN = gsl_blas_dnrm2 (vecdxscal);
+  double normg = gsl_blas_dnrm2 (vecg);
+  double normMg = gsl_blas_dnrm2 (vecMg);
+  double gpN;
+  gsl_blas_ddot (vecg, vecdxscal, &gpN);
+  // The Cauchy point pC = -t*g minimizes the linear model along -g
+  double t = (normMg > 0) ? std::pow (normg/normMg, 2) : 0;
+  double normC = t*normg;
+  
+  if (radius <= 0) radius = normN;
+  
+  const double eta1 = 1E-4;   // minimum ratio of actual to predicted reduction for a successful step
+  const double eta2 = 0.25;   // below this ratio, the radius is reduced
+  const double eta3 = 0.75;   // above this ratio, the radius is enlarged if the step was limited
+  const int ntrymax = 10;
+  
+  int ntry;
+  double a = 1, b = 0, normp = normN, rho = 0;
+  for (ntry = 0; ntry < ntrymax; ++ntry) {
+    // Dogleg step for the current radius
+    if (normN <= radius || normg == 0) {
+      a = 1; 
+      b = 0;
+      normp = normN;
+    }
+    else if (normC >= radius || t == 0) {
+      a = 0;
+      b = -radius/normg;
+      normp = radius;
+    }
+    else {
+      // p = pC + beta*(pN - pC) with |p| = radius and 0 < beta < 1
+      double dd = normN*normN + 2*t*gpN + normC*normC;   // |pN - pC|^2
+      double pCd = -t*gpN - normC*normC;                   // pC.(pN - pC)
+      double beta = (-pCd + std::sqrt (std::max (0., pCd*pCd + dd*(radius*radius - normC*normC))))/dd;
+      a = beta;
+      b = -t*(1-beta);
+      normp = radius;
+    }
+    
+    // predicted reduction
+    gsl_blas_dcopy (vecyscal, vecr);
+    if (a != 0) gsl_blas_daxpy (a, vecMpN, vecr);
+    if (b != 0) gsl_blas_daxpy (b, vecMg, vecr);
+    double pred = F0 - 0.5*std::pow (gsl_blas_dnrm2 (vecr), 2);
+    
+    // actual reduction: xnew = x + e*p
+    for (unsigned int i = 0; i < idim; ++i) 
+      gsl_vector_set (vecxnew, i, gsl_vector_get (vecx, i) + 
+                      gsl_vector_get (vece, i)*(a*gsl_vector_get (vecdxscal, i) + b*gsl_vector_get (vecg, i)));
+    updateParams (vecxnew);
+    ++ntrial;
+    assembley (vecr, vecxnew);
+    gsl_vector_mul (vecr, vece);
+    double F = isfinite (vecr) ? 0.5*std::pow (gsl_blas_dnrm2 (vecr), 2) : 
+                                 std::numeric_limits<double>::infinity();
+    rho = (pred > 0) ? (F0 - F)/pred : -1;
+    
+    alpha = (normN > 0) ? normp/normN : 0;
+    
+#ifndef FIT_TRACEOFF
+    calcChi2();
+    traceValues["alpha"] = alpha;
+    traceValues["phi"] = F;
+    traceValues["mu"] = 0;
+    traceValues["radius"] = radius;
+    if (tracer) tracer->substep (*this, 3);
+#endif   
+    
+    if (debug > 2) {
+      cout << "NewFitterGSL::calcTrustRegionDx: radius=" << radius << ", |pN|=" << normN 
+           << ", |p|=" << normp << ", F0=" << F0 << ", F=" << F << ", Fpred=" << F0-pred
+           << " => rho=" << rho << endl;
+    }
+    
+    // update the radius
+    if (!(rho >= eta2)) radius = eta2*normp;
+    else if (rho > eta3 && normp >= 0.99*radius) radius *= 2;
+    
+    if (rho > eta1) return ntry;
+  }
+  // No trial step was successful: start again from the Newton step length 
+  // in the next iteration, and let the caller limit this step
+  radius = 0;
+  return -1;
+}
+                
 int NewFitterGSL::doLineSearch (double& alpha, gsl_vector *vecxnew, 
                                 int imode, 
                                 double phi0, double dphi0, double phiR,
@@ -1146,10 +2178,10 @@ double NewFitterGSL::calcMu (const gsl_vector *vecx, const gsl_vector *vece,
   assert (vecdx->size == idim);
   assert (vecdxscal);
   assert (vecdxscal->size == idim);
-  assert (MatM);
-  assert (MatM->size1 == idim && MatM->size2 == idim);
-  assert (MatMscal);
-  assert (MatMscal->size1 == idim && MatMscal->size2 == idim);
+  assert (usesparse || MatM);
+  assert (usesparse || (MatM->size1 == idim && MatM->size2 == idim));
+  assert (usesparse || MatMscal);
+  assert (usesparse || (MatMscal->size1 == idim && MatMscal->size2 == idim));
   assert (vecw);
   assert (vecw->size == idim);
   
@@ -1199,7 +2231,7 @@ double NewFitterGSL::calcMu (const gsl_vector *vecx, const gsl_vector *vece,
         }
         else {
           // calculate p^T L p
-          double pTLp = calcpTLp (vecdx, MatM, vecw);
+          double pTLp = usesparse ? calcpTLp (vecdx, *Msparse) : calcpTLp (vecdx, MatM, vecw);
           double sigma = (pTLp > 0) ? 1 : 0;
           if (debug > 7)
             cout << "  pTLp = " << pTLp << endl;
@@ -1231,6 +2263,7 @@ double NewFitterGSL::meritFunction (double mu, const gsl_vector *vecx, const gsl
   assert (vece);
   assert (vece->size == idim);
   
+  ++ntrial;
   double result = 0;
   switch (imerit) {
     case 1: // l1 penalty function, Nocedal&Wright Eq. (15.24)
@@ -1452,6 +2485,218 @@ void NewFitterGSL::calcCovMatrix(gsl_matrix *MatW,
   }    
   covValid = true;
 }
+
+int NewFitterGSL::calcCovMatrixSparse (gsl_vector *vecx, const gsl_vector *vece, 
+                                       gsl_vector *vecw1, gsl_vector *vecw2) {
+  assert (vecx);
+  assert (vecx->size == idim);
+  assert (vece);
+  assert (vece->size == idim);
+  assert (vecw1);
+  assert (vecw1->size == idim);
+  assert (vecw2);
+  assert (vecw2->size == idim);
+  
+  // Same error propagation as in calcCovMatrix:
+  // Cov_a = dadeta*Cov_eta*dadeta^T, with dadeta = M^-1*H,
+  // where H = d^2 chi^2 / d a d a (the sign does not matter here).
+  // Since M and H are symmetric, column j of Cov_a is
+  // Cov_a*e_j = M^-1*H*Cov_eta*H*M^-1*e_j,
+  // which needs two solves with the factorization of M per column,
+  // instead of the inversion of M.
+  // M is factorized scaled, M^-1 = E*Mscal^-1*E with E = diag(vece)
+  
+  Hsparse->resize (npar);
+  Vsparse->resize (npar);
+  for (FitObjectIterator i = fitobjects.begin(); i != fitobjects.end(); ++i) {
+    BaseFitObject *fo = *i;
+    assert (fo);
+    fo->addToGlobalChi2DerMatrix (*Hsparse);
+    fo->addToGlobCov (*Vsparse);
+  }
+  
+  assembleM (*Msparse, vecx, true);
+  Mscalsparse->assignScaled (*Msparse, vece->block->data);
+  int ifail = ldl->factorize (*Mscalsparse);
+  if (debug > 3) {
+    cout << "NewFitterGSL::calcCovMatrixSparse: factorize result=" << ifail 
+         << ", nonzero elements of L: " << ldl->getNNZL() << endl;
+  }
+  if (ifail) return 1;
+
+  if (cov && covDim != npar) {
+    delete[] cov;
+    cov = 0;
+  }
+  covDim = npar;
+  if (!cov) cov = new double[covDim*covDim];
+  
+  const double *e = vece->block->data;
+  double *u = vecw1->block->data;
+  double *w = vecw2->block->data;
+  for (int j = 0; j < npar; ++j) {
+    // u = M^-1*e_j
+    for (unsigned int i = 0; i < idim; ++i) u[i] = 0;
+    u[j] = e[j];
+    ldl->solve (u);
+    for (int i = 0; i < npar; ++i) u[i] *= e[i];
+    // w = H*u, u = Cov_eta*w, w = H*u
+    Hsparse->multiply (w, u);
+    Vsparse->multiply (u, w);
+    Hsparse->multiply (w, u);
+    // w = M^-1*w
+    for (int i = 0; i < npar; ++i) w[i] *= e[i];
+    for (unsigned int i = npar; i < idim; ++i) w[i] = 0;
+    ldl->solve (w);
+    for (int i = 0; i < npar; ++i) cov[i*covDim+j] = e[i]*w[i];
+  }
+  for (int i = 0; i < covDim*covDim; ++i) 
+    if (!std::isfinite (cov[i])) return 2;
+  covValid = true;
+  return 0;
+}
+
+int NewFitterGSL::factorizeCovM () {
+  if (covfactorized) return 0;
+  
+  // M as in calcCovMatrix, and the matrices H = d^2 chi^2 / d a d a 
+  // and Cov_eta are stored now, before the covariance matrices
+  // of the fit objects are overwritten by updateFitObjectCov
+  covsparse = usesparse;
+  if (covsparse) {
+    Hsparse->resize (npar);
+    Vsparse->resize (npar);
+    for (FitObjectIterator i = fitobjects.begin(); i != fitobjects.end(); ++i) {
+      BaseFitObject *fo = *i;
+      assert (fo);
+      fo->addToGlobalChi2DerMatrix (*Hsparse);
+      fo->addToGlobCov (*Vsparse);
+    }
+    assembleM (*Msparse, x, true);
+    Mscalsparse->assignScaled (*Msparse, perr->block->data);
+    int ifail = ldl->factorize (*Mscalsparse);
+    if (ifail) {
+      if (debug > 0) cout << "NewFitterGSL::factorizeCovM: sparse factorization failed, using dense matrices" << endl;
+      ini_dense_matrices (idim);
+      covsparse = false;
+    }
+  }
+  if (!covsparse) {
+    gsl_matrix_set_zero (M1);
+    gsl_matrix_set_zero (M2);
+    for (FitObjectIterator i = fitobjects.begin(); i != fitobjects.end(); ++i) {
+      BaseFitObject *fo = *i;
+      assert (fo);
+      fo->addToGlobalChi2DerMatrix (M1->block->data, M1->tda);
+      fo->addToGlobCov (M2->block->data, M2->tda);
+    }
+    assembleM (W, x, true);
+    ipivW.resize (idim);
+    int result = bunchKaufmanDecomp (W, &ipivW[0]);
+    if (debug > 3) cout << "NewFitterGSL::factorizeCovM: bunchKaufmanDecomp result=" << result << endl;
+    if (result) return result;
+  }
+  covfactorized = true;
+  return 0;
+}
+
+int NewFitterGSL::calcCovBlock (int n, const int *index, double *covblock, int ldc) {
+  TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_COVARIANCE);
+  assert (n >= 0);
+  assert (n == 0 || (index && covblock));
+  assert (ldc >= n);
+  
+  // Same error propagation as in calcCovMatrix:
+  // Cov_a = dadeta*Cov_eta*dadeta^T, with dadeta = -M^-1*H.
+  // Since M is symmetric, row i of dadeta is -(H*z_i)^T with z_i = M^-1*e_i.
+  // Thus a block of Cov_a needs one solve per requested parameter, 
+  // which eliminates the constraints with the Schur complement of M
+  // that is contained in its LDL^T factorization.
+  int ifail = factorizeCovM ();
+  if (ifail) return ifail;
+  
+  covrows.resize (n*npar);
+  double *z = v1->block->data;
+  const double *e = perr->block->data;
+  for (int a = 0; a < n; ++a) {
+    int i = index[a];
+    assert (i >= 0 && i < npar);
+    for (unsigned int k = 0; k < idim; ++k) z[k] = 0;
+    double *d = &covrows[a*npar];
+    if (covsparse) {
+      // M is factorized scaled, M^-1 = E*Mscal^-1*E with E = diag(perr)
+      z[i] = e[i];
+      ldl->solve (z);
+      for (int k = 0; k < npar; ++k) z[k] *= e[k];
+      Hsparse->multiply (d, z);
+    }
+    else {
+      z[i] = 1;
+      bunchKaufmanSolve (W, &ipivW[0], v1);
+      gsl_matrix_const_view H = gsl_matrix_const_submatrix (M1, 0, 0, npar, npar);
+      gsl_vector_const_view zpar = gsl_vector_const_subvector (v1, 0, npar);
+      gsl_vector_view dview = gsl_vector_view_array (d, npar);
+      gsl_blas_dgemv (CblasNoTrans, 1, &H.matrix, &zpar.vector, 0, &dview.vector);
+    }
+  }
+  
+  // covblock = dadeta*Cov_eta*dadeta^T for the requested rows
+  double *w = v2->block->data;
+  for (int a = 0; a < n; ++a) {
+    const double *da = &covrows[a*npar];
+    if (covsparse) {
+      Vsparse->multiply (w, da);
+    }
+    else {
+      gsl_matrix_const_view Cov_eta = gsl_matrix_const_submatrix (M2, 0, 0, npar, npar);
+      gsl_vector_const_view daview = gsl_vector_const_view_array (da, npar);
+      gsl_vector_view wview = gsl_vector_subvector (v2, 0, npar);
+      gsl_blas_dgemv (CblasNoTrans, 1, &Cov_eta.matrix, &daview.vector, 0, &wview.vector);
+    }
+    for (int b = 0; b <= a; ++b) {
+      const double *db = &covrows[b*npar];
+      double sum = 0;
+      for (int k = 0; k < npar; ++k) sum += db[k]*w[k];
+      if (!std::isfinite (sum)) return -1;
+      covblock[a*ldc+b] = covblock[b*ldc+a] = sum;
+    }
+  }
+  return 0;
+}
+
+bool NewFitterGSL::calcLazyCovariance () {
+  if (!covpending) return covValid;
+  covpending = false;
+  if (npar <= 0) return false;
+  
+  if (cov && covDim != npar) {
+    delete[] cov;
+    cov = 0;
+  }
+  covDim = npar;
+  if (!cov) cov = new double[covDim*covDim];
+  std::vector<int> index (npar);
+  for (int i = 0; i < npar; ++i) index[i] = i;
+  int ifail = calcCovBlock (npar, &index[0], cov, covDim);
+  if (ifail) {
+    if (debug > 0) cout << "NewFitterGSL::calcLazyCovariance: error propagation failed, ifail=" << ifail << endl;
+    return false;
+  }
+  covValid = true;
+
+  // update errors in fitobjects
+  for (unsigned int ifitobj = 0; ifitobj < fitobjects.size(); ++ifitobj) {
+    for (int ilocal = 0; ilocal < fitobjects[ifitobj]->getNPar(); ++ilocal) {
+      int iglobal = fitobjects[ifitobj]->getGlobalParNum (ilocal); 
+      for (int jlocal = ilocal; jlocal < fitobjects[ifitobj]->getNPar(); ++jlocal) {
+        int jglobal = fitobjects[ifitobj]->getGlobalParNum (jlocal); 
+        if (iglobal >= 0 && jglobal >= 0) 
+        fitobjects[ifitobj]->setCov(ilocal, jlocal, cov[iglobal*covDim+jglobal]); 
+      }
+    }
+  }
+  return true;
+}
   
 void NewFitterGSL::determineLambdas (gsl_vector *vecxnew, 
                                      const gsl_matrix *MatM, const gsl_vector *vecx, 
@@ -1469,14 +2714,15 @@ void NewFitterGSL::determineLambdas (gsl_vector *vecxnew,
   assert (vecw->size == idim);
   assert (idim == static_cast<unsigned int>(npar + ncon));
 
+  if (ncon == 0) return;
+
   gsl_matrix_const_view A (gsl_matrix_const_submatrix (MatM, 0, npar, npar, ncon));
   gsl_matrix_view ATA (gsl_matrix_submatrix (MatW, npar, npar, ncon, ncon));
-  gsl_matrix_view Acopy (gsl_matrix_submatrix (MatW, 0, npar, npar, ncon));
-  gsl_matrix_view& V = ATA;
+  assert (W2);
+  gsl_matrix_view V (gsl_matrix_submatrix (W2, 0, 0, ncon, ncon));
   
   gsl_vector_view gradf (gsl_vector_subvector (vecw, 0, npar));
-  gsl_vector_view ATgradf (gsl_vector_subvector (vecw, npar, ncon));
-  gsl_vector_view& s = ATgradf;
+  gsl_vector_view s (gsl_vector_subvector (vecw, 0, ncon));
 
   gsl_vector_view lambdanew (gsl_vector_subvector (vecxnew, npar, ncon));
 
@@ -1487,59 +2733,70 @@ void NewFitterGSL::determineLambdas (gsl_vector *vecxnew,
     cout << endl;
   }
   
-  // ATA = 1*A^T*A + 0*ATA
-  gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, &A.matrix, &A.matrix, 0, &ATA.matrix);
-
   // put grad(f) into vecw
   assembleChi2Der (vecw);
 
-  
-  // ATgradf = -1*A^T*gradf + 0*ATgradf
-  gsl_blas_dgemv (CblasTrans, -1, &A.matrix, &gradf.vector, 0, &ATgradf.vector);
+  // lambdanew = -1*A^T*gradf + 0*lambdanew
+  gsl_blas_dgemv (CblasTrans, -1, &A.matrix, &gradf.vector, 0, &lambdanew.vector);
   
   if (debug > 7) {
     cout << "A: " <<endl;;
     gsl_matrix_fprintf (stdout, &A.matrix, "%f");
     cout << endl;
-    cout << "ATA: " <<endl;;
-    gsl_matrix_fprintf (stdout, &ATA.matrix, "%f");
-    cout << endl;
     cout << "gradf: " <<endl;;
     gsl_vector_fprintf (stdout, &gradf.vector, "%f");
     cout << endl;
     cout << "ATgradf: " <<endl;;
-    gsl_vector_fprintf (stdout, &ATgradf.vector, "%f");
+    gsl_vector_fprintf (stdout, &lambdanew.vector, "%f");
     cout << endl;
   }
   
-  // solve ATA * lambdanew = ATgradf using the Cholsky factorization method
-  gsl_error_handler_t *old_handler =  gsl_set_error_handler_off ();
-  int cholesky_result = gsl_linalg_cholesky_decomp (&ATA.matrix);
-  gsl_set_error_handler (old_handler);
-  if (cholesky_result) {
+  // solve ATA * lambdanew = ATgradf
+  if (solveATA (&A.matrix, &lambdanew.vector, &ATA.matrix, &V.matrix, &s.vector, eps)) {
     cout << "NewFitterGSL::determineLambdas: resorting to SVD" << endl;
-    // ATA is not positive definite, i.e. A does not have full column rank
-    // => use the SVD of A to solve A lambdanew = gradf
-    
-    // Acopy = A
-    gsl_matrix_memcpy (&Acopy.matrix, &A.matrix);
-    
-    // SVD decomposition of Acopy
-    gsl_linalg_SV_decomp_jacobi (&Acopy.matrix, &V.matrix, &s.vector);
-    // set small values to zero
-    double mins = eps*std::fabs (gsl_vector_get (&s.vector, 0));
-    for (int i = 0; i < ncon; ++i) {
-      if (std::fabs (gsl_vector_get (&s.vector, i)) <= mins) 
-        gsl_vector_set (&s.vector, i, 0);
+  }
+  if (debug > 5) {
+    cout << "lambdanew: " <<endl;;
+    gsl_vector_fprintf (stdout, &lambdanew.vector, "%f");
+    cout << endl;
+  }
+}
+
+void NewFitterGSL::determineLambdas (gsl_vector *vecxnew, 
+                                     const SparseSymMatrix& MatM,
+                                     gsl_vector *vecw) {
+  assert (vecxnew);
+  assert (vecxnew->size == idim);
+  assert (MatM.getDim() == (int)idim);
+  assert (vecw);
+  assert (vecw->size == idim);
+  assert (idim == static_cast<unsigned int>(npar + ncon));
+  
+  if (ncon == 0) return;
+
+  // put grad(f) into vecw
+  assembleChi2Der (vecw);
+  const double *gradf = vecw->block->data;
+  
+  // lambdanew = -(A^T*A)^-1*A^T*gradf; 
+  // column npar+k of MatM holds the derivatives of constraint k
+  double *lambdanew = vecxnew->block->data + npar;
+  for (int k = 0; k < ncon; ++k) {
+    int kglobal = npar+k;
+    double s = 0;
+    for (int l = 0; l < MatM.getColSize (kglobal); ++l) {
+      int i = MatM.getRow (kglobal, l);
+      if (i < npar) s += MatM.getValue (kglobal, l)*gradf[i];
     }
-    gsl_linalg_SV_solve (&Acopy.matrix, &V.matrix, &s.vector, &gradf.vector, &lambdanew.vector);
+    lambdanew[k] = -s;
   }
-  else {
-    gsl_linalg_cholesky_solve (&ATA.matrix, &ATgradf.vector, &lambdanew.vector);
+  if (solveAAT (lambdanew, MatM)) {
+    cout << "NewFitterGSL::determineLambdas: A^T*A is singular, using regularised A^T*A" << endl;
   }
   if (debug > 5) {
+    gsl_vector_view lambda (gsl_vector_subvector (vecxnew, npar, ncon));
     cout << "lambdanew: " <<endl;;
-    gsl_vector_fprintf (stdout, &lambdanew.vector, "%f");
+    gsl_vector_fprintf (stdout, &lambda.vector, "%f");
     cout << endl;
   }
 }
@@ -1606,6 +2863,14 @@ double NewFitterGSL::calcpTLp (const gsl_vector *vecdx, const gsl_matrix *MatM,
   return result;
 }
 
+double NewFitterGSL::calcpTLp (const gsl_vector *vecdx, const SparseSymMatrix& MatM) {
+  assert (vecdx);
+  assert (vecdx->size == idim);
+  assert (MatM.getDim() == (int)idim);
+  
+  return MatM.quadraticForm (vecdx->block->data, npar);
+}
+
 void NewFitterGSL::calc2ndOrderCorr (gsl_vector *vecdxhat, 
                                      const gsl_vector *vecxnew, 
                                      const gsl_matrix *MatM,   
@@ -1627,48 +2892,27 @@ void NewFitterGSL::calc2ndOrderCorr (gsl_vector *vecdxhat,
 
   // Calculate 2nd order correction 
   // see Nocedal&Wright (15.36)
+  // phat = -A^T*(A*A^T)^-1*c
+  gsl_vector_set_zero (vecdxhat);
+  if (ncon == 0) return;
+  addConstraints (vecdxhat);
+  
   gsl_matrix_const_view AT     (gsl_matrix_const_submatrix (MatM, 0,    npar, npar, ncon));
   gsl_matrix_view AAT          (gsl_matrix_submatrix       (MatW, npar, npar, ncon, ncon));
-  gsl_matrix_view ATcopy       (gsl_matrix_submatrix       (MatW, 0,    npar, npar, ncon));
-  gsl_matrix_view& V = AAT;
+  assert (W2);
+  gsl_matrix_view V            (gsl_matrix_submatrix       (W2,   0,    0,    ncon, ncon));
 
-  gsl_vector_set_zero (vecdxhat);
-  addConstraints (vecdxhat);
   gsl_vector_view c (gsl_vector_subvector (vecdxhat, npar, ncon));
   gsl_vector_view phat = (gsl_vector_subvector (vecdxhat, 0, npar));
                                        
   gsl_vector_set_zero (vecw);
   gsl_vector_view AATinvc (gsl_vector_subvector (vecw, npar, ncon));
-  gsl_vector_view& s = AATinvc;
-  
+  gsl_vector_view s (gsl_vector_subvector (vecw, 0, ncon));
+  gsl_vector_memcpy (&AATinvc.vector, &c.vector);
   
-  // AAT = 1*A*A^T + 0*AAT
-  gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, &AT.matrix, &AT.matrix, 0, &AAT.matrix);
-  
-  // solve AAT * AATinvc = c using the Cholsky factorization method
-  gsl_error_handler_t *old_handler =  gsl_set_error_handler_off ();
-  int cholesky_result = gsl_linalg_cholesky_decomp (&AAT.matrix);
-  gsl_set_error_handler (old_handler);
-  if (cholesky_result) {
+  // solve AAT * AATinvc = c
+  if (solveATA (&AT.matrix, &AATinvc.vector, &AAT.matrix, &V.matrix, &s.vector, eps)) {
     cout << "NewFitterGSL::calc2ndOrderCorr: resorting to SVD" << endl;
-    // AAT is not positive definite, i.e. A does not have full column rank
-    // => use the SVD of AT to solve A lambdanew = gradf
-    
-    // ATcopy = AT
-    gsl_matrix_memcpy (&ATcopy.matrix, &AT.matrix);
-    
-    // SVD decomposition of Acopy
-    gsl_linalg_SV_decomp_jacobi (&ATcopy.matrix, &V.matrix, &s.vector);
-    // set small values to zero
-    double mins = eps*std::fabs (gsl_vector_get (&s.vector, 0));
-    for (int i = 0; i < ncon; ++i) {
-      if (std::fabs (gsl_vector_get (&s.vector, i)) <= mins) 
-        gsl_vector_set (&s.vector, i, 0);
-    }
-    gsl_linalg_SV_solve (&ATcopy.matrix, &V.matrix, &s.vector, &c.vector, &AATinvc.vector);
-  }
-  else {
-    gsl_linalg_cholesky_solve (&AAT.matrix, &c.vector, &AATinvc.vector);
   }
   
   // phat = -1*A^T*AATinvc+ 0*phat
@@ -1677,6 +2921,40 @@ void NewFitterGSL::calc2ndOrderCorr (gsl_vector *vecdxhat,
                                        
 }
 
+void NewFitterGSL::calc2ndOrderCorr (gsl_vector *vecdxhat, 
+                                     const SparseSymMatrix& MatM,   
+                                     gsl_vector *vecw) {  
+  assert (vecdxhat);
+  assert (vecdxhat->size == idim);
+  assert (MatM.getDim() == (int)idim);
+  assert (vecw);
+  assert (vecw->size == idim);
+  assert (idim == static_cast<unsigned int>(npar + ncon));
+
+  // Calculate 2nd order correction, as in the dense version:
+  // phat = -A^T*(A*A^T)^-1*c
+  gsl_vector_set_zero (vecdxhat);
+  if (ncon == 0) return;
+  addConstraints (vecdxhat);
+  
+  gsl_vector_set_zero (vecw);
+  double *AATinvc = vecw->block->data + npar;
+  for (int k = 0; k < ncon; ++k) AATinvc[k] = gsl_vector_get (vecdxhat, npar+k);
+  if (solveAAT (AATinvc, MatM)) {
+    cout << "NewFitterGSL::calc2ndOrderCorr: A*A^T is singular, using regularised A*A^T" << endl;
+  }
+  
+  double *phat = vecdxhat->block->data;
+  for (int k = 0; k < ncon; ++k) {
+    int kglobal = npar+k;
+    for (int l = 0; l < MatM.getColSize (kglobal); ++l) {
+      int i = MatM.getRow (kglobal, l);
+      if (i < npar) phat[i] -= MatM.getValue (kglobal, l)*AATinvc[k];
+    }
+    phat[kglobal] = 0;
+  }
+}
+
 int NewFitterGSL::solveSystem (      gsl_vector *vecdxscal, 
                                      double& detW,
                                const gsl_vector *vecyscal, 
@@ -1700,17 +2978,116 @@ int NewFitterGSL::solveSystem (      gsl_vector *vecdxscal,
   assert (vecw->size == idim);
   
   int result = 0;
+  inertiaZero = -1;
   
-  int iLU = solveSystemLU (vecdxscal, detW, vecyscal, MatMscal, MatW, vecw, epsLU);
-  if (iLU == 0) return result;
+  int iLDL = solveSystemLDL (vecdxscal, detW, vecyscal, MatMscal, MatW, epsLU);
+  if (iLDL == 0) return result;
   
   result = 1;
+  inertiaZero = -1;
+  TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_SVD);
   int iSVD = solveSystemSVD (vecdxscal, detW, vecyscal, MatMscal, MatW, MatW2, vecw, epsSV);
   if (iSVD == 0) return result;
   
   return -1;
 }
 
+int NewFitterGSL::solveSystemLDL (      gsl_vector *vecdxscal, 
+                                        double&     detW,
+                                  const gsl_vector *vecyscal,
+                                  const gsl_matrix *MatMscal,
+                                        gsl_matrix *MatW,   
+                                        double eps) {  
+  assert (vecdxscal);
+  assert (vecdxscal->size == idim);
+  assert (vecyscal);
+  assert (vecyscal->size == idim);
+  assert (MatMscal);
+  assert (MatMscal->size1 == idim && MatMscal->size2 == idim);
+  assert (MatW);
+  assert (MatW->size1 == idim && MatW->size2 == idim);
+  assert (ipivW.size() == idim);
+  
+  gsl_matrix_memcpy (MatW, MatMscal);
+  
+  detW = 0;
+  
+  int result = bunchKaufmanDecomp (MatW, &ipivW[0]);
+  if (debug>4)cout << "NewFitterGSL::solveSystem: bunchKaufmanDecomp result=" << result << endl;
+  if (result != 0) return 1;
+  
+  detW = bunchKaufmanDet (MatW, &ipivW[0], inertiaPos, inertiaNeg, inertiaZero);
+  if (debug>4)cout << "NewFitterGSL::solveSystem: determinant of W=" << detW 
+                   << ", inertia=(" << inertiaPos << ", " << inertiaNeg << ", " << inertiaZero << ")" << endl;
+  if (std::fabs(detW) < eps) return 2;
+  if (!std::isfinite(detW)) {
+    if (debug>0)cout << "NewFitterGSL::solveSystem: infinite determinant of W=" << detW << endl;
+    return 3;
+  }
+  if (debug>5) {
+    cout << "NewFitterGSL::solveSystem: after LDL^T decomposition: \n";
+    debug_print (MatW, "W");
+  }
+  // Solve W*dxscal = yscal
+  gsl_vector_memcpy (vecdxscal, vecyscal);
+  bunchKaufmanSolve (MatW, &ipivW[0], vecdxscal);
+  return 0;
+}
+
+int NewFitterGSL::correctInertia (      gsl_vector *vecdxscal, 
+                                        double&     detW,
+                                  const gsl_vector *vecyscal,
+                                  const gsl_vector *vece,
+                                  const gsl_matrix *MatMscal,
+                                        gsl_matrix *MatW,   
+                                        gsl_matrix *MatW2,   
+                                        gsl_vector *vecw,
+                                        double epsLU,
+                                        double epsSV
+                                 ) {
+  // Shift the Hessian of the chi2 w.r.t. the measured parameters
+  // by delta*1 in scaled units, i.e. by delta/perr^2, with increasing delta.
+  // The unmeasured parameters have no chi2 term; shifting them 
+  // as well would change the step where the chi2 does not curve at all.
+  assert (vecdxscal);
+  assert (vecyscal);
+  assert (vece);
+  assert (MatMscal || usesparse);
+  const double deltamax = 1E4;
+  double shift = 0;
+  for (double delta = inertiadelta; delta <= deltamax; delta *= 10) {
+    int result;
+    if (MatMscal) {
+      assert (MatW2);
+      gsl_matrix_memcpy (MatW2, MatMscal);
+      for (unsigned int i = 0; i < imeasured.size(); ++i) 
+        *gsl_matrix_ptr (MatW2, imeasured[i], imeasured[i]) += delta;
+      result = solveSystemLDL (vecdxscal, detW, vecyscal, MatW2, MatW, epsLU);
+    }
+    else {
+      for (unsigned int i = 0; i < imeasured.size(); ++i) 
+        Mscalsparse->add (imeasured[i], imeasured[i], delta - shift);
+      shift = delta;
+      result = solveSystem (vecdxscal, detW, vecyscal, *Mscalsparse, vecw, epsLU);
+    }
+    if (result == 0 && inertiaNeg == ncon && inertiaZero == 0) {
+      if (debug>2) cout << "NewFitterGSL::correctInertia: inertia corrected with delta=" << delta << endl;
+      return 0;
+    }
+  }
+  
+  // No shift helped: take the unmodified Newton step
+  if (debug>2) cout << "NewFitterGSL::correctInertia: inertia not corrected" << endl;
+  if (MatMscal) {
+    solveSystem (vecdxscal, detW, vecyscal, MatMscal, MatW, MatW2, vecw, epsLU, epsSV);
+  }
+  else {
+    Mscalsparse->assignScaled (*Msparse, vece->block->data);
+    solveSystem (vecdxscal, detW, vecyscal, *Mscalsparse, vecw, epsLU);
+  }
+  return 1;
+}
+
 int NewFitterGSL::solveSystemLU (      gsl_vector *vecdxscal, 
                                        double&     detW,
                                  const gsl_vector *vecyscal,
@@ -1788,21 +3165,121 @@ int NewFitterGSL::solveSystemSVD (      gsl_vector *vecdxscal,
   if (debug>0) cout << "solveSystemSVD called" << endl;
   
   gsl_matrix_memcpy (MatW, MatMscal);
-    
-  // SVD decomposition of MatW
-  gsl_linalg_SV_decomp_jacobi (MatW, MatW2, vecw);
-  // set small values to zero
-  double mins = eps*std::fabs (gsl_vector_get (vecw, 0));
-  if (debug>5) cout << "SV 0 = " << gsl_vector_get (vecw, 0) << endl;
+  int nzero = solveSVD (MatW, MatW2, vecw, vecyscal, vecdxscal, eps);
+  if (debug>5) cout << "SV 0 = " << gsl_vector_get (vecw, 0) << ", " << nzero << " singular values set to zero" << endl;
+  return 0;
+}  
+
+int NewFitterGSL::solveSystem (      gsl_vector *vecdxscal, 
+                                     double& detW,
+                               const gsl_vector *vecyscal, 
+                               const SparseSymMatrix& MatMscal,  
+                                     gsl_vector *vecw,
+                                     double eps) {  
+  assert (vecdxscal);
+  assert (vecdxscal->size == idim);
+  assert (vecyscal);
+  assert (vecyscal->size == idim);
+  assert (MatMscal.getDim() == (int)idim);
+  assert (vecw);
+  assert (vecw->size == idim);
+  
+  detW = 0;
+  inertiaZero = -1;
+  int result = ldl->factorize (MatMscal, eps);
+  if (debug>4) cout << "NewFitterGSL::solveSystem: sparse factorize result=" << result 
+                    << ", nonzero elements of M: " << MatMscal.getNNZ() 
+                    << ", of L: " << ldl->getNNZL() << endl;
+  if (result != 0) return 1;
+  detW = ldl->getDeterminant();
+  inertiaPos = ldl->getNPositive();
+  inertiaNeg = ldl->getNNegative();
+  inertiaZero = idim - inertiaPos - inertiaNeg;
+  if (!std::isfinite(detW)) return 2;
+  
+  // Solve Mscal*dxscal = yscal,
+  // with iterative refinement because the factorization does no pivoting
+  const double *yscal = vecyscal->block->data;
+  double *dxscal = vecdxscal->block->data;
+  double *r = vecw->block->data;
+  double amax = MatMscal.getMaxAbs();
+  double ynorm = 0;
   for (unsigned int i = 0; i < idim; ++i) {
-    if (std::fabs (gsl_vector_get (vecw, i)) <= mins) {
-      if (debug>5) cout << "Setting SV" << i << " = " << gsl_vector_get (vecw, i) << " to zero!" << endl;
-      gsl_vector_set (vecw, i, 0);
+    dxscal[i] = yscal[i];
+    if (std::fabs (yscal[i]) > ynorm) ynorm = std::fabs (yscal[i]);
+  }
+  ldl->solve (dxscal);
+  
+  for (int iref = 0; ; ++iref) {
+    // r = yscal - Mscal*dxscal
+    MatMscal.multiply (r, dxscal);
+    double rnorm = 0;
+    double dxnorm = 0;
+    for (unsigned int i = 0; i < idim; ++i) {
+      r[i] = yscal[i] - r[i];
+      if (std::fabs (r[i]) > rnorm) rnorm = std::fabs (r[i]);
+      if (std::fabs (dxscal[i]) > dxnorm) dxnorm = std::fabs (dxscal[i]);
     }
+    if (debug>4) cout << "NewFitterGSL::solveSystem: refinement step " << iref 
+                      << ", residual " << rnorm << endl;
+    if (!std::isfinite (rnorm)) return 3;
+    // stop when the backward error is small
+    if (rnorm <= 1E-12*(amax*dxnorm + ynorm)) break;
+    if (iref >= 3) return 4;
+    ldl->solve (r);
+    for (unsigned int i = 0; i < idim; ++i) dxscal[i] += r[i];
   }
-  gsl_linalg_SV_solve (MatW, MatW2, vecw, vecyscal, vecdxscal);
   return 0;
-}  
+}
+
+int NewFitterGSL::solveAAT (double *z, const SparseSymMatrix& MatM) {
+  assert (z);
+  assert (MatM.getDim() == (int)idim);
+  assert (AATsparse->getDim() == ncon);
+  
+  // The constraint derivatives A, stored column-wise in MatM, 
+  // sorted by parameter, i.e. the columns of A
+  std::vector<int> start (npar+1, 0);
+  for (int k = 0; k < ncon; ++k) 
+    for (int l = 0; l < MatM.getColSize (npar+k); ++l) 
+      if (MatM.getRow (npar+k, l) < npar) ++start[MatM.getRow (npar+k, l)+1];
+  for (int i = 0; i < npar; ++i) start[i+1] += start[i];
+  std::vector<int> pos (start.begin(), start.end()-1);
+  std::vector<int> con (start[npar]);
+  std::vector<double> der (start[npar]);
+  for (int k = 0; k < ncon; ++k) {
+    for (int l = 0; l < MatM.getColSize (npar+k); ++l) {
+      int i = MatM.getRow (npar+k, l);
+      if (i < npar) {
+        con[pos[i]] = k;
+        der[pos[i]++] = MatM.getValue (npar+k, l);
+      }
+    }
+  }
+  
+  // A*A^T: sum of the outer products of the columns of A
+  AATsparse->setZero();
+  for (int i = 0; i < npar; ++i) 
+    for (int l = start[i]; l < start[i+1]; ++l) 
+      for (int m = l; m < start[i+1]; ++m) 
+        AATsparse->add (con[l], con[m], der[l]*der[m]);
+
+  // A*A^T is positive semidefinite; if A does not have full rank,
+  // add a small multiple of the unit matrix
+  int result = 0;
+  if (ldlAAT->factorize (*AATsparse) || ldlAAT->getNNegative() > 0) {
+    double delta = 1E-10*AATsparse->getMaxAbs();
+    if (!(delta > 0)) delta = 1E-10;
+    for (int k = 0; k < ncon; ++k) AATsparse->add (k, k, delta);
+    result = 1;
+    if (ldlAAT->factorize (*AATsparse, 0)) {
+      for (int k = 0; k < ncon; ++k) z[k] = 0;
+      return 2;
+    }
+  }
+  ldlAAT->solve (z);
+  return result;
+}
 
 gsl_matrix_view NewFitterGSL::calcZ (int& rankA, gsl_matrix *MatW1,  gsl_matrix *MatW2, 
                                      gsl_vector *vecw1, gsl_vector *vecw2, 
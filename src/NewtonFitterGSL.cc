@@ -14,6 +14,7 @@
  *
  * \b Changelog:
  * - 26.9.08 BL: Correct parameter counting (discared fixed parameters)
+ * - 16.10.2026 Phase hooks for the tracer
  *
  * \b CVS Log messages:
  * - $Log: NewtonFitterGSL.cc,v $
@@ -73,13 +74,11 @@ using std::endl;
 using std::abs;
 
 static int nitdebug = 100;
-static int nitcalc = 0;
-static int nitsvd = 0;
 
 // constructor
 NewtonFitterGSL::NewtonFitterGSL() 
   : npar (0), ncon (0), nsoft (0), nunm(0), ierr(0), nit(0), fitprob(0), chi2(0),
-    idim (0),
+    phasetracer (0), idim (0),
     x(0), xold(0), xbest(0), dx(0), dxscal (0), grad(0), y(0), yscal(0), 
     perr(0), v1 (0), v2(0), Meval (0),
     M(0), Mscal (0), M1(0), M2 (0), M3 (0), M4 (0), M5 (0), Mevec (0), 
@@ -129,6 +128,12 @@ double NewtonFitterGSL::fit() {
   // order parameters etc
   initialize();
   
+#ifndef FIT_TRACEOFF
+  phasetracer = (tracer && tracer->tracesPhases()) ? tracer : 0;
+#endif   
+  // the fit objects report their cache updates to the tracer until the end of the fit
+  PhaseTracerScope scope (phasetracer, *this);
+  
   // initialize eta, etasv, y   
   assert (x && x->size == idim);
   assert (dx && dx->size == idim);
@@ -236,14 +241,20 @@ double NewtonFitterGSL::fit() {
     // Store old x values in xold
     fillxold();    
     // Fill errors into perr
-    fillperr();    
+    {
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_PARERRORS);
+      fillperr();    
+    }
  
-    // Compose M:
-    calcM(); 
+    {
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_ASSEMBLY);
+      // Compose M:
+      calcM(); 
     
-    // Now, calculate the result vector y with the values of the derivatives
-    // d chi^2/d x
-    calcy();
+      // Now, calculate the result vector y with the values of the derivatives
+      // d chi^2/d x
+      calcy();
+    }
 
     if (debug>3 && (nit==0 || nit<nitdebug)) {
       cout << "After setting up equations: \n";
@@ -277,7 +288,10 @@ double NewtonFitterGSL::fit() {
       debug_print (xbest, "new parameters");
     }  
 
-    calcy();
+    {
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_ASSEMBLY);
+      calcy();
+    }
     //cout << "New fval: " << 0.5*pow(gsl_blas_dnrm2 (yscal), 2) << endl;
     chi2new = calcChi2();
     //cout << "chi2: " << chi2old << " -> " << chi2new << endl;
@@ -326,6 +340,7 @@ double NewtonFitterGSL::fit() {
 // ERROR CALCULATION 
 
   if (!ierr) {
+    TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_COVARIANCE);
 
     calcCovMatrix();  
 
@@ -489,7 +504,6 @@ int NewtonFitterGSL::getIterations() const {return nit;}
 
 int NewtonFitterGSL::calcDx () {
     if (debug>1)cout << "entering calcDx" << endl;
-    nitcalc++;
     // from x_(n+1) = x_n - y/y' = x_n - M^(-1)*y we have M*(x_n-x_(n+1)) = y, 
     // which we solve for dx = x_n-x_(n+1) and hence x_(n+1) = x_n-dx
   
@@ -500,12 +514,15 @@ int NewtonFitterGSL::calcDx () {
     
     int ifail = 0;
     
-    int signum;
-    int result = gsl_linalg_LU_decomp (M1, permM, &signum);
-    if (debug>1)cout << "calcDx: gsl_linalg_LU_decomp result=" << result << endl;
-    // Solve M1*dx = y
-    ifail = gsl_linalg_LU_solve (M1, permM, yscal, dxscal);
-    if (debug>1)cout << "calcDx: gsl_linalg_LU_solve result=" << ifail << endl;
+    {
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_FACTORIZATION);
+      int signum;
+      int result = gsl_linalg_LU_decomp (M1, permM, &signum);
+      if (debug>1)cout << "calcDx: gsl_linalg_LU_decomp result=" << result << endl;
+      // Solve M1*dx = y
+      ifail = gsl_linalg_LU_solve (M1, permM, yscal, dxscal);
+      if (debug>1)cout << "calcDx: gsl_linalg_LU_solve result=" << ifail << endl;
+    }
     
     if (ifail != 0) {
       cerr << "NewtonFitter::calcDx: ifail from gsl_linalg_LU_solve=" << ifail << endl;
@@ -523,7 +540,10 @@ int NewtonFitterGSL::calcDx () {
     gsl_vector_memcpy (xbest, xold);
     chi2best = chi2old;
     
-    optimizeScale();
+    {
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_LINESEARCH);
+      optimizeScale();
+    }
     
     if (scalebest < 0.01) {
       if (debug > 1) cout << "NewtonFitter::calcDx: reverting to calcDxSVD\n";
@@ -536,7 +556,6 @@ int NewtonFitterGSL::calcDx () {
 int NewtonFitterGSL::calcDxSVD () {
     //cout << "entering calcDxSVD" << endl;
 
-    nitsvd++;
     // from x_(n+1) = x_n - y/y' = x_n - M^(-1)*y we have M*(x_n-x_(n+1)) = y, 
     // which we solve for dx = x_n-x_(n+1) and hence x_(n+1) = x_n-dx
   
@@ -545,6 +564,7 @@ int NewtonFitterGSL::calcDxSVD () {
 //     cout << "Complete system:\n";
 //     printMy(M, y, idim);
      // Get eigenvalues and eigenvectors of Mscal
+     TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_SVD);
      int ierr=0;
      gsl_matrix_memcpy (M1, Mscal);
      if (debug > 3) cout << "NewtonFitterGSL::calcDxSVD: Calling gsl_eigen_symmv" << endl;
@@ -628,7 +648,10 @@ int NewtonFitterGSL::calcDxSVD () {
        debug_print (dxscal, "dxscal");
      }
      
-     optimizeScale();
+     {
+       TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_LINESEARCH);
+       optimizeScale();
+     }
      
      --ndim;
      
@@ -824,6 +847,7 @@ int NewtonFitterGSL::calcM (bool errorpropagation) {
   }  
 
   // Rescale columns and rows by perr
+  TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_SCALING);
   for (unsigned int i = 0; i < idim; ++i) 
     for (unsigned int j = 0; j < idim; ++j) 
       gsl_matrix_set (Mscal, i, j,  
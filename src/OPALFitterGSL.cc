@@ -7,6 +7,9 @@
  *
  * \b Changelog:
  * - 2.10.08 BL: First version, based on OPALFitter
+ * - 16.10.2026 Warm start from given parameters
+ * - 16.10.2026 Cholesky solver for S and V, V factorized once per fit
+ * - 16.10.2026 Phase hooks for the tracer
  *
  * \b CVS Log messages:
  * - $Log: OPALFitterGSL.cc,v $
@@ -62,6 +65,7 @@
 #include <gsl/gsl_linalg.h>
 #include <gsl/gsl_blas.h>
 #include <gsl/gsl_cdf.h>
+#include <gsl/gsl_errno.h>
 
 using std::cout;
 using std::cerr;
@@ -73,6 +77,7 @@ using std::abs;
 OPALFitterGSL::OPALFitterGSL() 
 : npar(0), nmea(0), nunm(0), ncon(0), ierr (0), nit (0),
   fitprob(0), chi2(0),
+  solvermode (SOLVER_CHOLESKY), phasetracer (0),
   f(0), r(0), Fetaxi (0), S(0), Sinv (0), SinvFxi(0), SinvFeta (0), 
   W1(0), G (0), H (0), HU (0), IGV (0), V(0), VLU(0), Vinv(0), Vnew (0), 
   Minv(0), dxdt(0), Vdxdt(0),
@@ -212,6 +217,12 @@ double OPALFitterGSL::fit() {
   // order parameters etc
   initialize();
   
+#ifndef FIT_TRACEOFF
+  phasetracer = (tracer && tracer->tracesPhases()) ? tracer : 0;
+#endif   
+  // the fit objects report their cache updates to the tracer until the end of the fit
+  PhaseTracerScope scope (phasetracer, *this);
+  
   assert (f && (int)f->size == ncon);
   assert (r && (int)r->size == ncon);
   assert (Fetaxi && (int)Fetaxi->size1 == ncon && (int)Fetaxi->size2 == npar);
@@ -272,6 +283,20 @@ double OPALFitterGSL::fit() {
     }
   }
   
+  // Warm start: take parameters from setStartValues
+  if (startpar.size() > 0) {
+    if ((int)startpar.size() == npar) {
+      for (int i = 0; i < npar; ++i) gsl_vector_set (etaxi, i, startpar[i]);
+      updateFitObjects (etaxi->block->data);
+      if (debug) cout << "OPALFitterGSL::fit: warm start" << endl;
+    }
+    else {
+      cerr << "OPALFitterGSL::fit: start values for npar=" << startpar.size()
+           << " do not match npar=" << npar << " => ignored" << endl;
+    }
+    startpar.clear();
+  }
+  
   /// initialize Fetaxi ( = d F / d eta,xi)
   gsl_matrix_set_zero (Fetaxi);
   for (int k=0; k < ncon; k++) {
@@ -302,6 +327,37 @@ double OPALFitterGSL::fit() {
   bool scut = false;
   bool calcerr = true;
   
+  // Get covariance matrix; it does not change during the fit,
+  // so it is factorized only once
+  gsl_matrix_set_zero (V);
+  for (unsigned int ifitobj = 0; ifitobj<fitobjects.size(); ++ifitobj) {
+    fitobjects[ifitobj]->addToGlobCov (V->block->data, V->tda);
+  }  
+  if (debug>1)  debug_print (V, "V");
+          
+  gsl_matrix_memcpy (VLU, &Vetaeta.matrix);  
+  
+  // Cholesky: VLU = L*L^T, used for the chi2 calculation 
+  bool usechol = (solvermode == SOLVER_CHOLESKY);
+  if (usechol && choleskyDecomp (VLU) != 0) {
+    if (debug) cout << "OPALFitterGSL::fit: V not positive definite, using LU decomposition" << endl;
+    gsl_matrix_memcpy (VLU, &Vetaeta.matrix);  
+    usechol = false;
+  }
+  if (!usechol) {
+    // invert covariance matrix (needed for chi2 calculation later)
+    int signum;
+    int result;
+    result = gsl_linalg_LU_decomp (VLU, permV, &signum);
+    if (debug>1)cout << "gsl_linalg_LU_decomp result=" << result << endl;
+    if (debug>3)  debug_print (VLU, "VLU");
+
+    result = gsl_linalg_LU_invert (VLU, permV, Vinv);
+    if (debug>1)cout << "gsl_linalg_LU_invert result=" << result << endl;
+
+    if (debug>2) debug_print (Vinv, "Vinv");
+  }
+  
 #ifndef FIT_TRACEOFF
   if (tracer) tracer->initialize (*this);
 #endif   
@@ -321,6 +377,7 @@ double OPALFitterGSL::fit() {
       }
       
 
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_ASSEMBLY);
       gsl_matrix_set_zero (Fetaxi);
       for (int k = 0; k < ncon; ++k)  {
         constraints[k]->getDerivatives(Fetaxi->size2, Fetaxi->block->data+k*Fetaxi->tda);
@@ -333,30 +390,9 @@ double OPALFitterGSL::fit() {
       chit0 = chit;
     }
     
-    // Get covariance matrix
-    gsl_matrix_set_zero (V);
-    
-    for (unsigned int ifitobj = 0; ifitobj<fitobjects.size(); ++ifitobj) {
-      fitobjects[ifitobj]->addToGlobCov (V->block->data, V->tda);
-    }  
-    if (debug>1)  debug_print (V, "V");
-            
-    gsl_matrix_memcpy (VLU, &Vetaeta.matrix);  
-        
-    // invert covariance matrix (needed for chi2 calculation later)
-    
-    int signum;
-    int result;
-    result = gsl_linalg_LU_decomp (VLU, permV, &signum);
-    if (debug>1)cout << "gsl_linalg_LU_decomp result=" << result << endl;
-    if (debug>3)  debug_print (VLU, "VLU");
-
-    result = gsl_linalg_LU_invert (VLU, permV, Vinv);
-    if (debug>1)cout << "gsl_linalg_LU_invert result=" << result << endl;
-
-    if (debug>2) debug_print (Vinv, "Vinv");
-    
 // *-- Evaluate f and S.
+    {
+    TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_ASSEMBLY);
     for (int k = 0; k < ncon; ++k) {
       gsl_vector_set (f, k, constraints[k]->getValue());
     }  
@@ -394,15 +430,25 @@ double OPALFitterGSL::fit() {
     }
     
     if (debug>1) debug_print (S, "S");
+    }
     
 // *-- Invert S to Sinv; S is destroyed here!
 // S is symmetric and positive definite
+// Cholesky: S is replaced by L with S = L*L^T, no inverse is formed
 
-   gsl_linalg_LU_decomp (S, permS, &signum);
-   inverr = gsl_linalg_LU_invert (S, permS, Sinv); 
+   {
+   TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_FACTORIZATION);
+   if (usechol) {
+     inverr = choleskyDecomp (S);
+   }
+   else {
+     int signum;
+     gsl_linalg_LU_decomp (S, permS, &signum);
+     inverr = gsl_linalg_LU_invert (S, permS, Sinv); 
+   }
 
    if (inverr != 0) {
-     cerr << "S: gsl_linalg_LU_invert error " << inverr << endl;
+     cerr << "S: " << (usechol ? "Cholesky decomposition" : "gsl_linalg_LU_invert") << " error " << inverr << endl;
      ierr = 7;
      calcerr = false;
      break;
@@ -410,19 +456,36 @@ double OPALFitterGSL::fit() {
    
    // Calculate S^1*r here, we will need it
    // Store it in lambda!
-   // lambda = 1*Sinv*r + 0*lambda; Sinv is symmetric
-   gsl_blas_dsymv (CblasUpper, 1, Sinv, r, 0, lambda);
+   if (usechol) {
+     // lambda is solution of S*lambda = r
+     gsl_vector_memcpy (lambda, r);
+     gsl_linalg_cholesky_svx (S, lambda);
+   }
+   else {
+     // lambda = 1*Sinv*r + 0*lambda; Sinv is symmetric
+     gsl_blas_dsymv (CblasUpper, 1, Sinv, r, 0, lambda);
+   }
+   }
 
 // *-- Calculate new unmeasured quantities, if any
 
     if (nunm > 0) {
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_FACTORIZATION);
       // Fxi is the part of Fetaxi containing the unmeasured quantities, if any    
       gsl_matrix_view Fxi = gsl_matrix_submatrix (Fetaxi,  0, nmea, ncon, nunm);
       // W1 = Fxi^T * Sinv * Fxi
-      // SinvFxi = 1*Sinv*Fxi + 0*SinvFxi
-      gsl_blas_dsymm (CblasLeft, CblasUpper, 1, Sinv, &Fxi.matrix, 0,  SinvFxi);
-      // W1 = 1*Fxi^T*SinvFxi + 0*W1
-      gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, &Fxi.matrix, SinvFxi, 0, W1);
+      if (usechol) {
+        // W1 = (L^-1*Fxi)^T * (L^-1*Fxi); here SinvFxi holds L^-1*Fxi
+        gsl_matrix_memcpy (SinvFxi, &Fxi.matrix);
+        gsl_blas_dtrsm (CblasLeft, CblasLower, CblasNoTrans, CblasNonUnit, 1, S, SinvFxi);
+        gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, SinvFxi, SinvFxi, 0, W1);
+      }
+      else {
+        // SinvFxi = 1*Sinv*Fxi + 0*SinvFxi
+        gsl_blas_dsymm (CblasLeft, CblasUpper, 1, Sinv, &Fxi.matrix, 0,  SinvFxi);
+        // W1 = 1*Fxi^T*SinvFxi + 0*W1
+        gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, &Fxi.matrix, SinvFxi, 0, W1);
+      }
       
       if (debug > 1) {
         debug_print (W1, "W1");
@@ -488,12 +551,20 @@ double OPALFitterGSL::fit() {
     // lambda is already set to Sinv*r, we just need to add Sinv*Fxi*dxi
     
     if (nunm > 0) {
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_LAMBDAS);
       // Fxi is the part of Fetaxi containing the unmeasured quantities, if any    
       gsl_matrix_view Fxi = gsl_matrix_submatrix (Fetaxi,  0, nmea, ncon, nunm);
       // calculate Fxidxi = 1*Fxi*dxi + 0*Fxidxi
       gsl_blas_dgemv (CblasNoTrans, 1, &Fxi.matrix, dxi, 0, Fxidxi);
-      // add to existing lambda: lambda = 1*Sinv*Fxidxi + 1*lambda; Sinv is symmetric
-      gsl_blas_dsymv (CblasUpper, 1, Sinv, Fxidxi, 1, lambda);
+      if (usechol) {
+        // solve S*z = Fxidxi, and add z to lambda
+        gsl_linalg_cholesky_svx (S, Fxidxi);
+        gsl_vector_add (lambda, Fxidxi);
+      }
+      else {
+        // add to existing lambda: lambda = 1*Sinv*Fxidxi + 1*lambda; Sinv is symmetric
+        gsl_blas_dsymv (CblasUpper, 1, Sinv, Fxidxi, 1, lambda);
+      }
     
     }
 
@@ -523,9 +594,12 @@ double OPALFitterGSL::fit() {
              << endl;
       }
     }
-    gsl_matrix_set_zero (Fetaxi);
-    for (int k=0; k < ncon; k++) {
-      constraints[k]->getDerivatives(Fetaxi->size2, Fetaxi->block->data+k*Fetaxi->tda);
+    {
+      TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_ASSEMBLY);
+      gsl_matrix_set_zero (Fetaxi);
+      for (int k=0; k < ncon; k++) {
+        constraints[k]->getDerivatives(Fetaxi->size2, Fetaxi->block->data+k*Fetaxi->tda);
+      }
     }
     if (debug>1)  debug_print (Fetaxi, "2: Fetaxi");
   
@@ -535,13 +609,22 @@ double OPALFitterGSL::fit() {
     // y_eta = y - eta
     gsl_vector_memcpy (y_eta, y);
     gsl_vector_sub (y_eta, &eta.vector);
-    // Now calculate Vinv*y_eta [ as solution to V* Vinvy_eta = y_eta]
-    // Vinvy_eta = 1*Vinv*y_eta + 0*Vinvy_eta; Vinv is symmetric
-    gsl_blas_dsymv (CblasUpper, 1, Vinv, y_eta, 0, Vinvy_eta);
-     // Now calculate y_eta *Vinvy_eta
-    gsl_blas_ddot (y_eta, Vinvy_eta, &chit);
+    if (usechol) {
+      // chit = y_eta^T * (L*L^T)^-1 * y_eta = |L^-1*y_eta|^2;
+      // here Vinvy_eta holds L^-1*y_eta
+      gsl_vector_memcpy (Vinvy_eta, y_eta);
+      gsl_blas_dtrsv (CblasLower, CblasNoTrans, CblasNonUnit, VLU, Vinvy_eta);
+      gsl_blas_ddot (Vinvy_eta, Vinvy_eta, &chit);
+    }
+    else {
+      // Now calculate Vinv*y_eta [ as solution to V* Vinvy_eta = y_eta]
+      // Vinvy_eta = 1*Vinv*y_eta + 0*Vinvy_eta; Vinv is symmetric
+      gsl_blas_dsymv (CblasUpper, 1, Vinv, y_eta, 0, Vinvy_eta);
+       // Now calculate y_eta *Vinvy_eta
+      gsl_blas_ddot (y_eta, Vinvy_eta, &chit);
+    }
 
-    if (debug > 1) {
+    if (debug > 1 && !usechol) {
     for (int i = 0; i < nmea; ++i) 
       for (int j = 0; j < nmea; ++j) {
         double dchit = (gsl_vector_get (y_eta, i)) * 
@@ -643,7 +726,7 @@ double OPALFitterGSL::fit() {
 // *-- Turn chisq into probability.
   fitprob = (ncon-nunm > 0) ? gsl_cdf_chisq_Q(chinew,ncon-nunm) : 0.5;
   chi2 = chinew;
-  
+
 // *-- End of iterations - calculate errors.
 
 // The result will (ultimately) be stored in Vnew
@@ -661,6 +744,7 @@ double OPALFitterGSL::fit() {
   if (debug) cout << "OPALFitterGSL: calcerr = " << calcerr << endl;
   
   if (calcerr) {
+    TracerPhase phase (phasetracer, *this, BaseTracer::PHASE_COVARIANCE);
   
 // *-- As a first step, calculate Minv as in 9.4.2 of Benno's book chapter 
 //                    (in O.Behnke et al "Data Analysis in High Energy Physics")
@@ -695,11 +779,16 @@ double OPALFitterGSL::fit() {
 // S is symmetric and positive definite
 
    int signum;
-   gsl_linalg_LU_decomp (S, permS, &signum);
-   inverr = gsl_linalg_LU_invert (S, permS, Sinv); 
+   if (usechol) {
+     inverr = choleskyDecomp (S);
+   }
+   else {
+     gsl_linalg_LU_decomp (S, permS, &signum);
+     inverr = gsl_linalg_LU_invert (S, permS, Sinv); 
+   }
 
    if (inverr != 0) {
-     cerr << "S: gsl_linalg_LU_invert error " << inverr << " in error calculation" << endl;
+     cerr << "S: " << (usechol ? "Cholesky decomposition" : "gsl_linalg_LU_invert") << " error " << inverr << " in error calculation" << endl;
      ierr = -1;
      return -1;
    }
@@ -709,10 +798,18 @@ double OPALFitterGSL::fit() {
 //  (same as W1, but for measured parameters) 
 // G = Feta^T * Sinv * Feta
 
-    // SinvFeta[ncon][nmea] = 1*Sinv[ncon][ncon]*Feta[ncon][nmea] + 0*SinvFeta
-    gsl_blas_dsymm (CblasLeft, CblasUpper, 1, Sinv, &Feta.matrix, 0,  SinvFeta);
-    // G[nmea][nmea] = 1*Feta^T[nmea][ncon]*SinvFeta[ncon][nmea] + 0*G
-    gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, &Feta.matrix, SinvFeta, 0, G);
+    if (usechol) {
+      // G = (L^-1*Feta)^T * (L^-1*Feta); here SinvFeta holds L^-1*Feta
+      gsl_matrix_memcpy (SinvFeta, &Feta.matrix);
+      gsl_blas_dtrsm (CblasLeft, CblasLower, CblasNoTrans, CblasNonUnit, 1, S, SinvFeta);
+      gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, SinvFeta, SinvFeta, 0, G);
+    }
+    else {
+      // SinvFeta[ncon][nmea] = 1*Sinv[ncon][ncon]*Feta[ncon][nmea] + 0*SinvFeta
+      gsl_blas_dsymm (CblasLeft, CblasUpper, 1, Sinv, &Feta.matrix, 0,  SinvFeta);
+      // G[nmea][nmea] = 1*Feta^T[nmea][ncon]*SinvFeta[ncon][nmea] + 0*G
+      gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, &Feta.matrix, SinvFeta, 0, G);
+    }
 
     if (debug>2) debug_print (G, "G(1)");
 
@@ -724,10 +821,18 @@ double OPALFitterGSL::fit() {
       // Fxi is the part of Fetaxi containing the unmeasured quantities, if any    
       gsl_matrix_view Fxi = gsl_matrix_submatrix (Fetaxi,  0, nmea, ncon, nunm);
       // H = Feta^T * Sinv * Fxi
-      // SinvFxi[ncon][nunm] = 1*Sinv[ncon][ncon]*Fxi[ncon][nunm] + 0*SinvFxi
-      gsl_blas_dsymm (CblasLeft, CblasUpper, 1, Sinv, &Fxi.matrix, 0,  SinvFxi);
-      // H[nmea][nunm] = 1*Feta^T[nmea][ncon]*SinvFxi[ncon][nunm] + 0*H
-      gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, &Feta.matrix, SinvFxi, 0, H);
+      if (usechol) {
+        // H = (L^-1*Feta)^T * (L^-1*Fxi); here SinvFxi holds L^-1*Fxi
+        gsl_matrix_memcpy (SinvFxi, &Fxi.matrix);
+        gsl_blas_dtrsm (CblasLeft, CblasLower, CblasNoTrans, CblasNonUnit, 1, S, SinvFxi);
+        gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, SinvFeta, SinvFxi, 0, H);
+      }
+      else {
+        // SinvFxi[ncon][nunm] = 1*Sinv[ncon][ncon]*Fxi[ncon][nunm] + 0*SinvFxi
+        gsl_blas_dsymm (CblasLeft, CblasUpper, 1, Sinv, &Fxi.matrix, 0,  SinvFxi);
+        // H[nmea][nunm] = 1*Feta^T[nmea][ncon]*SinvFxi[ncon][nunm] + 0*H
+        gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, &Feta.matrix, SinvFxi, 0, H);
+      }
 
       if (debug>2) debug_print (H, "H");
       
@@ -738,11 +843,23 @@ double OPALFitterGSL::fit() {
       gsl_matrix *Uinv = W1;
       gsl_matrix_view U = gsl_matrix_submatrix (Minv, nmea, nmea, nunm, nunm);
       // Uinv = Fxi^T * Sinv * Fxi
-      // Uinv[nunm][nunm] = 1*Fxi^T[nunm][ncon]*SinvFxi[ncon][nunm] + 0*W1
-      gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, &Fxi.matrix, SinvFxi, 0, Uinv);
+      if (usechol) {
+        // Uinv = (L^-1*Fxi)^T * (L^-1*Fxi); U is needed explicitly,
+        // it is the covariance matrix of the unmeasured parameters
+        gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, SinvFxi, SinvFxi, 0, Uinv);
+        inverr = choleskyDecomp (Uinv);
+        if (inverr == 0) {
+          gsl_linalg_cholesky_invert (Uinv);
+          gsl_matrix_memcpy (&U.matrix, Uinv);
+        }
+      }
+      else {
+        // Uinv[nunm][nunm] = 1*Fxi^T[nunm][ncon]*SinvFxi[ncon][nunm] + 0*W1
+        gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1, &Fxi.matrix, SinvFxi, 0, Uinv);
       
-      gsl_linalg_LU_decomp (Uinv, permU, &signum);
-      inverr = gsl_linalg_LU_invert (Uinv, permU, &U.matrix); 
+        gsl_linalg_LU_decomp (Uinv, permU, &signum);
+        inverr = gsl_linalg_LU_invert (Uinv, permU, &U.matrix); 
+      }
             
       if (debug>2) debug_print (&U.matrix, "U"); 
       if (debug > 2) {
@@ -754,7 +871,7 @@ double OPALFitterGSL::fit() {
       }
       
       if (inverr != 0) {
-        cerr << "U: gsl_linalg_LU_invert error " << inverr << " in error calculation " << endl;
+        cerr << "U: " << (usechol ? "Cholesky decomposition" : "gsl_linalg_LU_invert") << " error " << inverr << " in error calculation " << endl;
         ierr = -1;
         return -1;
       }
@@ -835,8 +952,15 @@ double OPALFitterGSL::fit() {
       gsl_matrix_view Vdetadt = gsl_matrix_submatrix (Vdxdt, 0, 0, nmea, nmea);
       if (debug > 3) cout << "after Vdetadt" << endl;
       
-      // detadt = - Minvetaeta * Fetat = -1 * Minvetaeta * (-1) * Vinv + 0 * detadt   // replace by symm?
-      gsl_blas_dgemm (CblasNoTrans, CblasNoTrans, 1, &Minvetaeta.matrix, Vinv, 0, &detadt.matrix);
+      if (usechol) {
+        // Without Vinv: Minvetaeta = Vetaeta * IGV, therefore
+        // detadt = Vetaeta * (1 - G*Vetaeta) * Vinv = 1 - Vetaeta*G = IGV^T
+        gsl_matrix_transpose_memcpy (&detadt.matrix, IGV);
+      }
+      else {
+        // detadt = - Minvetaeta * Fetat = -1 * Minvetaeta * (-1) * Vinv + 0 * detadt   // replace by symm?
+        gsl_blas_dgemm (CblasNoTrans, CblasNoTrans, 1, &Minvetaeta.matrix, Vinv, 0, &detadt.matrix);
+      }
       if (debug>2) debug_print (&detadt.matrix, "deta/dt");
       
       // Vdetadt = 1 * Vetaeta * detadt^T + 0* Vdetadt
@@ -858,8 +982,16 @@ double OPALFitterGSL::fit() {
       
         gsl_matrix_view dxidt = gsl_matrix_submatrix (dxdt, nmea, 0, nunm, nmea);      //[nunm][nmea]
         if (debug > 3) cout << "after dxidt" << endl;
-        // dxidt[nunm][nmea] = - Minvxieta * Fetat = -1 * Minvxieta[nunm][nmea] * Vinv[nmea][nmea] + 0 * dxidt
-        gsl_blas_dgemm (CblasNoTrans, CblasNoTrans, 1, &Minvxieta.matrix, Vinv, 0, &dxidt.matrix);   //ok
+        if (usechol) {
+          // Without Vinv: Minvxieta = -(Vetaeta*HU)^T, therefore
+          // dxidt = -HU^T * Vetaeta * Vinv = -HU^T
+          gsl_matrix_transpose_memcpy (&dxidt.matrix, HU);
+          gsl_matrix_scale (&dxidt.matrix, -1);
+        }
+        else {
+          // dxidt[nunm][nmea] = - Minvxieta * Fetat = -1 * Minvxieta[nunm][nmea] * Vinv[nmea][nmea] + 0 * dxidt
+          gsl_blas_dgemm (CblasNoTrans, CblasNoTrans, 1, &Minvxieta.matrix, Vinv, 0, &dxidt.matrix);   //ok
+        }
         if (debug>2) debug_print (&dxidt.matrix, "dxi/dt");
      
         // Vdxdt = V * dxdt^T => Vdxdt[nmea][npar]
@@ -1065,6 +1197,39 @@ double OPALFitterGSL::getChi2() const {return chi2;}
 int OPALFitterGSL::getDoF() const {return ncon-nunm;}
 int OPALFitterGSL::getIterations() const {return nit;}
 
+void OPALFitterGSL::setStartValues (int npar_, const double *par, int ncon_, const double *lambda_) {
+  assert (npar_ >= 0 && (npar_ == 0 || par));
+  if (ncon_ != 0 || lambda_) {
+    cerr << "OPALFitterGSL::setStartValues: this fitter takes no start values for the Lagrange multipliers"
+         << " => start values rejected" << endl;
+    startpar.clear();
+    return;
+  }
+  startpar.assign (par, par+npar_);
+}
+
+bool OPALFitterGSL::setStartValuesFromLastFit () {
+  if (!etaxi || ierr || npar <= 0 || (int)etaxi->size != npar) return false;
+  startpar.resize (npar);
+  return getSolution (npar, &startpar[0]);
+}
+
+bool OPALFitterGSL::getSolution (int npar_, double *par, int ncon_, double *lambda_) const {
+  if (!etaxi || (int)etaxi->size != npar || npar_ != npar || (ncon_ != 0 && ncon_ != ncon)) return false;
+  if (ncon_ && (!lambda || (int)lambda->size != ncon)) return false;
+  assert (par);
+  assert (ncon_ == 0 || lambda_);
+  for (int i = 0; i < npar; ++i) par[i] = gsl_vector_get (etaxi, i);
+  for (int k = 0; k < ncon_; ++k) lambda_[k] = gsl_vector_get (lambda, k);
+  return true;
+}
+
+void OPALFitterGSL::setSolverMode (int mode) {
+  assert (mode == SOLVER_LU || mode == SOLVER_CHOLESKY);
+  solvermode = mode;
+}
+int OPALFitterGSL::getSolverMode () const {return solvermode;}
+
 void OPALFitterGSL::ini_gsl_permutation (gsl_permutation *&p, unsigned int size) {
   if (p) {
     if (p->size != size) {
@@ -1102,6 +1267,28 @@ void OPALFitterGSL::ini_gsl_matrix (gsl_matrix *&m, unsigned int size1, unsigned
     if (size1*size2 > 0) m = gsl_matrix_alloc (size1, size2);
 }
 
+int OPALFitterGSL::choleskyDecomp (gsl_matrix *A) {
+  // Same result as gsl_linalg_cholesky_decomp, but failure is signalled
+  // only by the return value, without calling the GSL error handler
+  assert (A && A->size1 == A->size2);
+  int n = A->size1;
+  for (int j = 0; j < n; ++j) {
+    double s = gsl_matrix_get (A, j, j);
+    for (int k = 0; k < j; ++k) s -= gsl_matrix_get (A, j, k)*gsl_matrix_get (A, j, k);
+    if (!(s > 0)) return GSL_EDOM;
+    double ljj = std::sqrt (s);
+    gsl_matrix_set (A, j, j, ljj);
+    for (int i = j+1; i < n; ++i) {
+      double t = gsl_matrix_get (A, i, j);
+      for (int k = 0; k < j; ++k) t -= gsl_matrix_get (A, i, k)*gsl_matrix_get (A, j, k);
+      gsl_matrix_set (A, i, j, t/ljj);
+    }
+  }
+  for (int i = 0; i < n; ++i) 
+    for (int j = i+1; j < n; ++j) gsl_matrix_set (A, i, j, gsl_matrix_get (A, j, i));
+  return 0;
+}
+
 void OPALFitterGSL::setDebug (int debuglevel) {
   debug = debuglevel;
 }
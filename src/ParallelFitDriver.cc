@@ -0,0 +1,106 @@
+/*! \file
+ *  \brief Implements class ParallelFitDriver
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#undef NDEBUG
+
+#include "ParallelFitDriver.h"
+
+#include "BaseEvent.h"
+#include "BaseFitter.h"
+
+#include <cassert>
+#include <thread>
+
+ParallelFitDriver::ParallelFitDriver (int nthreads_)
+: nthreads (1), nextevent (0)
+{
+  setNThreads (nthreads_);
+}
+
+ParallelFitDriver::~ParallelFitDriver() {}
+
+void ParallelFitDriver::setNThreads (int nthreads_) {
+  nthreads = nthreads_ > 0 ? nthreads_ : std::thread::hardware_concurrency();
+  if (nthreads < 1) nthreads = 1;
+}
+
+int ParallelFitDriver::getNThreads () const {return nthreads;}
+
+int ParallelFitDriver::fitEvents (std::vector<BaseEvent *>& events) {
+  FitResult empty = {0, 0, 0, 0, -1, -1};
+  results.assign (events.size(), empty);
+  nextevent = 0;
+
+  int nworkers = nthreads < (int)events.size() ? nthreads : events.size();
+  std::vector<BaseFitter *> fitters (nworkers > 0 ? nworkers : 0);
+  for (int i = 0; i < nworkers; ++i) fitters[i] = createFitter();
+
+  if (nworkers == 1) {
+    work (events, *fitters[0]);
+  }
+  else if (nworkers > 1) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < nworkers; ++i) {
+      threads.push_back (std::thread (&ParallelFitDriver::work, this, std::ref (events), std::ref (*fitters[i])));
+    }
+    for (int i = 0; i < nworkers; ++i) threads[i].join();
+  }
+
+  for (int i = 0; i < nworkers; ++i) delete fitters[i];
+
+  int nok = 0;
+  for (unsigned int iev = 0; iev < results.size(); ++iev) if (results[iev].ierr == 0) ++nok;
+  return nok;
+}
+
+void ParallelFitDriver::work (std::vector<BaseEvent *>& events, BaseFitter& fitter) {
+  int nevt = events.size();
+  for (int iev = nextevent++; iev < nevt; iev = nextevent++) {
+    BaseEvent *event = events[iev];
+    assert (event);
+    FitResult& r = results[iev];
+    r.result = event->fitEvent (fitter);
+    r.ierr   = fitter.getError();
+    r.dof    = fitter.getDoF();
+    r.nit    = fitter.getIterations();
+    r.prob   = fitter.getProbability();
+    r.chi2   = fitter.getChi2();
+  }
+}
+
+int ParallelFitDriver::getNEvents () const {return results.size();}
+
+int ParallelFitDriver::getResult (int iev) const {
+  assert (iev >= 0 && iev < (int)results.size());
+  return results[iev].result;
+}
+
+int ParallelFitDriver::getError (int iev) const {
+  assert (iev >= 0 && iev < (int)results.size());
+  return results[iev].ierr;
+}
+
+double ParallelFitDriver::getProbability (int iev) const {
+  assert (iev >= 0 && iev < (int)results.size());
+  return results[iev].prob;
+}
+
+double ParallelFitDriver::getChi2 (int iev) const {
+  assert (iev >= 0 && iev < (int)results.size());
+  return results[iev].chi2;
+}
+
+int ParallelFitDriver::getDoF (int iev) const {
+  assert (iev >= 0 && iev < (int)results.size());
+  return results[iev].dof;
+}
+
+int ParallelFitDriver::getIterations (int iev) const {
+  assert (iev >= 0 && iev < (int)results.size());
+  return results[iev].nit;
+}
@@ -58,6 +58,8 @@ void ParameterScanner::doScan (int xglobal,
             double mumerit) {
   
   NewFitterGSL *newfitter = dynamic_cast<NewFitterGSL *>(&fitter);
+  // the scan uses the dense matrices, which the sparse solver does not allocate
+  if (newfitter && newfitter->usesSparseSolver()) newfitter->ini_dense_matrices (newfitter->idim);
             
   FitObjectContainer* fitobjects = fitter.getFitObjects();
   if (fitobjects == 0) return;
@@ -26,6 +26,36 @@
 #include <cmath>
 using namespace std;
 
+void ParticleConstraint::add1stDerivativesToMatrix (double *M, int idim) const {
+  Evaluation evaluation (*this);
+  BaseHardConstraint::add1stDerivativesToMatrix (M, idim);
+}
+
+void ParticleConstraint::add1stDerivativesToMatrix (SparseSymMatrix& M) const {
+  Evaluation evaluation (*this);
+  BaseHardConstraint::add1stDerivativesToMatrix (M);
+}
+
+void ParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim, double lambda, ScratchArena& scratch) const {
+  Evaluation evaluation (*this);
+  BaseHardConstraint::add2ndDerivativesToMatrix (M, idim, lambda, scratch);
+}
+
+void ParticleConstraint::add2ndDerivativesToMatrix (SparseSymMatrix& M, double lambda, ScratchArena& scratch) const {
+  Evaluation evaluation (*this);
+  BaseHardConstraint::add2ndDerivativesToMatrix (M, lambda, scratch);
+}
+
+void ParticleConstraint::addToGlobalChi2DerVector (double *y, int idim, double lambda) const {
+  Evaluation evaluation (*this);
+  BaseHardConstraint::addToGlobalChi2DerVector (y, idim, lambda);
+}
+
+double ParticleConstraint::getError() const {
+  Evaluation evaluation (*this);
+  return BaseHardConstraint::getError();
+}
+
 
 // probably these can also be moved to basehardconstraint?
 
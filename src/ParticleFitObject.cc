@@ -123,7 +123,7 @@ std::ostream&  ParticleFitObject::print4Vector(std::ostream& os) const {
 }
 
 FourVector ParticleFitObject::getFourMomentum() const {
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   return fourMomentum;
 }
 double ParticleFitObject::getE()   const {
@@ -154,7 +154,7 @@ double ParticleFitObject::getPt2() const {
 
 std::ostream&  ParticleFitObject::print (std::ostream& os) const {
 
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
 
   printParams(os);
   os << " => ";
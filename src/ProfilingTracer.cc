@@ -0,0 +1,212 @@
+/*! \file
+ *  \brief Implements class ProfilingTracer
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#include "ProfilingTracer.h"
+
+#undef NDEBUG
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+ProfilingTracer::ProfilingTracer() {
+  reset();
+}
+
+ProfilingTracer::~ProfilingTracer()
+{}
+
+void ProfilingTracer::reset() {
+  infit = false;
+  pending = false;
+  fitstart = fitstartcyc = 0;
+  lazystart = lazystartcyc = 0;
+  tlast = clast = 0;
+  depth = 0;
+  for (int i = 0; i < NSLOTS; ++i) {
+    fittime[i] = 0;
+    fitcyc[i] = 0;
+    ncalls[i] = 0;
+    sumcyc[i] = 0;
+    times[i].clear();
+  }
+}
+
+double ProfilingTracer::now () {
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1E-9*ts.tv_nsec;
+}
+
+double ProfilingTracer::cycles () {
+#if defined(__x86_64__) || defined(__i386__)
+  return static_cast<double>(__rdtsc());
+#else
+  return 0;
+#endif
+}
+
+void ProfilingTracer::charge (double t, double c) {
+  if (depth > 0) {
+    fittime[stack[depth-1]] += t - tlast;
+    fitcyc[stack[depth-1]] += c - clast;
+  }
+  tlast = t;
+  clast = c;
+}
+
+void ProfilingTracer::openFit (double t, double c) {
+  if (infit) return;
+  infit = true;
+  fitstart = t;
+  fitstartcyc = c;
+  ++ncalls[TOTAL];
+}
+
+void ProfilingTracer::closeFit () {
+  if (!pending) return;
+  pending = false;
+  double sumtime = 0, sumc = 0;
+  for (int i = 0; i < NPHASES; ++i) {
+    sumtime += fittime[i];
+    sumc += fitcyc[i];
+  }
+  fittime[OTHER] = std::max (0., fittime[TOTAL] - sumtime);
+  fitcyc[OTHER] = std::max (0., fitcyc[TOTAL] - sumc);
+  if (fittime[OTHER] > 0) ++ncalls[OTHER];
+  for (int i = 0; i < NSLOTS; ++i) {
+    times[i].push_back (fittime[i]);
+    sumcyc[i] += fitcyc[i];
+    fittime[i] = 0;
+    fitcyc[i] = 0;
+  }
+}
+
+void ProfilingTracer::initialize (BaseFitter& fitter) {
+  closeFit();
+  openFit (now(), cycles());
+  BaseTracer::initialize (fitter);
+}
+
+void ProfilingTracer::finish (BaseFitter& fitter) {
+  BaseTracer::finish (fitter);
+  if (!infit) return;
+  double t = now(), c = cycles();
+  charge (t, c);
+  fittime[TOTAL] += t - fitstart;
+  fitcyc[TOTAL] += c - fitstartcyc;
+  infit = false;
+  pending = true;
+}
+
+bool ProfilingTracer::tracesPhases () const {
+  return true;
+}
+
+void ProfilingTracer::beginPhase (BaseFitter& fitter, int phase) {
+  assert (phase >= 0 && phase < NPHASES);
+  assert (depth < MAXDEPTH);
+  double t = now(), c = cycles();
+  if (pending && depth == 0) {
+    if (phase == PHASE_COVARIANCE) {
+      // covariance on demand after the end of the fit
+      lazystart = t;
+      lazystartcyc = c;
+    }
+    else {
+      closeFit();
+    }
+  }
+  if (!pending) openFit (t, c);
+  charge (t, c);
+  stack[depth++] = phase;
+  ++ncalls[phase];
+  BaseTracer::beginPhase (fitter, phase);
+}
+
+void ProfilingTracer::endPhase (BaseFitter& fitter, int phase) {
+  BaseTracer::endPhase (fitter, phase);
+  assert (depth > 0 && stack[depth-1] == phase);
+  double t = now(), c = cycles();
+  charge (t, c);
+  --depth;
+  if (pending && depth == 0) {
+    fittime[TOTAL] += t - lazystart;
+    fitcyc[TOTAL] += c - lazystartcyc;
+  }
+}
+
+void ProfilingTracer::flush() {
+  closeFit();
+}
+
+int ProfilingTracer::getNFits() const {
+  return times[TOTAL].size();
+}
+
+long ProfilingTracer::getNCalls (int slot) const {
+  assert (slot >= 0 && slot < NSLOTS);
+  return ncalls[slot];
+}
+
+double ProfilingTracer::getTotalTime (int slot) const {
+  assert (slot >= 0 && slot < NSLOTS);
+  double result = 0;
+  for (unsigned int i = 0; i < times[slot].size(); ++i) result += times[slot][i];
+  return result;
+}
+
+double ProfilingTracer::getTotalCycles (int slot) const {
+  assert (slot >= 0 && slot < NSLOTS);
+  return sumcyc[slot];
+}
+
+double ProfilingTracer::getTimeQuantile (int slot, double p) const {
+  assert (slot >= 0 && slot < NSLOTS);
+  assert (p >= 0 && p <= 1);
+  int n = times[slot].size();
+  if (n == 0) return 0;
+  // nearest rank
+  int k = static_cast<int>(std::ceil (p*n)) - 1;
+  if (k < 0) k = 0;
+  if (k >= n) k = n-1;
+  std::vector<double> sorted (times[slot]);
+  std::nth_element (sorted.begin(), sorted.begin()+k, sorted.end());
+  return sorted[k];
+}
+
+const char *ProfilingTracer::getSlotName (int slot) {
+  if (slot == OTHER) return "other";
+  if (slot == TOTAL) return "total";
+  return getPhaseName (slot);
+}
+
+void ProfilingTracer::writeSummary (std::ostream& os) {
+  flush();
+  int nfits = getNFits();
+  double total = getTotalTime (TOTAL);
+  os << "phase,nfits,ncalls,total_s,fraction,mean_us,p50_us,p90_us,p99_us,max_us,mean_kcycles\n";
+  for (int slot = 0; slot < NSLOTS; ++slot) {
+    double sum = getTotalTime (slot);
+    os << getSlotName (slot) << ","
+       << nfits << ","
+       << getNCalls (slot) << ","
+       << sum << ","
+       << (total > 0 ? sum/total : 0) << ","
+       << (nfits > 0 ? 1E6*sum/nfits : 0) << ","
+       << 1E6*getTimeQuantile (slot, 0.5) << ","
+       << 1E6*getTimeQuantile (slot, 0.9) << ","
+       << 1E6*getTimeQuantile (slot, 0.99) << ","
+       << 1E6*getTimeQuantile (slot, 1) << ","
+       << (nfits > 0 ? 1E-3*getTotalCycles (slot)/nfits : 0) << "\n";
+  }
+}
@@ -0,0 +1,334 @@
+/*! \file
+ *  \brief Implements class PullStudyDriver
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+#ifdef MARLIN_USE_ROOT
+
+#undef NDEBUG
+
+#include "PullStudyDriver.h"
+
+#include "TopEventILC.h"
+#include "CounterRandom.h"
+#include "BaseFitter.h"
+#include "ParticleFitObject.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+// binning of the distributions
+static const int    NBINS_PULL = 100;
+static const double MAX_PULL   = 5;
+static const int    NBINS_CHI2 = 100;
+static const double MAX_CHI2   = 50;
+static const int    NBINS_PROB = 100;
+
+// difference of two angles, between -pi and pi
+static double phiDiff (double phi1, double phi2) {
+  return std::remainder (phi1 - phi2, 2*M_PI);
+}
+
+PullStudyDriver::Histogram::Histogram (int nbins_, double low_, double high_)
+: nbins (nbins_), low (low_), high (high_), bins (nbins_+2, 0L),
+  entries (0), sum (0), sum2 (0)
+{
+  assert (nbins > 0);
+  assert (high > low);
+}
+
+void PullStudyDriver::Histogram::fill (double x) {
+  if (!std::isfinite (x)) return;
+  int ibin;
+  if (x < low) ibin = 0;
+  else if (x >= high) ibin = nbins+1;
+  else {
+    ibin = 1 + static_cast<int>((x - low)/(high - low)*nbins);
+    if (ibin > nbins) ibin = nbins;
+  }
+  ++bins[ibin];
+  ++entries;
+  sum += x;
+  sum2 += x*x;
+}
+
+void PullStudyDriver::Histogram::add (const Histogram& rhs) {
+  assert (rhs.nbins == nbins && rhs.low == low && rhs.high == high);
+  for (int ibin = 0; ibin < nbins+2; ++ibin) bins[ibin] += rhs.bins[ibin];
+  entries += rhs.entries;
+  sum += rhs.sum;
+  sum2 += rhs.sum2;
+}
+
+void PullStudyDriver::Histogram::reset () {
+  bins.assign (nbins+2, 0L);
+  entries = 0;
+  sum = sum2 = 0;
+}
+
+int PullStudyDriver::Histogram::getNBins () const {return nbins;}
+
+double PullStudyDriver::Histogram::getLow () const {return low;}
+
+double PullStudyDriver::Histogram::getHigh () const {return high;}
+
+long PullStudyDriver::Histogram::getBinContent (int ibin) const {
+  assert (ibin >= 0 && ibin < nbins+2);
+  return bins[ibin];
+}
+
+long PullStudyDriver::Histogram::getEntries () const {return entries;}
+
+double PullStudyDriver::Histogram::getMean () const {
+  return entries > 0 ? sum/entries : 0;
+}
+
+double PullStudyDriver::Histogram::getRMS () const {
+  if (entries == 0) return 0;
+  double mean = getMean();
+  double var = sum2/entries - mean*mean;
+  return var > 0 ? std::sqrt (var) : 0;
+}
+
+PullStudyDriver::PullStudyDriver (int nthreads_)
+: nthreads (1), seed (4357), chunksize (1000), leptonic (false), softmasses (false),
+  nevents (0), firstevent (0), nchunks (0), nextchunk (0), nfailed (0)
+{
+  setNThreads (nthreads_);
+}
+
+PullStudyDriver::~PullStudyDriver() {}
+
+void PullStudyDriver::setNThreads (int nthreads_) {
+  nthreads = nthreads_ > 0 ? nthreads_ : std::thread::hardware_concurrency();
+  if (nthreads < 1) nthreads = 1;
+}
+
+int PullStudyDriver::getNThreads () const {return nthreads;}
+
+void PullStudyDriver::setSeed (unsigned long seed_) {seed = seed_;}
+
+unsigned long PullStudyDriver::getSeed () const {return seed;}
+
+void PullStudyDriver::setChunkSize (int chunksize_) {
+  assert (chunksize_ > 0);
+  chunksize = chunksize_;
+}
+
+int PullStudyDriver::getChunkSize () const {return chunksize;}
+
+void PullStudyDriver::setLeptonic (bool leptonic_) {leptonic = leptonic_;}
+
+void PullStudyDriver::setSoftMasses (bool softmasses_) {softmasses = softmasses_;}
+
+TopEventILC *PullStudyDriver::createEvent () const {
+  TopEventILC *event = new TopEventILC();
+  event->leptonic = leptonic;
+  event->softmasses = softmasses;
+  return event;
+}
+
+long PullStudyDriver::run (long nevents_, long firstevent_) {
+  assert (nevents_ >= 0);
+  assert (firstevent_ >= 0);
+  nevents = nevents_;
+  firstevent = firstevent_;
+  nchunks = (nevents + chunksize - 1)/chunksize;
+
+  // the names of the pulls, from the fit objects of one event
+  pullnames.clear();
+  periodic.clear();
+  {
+    TopEventILC *event = createEvent();
+    CounterRandom random (seed);
+    event->setRandom (&random);
+    event->genEvent();
+    for (int j = 0; j < event->getNFitObjects(); ++j) {
+      const ParticleFitObject *fo = event->getFittedFitObject (j);
+      assert (fo);
+      for (int k = 0; k < fo->getNPar(); ++k) {
+        pullnames.push_back (std::string (fo->getName()) + "_" + fo->getParamName (k));
+        periodic.push_back (std::strcmp (fo->getParamName (k), "phi") == 0);
+      }
+    }
+    delete event;
+  }
+  int npulls = pullnames.size();
+  int nq = 2*npulls + 2;
+  hists.assign (2*npulls, Histogram (NBINS_PULL, -MAX_PULL, MAX_PULL));
+  hists.push_back (Histogram (NBINS_CHI2, 0, MAX_CHI2));
+  hists.push_back (Histogram (NBINS_PROB, 0, 1));
+  chunksums.assign (2*nq*nchunks, 0.);
+
+  int nworkers = nthreads < nchunks ? nthreads : nchunks;
+  std::vector<Worker> workers (nworkers);
+  for (int i = 0; i < nworkers; ++i) {
+    Worker& w = workers[i];
+    w.event = createEvent();
+    w.fitter = createFitter();
+    w.random = new CounterRandom (seed);
+    w.event->setRandom (w.random);
+    w.hists = hists;
+    w.nfailed = 0;
+  }
+
+  nextchunk = 0;
+  if (nworkers == 1) {
+    work (workers[0]);
+  }
+  else if (nworkers > 1) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < nworkers; ++i) {
+      threads.push_back (std::thread (&PullStudyDriver::work, this, std::ref (workers[i])));
+    }
+    for (int i = 0; i < nworkers; ++i) threads[i].join();
+  }
+
+  // bin contents are integers, so the order of the threads does not matter;
+  // the sums are added in the order of the chunks
+  nfailed = 0;
+  for (int i = 0; i < nworkers; ++i) {
+    Worker& w = workers[i];
+    for (int iq = 0; iq < nq; ++iq) hists[iq].add (w.hists[iq]);
+    nfailed += w.nfailed;
+    delete w.event;
+    delete w.fitter;
+    delete w.random;
+  }
+  for (int iq = 0; iq < nq; ++iq) {
+    Histogram& h = hists[iq];
+    h.sum = h.sum2 = 0;
+    for (long ichunk = 0; ichunk < nchunks; ++ichunk) {
+      h.sum  += chunksums[2*(ichunk*nq + iq)];
+      h.sum2 += chunksums[2*(ichunk*nq + iq) + 1];
+    }
+  }
+
+  return nevents - nfailed;
+}
+
+void PullStudyDriver::fill (Worker& w, int iq, double x, double *chunksum) {
+  if (!std::isfinite (x)) return;
+  w.hists[iq].fill (x);
+  chunksum[2*iq]   += x;
+  chunksum[2*iq+1] += x*x;
+}
+
+void PullStudyDriver::work (Worker& w) {
+  int npulls = pullnames.size();
+  int nq = 2*npulls + 2;
+  long lastevent = firstevent + nevents;
+  for (long ichunk = nextchunk++; ichunk < nchunks; ichunk = nextchunk++) {
+    double *chunksum = &chunksums[2*ichunk*nq];
+    long begin = firstevent + ichunk*chunksize;
+    long end = begin + chunksize < lastevent ? begin + chunksize : lastevent;
+    for (long iev = begin; iev < end; ++iev) {
+      w.random->setStream (iev);
+      w.event->genEvent();
+      if (w.event->fitEvent (*w.fitter) != 0) {
+        ++w.nfailed;
+        continue;
+      }
+      int ip = 0;
+      for (int j = 0; j < w.event->getNFitObjects(); ++j) {
+        const ParticleFitObject *truth  = w.event->getTrueFitObject (j);
+        const ParticleFitObject *start  = w.event->getStartFitObject (j);
+        const ParticleFitObject *fitted = w.event->getFittedFitObject (j);
+        for (int k = 0; k < fitted->getNPar(); ++k, ++ip) {
+          assert (ip < npulls);
+          double sfit = fitted->getError (k);
+          double dmeas = fitted->getParam (k) - start->getParam (k);
+          double dtrue = fitted->getParam (k) - truth->getParam (k);
+          if (periodic[ip]) {
+            dmeas = phiDiff (fitted->getParam (k), start->getParam (k));
+            dtrue = phiDiff (fitted->getParam (k), truth->getParam (k));
+          }
+          if (start->isParamMeasured (k)) {
+            double smeas = start->getError (k);
+            double d2 = smeas*smeas - sfit*sfit;
+            if (d2 > 0) fill (w, ip, dmeas/std::sqrt (d2), chunksum);
+          }
+          if (sfit > 0) fill (w, npulls + ip, dtrue/sfit, chunksum);
+        }
+      }
+      fill (w, 2*npulls,   w.fitter->getChi2(), chunksum);
+      fill (w, 2*npulls+1, w.fitter->getProbability(), chunksum);
+    }
+  }
+}
+
+long PullStudyDriver::getNEvents () const {return nevents;}
+
+long PullStudyDriver::getNFailed () const {return nfailed;}
+
+int PullStudyDriver::getNPulls () const {return pullnames.size();}
+
+const std::string& PullStudyDriver::getPullName (int i) const {
+  assert (i >= 0 && i < (int)pullnames.size());
+  return pullnames[i];
+}
+
+const PullStudyDriver::Histogram& PullStudyDriver::getPull (int i) const {
+  assert (i >= 0 && i < (int)pullnames.size());
+  return hists[i];
+}
+
+const PullStudyDriver::Histogram& PullStudyDriver::getTruePull (int i) const {
+  assert (i >= 0 && i < (int)pullnames.size());
+  return hists[pullnames.size() + i];
+}
+
+const PullStudyDriver::Histogram& PullStudyDriver::getChi2 () const {
+  assert (hists.size() == 2*pullnames.size() + 2);
+  return hists[2*pullnames.size()];
+}
+
+const PullStudyDriver::Histogram& PullStudyDriver::getProbability () const {
+  assert (hists.size() == 2*pullnames.size() + 2);
+  return hists[2*pullnames.size() + 1];
+}
+
+std::string PullStudyDriver::getName (int iq) const {
+  int npulls = pullnames.size();
+  if (iq < npulls) return "pull_" + pullnames[iq];
+  if (iq < 2*npulls) return "truepull_" + pullnames[iq - npulls];
+  return iq == 2*npulls ? "chi2" : "prob";
+}
+
+void PullStudyDriver::writeSummary (std::ostream& os) const {
+  os << "quantity,entries,mean,rms,underflow,overflow\n";
+  for (unsigned int iq = 0; iq < hists.size(); ++iq) {
+    const Histogram& h = hists[iq];
+    os << getName (iq) << ","
+       << h.getEntries() << ","
+       << h.getMean() << ","
+       << h.getRMS() << ","
+       << h.getBinContent (0) << ","
+       << h.getBinContent (h.getNBins()+1) << "\n";
+  }
+}
+
+void PullStudyDriver::writeHistograms (std::ostream& os) const {
+  const double inf = std::numeric_limits<double>::infinity();
+  os << "quantity,bin,low,high,content\n";
+  for (unsigned int iq = 0; iq < hists.size(); ++iq) {
+    const Histogram& h = hists[iq];
+    double width = (h.getHigh() - h.getLow())/h.getNBins();
+    for (int ibin = 0; ibin < h.getNBins()+2; ++ibin) {
+      double low  = ibin == 0 ? -inf : h.getLow() + (ibin-1)*width;
+      double high = ibin == h.getNBins()+1 ? inf : h.getLow() + ibin*width;
+      os << getName (iq) << ","
+         << ibin << ","
+         << low << ","
+         << high << ","
+         << h.getBinContent (ibin) << "\n";
+    }
+  }
+}
+
+#endif // MARLIN_USE_ROOT
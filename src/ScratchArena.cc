@@ -0,0 +1,94 @@
+/*! \file
+ *  \brief Implements class ScratchArena
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ * - 16.10.2026 ScratchDispatch
+ *
+ */
+
+#undef NDEBUG
+
+#include "ScratchArena.h"
+
+#include <cassert>
+
+ScratchArena::ScratchArena (std::size_t nbytes)
+: block (0), cap (0), used (0), demand (0), peak (0), nframes (0),
+  nrequests (0), nallocations (0)
+{
+  overflow.reserve (8);
+  if (nbytes > 0) reserve (nbytes);
+}
+
+ScratchArena::~ScratchArena() {
+  assert (nframes == 0);
+  for (unsigned int i = 0; i < overflow.size(); ++i) delete[] overflow[i];
+  delete[] block;
+}
+
+void ScratchArena::reserve (std::size_t nbytes) {
+  assert (nframes == 0);
+  nbytes = roundUp (nbytes);
+  if (nbytes <= cap) return;
+  delete[] block;
+  block = new char[nbytes];
+  cap = nbytes;
+  ++nallocations;
+}
+
+void *ScratchArena::allocBytes (std::size_t nbytes) {
+  assert (nframes > 0);
+  ++nrequests;
+  demand += nbytes;
+  if (demand > peak) peak = demand;
+  if (used + nbytes <= cap) {
+    void *result = block + used;
+    used += nbytes;
+    return result;
+  }
+  char *result = new char[nbytes > 0 ? nbytes : 1];
+  overflow.push_back (result);
+  ++nallocations;
+  return result;
+}
+
+ScratchArena::Frame::Frame (ScratchArena& arena_)
+: arena (arena_), used (arena_.used), demand (arena_.demand), noverflow (arena_.overflow.size())
+{
+  ++arena.nframes;
+}
+
+ScratchArena::Frame::~Frame() {
+  while (arena.overflow.size() > noverflow) {
+    delete[] arena.overflow.back();
+    arena.overflow.pop_back();
+  }
+  arena.used = used;
+  arena.demand = demand;
+  // after the outermost frame, make the block large enough for the next time
+  if (--arena.nframes == 0 && arena.peak > arena.cap) arena.reserve (arena.peak);
+}
+
+ScratchDispatch::Call::Call (ScratchDispatch& dispatch_)
+: dispatch (dispatch_), scratch (dispatch_.current), own (0), isfirst (dispatch_.current == 0)
+{}
+
+ScratchDispatch::Call::Call (ScratchDispatch& dispatch_, ScratchArena& scratch_)
+: dispatch (dispatch_), scratch (&scratch_), own (0), isfirst (dispatch_.current != &scratch_)
+{
+  if (isfirst) dispatch.current = scratch;
+}
+
+ScratchDispatch::Call::~Call() {
+  if (isfirst) dispatch.current = 0;
+  delete own;
+}
+
+ScratchArena& ScratchDispatch::Call::makeArena (std::size_t nbytes) {
+  assert (isfirst && !own);
+  own = new ScratchArena (nbytes);
+  scratch = own;
+  dispatch.current = own;
+  return *own;
+}
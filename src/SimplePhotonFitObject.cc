@@ -41,7 +41,7 @@ using std::cout;
 using std::endl;
 
 // constructor
-SimplePhotonFitObject::SimplePhotonFitObject(double px, double py, double pz, double Dpz) : pt2(0), p2(0), p(0),dE0(0), dE1(0), dE2(0),chi2(0)
+SimplePhotonFitObject::SimplePhotonFitObject(double px, double py, double pz, double Dpz) : ParticleFitObject (paramstorage), pt2(0), p2(0), p(0),dE0(0), dE1(0), dE2(0),chi2(0)
 {
 
   assert( int(NPAR) <= int(BaseDefs::MAXPAR) );
@@ -61,7 +61,7 @@ SimplePhotonFitObject::SimplePhotonFitObject(double px, double py, double pz, do
 // destructor
 SimplePhotonFitObject::~SimplePhotonFitObject() {}
 
-SimplePhotonFitObject::SimplePhotonFitObject (const SimplePhotonFitObject& rhs) : pt2(0), p2(0), p(0),dE0(0), dE1(0), dE2(0),chi2(0)
+SimplePhotonFitObject::SimplePhotonFitObject (const SimplePhotonFitObject& rhs) : ParticleFitObject (paramstorage), pt2(0), p2(0), p(0),dE0(0), dE1(0), dE2(0),chi2(0)
 {
   //std::cout << "copying SimplePhotonFitObject with name" << rhs.name << std::endl;
   SimplePhotonFitObject::assign (rhs);
@@ -121,7 +121,7 @@ bool SimplePhotonFitObject::updateParams (double pp[], int idim) {
 // these depend on actual parametrisation!
 double SimplePhotonFitObject::getDPx(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-//   if (!cachevalid) updateCache();
+//   if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
 //     case 0: return dpx0;
 //     case 1: return dpx1;
@@ -135,7 +135,7 @@ double SimplePhotonFitObject::getDPx(int ilocal) const {
 
 double SimplePhotonFitObject::getDPy(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-//   if (!cachevalid) updateCache();
+//   if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
 //     case 0: return dpy0;
 //     case 1: return dpy1;
@@ -149,7 +149,7 @@ double SimplePhotonFitObject::getDPy(int ilocal) const {
 
 double SimplePhotonFitObject::getDPz(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-//   if (!cachevalid) updateCache();
+//   if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
 //     case 0: return dpz0;
 //     case 1: return dpz1;
@@ -163,7 +163,7 @@ double SimplePhotonFitObject::getDPz(int ilocal) const {
 
 double SimplePhotonFitObject::getDE(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
     case 0: return dE0;
     case 1: return dE1;
@@ -198,7 +198,7 @@ double SimplePhotonFitObject::getFirstDerivative_Meta_Local( int iMeta, int iloc
 
 double SimplePhotonFitObject::getSecondDerivative_Meta_Local( int iMeta, int ilocal , int jlocal , int metaSet ) const {
   assert ( metaSet==0 );
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
 
   if ( jlocal<ilocal ) {
     int temp=jlocal;
@@ -2,7 +2,13 @@
  *  \brief Implements class SoftBWParticleConstraint
  *
  * \b Changelog:
- * - 
+ * - 16.10.2026 Work arrays of add2ndDerivativesToMatrix from a ScratchArena
+ * - 16.10.2026 Chain rule of add2ndDerivativesToMatrix in ChainRuleKernels
+ * - 16.10.2026 add2ndDerivativesToMatrix only for pairs of fit objects with second derivatives
+ * - 16.10.2026 Normal quantile from GSL instead of ROOT::Math, available without ROOT
+ * - 16.10.2026 Evaluation of value and derivatives in one pass, kept during the derivative assembly
+ * - 16.10.2026 add2ndDerivativesToMatrix examines only the parameters of its fit objects
+ * - 16.10.2026 Versions of add2ndDerivativesToMatrix with and without arena call each other once
  *
  * \b CVS Log messages:
  * - $Log: SoftBWParticleConstraint.cc,v $
@@ -20,26 +26,37 @@
 // Redo calculation of penalty function and deriavtives
 // Check where to get erfinv 
 
-#ifdef MARLIN_USE_ROOT
-
-
 #include "SoftBWParticleConstraint.h"
 #include "ParticleFitObject.h"
+#include "SparseSymMatrix.h"
+#include "ScratchArena.h"
+#include "ChainRuleKernels.h"
 
-#include "Math/ProbFuncMathCore.h"
-#include "Math/QuantFuncMathCore.h"
+#include <gsl/gsl_cdf.h>
 
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
 using namespace std;
 
+namespace {
+  void addTo2ndDerivatives (const ParticleFitObject *fo, DenseMatrixRef& M, double lambda, double der[], int metaSet) {
+    fo->addTo2ndDerivatives (M.M, M.idim, lambda, der, metaSet);
+  }
+  void addTo2ndDerivatives (const ParticleFitObject *fo, SparseSymMatrix& M, double lambda, double der[], int metaSet) {
+    fo->addTo2ndDerivatives (M, lambda, der, metaSet);
+  }
+}
+
 SoftBWParticleConstraint::SoftBWParticleConstraint(double gamma_, double emin_, double emax_)
 : 
   fitobjects( FitObjectContainer() ), derivatives( std::vector <double> () ), flags ( std::vector <int> () ),
   gamma (gamma_), emin (emin_), emax (emax_),
   cachevalid(false),
-  atanxmin(0),atanxmax(0), diffatanx(0)
+  atanxmin(0),atanxmax(0), diffatanx(0),
+  secondDerivativePairs (std::vector <int> ()), npairobjects (-1),
+  evaluated (false)
 {
   invalidateCache();
 }
@@ -61,6 +78,7 @@ double SoftBWParticleConstraint::getChi2() const {
 }
   
 double SoftBWParticleConstraint::getError() const {
+  Evaluation evaluation (*this);
   double dgdpi[4];
   double error2 = 0;
   for (unsigned int i = 0; i < fitobjects.size(); ++i) {
@@ -96,8 +114,11 @@ double SoftBWParticleConstraint::getError() const {
  */
  
  
-void SoftBWParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim) const
+template <class Matrix>
+void SoftBWParticleConstraint::add2ndDerivativesToMatrixT (Matrix& M, ScratchArena& scratch) const
 {
+  Evaluation evaluation (*this);
+  ScratchArena::Frame frame (scratch);
 
   /** First, treat the part 
    * $$ 
@@ -119,14 +140,11 @@ void SoftBWParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim) c
   // with ii=0, 1, 2, 3 for E, px, py, pz
   const int KMAX=4;
   const int n = fitobjects.size();
-  double *dPidAk = new double[n*KMAX*4];
-  bool *dPidAkval = new bool[n];
+  double *dPidAk = scratch.alloc<double> (n*KMAX*4);
+  bool *dPidAkval = scratch.alloc<bool> (n);
   
   for (int i = 0; i < n; ++i) dPidAkval[i] = false;
   
-  // Derivatives $\frac{\partial ^2 g}{\partial P_i \partial a_l}$ at fixed i
-  // d2GdPdAl[4*l + ii] is $\frac{\partial ^2 g}{\partial P_{i,ii} \partial a_l}$
-  double d2GdPdAl[4*KMAX];
   // Derivatives $\frac{\partial ^2 g}{\partial a_k \partial a_l}$ 
   double d2GdAkdAl[KMAX*KMAX];
   
@@ -134,7 +152,7 @@ void SoftBWParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim) c
   
   // Global parameter numbers: parglobal[KMAX*i+klocal] 
   // is global parameter number of local parameter klocal of i-th Fit object
-  int *parglobal = new int[KMAX*n];
+  int *parglobal = scratch.alloc<int> (KMAX*n);
   
   for (int i = 0; i < n; ++i) {
     const ParticleFitObject *foi = fitobjects[i];
@@ -145,61 +163,41 @@ void SoftBWParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim) c
   }
   
   
-  for (int i = 0; i < n; ++i) {
+  // Only pairs of fit objects that can have second derivatives
+  const std::vector <int>& pairs = getSecondDerivativePairs();
+  for (unsigned int ipair = 0; ipair < pairs.size(); ipair += 2) {
+    int i = pairs[ipair];
+    int j = pairs[ipair+1];
     const ParticleFitObject *foi = fitobjects[i];
     assert (foi);
-    for (int j = 0; j < n; ++j) {
-      const ParticleFitObject *foj = fitobjects[j];
-      assert (foj);
-      if (secondDerivatives (i, j, d2GdPidPj)) {
-        if (!dPidAkval[i]) {
-          foi->getDerivatives (dPidAk+i*(KMAX*4), KMAX*4);
-          dPidAkval[i] = true;
-        }
-        if (!dPidAkval[j]) {
-          foj->getDerivatives (dPidAk+j*(KMAX*4), KMAX*4);
-          dPidAkval[j] = true;
-        }
-        // Now sum over E/px/Py/Pz for object j:
-        // $$\frac{\partial ^2 g}{\partial P_{i,ii} \partial a_l}
-        //   = (sum_{j}) sum_{jj} frac{\partial ^2 g}{\partial P_{i,ii} \partial P_{j,jj}}  
-        //     \cdot \frac{\partial P_{j,jj}}{\partial a_l}
-        // We're summing over jj here
+    const ParticleFitObject *foj = fitobjects[j];
+    assert (foj);
+    if (secondDerivatives (i, j, d2GdPidPj)) {
+      if (!dPidAkval[i]) {
+        foi->getDerivatives (dPidAk+i*(KMAX*4), KMAX*4);
+        dPidAkval[i] = true;
+      }
+      if (!dPidAkval[j]) {
+        foj->getDerivatives (dPidAk+j*(KMAX*4), KMAX*4);
+        dPidAkval[j] = true;
+      }
+      // Now sum over E/px/Py/Pz for object j and for object i:
+      // $$
+      // \frac{\partial ^2 g}{\partial a_k \partial a_l}
+      //      = \sum_{ii} \sum_{jj} \frac{\partial P_{i,ii}}{\partial a_k} \cdot
+      //        \frac{\partial ^2 g}{\partial P_{i,ii} \partial P_{j,jj}} \cdot
+      //        \frac{\partial P_{j,jj}}{\partial a_l}
+      // $$
+      ChainRuleKernels::contract (d2GdPidPj, dPidAk+(KMAX*4)*i, foi->getNPar(),
+                                  dPidAk+(KMAX*4)*j, foj->getNPar(), d2GdAkdAl, KMAX);
+      // Now expand the local parameter numbers to global ones
+      for (int klocal = 0; klocal < foi->getNPar(); ++klocal) {
+        int kglobal = parglobal [KMAX*i + klocal];
+        if (kglobal < 0) continue;
         for (int llocal = 0; llocal < foj->getNPar(); ++llocal) {
-          for (int ii = 0; ii < 4; ++ii) {
-            int ind1 = 4*ii;
-            int ind2 = (KMAX*4)*j + 4*llocal;
-            double& r = d2GdPdAl[4*llocal + ii];
-            r  = d2GdPidPj[  ind1] * dPidAk[  ind2];   // E
-            r += d2GdPidPj[++ind1] * dPidAk[++ind2];   // px
-            r += d2GdPidPj[++ind1] * dPidAk[++ind2];   // py
-            r += d2GdPidPj[++ind1] * dPidAk[++ind2];   // pz
-          }
-        }
-        // Now sum over E/px/Py/Pz for object i, i.e. sum over ii:
-        // $$
-        // \frac{\partial ^2 g}{\partial a_k \partial a_l}
-        //      = \sum_{ii} \frac{\partial ^2 g}{\partial P_{i,ii} \partial a_l} \cdot 
-        //        \frac{\partial P_{i,ii}}{\partial a_k}
-        // $$
-        for (int klocal = 0; klocal < foi->getNPar(); ++klocal) {
-          for (int llocal = 0; llocal < foj->getNPar(); ++llocal) {
-            int ind1 = 4*llocal;
-            int ind2 = (KMAX*4)*i + 4*klocal;
-            double& r = d2GdAkdAl[KMAX*klocal+llocal];
-            r  = d2GdPdAl[  ind1] * dPidAk[  ind2];    //E
-            r += d2GdPdAl[++ind1] * dPidAk[++ind2];   // px
-            r += d2GdPdAl[++ind1] * dPidAk[++ind2];   // py
-            r += d2GdPdAl[++ind1] * dPidAk[++ind2];   // pz
-          }
-        }
-        // Now expand the local parameter numbers to global ones
-        for (int klocal = 0; klocal < foi->getNPar(); ++klocal) {
-          int kglobal = parglobal [KMAX*i + klocal];
-          for (int llocal = 0; llocal < foj->getNPar(); ++llocal) {
-            int lglobal = parglobal [KMAX*j + llocal];
-            M [idim*kglobal+lglobal] += fact*d2GdAkdAl[KMAX*klocal+llocal];
-          }
+          int lglobal = parglobal [KMAX*j + llocal];
+          if (lglobal < 0) continue;
+          M.add (kglobal, lglobal, fact*d2GdAkdAl[KMAX*klocal+llocal]);
         }
       }
     }
@@ -223,8 +221,21 @@ void SoftBWParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim) c
    * the FitObject
    */
   
-  double *v = new double[idim];
-  for (int i = 0; i < idim; ++i) v[i] = 0;
+  // v can only be nonzero at the global parameters of the fit objects,
+  // so only these are set to 0 and examined afterwards
+  int idim = M.getDim();
+  double *v = scratch.alloc<double> (idim);
+  int *nonzero = scratch.alloc<int> (getNParTotal());
+  int nindex = 0;
+  for (int i = 0; i < n; ++i) {
+    const ParticleFitObject *foi = fitobjects[i];
+    for (int klocal = 0; klocal < foi->getNPar(); ++klocal) {
+      int kglobal = foi->getGlobalParNum (klocal);
+      if (kglobal < 0) continue;
+      v[kglobal] = 0;
+      nonzero[nindex++] = kglobal;
+    }
+  }
   
   // fact2 may be negative, so don't use sqrt(fact2)
   double dgdpi[4];
@@ -232,28 +243,112 @@ void SoftBWParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim) c
     const ParticleFitObject *foi = fitobjects[i];
     assert (foi);
     if (firstDerivatives (i, dgdpi)) {
-      foi->addTo2ndDerivatives (M, idim, fact, dgdpi, getVarBasis() );
+      addTo2ndDerivatives (foi, M, fact, dgdpi, getVarBasis() );
       foi->addToGlobalChi2DerVector (v, idim, 1, dgdpi, getVarBasis() );
     }
   }
   
-  for (int i = 0; i<idim; ++i) {
-    if (double vi = v[i]) {
-      int ioffs = i*idim;
-      for (double *pvj = v; pvj < v+idim; ++pvj) {
-        M[ioffs++] += fact2*vi*(*pvj);
+  // only the nonzero elements of v contribute
+  std::sort (nonzero, nonzero+nindex);
+  nindex = std::unique (nonzero, nonzero+nindex) - nonzero;
+  int nnonzero = 0;
+  for (int k = 0; k < nindex; ++k) if (v[nonzero[k]]) nonzero[nnonzero++] = nonzero[k];
+  for (int k = 0; k < nnonzero; ++k) {
+    int i = nonzero[k];
+    double vi = v[i];
+    for (int l = 0; l < nnonzero; ++l) {
+      M.add (i, nonzero[l], fact2*vi*v[nonzero[l]]);
+    }
+  }
+}
+
+// The versions with and without arena call each other once through the
+// virtual functions, so that overrides of either are called, see ScratchDispatch
+void SoftBWParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim) const
+{
+  ScratchDispatch::Call call (dispatch);
+  if (call.first()) {
+    add2ndDerivativesToMatrix (M, idim, call.makeArena (getScratchSize (idim)));
+  }
+  else {
+    DenseMatrixRef Mref (M, idim);
+    add2ndDerivativesToMatrixT (Mref, call.arena());
+  }
+}
+
+void SoftBWParticleConstraint::add2ndDerivativesToMatrix (SparseSymMatrix& M) const
+{
+  ScratchDispatch::Call call (dispatch);
+  if (call.first()) {
+    add2ndDerivativesToMatrix (M, call.makeArena (getScratchSize (M.getDim())));
+  }
+  else {
+    add2ndDerivativesToMatrixT (M, call.arena());
+  }
+}
+
+void SoftBWParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim, ScratchArena& scratch) const
+{
+  ScratchDispatch::Call call (dispatch, scratch);
+  if (call.first()) {
+    add2ndDerivativesToMatrix (M, idim);
+  }
+  else {
+    DenseMatrixRef Mref (M, idim);
+    add2ndDerivativesToMatrixT (Mref, scratch);
+  }
+}
+
+void SoftBWParticleConstraint::add2ndDerivativesToMatrix (SparseSymMatrix& M, ScratchArena& scratch) const
+{
+  ScratchDispatch::Call call (dispatch, scratch);
+  if (call.first()) {
+    add2ndDerivativesToMatrix (M);
+  }
+  else {
+    add2ndDerivativesToMatrixT (M, scratch);
+  }
+}
+
+bool SoftBWParticleConstraint::hasSecondDerivatives (int, int) const {
+  return true;
+}
+
+const std::vector <int>& SoftBWParticleConstraint::getSecondDerivativePairs() const {
+  const int n = fitobjects.size();
+  if (npairobjects != n) {
+    secondDerivativePairs.resize (0);
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+        if (hasSecondDerivatives (i, j)) {
+          secondDerivativePairs.push_back (i);
+          secondDerivativePairs.push_back (j);
+        }
       }
     }
+    npairobjects = n;
   }
-  
-  
-  delete[] dPidAk;
-  delete[] dPidAkval;
-  delete[] parglobal;
-  delete[] v;
+  return secondDerivativePairs;
+}
+
+int SoftBWParticleConstraint::getNParTotal() const
+{
+  int npartotal = 0;
+  for (unsigned int i = 0; i < fitobjects.size(); ++i) npartotal += fitobjects[i]->getNPar();
+  return npartotal;
+}
+
+std::size_t SoftBWParticleConstraint::getScratchSize (int idim) const
+{
+  const int KMAX=4;
+  const int n = fitobjects.size();
+  return ScratchArena::size<double> (n*KMAX*4) + ScratchArena::size<bool> (n) 
+       + ScratchArena::size<int> (KMAX*n) + ScratchArena::size<double> (idim) 
+       + ScratchArena::size<int> (getNParTotal());
 }
 
 void SoftBWParticleConstraint::addToGlobalChi2DerVector (double *y, int idim) const {
+  Evaluation evaluation (*this);
   double dgdpi[4];
   double r = penalty1stder (getValue());
   for (unsigned int i = 0; i < fitobjects.size(); ++i) {
@@ -381,20 +476,20 @@ double SoftBWParticleConstraint::erfinv (double x) {
 //   double ll = std::log (1 - x*x);
 //   double xx = aa + 0.5*ll;
 //   return s * std::sqrt(-xx + std::sqrt (xx*xx - ll/a));
-  return 2*ROOT::Math::normal_quantile (std::sqrt(2.0)*x, 1.0)-1;
+  return 2*gsl_cdf_ugaussian_Pinv (std::sqrt(2.0)*x)-1;
 }
 
 double SoftBWParticleConstraint::normal_quantile (double x) {
-  return ROOT::Math::normal_quantile (x, 1.0);
+  return gsl_cdf_ugaussian_Pinv (x);
 }
 
 double SoftBWParticleConstraint::normal_quantile_1stderiv (double x) {
-  double y = ROOT::Math::normal_quantile (x, 1.0);
+  double y = gsl_cdf_ugaussian_Pinv (x);
   return 1/normal_pdf (y);
 }
 
 double SoftBWParticleConstraint::normal_quantile_2ndderiv (double x) {
-  double y = ROOT::Math::normal_quantile (x, 1.0);
+  double y = gsl_cdf_ugaussian_Pinv (x);
 //  return -normal_pdf_deriv (y)/pow (normal_pdf (y), 3);
   return -y/pow (normal_pdf (y), 2);
 }
@@ -505,5 +600,3 @@ bool SoftBWParticleConstraint::cacheValid() const {
 int SoftBWParticleConstraint::getVarBasis() const {
   return VAR_BASIS;
 }
-
-#endif // MARLIN_USE_ROOT
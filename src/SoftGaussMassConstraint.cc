@@ -37,23 +37,30 @@ SoftGaussMassConstraint::~SoftGaussMassConstraint () {
   // std::cout << "destroying SoftGaussMassConstraint" << std::endl;
 }
 
-// calulate current value of constraint function
-double SoftGaussMassConstraint::getValue() const {
-  double totE[2] = {0,0};
-  double totpx[2] = {0,0}; 
-  double totpy[2] = {0,0}; 
-  double totpz[2] = {0,0}; 
+// calculate the sums of the four-momenta of both sets of fit objects and the value of the constraint function
+void SoftGaussMassConstraint::evaluate() const {
+  for (int index = 0; index < 2; ++index) {
+    totE[index] = totpx[index] = totpy[index] = totpz[index] = 0;
+    nonempty[index] = false;
+  }
   for (unsigned int i = 0; i < fitobjects.size(); i++) {
     int index = (flags[i] == 1) ? 0 : 1; // default is 1, but 2 may indicate fitobjects for a second W -> equal mass constraint!
-    totE[index] += fitobjects[i]->getE(); 
+    nonempty[index] = true;
+    totE[index]  += fitobjects[i]->getE(); 
     totpx[index] += fitobjects[i]->getPx(); 
     totpy[index] += fitobjects[i]->getPy(); 
     totpz[index] += fitobjects[i]->getPz(); 
   }
-  double result = -mass;
-  result += std::sqrt(std::abs(totE[0]*totE[0]-totpx[0]*totpx[0]-totpy[0]*totpy[0]-totpz[0]*totpz[0]));
-  result -= std::sqrt(std::abs(totE[1]*totE[1]-totpx[1]*totpx[1]-totpy[1]*totpy[1]-totpz[1]*totpz[1]));
-  return result;
+  value = -mass;
+  value += std::sqrt(std::abs(totE[0]*totE[0]-totpx[0]*totpx[0]-totpy[0]*totpy[0]-totpz[0]*totpz[0]));
+  value -= std::sqrt(std::abs(totE[1]*totE[1]-totpx[1]*totpx[1]-totpy[1]*totpy[1]-totpz[1]*totpz[1]));
+  have1st = have2nd = false;
+}
+
+// calulate current value of constraint function
+double SoftGaussMassConstraint::getValue() const {
+  if (!isEvaluated()) evaluate();
+  return value;
 }
 
 // calculate vector/array of derivatives of this contraint 
@@ -62,19 +69,8 @@ double SoftGaussMassConstraint::getValue() const {
 //          = d M /d p(i) * d p(i) /d par(j)
 //          =  +-1/M * p(i) * d p(i) /d par(j)
 void SoftGaussMassConstraint::getDerivatives(int idim, double der[]) const {
-  double totE[2] = {0,0};
-  double totpx[2] = {0,0}; 
-  double totpy[2] = {0,0}; 
-  double totpz[2] = {0,0}; 
-  bool valid[2] = {false, false};
-  for (unsigned int i = 0; i < fitobjects.size(); i++) {
-    int index = (flags[i]==1) ? 0 : 1; // default is 1, but 2 may indicate fitobjects for a second W -> equal mass constraint!
-    valid[index] = true;
-    totE[index]  += fitobjects[i]->getE(); 
-    totpx[index] += fitobjects[i]->getPx(); 
-    totpy[index] += fitobjects[i]->getPy(); 
-    totpz[index] += fitobjects[i]->getPz(); 
-  }
+  if (!isEvaluated()) evaluate();
+  const bool *valid = nonempty;
   double m2[2]; 
   double m_inv[2] = {0,0}; 
   for (int index = 0; index < 2; ++index) {
@@ -136,81 +132,81 @@ void SoftGaussMassConstraint::setMass (double mass_) {
   mass = mass_;
 }
 
+// calculate the first derivatives w.r.t. the 4-vectors for both sets of fit objects
+void SoftGaussMassConstraint::evaluate1stDerivatives() const {
+  for (int index = 0; index < 2; ++index) {
+    if (!nonempty[index]) continue;
+    double E = totE[index], px = totpx[index], py = totpy[index], pz = totpz[index];
+    if (E <= 0) {
+      cerr << "SoftGaussMassConstraint::firstDerivatives: totE = " << E << endl;
+    }
+  
+    double m = std::sqrt(std::abs(E*E-px*px-py*py-pz*pz));
+    if (index) m = -m;
+
+    double *d = dgdp[index];
+    d[0] = E/m;
+    d[1] = -px/m;
+    d[2] = -py/m;
+    d[3] = -pz/m;
+  }
+  have1st = true;
+}
+
+// calculate the second derivatives w.r.t. the 4-vectors for both sets of fit objects
+void SoftGaussMassConstraint::evaluate2ndDerivatives() const {
+  for (int index = 0; index < 2; ++index) {
+    if (!nonempty[index]) continue;
+    double E = totE[index], px = totpx[index], py = totpy[index], pz = totpz[index];
+    if (E <= 0) {
+      cerr << "SoftGaussMassConstraint::secondDerivatives: totE = " << E << endl;
+    }
+  
+    double m2 = std::abs(E*E-px*px-py*py-pz*pz);
+    double m = std::sqrt(m2);
+    if (index) m = -m;
+    double minv3 = 1/(m*m*m);
+
+    double *d = d2gdp2[index];
+    d[4*0+0] =                 (m2-E*E)  *minv3;
+    d[4*0+1] = d[4*1+0] =       E*px     *minv3;
+    d[4*0+2] = d[4*2+0] =       E*py     *minv3;
+    d[4*0+3] = d[4*3+0] =       E*pz     *minv3;
+    d[4*1+1] =               -(m2+px*px) *minv3;
+    d[4*1+2] = d[4*2+1] =     -px*py     *minv3;
+    d[4*1+3] = d[4*3+1] =     -px*pz     *minv3;
+    d[4*2+2] =               -(m2+py*py) *minv3;
+    d[4*2+3] = d[4*3+2] =     -py*pz     *minv3;
+    d[4*3+3] =               -(m2+pz*pz) *minv3;
+  }
+  have2nd = true;
+}
+
 bool SoftGaussMassConstraint::secondDerivatives (int i, int j, double *dderivatives) const 
 {
   // cout << "SoftGaussMassConstraint::secondDerivatives: i=" << i << ", j=" << j << endl;
   int index = (flags[i] == 1) ? 0 : 1; // default is 1, but 2 may indicate fitobjects for a second W -> equal mass constraint!
   int jndex = (flags[j] == 1) ? 0 : 1; // default is 1, but 2 may indicate fitobjects for a second W -> equal mass constraint!
   if (index != jndex) return false;
-  double totE = 0;
-  double totpx = 0; 
-  double totpy = 0; 
-  double totpz = 0; 
-  for (unsigned int k = 0; k < fitobjects.size(); ++k) {
-    int kndex = (flags[k] == 1) ? 0 : 1; // default is 1, but 2 may indicate fitobjects for a second W -> equal mass constraint!
-    const ParticleFitObject *fok = fitobjects[k];
-    assert (fok);
-    if (index == kndex) {
-      totE  += fok->getE(); 
-      totpx += fok->getPx(); 
-      totpy += fok->getPy(); 
-      totpz += fok->getPz(); 
-    }
-  }
-  
-  if (totE <= 0) {
-    cerr << "SoftGaussMassConstraint::secondDerivatives: totE = " << totE << endl;
-  }
-  
-  double m2 = std::abs(totE*totE-totpx*totpx-totpy*totpy-totpz*totpz);
-  double m = std::sqrt(m2);
-  if (index) m = -m;
-  double minv3 = 1/(m*m*m);
+  if (!isEvaluated()) evaluate();
+  if (!have2nd) evaluate2ndDerivatives();
 
   assert (dderivatives);
-  for (int k = 0; k<16; ++k) dderivatives[k] = 0;
-  dderivatives[4*0+0] =                      (m2-totE *totE) *minv3;
-  dderivatives[4*0+1] = dderivatives[4*1+0] =     totE *totpx *minv3;
-  dderivatives[4*0+2] = dderivatives[4*2+0] =     totE *totpy *minv3;
-  dderivatives[4*0+3] = dderivatives[4*3+0] =     totE *totpz *minv3;
-  dderivatives[4*1+1] =                     -(m2+totpx*totpx)*minv3;
-  dderivatives[4*1+2] = dderivatives[4*2+1] =    -totpx*totpy *minv3;
-  dderivatives[4*1+3] = dderivatives[4*3+1] =    -totpx*totpz *minv3;
-  dderivatives[4*2+2] =                     -(m2+totpy*totpy)*minv3;
-  dderivatives[4*2+3] = dderivatives[4*3+2] =    -totpy*totpz *minv3;
-  dderivatives[4*3+3] =                     -(m2+totpz*totpz)*minv3;
-  // cout << "   ...minv=" << minv << endl; 
+  for (int k = 0; k<16; ++k) dderivatives[k] = d2gdp2[index][k];
   return true;
 }
 
+bool SoftGaussMassConstraint::hasSecondDerivatives (int i, int j) const {
+  int index = (flags[i] == 1) ? 0 : 1;
+  int jndex = (flags[j] == 1) ? 0 : 1;
+  return index == jndex;
+}
+
 bool SoftGaussMassConstraint::firstDerivatives (int i, double *dderivatives) const {
-  double totE = 0;
-  double totpx = 0; 
-  double totpy = 0; 
-  double totpz = 0; 
   int index = (flags[i] == 1) ? 0 : 1; // default is 1, but 2 may indicate fitobjects for a second W -> equal mass constraint!
-  for (unsigned int j = 0; j < fitobjects.size(); ++j) {
-    int jndex = (flags[j] == 1) ? 0 : 1; // default is 1, but 2 may indicate fitobjects for a second W -> equal mass constraint!
-    const ParticleFitObject *foj = fitobjects[j];
-    assert (foj);
-    if (index == jndex) {
-      totE  += foj->getE(); 
-      totpx += foj->getPx(); 
-      totpy += foj->getPy(); 
-      totpz += foj->getPz(); 
-    }
-  }
-  
-  if (totE <= 0) {
-    cerr << "SoftGaussMassConstraint::firstDerivatives: totE = " << totE << endl;
-  }
-  
-  double m = std::sqrt(std::abs(totE*totE-totpx*totpx-totpy*totpy-totpz*totpz));
-  if (index) m = -m;
+  if (!isEvaluated()) evaluate();
+  if (!have1st) evaluate1stDerivatives();
 
-  dderivatives[0] = totE/m;
-  dderivatives[1] = -totpx/m;
-  dderivatives[2] = -totpy/m;
-  dderivatives[3] = -totpz/m;
+  for (int k = 0; k<4; ++k) dderivatives[k] = dgdp[index][k];
   return true;
 }
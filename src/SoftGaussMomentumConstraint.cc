@@ -78,6 +78,10 @@ void SoftGaussMomentumConstraint::getDerivatives(int idim, double der[]) const {
 }
   
 
+bool SoftGaussMomentumConstraint::hasSecondDerivatives (int, int) const {
+  return false;
+}
+
 bool SoftGaussMomentumConstraint::firstDerivatives (int i, double *derivatives) const {
   derivatives[0] = efact;
   derivatives[1] = pxfact;
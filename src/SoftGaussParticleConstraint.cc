@@ -2,7 +2,12 @@
  *  \brief Implements class SoftGaussParticleConstraint
  *
  * \b Changelog:
- * - 
+ * - 16.10.2026 Work arrays of add2ndDerivativesToMatrix from a ScratchArena
+ * - 16.10.2026 Chain rule of add2ndDerivativesToMatrix in ChainRuleKernels
+ * - 16.10.2026 add2ndDerivativesToMatrix only for pairs of fit objects with second derivatives
+ * - 16.10.2026 Evaluation of value and derivatives in one pass, kept during the derivative assembly
+ * - 16.10.2026 add2ndDerivativesToMatrix examines only the parameters of its fit objects
+ * - 16.10.2026 Versions of add2ndDerivativesToMatrix with and without arena call each other once
  *
  * \b CVS Log messages:
  * - $Log: SoftGaussParticleConstraint.cc,v $
@@ -26,11 +31,25 @@
 
 #include "SoftGaussParticleConstraint.h"
 #include "ParticleFitObject.h"
+#include "SparseSymMatrix.h"
+#include "ScratchArena.h"
+#include "ChainRuleKernels.h"
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 using namespace std;
+
+namespace {
+  void addTo2ndDerivatives (const ParticleFitObject *fo, DenseMatrixRef& M, double lambda, double der[], int metaSet) {
+    fo->addTo2ndDerivatives (M.M, M.idim, lambda, der, metaSet);
+  }
+  void addTo2ndDerivatives (const ParticleFitObject *fo, SparseSymMatrix& M, double lambda, double der[], int metaSet) {
+    fo->addTo2ndDerivatives (M, lambda, der, metaSet);
+  }
+}
 SoftGaussParticleConstraint::SoftGaussParticleConstraint(double sigma_)
-: sigma (sigma_)
+: sigma (sigma_), secondDerivativePairs (std::vector <int> ()), npairobjects (-1),
+  evaluated (false)
 {
   invalidateCache();
 }
@@ -52,6 +71,7 @@ double SoftGaussParticleConstraint::getChi2() const {
 }
   
 double SoftGaussParticleConstraint::getError() const {
+  Evaluation evaluation (*this);
   double dgdpi[4];
   double error2 = 0;
   for (unsigned int i = 0; i < fitobjects.size(); ++i) {
@@ -87,8 +107,11 @@ double SoftGaussParticleConstraint::getError() const {
  */
  
  
-void SoftGaussParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim) const
+template <class Matrix>
+void SoftGaussParticleConstraint::add2ndDerivativesToMatrixT (Matrix& M, ScratchArena& scratch) const
 {
+  Evaluation evaluation (*this);
+  ScratchArena::Frame frame (scratch);
 
   /** First, treat the part 
    * $$
@@ -108,20 +131,17 @@ void SoftGaussParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim
   // with ii=0, 1, 2, 3 for E, px, py, pz
   const int KMAX=4;
   const int n = fitobjects.size();
-  double *dPidAk = new double[n*KMAX*4];
-  bool *dPidAkval = new bool[n];
+  double *dPidAk = scratch.alloc<double> (n*KMAX*4);
+  bool *dPidAkval = scratch.alloc<bool> (n);
   
   for (int i = 0; i < n; ++i) dPidAkval[i] = false;
   
-  // Derivatives $\frac{\partial ^2 g}{\partial P_i \partial a_l}$ at fixed i
-  // d2GdPdAl[4*l + ii] is $\frac{\partial ^2 g}{\partial P_{i,ii} \partial a_l}$
-  double d2GdPdAl[4*KMAX];
   // Derivatives $\frac{\partial ^2 g}{\partial a_k \partial a_l}$ 
   double d2GdAkdAl[KMAX*KMAX];
   
   // Global parameter numbers: parglobal[KMAX*i+klocal] 
   // is global parameter number of local parameter klocal of i-th Fit object
-  int *parglobal = new int[KMAX*n];
+  int *parglobal = scratch.alloc<int> (KMAX*n);
   
   for (int i = 0; i < n; ++i) {
     const ParticleFitObject *foi = fitobjects[i];
@@ -132,61 +152,41 @@ void SoftGaussParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim
   }
   
   
-  for (int i = 0; i < n; ++i) {
+  // Only pairs of fit objects that can have second derivatives
+  const std::vector <int>& pairs = getSecondDerivativePairs();
+  for (unsigned int ipair = 0; ipair < pairs.size(); ipair += 2) {
+    int i = pairs[ipair];
+    int j = pairs[ipair+1];
     const ParticleFitObject *foi = fitobjects[i];
     assert (foi);
-    for (int j = 0; j < n; ++j) {
-      const ParticleFitObject *foj = fitobjects[j];
-      assert (foj);
-      if (secondDerivatives (i, j, d2GdPidPj)) {
-        if (!dPidAkval[i]) {
-          foi->getDerivatives (dPidAk+i*(KMAX*4), KMAX*4);
-          dPidAkval[i] = true;
-        }
-        if (!dPidAkval[j]) {
-          foj->getDerivatives (dPidAk+j*(KMAX*4), KMAX*4);
-          dPidAkval[j] = true;
-        }
-        // Now sum over E/px/Py/Pz for object j:
-        // $$\frac{\partial ^2 g}{\partial P_{i,ii} \partial a_l}
-        //   = (sum_{j}) sum_{jj} frac{\partial ^2 g}{\partial P_{i,ii} \partial P_{j,jj}}  
-        //     \cdot \frac{\partial P_{j,jj}}{\partial a_l}
-        // We're summing over jj here
+    const ParticleFitObject *foj = fitobjects[j];
+    assert (foj);
+    if (secondDerivatives (i, j, d2GdPidPj)) {
+      if (!dPidAkval[i]) {
+        foi->getDerivatives (dPidAk+i*(KMAX*4), KMAX*4);
+        dPidAkval[i] = true;
+      }
+      if (!dPidAkval[j]) {
+        foj->getDerivatives (dPidAk+j*(KMAX*4), KMAX*4);
+        dPidAkval[j] = true;
+      }
+      // Now sum over E/px/Py/Pz for object j and for object i:
+      // $$
+      // \frac{\partial ^2 g}{\partial a_k \partial a_l}
+      //      = \sum_{ii} \sum_{jj} \frac{\partial P_{i,ii}}{\partial a_k} \cdot
+      //        \frac{\partial ^2 g}{\partial P_{i,ii} \partial P_{j,jj}} \cdot
+      //        \frac{\partial P_{j,jj}}{\partial a_l}
+      // $$
+      ChainRuleKernels::contract (d2GdPidPj, dPidAk+(KMAX*4)*i, foi->getNPar(),
+                                  dPidAk+(KMAX*4)*j, foj->getNPar(), d2GdAkdAl, KMAX);
+      // Now expand the local parameter numbers to global ones
+      for (int klocal = 0; klocal < foi->getNPar(); ++klocal) {
+        int kglobal = parglobal [KMAX*i + klocal];
+        if (kglobal < 0) continue;
         for (int llocal = 0; llocal < foj->getNPar(); ++llocal) {
-          for (int ii = 0; ii < 4; ++ii) {
-            int ind1 = 4*ii;
-            int ind2 = (KMAX*4)*j + 4*llocal;
-            double& r = d2GdPdAl[4*llocal + ii];
-            r  = d2GdPidPj[  ind1] * dPidAk[  ind2];   // E
-            r += d2GdPidPj[++ind1] * dPidAk[++ind2];   // px
-            r += d2GdPidPj[++ind1] * dPidAk[++ind2];   // py
-            r += d2GdPidPj[++ind1] * dPidAk[++ind2];   // pz
-          }
-        }
-        // Now sum over E/px/Py/Pz for object i, i.e. sum over ii:
-        // $$
-        // \frac{\partial ^2 g}{\partial a_k \partial a_l}
-        //      = \sum_{ii} \frac{\partial ^2 g}{\partial P_{i,ii} \partial a_l} \cdot 
-        //        \frac{\partial P_{i,ii}}{\partial a_k}
-        // $$
-        for (int klocal = 0; klocal < foi->getNPar(); ++klocal) {
-          for (int llocal = 0; llocal < foj->getNPar(); ++llocal) {
-            int ind1 = 4*llocal;
-            int ind2 = (KMAX*4)*i + 4*klocal;
-            double& r = d2GdAkdAl[KMAX*klocal+llocal];
-            r  = d2GdPdAl[  ind1] * dPidAk[  ind2];    //E
-            r += d2GdPdAl[++ind1] * dPidAk[++ind2];   // px
-            r += d2GdPdAl[++ind1] * dPidAk[++ind2];   // py
-            r += d2GdPdAl[++ind1] * dPidAk[++ind2];   // pz
-          }
-        }
-        // Now expand the local parameter numbers to global ones
-        for (int klocal = 0; klocal < foi->getNPar(); ++klocal) {
-          int kglobal = parglobal [KMAX*i + klocal];
-          for (int llocal = 0; llocal < foj->getNPar(); ++llocal) {
-            int lglobal = parglobal [KMAX*j + llocal];
-            M [idim*kglobal+lglobal] += fact*d2GdAkdAl[KMAX*klocal+llocal];
-          }
+          int lglobal = parglobal [KMAX*j + llocal];
+          if (lglobal < 0) continue;
+          M.add (kglobal, lglobal, fact*d2GdAkdAl[KMAX*klocal+llocal]);
         }
       }
     }
@@ -209,8 +209,21 @@ void SoftGaussParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim
    * the FitObject
    */
   
-  double *v = new double[idim];
-  for (int i = 0; i < idim; ++i) v[i] = 0;
+  // v can only be nonzero at the global parameters of the fit objects,
+  // so only these are set to 0 and examined afterwards
+  int idim = M.getDim();
+  double *v = scratch.alloc<double> (idim);
+  int *nonzero = scratch.alloc<int> (getNParTotal());
+  int nindex = 0;
+  for (int i = 0; i < n; ++i) {
+    const ParticleFitObject *foi = fitobjects[i];
+    for (int klocal = 0; klocal < foi->getNPar(); ++klocal) {
+      int kglobal = foi->getGlobalParNum (klocal);
+      if (kglobal < 0) continue;
+      v[kglobal] = 0;
+      nonzero[nindex++] = kglobal;
+    }
+  }
   double sqrtfact2 = sqrt(2.0)/s;
   
   double dgdpi[4];
@@ -218,28 +231,112 @@ void SoftGaussParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim
     const ParticleFitObject *foi = fitobjects[i];
     assert (foi);
     if (firstDerivatives (i, dgdpi)) {
-      foi->addTo2ndDerivatives (M, idim, fact, dgdpi, getVarBasis() );
+      addTo2ndDerivatives (foi, M, fact, dgdpi, getVarBasis() );
       foi->addToGlobalChi2DerVector (v, idim, sqrtfact2, dgdpi, getVarBasis() );
     }
   }
   
-  for (int i = 0; i<idim; ++i) {
-    if (double vi = v[i]) {
-      int ioffs = i*idim;
-      for (double *pvj = v; pvj < v+idim; ++pvj) {
-        M[ioffs++] += vi*(*pvj);
+  // only the nonzero elements of v contribute
+  std::sort (nonzero, nonzero+nindex);
+  nindex = std::unique (nonzero, nonzero+nindex) - nonzero;
+  int nnonzero = 0;
+  for (int k = 0; k < nindex; ++k) if (v[nonzero[k]]) nonzero[nnonzero++] = nonzero[k];
+  for (int k = 0; k < nnonzero; ++k) {
+    int i = nonzero[k];
+    double vi = v[i];
+    for (int l = 0; l < nnonzero; ++l) {
+      M.add (i, nonzero[l], vi*v[nonzero[l]]);
+    }
+  }
+}
+
+// The versions with and without arena call each other once through the
+// virtual functions, so that overrides of either are called, see ScratchDispatch
+void SoftGaussParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim) const
+{
+  ScratchDispatch::Call call (dispatch);
+  if (call.first()) {
+    add2ndDerivativesToMatrix (M, idim, call.makeArena (getScratchSize (idim)));
+  }
+  else {
+    DenseMatrixRef Mref (M, idim);
+    add2ndDerivativesToMatrixT (Mref, call.arena());
+  }
+}
+
+void SoftGaussParticleConstraint::add2ndDerivativesToMatrix (SparseSymMatrix& M) const
+{
+  ScratchDispatch::Call call (dispatch);
+  if (call.first()) {
+    add2ndDerivativesToMatrix (M, call.makeArena (getScratchSize (M.getDim())));
+  }
+  else {
+    add2ndDerivativesToMatrixT (M, call.arena());
+  }
+}
+
+void SoftGaussParticleConstraint::add2ndDerivativesToMatrix (double *M, int idim, ScratchArena& scratch) const
+{
+  ScratchDispatch::Call call (dispatch, scratch);
+  if (call.first()) {
+    add2ndDerivativesToMatrix (M, idim);
+  }
+  else {
+    DenseMatrixRef Mref (M, idim);
+    add2ndDerivativesToMatrixT (Mref, scratch);
+  }
+}
+
+void SoftGaussParticleConstraint::add2ndDerivativesToMatrix (SparseSymMatrix& M, ScratchArena& scratch) const
+{
+  ScratchDispatch::Call call (dispatch, scratch);
+  if (call.first()) {
+    add2ndDerivativesToMatrix (M);
+  }
+  else {
+    add2ndDerivativesToMatrixT (M, scratch);
+  }
+}
+
+bool SoftGaussParticleConstraint::hasSecondDerivatives (int, int) const {
+  return true;
+}
+
+const std::vector <int>& SoftGaussParticleConstraint::getSecondDerivativePairs() const {
+  const int n = fitobjects.size();
+  if (npairobjects != n) {
+    secondDerivativePairs.resize (0);
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+        if (hasSecondDerivatives (i, j)) {
+          secondDerivativePairs.push_back (i);
+          secondDerivativePairs.push_back (j);
+        }
       }
     }
+    npairobjects = n;
   }
-  
-  
-  delete[] dPidAk;
-  delete[] dPidAkval;
-  delete[] parglobal;
-  delete[] v;
+  return secondDerivativePairs;
+}
+
+int SoftGaussParticleConstraint::getNParTotal() const
+{
+  int npartotal = 0;
+  for (unsigned int i = 0; i < fitobjects.size(); ++i) npartotal += fitobjects[i]->getNPar();
+  return npartotal;
+}
+
+std::size_t SoftGaussParticleConstraint::getScratchSize (int idim) const
+{
+  const int KMAX=4;
+  const int n = fitobjects.size();
+  return ScratchArena::size<double> (n*KMAX*4) + ScratchArena::size<bool> (n) 
+       + ScratchArena::size<int> (KMAX*n) + ScratchArena::size<double> (idim) 
+       + ScratchArena::size<int> (getNParTotal());
 }
 
 void SoftGaussParticleConstraint::addToGlobalChi2DerVector (double *y, int idim) const {
+  Evaluation evaluation (*this);
   double dgdpi[4];
   double s = getSigma();
   double r = 2*getValue()/(s*s);
@@ -0,0 +1,248 @@
+/*! \file
+ *  \brief Implements class SparseLDLSolver
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#undef NDEBUG
+
+#include "SparseLDLSolver.h"
+#include "SparseSymMatrix.h"
+
+#include <cassert>
+#include <cmath>
+#include <set>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+  // Priority of a row in the minimum degree ordering
+  struct DegreeKey {
+    int phase;
+    int degree;
+    int row;
+    bool operator< (const DegreeKey& rhs) const {
+      if (phase != rhs.phase) return phase < rhs.phase;
+      if (degree != rhs.degree) return degree < rhs.degree;
+      return row < rhs.row;
+    }
+  };
+}
+
+SparseLDLSolver::SparseLDLSolver()
+: matrix (0), version (0), analyzed (false), factorized (false), n (0)
+{}
+
+SparseLDLSolver::~SparseLDLSolver() {}
+
+void SparseLDLSolver::setPhases (const std::vector<int>& phase_) {
+  if (phase_ != phase) {
+    phase = phase_;
+    analyzed = false;
+  }
+}
+
+void SparseLDLSolver::order (const SparseSymMatrix& A) {
+  // Adjacency lists of the elimination graph, sorted by row number
+  std::vector<std::vector<int> > adj (n);
+  for (int j = 0; j < n; ++j) {
+    for (int k = 0; k < A.getColSize (j); ++k) {
+      int i = A.getRow (j, k);
+      if (i != j) {
+        adj[i].push_back (j);
+        adj[j].push_back (i);
+      }
+    }
+  }
+  for (int i = 0; i < n; ++i) std::sort (adj[i].begin(), adj[i].end());
+
+  bool usephases = ((int)phase.size() == n);
+  std::set<DegreeKey> queue;
+  for (int i = 0; i < n; ++i) {
+    DegreeKey key = {usephases ? phase[i] : 0, (int)adj[i].size(), i};
+    queue.insert (key);
+  }
+
+  // Eliminate the row with the lowest phase and the smallest degree,
+  // its neighbours become a clique
+  std::vector<int> merged;
+  for (int step = 0; step < n; ++step) {
+    int v = queue.begin()->row;
+    queue.erase (queue.begin());
+    perm[step] = v;
+    const std::vector<int>& nb = adj[v];
+    for (unsigned int k = 0; k < nb.size(); ++k) {
+      int u = nb[k];
+      DegreeKey key = {usephases ? phase[u] : 0, (int)adj[u].size(), u};
+      queue.erase (key);
+      merged.clear();
+      std::set_union (adj[u].begin(), adj[u].end(), nb.begin(), nb.end(), std::back_inserter (merged));
+      adj[u].clear();
+      for (unsigned int l = 0; l < merged.size(); ++l)
+        if (merged[l] != u && merged[l] != v) adj[u].push_back (merged[l]);
+      key.degree = adj[u].size();
+      queue.insert (key);
+    }
+    std::vector<int>().swap (adj[v]);
+  }
+}
+
+void SparseLDLSolver::analyze (const SparseSymMatrix& A) {
+  n = A.getDim();
+  perm.resize (n);
+  pinv.resize (n);
+  order (A);
+  for (int k = 0; k < n; ++k) pinv[perm[k]] = k;
+
+  // Upper triangle of P*A*P^T
+  Cp.assign (n+1, 0);
+  for (int j = 0; j < n; ++j) {
+    for (int k = 0; k < A.getColSize (j); ++k) {
+      int pi = pinv[A.getRow (j, k)];
+      int pj = pinv[j];
+      ++Cp[(pi > pj ? pi : pj) + 1];
+    }
+  }
+  for (int k = 0; k < n; ++k) Cp[k+1] += Cp[k];
+  int nnz = Cp[n];
+  Ci.resize (nnz);
+  Cx.resize (nnz);
+  Cmap.resize (nnz);
+  flag.assign (Cp.begin(), Cp.end()-1);
+  int ielem = 0;
+  for (int j = 0; j < n; ++j) {
+    for (int k = 0; k < A.getColSize (j); ++k) {
+      int pi = pinv[A.getRow (j, k)];
+      int pj = pinv[j];
+      int pos = flag[pi > pj ? pi : pj]++;
+      Ci[pos] = (pi < pj ? pi : pj);
+      Cmap[ielem++] = pos;
+    }
+  }
+
+  // Elimination tree and number of elements per column of L
+  parent.resize (n);
+  Lnz.resize (n);
+  flag.resize (n);
+  for (int k = 0; k < n; ++k) {
+    parent[k] = -1;
+    flag[k] = k;
+    Lnz[k] = 0;
+    for (int p = Cp[k]; p < Cp[k+1]; ++p) {
+      int i = Ci[p];
+      if (i < k) {
+        for (; flag[i] != k; i = parent[i]) {
+          if (parent[i] == -1) parent[i] = k;
+          ++Lnz[i];
+          flag[i] = k;
+        }
+      }
+    }
+  }
+  Lp.resize (n+1);
+  Lp[0] = 0;
+  for (int k = 0; k < n; ++k) Lp[k+1] = Lp[k] + Lnz[k];
+  Li.resize (Lp[n]);
+  Lx.resize (Lp[n]);
+  D.resize (n);
+  y.assign (n, 0);
+  pattern.resize (n);
+
+  matrix = &A;
+  version = A.getPatternVersion();
+  analyzed = true;
+}
+
+int SparseLDLSolver::factorize (const SparseSymMatrix& A, double pivtol) {
+  if (!analyzed || matrix != &A || version != A.getPatternVersion() || n != A.getDim()) analyze (A);
+  factorized = false;
+
+  double amax = 0;
+  int ielem = 0;
+  for (int j = 0; j < n; ++j) {
+    for (int k = 0; k < A.getColSize (j); ++k) {
+      double a = A.getValue (j, k);
+      Cx[Cmap[ielem++]] = a;
+      if (std::fabs (a) > amax) amax = std::fabs (a);
+    }
+  }
+  double tol = pivtol*amax;
+
+  // Up-looking factorization: row k of L from the solution of a triangular system
+  for (int k = 0; k < n; ++k) {
+    y[k] = 0;
+    int top = n;
+    flag[k] = k;
+    Lnz[k] = 0;
+    for (int p = Cp[k]; p < Cp[k+1]; ++p) {
+      int i = Ci[p];
+      y[i] += Cx[p];
+      int len = 0;
+      for (; flag[i] != k; i = parent[i]) {
+        pattern[len++] = i;
+        flag[i] = k;
+      }
+      while (len > 0) pattern[--top] = pattern[--len];
+    }
+    D[k] = y[k];
+    y[k] = 0;
+    for (; top < n; ++top) {
+      int i = pattern[top];
+      double yi = y[i];
+      y[i] = 0;
+      int p2 = Lp[i] + Lnz[i];
+      int p;
+      for (p = Lp[i]; p < p2; ++p) y[Li[p]] -= Lx[p]*yi;
+      double lki = yi/D[i];
+      D[k] -= lki*yi;
+      Li[p] = k;
+      Lx[p] = lki;
+      ++Lnz[i];
+    }
+    if (!(std::fabs (D[k]) > tol)) return k+1;
+  }
+  factorized = true;
+  return 0;
+}
+
+void SparseLDLSolver::solve (double *x) const {
+  assert (x);
+  assert (factorized);
+  for (int k = 0; k < n; ++k) y[k] = x[perm[k]];
+  for (int j = 0; j < n; ++j) {
+    double yj = y[j];
+    for (int p = Lp[j]; p < Lp[j+1]; ++p) y[Li[p]] -= Lx[p]*yj;
+  }
+  for (int j = 0; j < n; ++j) y[j] /= D[j];
+  for (int j = n-1; j >= 0; --j) {
+    double yj = y[j];
+    for (int p = Lp[j]; p < Lp[j+1]; ++p) yj -= Lx[p]*y[Li[p]];
+    y[j] = yj;
+  }
+  for (int k = 0; k < n; ++k) x[perm[k]] = y[k];
+}
+
+int SparseLDLSolver::getNNZL() const {
+  return analyzed ? Lp[n] : 0;
+}
+
+double SparseLDLSolver::getDeterminant() const {
+  if (!factorized) return 0;
+  double result = 1;
+  for (int k = 0; k < n; ++k) result *= D[k];
+  return result;
+}
+
+int SparseLDLSolver::getNPositive() const {
+  int result = 0;
+  if (factorized) for (int k = 0; k < n; ++k) if (D[k] > 0) ++result;
+  return result;
+}
+
+int SparseLDLSolver::getNNegative() const {
+  int result = 0;
+  if (factorized) for (int k = 0; k < n; ++k) if (D[k] < 0) ++result;
+  return result;
+}
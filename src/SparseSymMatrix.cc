@@ -0,0 +1,149 @@
+/*! \file
+ *  \brief Implements class SparseSymMatrix
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version
+ *
+ */
+
+#undef NDEBUG
+
+#include "SparseSymMatrix.h"
+
+#include <cassert>
+#include <cmath>
+
+SparseSymMatrix::SparseSymMatrix (int n_)
+: n (0), nnz (0), version (0)
+{
+  resize (n_);
+}
+
+SparseSymMatrix::~SparseSymMatrix() {}
+
+void SparseSymMatrix::resize (int n_) {
+  assert (n_ >= 0);
+  n = n_;
+  nnz = 0;
+  cols.resize (n);
+  for (int j = 0; j < n; ++j) cols[j].clear();
+  ++version;
+}
+
+void SparseSymMatrix::setZero() {
+  for (int j = 0; j < n; ++j) {
+    Column& c = cols[j];
+    for (unsigned int k = 0; k < c.size(); ++k) c[k].val = 0;
+  }
+}
+
+double& SparseSymMatrix::element (int i, int j) {
+  assert (i >= 0 && i <= j && j < n);
+  Column& c = cols[j];
+  // binary search for row i
+  int lo = 0, hi = c.size();
+  while (lo < hi) {
+    int mid = (lo + hi)/2;
+    if (c[mid].row < i) lo = mid+1;
+    else hi = mid;
+  }
+  if (lo < (int)c.size() && c[lo].row == i) return c[lo].val;
+  Element e = {i, 0};
+  c.insert (c.begin()+lo, e);
+  ++nnz;
+  ++version;
+  return c[lo].val;
+}
+
+double SparseSymMatrix::get (int i, int j) const {
+  if (i > j) {int t = i; i = j; j = t;}
+  assert (i >= 0 && j < n);
+  const Column& c = cols[j];
+  for (unsigned int k = 0; k < c.size() && c[k].row <= i; ++k)
+    if (c[k].row == i) return c[k].val;
+  return 0;
+}
+
+void SparseSymMatrix::assignScaled (const SparseSymMatrix& source, const double *e) {
+  assert (e);
+  if (n != source.n) resize (source.n);
+  for (int j = 0; j < n; ++j) {
+    Column& c = cols[j];
+    const Column& s = source.cols[j];
+    bool same = (c.size() == s.size());
+    for (unsigned int k = 0; same && k < c.size(); ++k) same = (c[k].row == s[k].row);
+    if (!same) {
+      nnz += (int)s.size() - (int)c.size();
+      c = s;
+      ++version;
+    }
+    double ej = e[j];
+    for (unsigned int k = 0; k < c.size(); ++k) c[k].val = e[s[k].row]*ej*s[k].val;
+  }
+}
+
+void SparseSymMatrix::multiply (double *y, const double *x) const {
+  assert (y && x);
+  for (int i = 0; i < n; ++i) y[i] = 0;
+  for (int j = 0; j < n; ++j) {
+    const Column& c = cols[j];
+    double xj = x[j];
+    double yj = 0;
+    for (unsigned int k = 0; k < c.size(); ++k) {
+      int i = c[k].row;
+      double a = c[k].val;
+      yj += a*x[i];
+      if (i != j) y[i] += a*xj;
+    }
+    y[j] += yj;
+  }
+}
+
+double SparseSymMatrix::quadraticForm (const double *x, int m) const {
+  assert (x);
+  assert (m >= 0 && m <= n);
+  double result = 0;
+  for (int j = 0; j < m; ++j) {
+    const Column& c = cols[j];
+    double s = 0;
+    for (unsigned int k = 0; k < c.size(); ++k) {
+      int i = c[k].row;
+      s += (i == j ? 1 : 2)*c[k].val*x[i];
+    }
+    result += s*x[j];
+  }
+  return result;
+}
+
+void SparseSymMatrix::copyTo (double *M, int tda) const {
+  assert (M);
+  assert (tda >= n);
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j < n; ++j) M[i*tda+j] = 0;
+  for (int j = 0; j < n; ++j) {
+    const Column& c = cols[j];
+    for (unsigned int k = 0; k < c.size(); ++k) {
+      int i = c[k].row;
+      M[i*tda+j] = M[j*tda+i] = c[k].val;
+    }
+  }
+}
+
+bool SparseSymMatrix::isfinite() const {
+  for (int j = 0; j < n; ++j) {
+    const Column& c = cols[j];
+    for (unsigned int k = 0; k < c.size(); ++k)
+      if (!std::isfinite (c[k].val)) return false;
+  }
+  return true;
+}
+
+double SparseSymMatrix::getMaxAbs() const {
+  double result = 0;
+  for (int j = 0; j < n; ++j) {
+    const Column& c = cols[j];
+    for (unsigned int k = 0; k < c.size(); ++k)
+      if (std::fabs (c[k].val) > result) result = std::fabs (c[k].val);
+  }
+  return result;
+}
@@ -38,6 +38,13 @@ using std::sin;
 //static  double mj   = 1.0;
 //static  double Ecm = 500;
 
+// set the seed of the random number generator
+void TopEventILC::setSeed (unsigned int seed) {
+  if (rnd == 0) rnd = new TRandom3 (seed);
+  else rnd->SetSeed (seed);
+  FourVector::setSeed (seed);
+}
+
 // constructor: 
 TopEventILC::TopEventILC()
 : leptonic (false), leptonasjet (false), debug (false),
@@ -50,10 +57,10 @@ TopEventILC::TopEventILC()
   sw (1.4/sqrt(0.805)),
   w1 (80.4),  
   w2 (80.4),
-  w (0)
+  w (0),
+  random (0)
   {
-  for (int i = 0; i < NFV; ++i) fv[i] = 0;
-  for (int i = 0; i < NBFO; ++i) bfo[i] = bfosmear[i] = 0;
+  for (int i = 0; i < NBFO; ++i) bfo[i] = bfosmear[i] = bfostart[i] = 0;
   pxc.setName ("px=0");
   pyc.setName ("py=0");
   pzc.setName ("pz=0");
@@ -68,13 +75,55 @@ TopEventILC::TopEventILC()
 
 //destructor: 
 TopEventILC::~TopEventILC() {
-  for (int i = 0; i < NFV; ++i) delete fv[i];
   for (int i = 0; i < NBFO; ++i) {
     delete bfo[i];
     delete bfosmear[i];
+    delete bfostart[i];
   }  
 }
 
+// Fit objects are reused from event to event: if the slot already holds
+// an object of the right type, it gets the new values, otherwise
+// it is replaced (e.g. after switching between hadronic and leptonic events)
+static void reuseJet (ParticleFitObject*& fo, double E, double theta, double phi,
+                      double DE, double Dtheta, double Dphi, double m) {
+  if (JetFitObject *jet = dynamic_cast<JetFitObject *>(fo)) {
+    jet->setValues (E, theta, phi, DE, Dtheta, Dphi, m);
+  }
+  else {
+    delete fo;
+    fo = new JetFitObject (E, theta, phi, DE, Dtheta, Dphi, m);
+  }
+}
+
+static void reuseLepton (ParticleFitObject*& fo, double ptinv, double theta, double phi,
+                         double Dptinv, double Dtheta, double Dphi, double m) {
+  if (LeptonFitObject *lepton = dynamic_cast<LeptonFitObject *>(fo)) {
+    lepton->setValues (ptinv, theta, phi, Dptinv, Dtheta, Dphi, m);
+  }
+  else {
+    delete fo;
+    fo = new LeptonFitObject (ptinv, theta, phi, Dptinv, Dtheta, Dphi, m);
+  }
+}
+
+static void reuseNeutrino (ParticleFitObject*& fo, double E, double theta, double phi,
+                           double DE, double Dtheta, double Dphi) {
+  if (NeutrinoFitObject *neutrino = dynamic_cast<NeutrinoFitObject *>(fo)) {
+    neutrino->setValues (E, theta, phi, DE, Dtheta, Dphi);
+  }
+  else {
+    delete fo;
+    fo = new NeutrinoFitObject (E, theta, phi, DE, Dtheta, Dphi);
+  }
+}
+
+// decay with the random number generator of the event, if it has one
+static void decay (const FourVector& mother, FourVector& d1, FourVector& d2, TRandom *random) {
+  if (random) mother.decayto (d1, d2, *random);
+  else mother.decayto (d1, d2);
+}
+
 // Generate Breit-Wigner Random number
 double TopEventILC::bwrandom (double r, double e0, double gamma, double emin, double emax) const {
   double a = atan (2.0*(emax - e0)/gamma);
@@ -121,16 +170,23 @@ void TopEventILC::genEvent(){
   double Ecm = 500;
       
   double rw[4];
-  if (rnd == 0) rnd = new TRandom3();
-  rnd->RndmArray (4, rw);
+  TRandom *r = random;
+  if (r == 0) {
+    if (rnd == 0) rnd = new TRandom3();
+    r = rnd;
+  }
+  r->RndmArray (4, rw);
   
-  FourVector *toppair = fv[0] = new FourVector (Ecm, 0, 0, 0);
+  FourVector *toppair = &fv[0];
+  toppair->setValues (Ecm, 0, 0, 0);
   double mtop1 = bwrandom (rw[0], mtop, gammatop, mtop-3*gammatop, mtop+3*gammatop);
   double mtop2 = bwrandom (rw[1], mtop, gammatop, mtop-3*gammatop, mtop+3*gammatop);
-  FourVector *top1 = fv[1] = new FourVector (mtop1, 0, 0, 0);
-  FourVector *top2 = fv[2] = new FourVector (mtop2, 0, 0, 0);
+  FourVector *top1 = &fv[1];
+  top1->setValues (mtop1, 0, 0, 0);
+  FourVector *top2 = &fv[2];
+  top2->setValues (mtop2, 0, 0, 0);
   
-  toppair->decayto (*top1, *top2);
+  decay (*toppair, *top1, *top2, random);
   if (debug) {
     cout << "top 1: m=" << mtop1 << " = " << top1->getM() << endl;
     cout << "top 2: m=" << mtop2 << " = " << top2->getM() << endl;
@@ -139,26 +195,34 @@ void TopEventILC::genEvent(){
   double mw1 = bwrandom (rw[2], mW, gammaW, mW-3*gammaW, mW+3*gammaW);
   double mw2 = bwrandom (rw[3], mW, gammaW, mW-3*gammaW, mW+3*gammaW);
   
-  FourVector *W1 = fv[3] = new FourVector (mw1, 0, 0, 0);
-  FourVector *W2 = fv[4] = new FourVector (mw2, 0, 0, 0);
-  FourVector *b1 = fv[5] = new FourVector (mb, 0, 0, 0);
-  FourVector *b2 = fv[8] = new FourVector (mb, 0, 0, 0);
+  FourVector *W1 = &fv[3];
+  W1->setValues (mw1, 0, 0, 0);
+  FourVector *W2 = &fv[4];
+  W2->setValues (mw2, 0, 0, 0);
+  FourVector *b1 = &fv[5];
+  b1->setValues (mb, 0, 0, 0);
+  FourVector *b2 = &fv[8];
+  b2->setValues (mb, 0, 0, 0);
   if (debug) {
     cout << "W 1: m=" << mw1 << " = " << W1->getM() << endl;
     cout << "W 2: m=" << mw2 << " = " << W2->getM() << endl;
   }  
   
-  top1->decayto (*W1, *b1);
-  top2->decayto (*W2, *b2);
+  decay (*top1, *W1, *b1, random);
+  decay (*top2, *W2, *b2, random);
   
-  FourVector *j11 = fv[6]  = new FourVector (mj, 0, 0, 0);
-  FourVector *j12 = fv[7]  = new FourVector (mj, 0, 0, 0);
+  FourVector *j11 = &fv[6];
+  j11->setValues (mj, 0, 0, 0);
+  FourVector *j12 = &fv[7];
+  j12->setValues (mj, 0, 0, 0);
   if (leptonic) mj = 0; // W2 decays to "massless" particles
-  FourVector *j21 = fv[9]  = new FourVector (mj, 0, 0, 0);
-  FourVector *j22 = fv[10] = new FourVector (mj, 0, 0, 0);
+  FourVector *j21 = &fv[9];
+  j21->setValues (mj, 0, 0, 0);
+  FourVector *j22 = &fv[10];
+  j22->setValues (mj, 0, 0, 0);
   
-  W1->decayto (*j11, *j12);
-  W2->decayto (*j21, *j22);
+  decay (*W1, *j11, *j12, random);
+  decay (*W2, *j21, *j22, random);
   
   double Eresolhad = 0.35;     // 35% / sqrt (E)
   double Eresolem = 0.10;     // 10% / sqrt (E)
@@ -174,10 +238,10 @@ void TopEventILC::genEvent(){
   
   for (int j = 0; j < 6; ++j) {
     int i = j+5;
-    double E = fv[i]->getE();
-    double theta = fv[i]->getTheta();
-    double phi = fv[i]->getPhi();
-    double ptinv = 1/(fv[i]->getPt());
+    double E = fv[i].getE();
+    double theta = fv[i].getTheta();
+    double phi = fv[i].getPhi();
+    double ptinv = 1/(fv[i].getPt());
     //double EError = (j==4 && leptonic) ? Eresolem*sqrt(E) : Eresolhad*sqrt(E);
     double EError = Eresolhad*sqrt(E);  // for jets
     //double ptinvError = ptinv*ptinv*sqrt(pow(sin(theta)*Eresolem*sqrt(E),2)+pow(E*cos(theta)*thetaResol,2));
@@ -194,7 +258,7 @@ void TopEventILC::genEvent(){
     static const char *names[] = {"b1", "j11", "j12", "b2", "j21", "j22"};
     // Create fit object with true quantities for later comparisons
     if (j < 4 || !leptonic || (j == 4 && leptonasjet)) {
-      bfo[j] = new JetFitObject (E, theta, phi, EError, thetaResol, phiResol, 0);
+      reuseJet (bfo[j], E, theta, phi, EError, thetaResol, phiResol, 0);
       bfo[j]->setName (names[j]);
       if (debug) {
         cout << "true jet " << j << ": E = " << bfo[j]->getParam(0) << " +- " << bfo[j]->getError(0)
@@ -204,7 +268,7 @@ void TopEventILC::genEvent(){
       }
     }  
     else if (j == 4 && leptonic && !leptonasjet) {
-      bfo[4] = new LeptonFitObject (ptinv, theta, phi, ptinvError, thetaResolTrack, phiResol, 0.);
+      reuseLepton (bfo[4], ptinv, theta, phi, ptinvError, thetaResolTrack, phiResol, 0.);
       if (debug) {
         cout << " true Lepton: E = " << bfo[4]->getE() << ", px = " << bfo[4]->getPx() << ", py = " << bfo[4]->getPy() 
              << ", pz = " << bfo[4]->getPz() << endl;
@@ -215,7 +279,7 @@ void TopEventILC::genEvent(){
       }       
     }  
     else if (j == 5 && leptonic) {
-      bfo[5] = new NeutrinoFitObject (E, theta, phi, 0.01, 0.0001, 0.00001);
+      reuseNeutrino (bfo[5], E, theta, phi, 0.01, 0.0001, 0.00001);
       bfo[5]->setName ("n22");
       if (debug) {
         cout << "true Neutrino: E = " << bfo[5]->getE() << ", px = " << bfo[5]->getPx() << ", py = " << bfo[5]->getPy() 
@@ -229,8 +293,7 @@ void TopEventILC::genEvent(){
     if (j == 4 && leptonic) bfo[4]->setName ("e22");
     
     double randoms[3];
-    if (rnd == 0) rnd = new TRandom3();
-    for (int irnd = 0; irnd < 3; ++irnd) randoms[irnd] = rnd->Gaus();
+    for (int irnd = 0; irnd < 3; ++irnd) randoms[irnd] = r->Gaus();
     
     // Create fit object with smeared quantities as fit input
     double ESmear = E + EError*randoms[0];
@@ -247,9 +310,9 @@ void TopEventILC::genEvent(){
     
     
     if (j < 4 || !leptonic || (j == 4 && leptonasjet)) {
-      bfosmear[j] = new JetFitObject (ESmear, thetaSmear, phiSmear, EError, thetaResol, phiResol, 0.);
+      reuseJet (bfosmear[j], ESmear, thetaSmear, phiSmear, EError, thetaResol, phiResol, 0.);
       bfosmear[j]->setName (names[j]);
-      bfostart[j] = new JetFitObject (ESmear, thetaSmear, phiSmear, EError, thetaResol, phiResol, 0.);
+      reuseJet (bfostart[j], ESmear, thetaSmear, phiSmear, EError, thetaResol, phiResol, 0.);
       bfostart[j]->setName (names[j]);
       Etot  += bfosmear[j]->getE();
       pxtot += bfosmear[j]->getPx();
@@ -263,8 +326,8 @@ void TopEventILC::genEvent(){
       }
     }
     else if (j == 4 && leptonic && !leptonasjet) {
-      bfosmear[4] = new LeptonFitObject (ptinvSmear, thetaSmearTrack, phiSmearTrack, ptinvError, thetaResolTrack, phiResolTrack, 0.);
-      bfostart[4] = new LeptonFitObject (ptinvSmear, thetaSmearTrack, phiSmearTrack, ptinvError, thetaResolTrack, phiResolTrack, 0.);
+      reuseLepton (bfosmear[4], ptinvSmear, thetaSmearTrack, phiSmearTrack, ptinvError, thetaResolTrack, phiResolTrack, 0.);
+      reuseLepton (bfostart[4], ptinvSmear, thetaSmearTrack, phiSmearTrack, ptinvError, thetaResolTrack, phiResolTrack, 0.);
       Etot  += bfosmear[4]->getE();
       pxtot += bfosmear[4]->getPx();
       pytot += bfosmear[4]->getPy();
@@ -301,8 +364,8 @@ void TopEventILC::genEvent(){
         cout << "Neutrino: pxn = " << pxn << ", pyn = " << pyn << ", pzn = " << pzn << ", pn = " << pn << endl;
         cout << "Neutrino momenta by hand: px = " << ptn*cos(phi) << ", py = " << ptn*sin(phi) << ", pz = " << pn*cos(theta) << endl;
       }   
-      bfosmear[5] = new NeutrinoFitObject (pn, theta, phi, 14, 0.32, 0.425);  // adjust such that "pull vs true" has width ~1
-      bfostart[5] = new NeutrinoFitObject (pn, theta, phi, 14, 0.32, 0.425);  // adjust such that "pull vs true" has width ~1
+      reuseNeutrino (bfosmear[5], pn, theta, phi, 14, 0.32, 0.425);  // adjust such that "pull vs true" has width ~1
+      reuseNeutrino (bfostart[5], pn, theta, phi, 14, 0.32, 0.425);  // adjust such that "pull vs true" has width ~1
     
       bfosmear[5]->setName ("n22");
       bfostart[5]->setName ("n22");
@@ -320,7 +383,7 @@ void TopEventILC::genEvent(){
       bfostart[4]->setName ("e22");
     }  
     
-    fvsmear[i] = new FourVector (bfosmear[j]->getE(), bfosmear[j]->getPx(), bfosmear[j]->getPy(), bfosmear[j]->getPz());
+    fvsmear[i].setValues (bfosmear[j]->getE(), bfosmear[j]->getPx(), bfosmear[j]->getPy(), bfosmear[j]->getPz());
     
     pxc.addToFOList (*bfosmear[j]);
     pyc.addToFOList (*bfosmear[j]);
@@ -330,11 +393,11 @@ void TopEventILC::genEvent(){
     w.addToFOList (*bfosmear[j], j<3?1:2);
       
   }
-  fvsmear[3] = new FourVector (*fvsmear[6]+*fvsmear[7]);
-  fvsmear[4] = new FourVector (*fvsmear[9]+*fvsmear[10]);
-  fvsmear[1] = new FourVector (*fvsmear[3]+*fvsmear[5]);
-  fvsmear[2] = new FourVector (*fvsmear[4]+*fvsmear[8]);
-  fvsmear[0] = new FourVector (*fvsmear[1]+*fvsmear[2]);
+  fvsmear[3] = fvsmear[6]+fvsmear[7];
+  fvsmear[4] = fvsmear[9]+fvsmear[10];
+  fvsmear[1] = fvsmear[3]+fvsmear[5];
+  fvsmear[2] = fvsmear[4]+fvsmear[8];
+  fvsmear[0] = fvsmear[1]+fvsmear[2];
   
   sw1.addToFOList (*bfosmear[1]);
   sw1.addToFOList (*bfosmear[2]);
@@ -373,20 +436,20 @@ int TopEventILC::fitEvent (BaseFitter& fitter){
       cout << bfosmear[i]->getName() << ": " << *bfosmear[i] << endl;
     }
     cout << "Total: \n";
-    cout << "gen:   " << *fv[0] << ", m=" << fv[0]->getM() << endl;
-    cout << "smear: " << *fvsmear[0] << ", m=" << fvsmear[0]->getM() << endl;
+    cout << "gen:   " << fv[0] << ", m=" << fv[0].getM() << endl;
+    cout << "smear: " << fvsmear[0] << ", m=" << fvsmear[0].getM() << endl;
     cout << "Top1: \n";
-    cout << "gen:   " << *fv[1] << ", m=" << fv[1]->getM() << endl;
-    cout << "smear: " << *fvsmear[1] << ", m=" << fvsmear[1]->getM() << endl;
+    cout << "gen:   " << fv[1] << ", m=" << fv[1].getM() << endl;
+    cout << "smear: " << fvsmear[1] << ", m=" << fvsmear[1].getM() << endl;
     cout << "Top2: \n";
-    cout << "gen:   " << *fv[2] << ", m=" << fv[2]->getM() << endl;
-    cout << "smear: " << *fvsmear[2] << ", m=" << fvsmear[2]->getM() << endl;
+    cout << "gen:   " << fv[2] << ", m=" << fv[2].getM() << endl;
+    cout << "smear: " << fvsmear[2] << ", m=" << fvsmear[2].getM() << endl;
     cout << "W1: \n";
-    cout << "gen:   " << *fv[3] << ", m=" << fv[3]->getM() << endl;
-    cout << "smear: " << *fvsmear[3] << ", m=" << fvsmear[3]->getM() << endl;
+    cout << "gen:   " << fv[3] << ", m=" << fv[3].getM() << endl;
+    cout << "smear: " << fvsmear[3] << ", m=" << fvsmear[3].getM() << endl;
     cout << "W2: \n";
-    cout << "gen:   " << *fv[4] << ", m=" << fv[4]->getM() << endl;
-    cout << "smear: " << *fvsmear[4] << ", m=" << fvsmear[4]->getM() << endl;
+    cout << "gen:   " << fv[4] << ", m=" << fv[4].getM() << endl;
+    cout << "smear: " << fvsmear[4] << ", m=" << fvsmear[4].getM() << endl;
   }
   
    
@@ -435,14 +498,14 @@ int TopEventILC::fitEvent (BaseFitter& fitter){
 
   for (int j = 0; j < 6; ++j) {
     int i = j+5;
-    fvfinal[i] = new FourVector (bfosmear[j]->getE(), bfosmear[j]->getPx(), bfosmear[j]->getPy(), bfosmear[j]->getPz());
+    fvfinal[i].setValues (bfosmear[j]->getE(), bfosmear[j]->getPx(), bfosmear[j]->getPy(), bfosmear[j]->getPz());
   }
   
-  fvfinal[3] = new FourVector (*fvfinal[6]+*fvfinal[7]);
-  fvfinal[4] = new FourVector (*fvfinal[9]+*fvfinal[10]);
-  fvfinal[1] = new FourVector (*fvfinal[3]+*fvfinal[5]);
-  fvfinal[2] = new FourVector (*fvfinal[4]+*fvfinal[8]);
-  fvfinal[0] = new FourVector (*fvfinal[1]+*fvfinal[2]);
+  fvfinal[3] = fvfinal[6]+fvfinal[7];
+  fvfinal[4] = fvfinal[9]+fvfinal[10];
+  fvfinal[1] = fvfinal[3]+fvfinal[5];
+  fvfinal[2] = fvfinal[4]+fvfinal[8];
+  fvfinal[0] = fvfinal[1]+fvfinal[2];
   
   if (debug) {
     cout << "===============After Fiting ===================================\n";
@@ -469,20 +532,20 @@ int TopEventILC::fitEvent (BaseFitter& fitter){
       }       
     }
     cout << "Total: \n";
-    cout << "gen:   " << *fv[0] << ", m=" << fv[0]->getM() << endl;
-    cout << "final: " << *fvfinal[0] << ", m=" << fvfinal[0]->getM() << endl;
+    cout << "gen:   " << fv[0] << ", m=" << fv[0].getM() << endl;
+    cout << "final: " << fvfinal[0] << ", m=" << fvfinal[0].getM() << endl;
     cout << "Top1: \n";
-    cout << "gen:   " << *fv[1] << ", m=" << fv[1]->getM() << endl;
-    cout << "final: " << *fvfinal[1] << ", m=" << fvfinal[1]->getM() << endl;
+    cout << "gen:   " << fv[1] << ", m=" << fv[1].getM() << endl;
+    cout << "final: " << fvfinal[1] << ", m=" << fvfinal[1].getM() << endl;
     cout << "Top2: \n";
-    cout << "gen:   " << *fv[2] << ", m=" << fv[2]->getM() << endl;
-    cout << "final: " << *fvfinal[2] << ", m=" << fvfinal[2]->getM() << endl;
+    cout << "gen:   " << fv[2] << ", m=" << fv[2].getM() << endl;
+    cout << "final: " << fvfinal[2] << ", m=" << fvfinal[2].getM() << endl;
     cout << "W1: \n";
-    cout << "gen:   " << *fv[3] << ", m=" << fv[3]->getM() << endl;
-    cout << "final: " << *fvfinal[3] << ", m=" << fvfinal[3]->getM() << endl;
+    cout << "gen:   " << fv[3] << ", m=" << fv[3].getM() << endl;
+    cout << "final: " << fvfinal[3] << ", m=" << fvfinal[3].getM() << endl;
     cout << "W2: \n";
-    cout << "gen:   " << *fv[4] << ", m=" << fv[4]->getM() << endl;
-    cout << "final: " << *fvfinal[4] << ", m=" << fvfinal[4]->getM() << endl;
+    cout << "gen:   " << fv[4] << ", m=" << fv[4].getM() << endl;
+    cout << "final: " << fvfinal[4] << ", m=" << fvfinal[4].getM() << endl;
     cout << "================================================\n";
   }
   
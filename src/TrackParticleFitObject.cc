@@ -34,74 +34,8 @@ const double TrackParticleFitObject::maxpt = 500; // GeV
 //const double TrackParticleFitObject::parfact[NPAR] = {1., 1., 1., 1., 1.};
 const double TrackParticleFitObject::parfact[NPAR] = {1.e-2, 1., 1.e-3, 1.e-2, 1., 1., 1.};
 
-TrackParticleFitObject::TrackParticleFitObject( const EVENT::Track* trk, double m) 
-  : trackReferencePoint( ThreeVector(0,0,0) ),
-    trackPlaneNormal( ThreeVector(0,0,0) ),
-    trackPcaVector( ThreeVector(0,0,0) ),
-    trajectoryPointAtPCA( ThreeVector(0,0,0) ),
-    trajectoryPointAtStart( ThreeVector(0,0,0) ),
-    trajectoryPointAtEnd( ThreeVector(0,0,0) ),
-    momentumAtPCA( ThreeVector(0,0,0) ),
-    momentumAtStart( ThreeVector(0,0,0) ),
-    momentumAtEnd( ThreeVector(0,0,0) ),
-    phi0(0), omega(0), tanl(0), d0(0), z0(0), s_start(0), s_end(0), chi2(0)
-{
-  invalidateCache();
-
-  double ppar[NPAR];
-  ppar[ iD0    ] =  trk->getD0()       ;
-  ppar[ iPhi0  ] =  trk->getPhi()      ;
-  ppar[ iOmega ] =  trk->getOmega()    ;
-  ppar[ iZ0    ] =  trk->getZ0()       ;
-  ppar[ iTanL  ] =  trk->getTanLambda();
-  ppar[ iStart ] =  0; // this one is not measured
-  ppar[ iEnd   ] =  0; // this one is not measured
-
-  double ccov[15];
-  for (int i=0; i<15; i++) ccov[i]=trk->getCovMatrix()[i];
-
-  trackReferencePoint.setValues( trk->getReferencePoint()[0],
-                                 trk->getReferencePoint()[1],
-                                 trk->getReferencePoint()[2] );
-
-  initialise( ppar , ccov, m );
-}
-
-TrackParticleFitObject::TrackParticleFitObject( const EVENT::TrackState* trk, double m) 
-  : trackReferencePoint( ThreeVector(0,0,0) ),
-    trackPlaneNormal( ThreeVector(0,0,0) ),
-    trackPcaVector( ThreeVector(0,0,0) ),
-    trajectoryPointAtPCA( ThreeVector(0,0,0) ),
-    trajectoryPointAtStart( ThreeVector(0,0,0) ),
-    trajectoryPointAtEnd( ThreeVector(0,0,0) ),
-    momentumAtPCA( ThreeVector(0,0,0) ),
-    momentumAtStart( ThreeVector(0,0,0) ),
-    momentumAtEnd( ThreeVector(0,0,0) ),
-    phi0(0), omega(0), tanl(0), d0(0), z0(0), s_start(0), s_end(0), chi2(0)
-{
-  invalidateCache();
-
-  double ppar[NPAR];
-  ppar[ iD0    ] =  trk->getD0()       ;
-  ppar[ iPhi0  ] =  trk->getPhi()      ;
-  ppar[ iOmega ] =  trk->getOmega()    ;
-  ppar[ iZ0    ] =  trk->getZ0()       ;
-  ppar[ iTanL  ] =  trk->getTanLambda();
-  ppar[ iStart ] =  0; // this one is not measured
-  ppar[ iEnd   ] =  0; // this one is not measured
-
-  double ccov[15];
-  for (int i=0; i<15; i++) ccov[i]=trk->getCovMatrix()[i];
-
-  trackReferencePoint.setValues( trk->getReferencePoint()[0],
-                                 trk->getReferencePoint()[1],
-                                 trk->getReferencePoint()[2] );
-
-  initialise( ppar , ccov, m );
-}
-
 TrackParticleFitObject::TrackParticleFitObject( const double* _ppars, const double* _cov, double m, const double* refPt_) 
-  : trackReferencePoint( ThreeVector(0,0,0) ),
+  : ParticleFitObject (paramstorage), trackReferencePoint( ThreeVector(0,0,0) ),
     trackPlaneNormal( ThreeVector(0,0,0) ),
     trackPcaVector( ThreeVector(0,0,0) ),
     trajectoryPointAtPCA( ThreeVector(0,0,0) ),
@@ -110,7 +44,9 @@ TrackParticleFitObject::TrackParticleFitObject( const double* _ppars, const doub
     momentumAtPCA( ThreeVector(0,0,0) ),
     momentumAtStart( ThreeVector(0,0,0) ),
     momentumAtEnd( ThreeVector(0,0,0) ),
-    phi0(0), omega(0), tanl(0), d0(0), z0(0), s_start(0), s_end(0), chi2(0)
+    phi0(0), omega(0), tanl(0), d0(0), z0(0), s_start(0), s_end(0), chi2(0),
+    momentumDerivativesValid(false), normalDerivativesValid(false), trajectoryDerivativesValid(false),
+    trackBfield(0), useTrackBfield(false)
 {
   invalidateCache();
 
@@ -173,7 +109,7 @@ TrackParticleFitObject::~TrackParticleFitObject() {}
 
 
 TrackParticleFitObject::TrackParticleFitObject (const TrackParticleFitObject& rhs)
-  : trackReferencePoint( ThreeVector(0,0,0) ),
+  : ParticleFitObject (paramstorage), trackReferencePoint( ThreeVector(0,0,0) ),
     trackPlaneNormal( ThreeVector(0,0,0) ),
     trackPcaVector( ThreeVector(0,0,0) ),
     trajectoryPointAtPCA( ThreeVector(0,0,0) ),
@@ -182,7 +118,9 @@ TrackParticleFitObject::TrackParticleFitObject (const TrackParticleFitObject& rh
     momentumAtPCA( ThreeVector(0,0,0) ),
     momentumAtStart( ThreeVector(0,0,0) ),
     momentumAtEnd( ThreeVector(0,0,0) ),
-    phi0(0), omega(0), tanl(0), d0(0), z0(0), s_start(0), s_end(0), chi2(0)
+    phi0(0), omega(0), tanl(0), d0(0), z0(0), s_start(0), s_end(0), chi2(0),
+    momentumDerivativesValid(false), normalDerivativesValid(false), trajectoryDerivativesValid(false),
+    trackBfield(0), useTrackBfield(false)
 {
   //std::cout << "copying TrackParticleFitObject with name " << rhs.name << std::endl;
   TrackParticleFitObject::assign (rhs);
@@ -205,6 +143,8 @@ TrackParticleFitObject& TrackParticleFitObject::assign (const BaseFitObject& sou
   if (const TrackParticleFitObject *psource = dynamic_cast<const TrackParticleFitObject *>(&source)) {
     if (psource != this) {
       ParticleFitObject::assign (source);
+      trackBfield = psource->trackBfield;
+      useTrackBfield = psource->useTrackBfield;
       // only mutable data members, need not to be copied, if cache is invalid
     }
   }
@@ -233,7 +173,7 @@ bool TrackParticleFitObject::updateParams (double p[], int idim) {
   double tempPar[NPAR]={0};
 
   // check that omega is not too small (pt too large)
-  double omegaMin = fabs(omega_pt_conv*getBfield()/maxpt);
+  double omegaMin = fabs(omega_pt_conv*getTrackBfield()/maxpt);
 
   bool result=false;
 
@@ -263,40 +203,40 @@ bool TrackParticleFitObject::updateParams (double p[], int idim) {
 }
 
 ThreeVector TrackParticleFitObject::getTrackPlaneNormal() const {
-  updateCache(); 
+  updateNormalCache();
   return trackPlaneNormal;
 }
 
 ThreeVector TrackParticleFitObject::getTrackPcaVector() const {
-  updateCache(); 
+  updateNormalCache();
   return trackPcaVector;
 }
 
 double TrackParticleFitObject::getDPx(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
   //  if (!cachevalid) 
-  updateCache();
+  updateMomentumCache();
   return getMomentumFirstDerivatives(1, ilocal);
 }
 
 double TrackParticleFitObject::getDPy(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  //  if (!cachevalid) updateCache();
-  updateCache();
+  //  if (!cachevalid) updateCacheTraced();
+  updateMomentumCache();
   return getMomentumFirstDerivatives(2, ilocal);
 }
 
 double TrackParticleFitObject::getDPz(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
   //if (!cachevalid) 
-  updateCache();
+  updateMomentumCache();
   return getMomentumFirstDerivatives(3, ilocal);
 }
 
 double TrackParticleFitObject::getDE(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
   //  if (!cachevalid) 
-  updateCache();
+  updateMomentumCache();
   return getMomentumFirstDerivatives(0, ilocal);
 }
 
@@ -304,13 +244,14 @@ double TrackParticleFitObject::getFirstDerivative_Meta_Local( int iMeta, int ilo
   // iMeta = intermediate variable (i.e. E,px,py,pz)
   // ilocal = local variable (ptinv, theta, phi)
   // metaSet = which set of intermediate varlables
-  //if (!cachevalid) 
-  updateCache();
+  // only the derivatives of this set are calculated
   switch ( metaSet ) {
   case BaseDefs::VARBASIS_EPXYZ:
+    updateMomentumCache();
     return getMomentumFirstDerivatives(iMeta, ilocal);
     break;
   case BaseDefs::VARBASIS_TRKNORMAL:
+    updateNormalCache();
     return getNormalFirstDerivatives(iMeta, ilocal);
     break;
 
@@ -323,13 +264,13 @@ double TrackParticleFitObject::getFirstDerivative_Meta_Local( int iMeta, int ilo
 }
 
 double TrackParticleFitObject::getSecondDerivative_Meta_Local( int iMeta, int ilocal , int jlocal , int metaSet ) const {
-  //  if (!cachevalid) 
-  updateCache();
   switch ( metaSet ) {
   case BaseDefs::VARBASIS_EPXYZ:
+    updateMomentumCache();
     return getMomentumSecondDerivatives(iMeta, ilocal, jlocal);
     break;
   case BaseDefs::VARBASIS_TRKNORMAL:
+    updateNormalCache();
     return getNormalSecondDerivatives(iMeta, ilocal, jlocal);
     break;
 
@@ -372,7 +313,7 @@ void TrackParticleFitObject::updateCache() const {
 
   //  cout <<  getParam(iPhi0 ) << " " <<  getParam(iOmega) << " " <<  getParam(iTanL ) << " " <<  getParam(iD0   ) << " " <<  getParam(iZ0   ) << " " << getParam(iStart) << endl;
 
-  double aB = omega_pt_conv*getBfield();
+  double aB = omega_pt_conv*getTrackBfield();
   double pt = aB/fabs( omega );
   double p  = pt * sqrt ( 1 + pow( tanl, 2 ) );
 
@@ -418,30 +359,43 @@ void TrackParticleFitObject::updateCache() const {
   //  cout << "TrackParticleFitObject::updateCache : FourMomentum = " << fourMomentum << endl;
   //  cout << "TrackParticleFitObject::updateCache() inter1: " << chi2 << " " << phi0 << " " << omega << " " << tanl << " " << d0 << " " << z0 << endl;
 
-  updateNormalDerivatives();
+  // the derivatives are calculated when they are used:
+  // fits with only constraints on the four-momenta need only the momentum derivatives
+  momentumDerivativesValid   = false;
+  normalDerivativesValid     = false;
+  trajectoryDerivativesValid = false;
 
-  //  cout << "TrackParticleFitObject::updateCache() inter2: " << chi2 << " " << phi0 << " " << omega << " " << tanl << " " << d0 << " " << z0 << endl;
+  cachevalid = true;
 
-  updateMomentumDerivatives();
+  //  cout << "... updated cache " << cachevalid << endl;
 
-  //  cout << "TrackParticleFitObject::updateCache() inter3: " << chi2 << " " << phi0 << " " << omega << " " << tanl << " " << d0 << " " << z0 << endl;
+  return;
+}
 
-  updateTrajectoryDerivatives();
+void TrackParticleFitObject::updateMomentumCache() const {
+  updateCache();
+  if ( momentumDerivativesValid ) return;
+  updateMomentumDerivatives();
+  momentumDerivativesValid = true;
+}
 
-  //  cout << "TrackParticleFitObject::updateCache() done: " << chi2 << " " << phi0 << " " << omega << " " << tanl << " " << d0 << " " << z0 << endl;
-  //  cout <<  getParam(iPhi0 ) << " " <<  getParam(iOmega) << " " <<  getParam(iTanL ) << " " <<  getParam(iD0   ) << " " <<  getParam(iZ0   ) << " " << getParam(iStart) << endl;
+void TrackParticleFitObject::updateNormalCache() const {
+  updateCache();
+  if ( normalDerivativesValid ) return;
+  updateNormalDerivatives();
   //  cout << "Normal vector = " << trackPlaneNormal << " " << trackPlaneNormal.getMag() << endl;
+  normalDerivativesValid = true;
+}
 
-  cachevalid = true;
-
-  //  cout << "... updated cache " << cachevalid << endl;
-
-  return;
+void TrackParticleFitObject::updateTrajectoryCache() const {
+  updateCache();
+  if ( trajectoryDerivativesValid ) return;
+  updateTrajectoryDerivatives();
+  trajectoryDerivativesValid = true;
 }
 
 void TrackParticleFitObject::updateTrajectoryDerivatives() const {
   resetTrajectoryFirstDerivatives();
-  resetTrajectorySecondDerivatives();
 
 //  cout << "hello from updateTrajectoryDerivatives" << endl;
 //  cout <<  "parameters: " << getParam(iPhi0 ) << " " <<  getParam(iOmega) << " " <<  getParam(iTanL ) << " " <<  
@@ -489,14 +443,10 @@ void TrackParticleFitObject::updateTrajectoryDerivatives() const {
     int iPoint  = iss==0 ? iStart : iEnd ;
 
     double interFirstDerivs [nInt][NPAR];
-    double interSecondDerivs[nInt][NPAR][NPAR];
 
     for (int i=0; i<nInt; i++) {
       for (int j=0; j<NPAR; j++) {
 	interFirstDerivs[i][j]=0;
-	for (int k=0; k<NPAR; k++) {
-	  interSecondDerivs[i][j][k]=0;
-	}
       }
     }
 
@@ -515,14 +465,12 @@ void TrackParticleFitObject::updateTrajectoryDerivatives() const {
     //   cout << endl;
     // }
 
+    // only the first derivatives are calculated: no constraint uses the second ones,
+    // which are given in the comments for reference
     double trajectoryInterFirstDerivs[nVars][nInt];
-    double trajectoryInterSecondDerivs[nVars][nInt][nInt];
     for (int i=0; i<nVars; i++) {
       for (int j=0; j<nInt; j++) {
 	trajectoryInterFirstDerivs[i][j]=0;
-	for (int k=0; k<nInt; k++) {
-	  trajectoryInterSecondDerivs[i][j][k]=0;
-	}
       }
     }
 
@@ -564,27 +512,6 @@ d2x/dWdW = (-2 S W Cos[P - S W] + 2 Sin[P] + (-2 + S^2 W^2) Sin[P - S W])/W^3
     trajectoryInterFirstDerivs[0][int_S]         = cos(PmSW);
     trajectoryInterFirstDerivs[0][int_W]         = (S*W*cos(PmSW) - sin(P) + sin(PmSW))/pow(W,2);
 
-    trajectoryInterSecondDerivs[0][int_D][int_D] = 0;
-    trajectoryInterSecondDerivs[0][int_D][int_P] = cos(P);
-    trajectoryInterSecondDerivs[0][int_D][int_S] = 0;
-    trajectoryInterSecondDerivs[0][int_D][int_W] = 0;
-
-    trajectoryInterSecondDerivs[0][int_P][int_D] = cos(P);
-    trajectoryInterSecondDerivs[0][int_P][int_P] = (-(1 + D*W)*sin(P) + sin(PmSW))/W;
-    trajectoryInterSecondDerivs[0][int_P][int_S] = -sin(PmSW);
-    trajectoryInterSecondDerivs[0][int_P][int_W] = -((cos(P) - cos(PmSW) + S*W*sin(PmSW))/pow(W,2));
-
-    trajectoryInterSecondDerivs[0][int_S][int_D] = 0;
-    trajectoryInterSecondDerivs[0][int_S][int_P] =  -sin(PmSW);
-    trajectoryInterSecondDerivs[0][int_S][int_S] = W*sin(PmSW);
-    trajectoryInterSecondDerivs[0][int_S][int_W] = S*sin(PmSW);
-
-    trajectoryInterSecondDerivs[0][int_W][int_D] = 0;
-    trajectoryInterSecondDerivs[0][int_W][int_P] = -((cos(P) - cos(PmSW) + S*W*sin(PmSW))/pow(W,2));
-    trajectoryInterSecondDerivs[0][int_W][int_S] = S*sin(PmSW);
-    trajectoryInterSecondDerivs[0][int_W][int_W] = ( -2*S*W*cos(PmSW) + 2*sin(P) + (-2 + pow(S,2)*pow(W,2))*sin(PmSW) ) / pow(W,3);
-
-
     /*
 
 y        = Y + D Cos[P] + (2 Sin[(S W)/2] Sin[P - (S W)/2])/W
@@ -621,26 +548,6 @@ d2y/dWdW = (-2 Cos[P] + (2 - S^2 W^2) Cos[P - S W] - 2 S W Sin[P - S W])/W^3
     trajectoryInterFirstDerivs[1][int_S]         =  sin(PmSW);
     trajectoryInterFirstDerivs[1][int_W]         =  (cos(P) - cos(PmSW) + S*W*sin(PmSW))/pow(W,2);
                                                                                                                  
-    trajectoryInterSecondDerivs[1][int_D][int_D] =  0;
-    trajectoryInterSecondDerivs[1][int_D][int_P] =  -sin(P);
-    trajectoryInterSecondDerivs[1][int_D][int_S] =  0;
-    trajectoryInterSecondDerivs[1][int_D][int_W] =  0;
-                                                                                                                 
-    trajectoryInterSecondDerivs[1][int_P][int_D] =  -sin(P);
-    trajectoryInterSecondDerivs[1][int_P][int_P] =  -(((-1 + D*W)*cos(P) + cos(PmSW))/W);
-    trajectoryInterSecondDerivs[1][int_P][int_S] =  cos(PmSW);
-    trajectoryInterSecondDerivs[1][int_P][int_W] =  (S*W*cos(PmSW) - sin(P) + sin(PmSW))/pow(W,2);
-     
-    trajectoryInterSecondDerivs[1][int_S][int_D] =  0;
-    trajectoryInterSecondDerivs[1][int_S][int_P] =  cos(PmSW); 
-    trajectoryInterSecondDerivs[1][int_S][int_S] =  -W*cos(PmSW);
-    trajectoryInterSecondDerivs[1][int_S][int_W] =  -S*cos(PmSW);
-
-    trajectoryInterSecondDerivs[1][int_W][int_D] =  0;
-    trajectoryInterSecondDerivs[1][int_W][int_P] =  (S*W*cos(PmSW) - sin(P) + sin(PmSW))/pow(W,2);
-    trajectoryInterSecondDerivs[1][int_W][int_S] =  -S*cos(PmSW);
-    trajectoryInterSecondDerivs[1][int_W][int_W] =  (-2*cos(P) + (2 - pow(S,2)*pow(W,2))*cos(PmSW) - 2*S*W*sin(PmSW))/pow(W,3);
-
     /*
 
 z = R + S T + Z
@@ -667,18 +574,6 @@ d2z/dTdT = 0
     trajectoryInterFirstDerivs[2][int_S] = T;
     trajectoryInterFirstDerivs[2][int_T] = S;
 
-    trajectoryInterSecondDerivs[2][int_Z][int_Z] = 0;
-    trajectoryInterSecondDerivs[2][int_Z][int_S] = 0;
-    trajectoryInterSecondDerivs[2][int_Z][int_T] = 0;
-
-    trajectoryInterSecondDerivs[2][int_S][int_Z] = 0;
-    trajectoryInterSecondDerivs[2][int_S][int_S] = 0;
-    trajectoryInterSecondDerivs[2][int_S][int_T] = 1;
-
-    trajectoryInterSecondDerivs[2][int_T][int_Z] = 0;
-    trajectoryInterSecondDerivs[2][int_T][int_S] = 1;
-    trajectoryInterSecondDerivs[2][int_T][int_T] = 0;
-
     // cout << "trajectoryInterFirstDerivs" << endl;
     // for (int i=0; i<nVars; i++) {
     //   for (int j=0; j<nInt; j++) {
@@ -705,22 +600,6 @@ d2z/dTdT = 0
 	} else {
 	  assert(0);
 	}
-
-	// the second derivs
-	for (int jpar=0; jpar<NPAR; jpar++) {
-	  double dd2(0);
-	  for (int j=0; j<nInt; j++) {
-	    dd2+=trajectoryInterFirstDerivs[ipe][j]*interSecondDerivs[j][ipar][jpar];
-	    for (int k=0; k<nInt; k++) {
-	      dd2+=trajectoryInterSecondDerivs[ipe][j][k]*interFirstDerivs[j][ipar]*interFirstDerivs[k][jpar];
-	    }
-	  }
-	  if ( iss==0 ) {
-	    setTrajectoryStartSecondDerivatives(ipe, ipar, jpar, dd2);	
-	  } else {
-	    setTrajectoryEndSecondDerivatives(ipe, ipar, jpar, dd2);	
-	  }
-	}
       }
     }
 
@@ -790,7 +669,7 @@ void TrackParticleFitObject::updateMomentumDerivatives() const {
 
   // track vars: iD0=0, iPhi0, iOmega, iZ0, iTanL, NPAR
 
-  double aB = omega_pt_conv*getBfield();
+  double aB = omega_pt_conv*getTrackBfield();
   double pt = aB/fabs( omega );
   double p  = pt * sqrt ( 1 + pow( tanl, 2 ) );
   double e = sqrt( p*p + mass*mass );
@@ -942,8 +821,8 @@ void TrackParticleFitObject::updateMomentumDerivatives() const {
 	dd+=momentumInterFirstDerivs[ipe][j]*interFirstDerivs[j][ipar];
       }
       setMomentumFirstDerivatives(ipe, ipar, dd);
-      // the second derivs
-      for (int jpar=0; jpar<NPAR; jpar++) {
+      // the second derivs; symmetric, so only jpar <= ipar
+      for (int jpar=0; jpar<=ipar; jpar++) {
 	double dd2(0);
 	for (int j=0; j<nInt; j++) {
 	  dd2+=momentumInterFirstDerivs[ipe][j]*interSecondDerivs[j][ipar][jpar];
@@ -1047,6 +926,8 @@ void TrackParticleFitObject::updateNormalDerivatives() const {
   ABCderivs[0][iTanL ]= y + d0*cos(phi0);
   ABCderivs[0][iD0   ]= cos(phi0)*tanl;
   ABCderivs[0][iZ0   ]= -sin(phi0);
+  ABCderivs[0][iStart]= 0;
+  ABCderivs[0][iEnd  ]= 0;
 
   for (int i=0; i<3; i++)
     for (int j=0; j<NPAR; j++)
@@ -1071,6 +952,8 @@ void TrackParticleFitObject::updateNormalDerivatives() const {
   ABCderivs[1][iTanL ]= -(x-d0*sin(phi0));
   ABCderivs[1][iD0   ]= sin(phi0)*tanl;
   ABCderivs[1][iZ0   ]= cos(phi0);
+  ABCderivs[1][iStart]= 0;
+  ABCderivs[1][iEnd  ]= 0;
 
   ABCsecondderivs[1][iPhi0 ][iPhi0 ] = -(z+z0)*cos(phi0) - d0*sin(phi0)*tanl;
   ABCsecondderivs[1][iPhi0 ][iTanL ] = d0*cos(phi0);
@@ -1091,6 +974,8 @@ void TrackParticleFitObject::updateNormalDerivatives() const {
   ABCderivs[2][iTanL ]= 0;
   ABCderivs[2][iD0   ]= -1;
   ABCderivs[2][iZ0   ]= 0;
+  ABCderivs[2][iStart]= 0;
+  ABCderivs[2][iEnd  ]= 0;
 
   ABCsecondderivs[2][iPhi0 ][iPhi0 ] = -x*sin(phi0) + y*cos(phi0);
 
@@ -1149,7 +1034,7 @@ void TrackParticleFitObject::updateNormalDerivatives() const {
 
 
   for (int i=0; i<NPAR; i++) { // <-- the object's parameters1
-    for (int j=0; j<NPAR; j++) { // <-- the object's parameters2
+    for (int j=0; j<=i; j++) { // <-- the object's parameters2 (symmetric, so only j <= i)
       for (int m=0; m<3; m++) { // <-- three vector
         double sumtot(0);
         for (int k=0; k<3; k++) { // <-- sum over intermediate ABC params
@@ -1174,8 +1059,7 @@ void TrackParticleFitObject::setNormalFirstDerivatives(int i, int j, double x) c
 
 void TrackParticleFitObject::setNormalSecondDerivatives(int i, int j, int k, double x) const {
   assert ( i>=0 && i<3 && j>=0 && j<NPAR && k>=0 && k<NPAR);
-  normalSecondDerivatives[i][j][k]=x * parfact[j] * parfact[k];
-  normalSecondDerivatives[i][k][j]=normalSecondDerivatives[i][j][k];
+  normalSecondDerivatives[i][symIndex(j,k)]=x * parfact[j] * parfact[k];
 }
 
 void TrackParticleFitObject::setMomentumFirstDerivatives(int i, int j, double x) const {
@@ -1185,8 +1069,7 @@ void TrackParticleFitObject::setMomentumFirstDerivatives(int i, int j, double x)
 
 void TrackParticleFitObject::setMomentumSecondDerivatives(int i, int j, int k, double x) const {
   assert ( i>=0 && i<4 && j>=0 && j<NPAR && k>=0 && k<NPAR);
-  momentumSecondDerivatives[i][j][k]=x * parfact[j] * parfact[k];
-  momentumSecondDerivatives[i][k][j]=momentumSecondDerivatives[i][j][k];
+  momentumSecondDerivatives[i][symIndex(j,k)]=x * parfact[j] * parfact[k];
 }
 
 void TrackParticleFitObject::setTrajectoryStartFirstDerivatives(int i, int j, double x) const {
@@ -1194,23 +1077,11 @@ void TrackParticleFitObject::setTrajectoryStartFirstDerivatives(int i, int j, do
   trajectoryStartFirstDerivatives[i][j]=x * parfact[j];
 }
 
-void TrackParticleFitObject::setTrajectoryStartSecondDerivatives(int i, int j, int k, double x) const {
-  assert ( i>=0 && i<3 && j>=0 && j<NPAR && k>=0 && k<NPAR);
-  trajectoryStartSecondDerivatives[i][j][k]=x * parfact[j] * parfact[k];
-  trajectoryStartSecondDerivatives[i][k][j]=trajectoryStartSecondDerivatives[i][j][k];
-}
-
 void TrackParticleFitObject::setTrajectoryEndFirstDerivatives(int i, int j, double x) const {
   assert ( i>=0 && i<3 && j>=0 && j<NPAR );
   trajectoryEndFirstDerivatives[i][j]=x * parfact[j];
 }
 
-void TrackParticleFitObject::setTrajectoryEndSecondDerivatives(int i, int j, int k, double x) const {
-  assert ( i>=0 && i<3 && j>=0 && j<NPAR && k>=0 && k<NPAR);
-  trajectoryEndSecondDerivatives[i][j][k]=x * parfact[j] * parfact[k];
-  trajectoryEndSecondDerivatives[i][k][j]=trajectoryEndSecondDerivatives[i][j][k];
-}
-
 double TrackParticleFitObject::getNormalFirstDerivatives(int i, int j) const {
   assert ( i>=0 && i<3 && j>=0 && j<NPAR );
   return normalFirstDerivatives[i][j];
@@ -1218,7 +1089,7 @@ double TrackParticleFitObject::getNormalFirstDerivatives(int i, int j) const {
 
 double TrackParticleFitObject::getNormalSecondDerivatives(int i, int j, int k) const {
   assert ( i>=0 && i<3 && j>=0 && j<NPAR && k>=0 && k<NPAR);
-  return normalSecondDerivatives[i][j][k];
+  return normalSecondDerivatives[i][symIndex(j,k)];
 }
 
 double TrackParticleFitObject::getMomentumFirstDerivatives(int i, int j) const {
@@ -1228,7 +1099,7 @@ double TrackParticleFitObject::getMomentumFirstDerivatives(int i, int j) const {
 
 double TrackParticleFitObject::getMomentumSecondDerivatives(int i, int j, int k) const {
   assert ( i>=0 && i<4 && j>=0 && j<NPAR && k>=0 && k<NPAR);
-  return momentumSecondDerivatives[i][j][k];
+  return momentumSecondDerivatives[i][symIndex(j,k)];
 }
 
 double TrackParticleFitObject::getTrajectoryStartFirstDerivatives(int i, int j) const {
@@ -1236,21 +1107,11 @@ double TrackParticleFitObject::getTrajectoryStartFirstDerivatives(int i, int j)
   return trajectoryStartFirstDerivatives[i][j];
 }
 
-double TrackParticleFitObject::getTrajectoryStartSecondDerivatives(int i, int j, int k) const {
-  assert ( i>=0 && i<3 && j>=0 && j<NPAR && k>=0 && k<NPAR);
-  return trajectoryStartSecondDerivatives[i][j][k];
-}
-
 double TrackParticleFitObject::getTrajectoryEndFirstDerivatives(int i, int j) const {
   assert ( i>=0 && i<3 && j>=0 && j<NPAR );
   return trajectoryEndFirstDerivatives[i][j];
 }
 
-double TrackParticleFitObject::getTrajectoryEndSecondDerivatives(int i, int j, int k) const {
-  assert ( i>=0 && i<3 && j>=0 && j<NPAR && k>=0 && k<NPAR);
-  return trajectoryEndSecondDerivatives[i][j][k];
-}
-
 void TrackParticleFitObject::resetMomentumFirstDerivatives() const {
   for (int i=0; i<4; i++)
     for (int j=0; j<NPAR; j++)
@@ -1259,9 +1120,8 @@ void TrackParticleFitObject::resetMomentumFirstDerivatives() const {
 }
 void TrackParticleFitObject::resetMomentumSecondDerivatives() const {
   for (int i=0; i<4; i++)
-    for (int j=0; j<NPAR; j++)
-      for (int k=0; k<NPAR; k++)
-        momentumSecondDerivatives[i][j][k]=0;
+    for (int j=0; j<NSYM; j++)
+      momentumSecondDerivatives[i][j]=0;
   return;
 }
 
@@ -1273,15 +1133,6 @@ void TrackParticleFitObject::resetTrajectoryFirstDerivatives() const {
     }
   return;
 }
-void TrackParticleFitObject::resetTrajectorySecondDerivatives() const {
-  for (int i=0; i<3; i++)
-    for (int j=0; j<NPAR; j++)
-      for (int k=0; k<NPAR; k++) {
-        trajectoryStartSecondDerivatives[i][j][k]=0;
-        trajectoryEndSecondDerivatives[i][j][k]=0;
-      }
-  return;
-}
 
 void TrackParticleFitObject::resetNormalFirstDerivatives() const {
   for (int i=0; i<3; i++)
@@ -1292,13 +1143,12 @@ void TrackParticleFitObject::resetNormalFirstDerivatives() const {
 
 void TrackParticleFitObject::resetNormalSecondDerivatives() const {
   for (int i=0; i<3; i++)
-    for (int j=0; j<NPAR; j++)
-      for (int k=0; k<NPAR; k++)
-        normalSecondDerivatives[i][j][k]=0;
+    for (int j=0; j<NSYM; j++)
+      normalSecondDerivatives[i][j]=0;
   return;
 }
 
-// B field in Tesla
+// global B field in Tesla
 double TrackParticleFitObject::bfield = 3.5;
 
 double TrackParticleFitObject::setBfield (double bfield_) {
@@ -1310,6 +1160,16 @@ double TrackParticleFitObject::getBfield () {
   return bfield;
 }
 
+double TrackParticleFitObject::setTrackBfield (double bfield_) {
+  invalidateCache();
+  useTrackBfield = true;
+  return trackBfield = bfield_;
+}
+
+double TrackParticleFitObject::getTrackBfield () const {
+  return useTrackBfield ? trackBfield : bfield;
+}
+
 int TrackParticleFitObject::getCharge() const {
   updateCache(); 
   return omega>0 ? 1 : -1;
@@ -1431,7 +1291,7 @@ ThreeVector TrackParticleFitObject::getVertexDerivative (int ivertex,       ///<
 							 int ilocal         ///< Local parameter number
 							 ) const { 
 
-  updateCache();
+  updateTrajectoryCache();
 
   ThreeVector vtxDer(0,0,0);
 
@@ -0,0 +1,85 @@
+/*! \file
+ *  \brief Implements the LCIO constructors of class TrackParticleFitObject
+ *
+ * These constructors are part of the LCIO adapter library,
+ * so that the core library does not depend on LCIO.
+ *
+ * \b Changelog:
+ * - 16.10.2026 First version, moved here from TrackParticleFitObject.cc
+ *
+ */
+
+#include "TrackParticleFitObject.h"
+
+#include "EVENT/TrackState.h"
+#include "EVENT/Track.h"
+
+TrackParticleFitObject::TrackParticleFitObject( const EVENT::Track* trk, double m) 
+  : ParticleFitObject (paramstorage), trackReferencePoint( ThreeVector(0,0,0) ),
+    trackPlaneNormal( ThreeVector(0,0,0) ),
+    trackPcaVector( ThreeVector(0,0,0) ),
+    trajectoryPointAtPCA( ThreeVector(0,0,0) ),
+    trajectoryPointAtStart( ThreeVector(0,0,0) ),
+    trajectoryPointAtEnd( ThreeVector(0,0,0) ),
+    momentumAtPCA( ThreeVector(0,0,0) ),
+    momentumAtStart( ThreeVector(0,0,0) ),
+    momentumAtEnd( ThreeVector(0,0,0) ),
+    phi0(0), omega(0), tanl(0), d0(0), z0(0), s_start(0), s_end(0), chi2(0),
+    momentumDerivativesValid(false), normalDerivativesValid(false), trajectoryDerivativesValid(false),
+    trackBfield(0), useTrackBfield(false)
+{
+  invalidateCache();
+
+  double ppar[NPAR];
+  ppar[ iD0    ] =  trk->getD0()       ;
+  ppar[ iPhi0  ] =  trk->getPhi()      ;
+  ppar[ iOmega ] =  trk->getOmega()    ;
+  ppar[ iZ0    ] =  trk->getZ0()       ;
+  ppar[ iTanL  ] =  trk->getTanLambda();
+  ppar[ iStart ] =  0; // this one is not measured
+  ppar[ iEnd   ] =  0; // this one is not measured
+
+  double ccov[15];
+  for (int i=0; i<15; i++) ccov[i]=trk->getCovMatrix()[i];
+
+  trackReferencePoint.setValues( trk->getReferencePoint()[0],
+                                 trk->getReferencePoint()[1],
+                                 trk->getReferencePoint()[2] );
+
+  initialise( ppar , ccov, m );
+}
+
+TrackParticleFitObject::TrackParticleFitObject( const EVENT::TrackState* trk, double m) 
+  : ParticleFitObject (paramstorage), trackReferencePoint( ThreeVector(0,0,0) ),
+    trackPlaneNormal( ThreeVector(0,0,0) ),
+    trackPcaVector( ThreeVector(0,0,0) ),
+    trajectoryPointAtPCA( ThreeVector(0,0,0) ),
+    trajectoryPointAtStart( ThreeVector(0,0,0) ),
+    trajectoryPointAtEnd( ThreeVector(0,0,0) ),
+    momentumAtPCA( ThreeVector(0,0,0) ),
+    momentumAtStart( ThreeVector(0,0,0) ),
+    momentumAtEnd( ThreeVector(0,0,0) ),
+    phi0(0), omega(0), tanl(0), d0(0), z0(0), s_start(0), s_end(0), chi2(0),
+    momentumDerivativesValid(false), normalDerivativesValid(false), trajectoryDerivativesValid(false),
+    trackBfield(0), useTrackBfield(false)
+{
+  invalidateCache();
+
+  double ppar[NPAR];
+  ppar[ iD0    ] =  trk->getD0()       ;
+  ppar[ iPhi0  ] =  trk->getPhi()      ;
+  ppar[ iOmega ] =  trk->getOmega()    ;
+  ppar[ iZ0    ] =  trk->getZ0()       ;
+  ppar[ iTanL  ] =  trk->getTanLambda();
+  ppar[ iStart ] =  0; // this one is not measured
+  ppar[ iEnd   ] =  0; // this one is not measured
+
+  double ccov[15];
+  for (int i=0; i<15; i++) ccov[i]=trk->getCovMatrix()[i];
+
+  trackReferencePoint.setValues( trk->getReferencePoint()[0],
+                                 trk->getReferencePoint()[1],
+                                 trk->getReferencePoint()[2] );
+
+  initialise( ppar , ccov, m );
+}
@@ -41,7 +41,7 @@ VertexFitObject::VertexFitObject(const char *name_,
                                  double y,
                                  double z
                                 )
-: tracks (0), constraints (0)
+: BaseFitObject (paramstorage), tracks (0), constraints (0)
 {
 
   assert( int(NPAR) <= int(BaseDefs::MAXPAR) );
@@ -57,7 +57,8 @@ VertexFitObject::VertexFitObject(const char *name_,
 
 }
 
-VertexFitObject::VertexFitObject (const VertexFitObject& rhs) 
+VertexFitObject::VertexFitObject (const VertexFitObject& rhs)
+  : BaseFitObject (paramstorage)
 {
   //  copy (rhs);
   VertexFitObject::assign (rhs);
@@ -23,7 +23,7 @@ using std::endl;
 // constructor
 ZinvisibleFitObject::ZinvisibleFitObject(double E, double theta, double phi, 
 					 double DE, double Dtheta, double Dphi, double m) 
-  : cachevalid(false), ctheta(0), stheta(0), cphi(0), sphi(0),p2(0), p(0), dpdE(0), pt(0), px(0), py(0), pz(0), dptdE(0),
+  : ParticleFitObject (paramstorage), cachevalid(false), ctheta(0), stheta(0), cphi(0), sphi(0),p2(0), p(0), dpdE(0), pt(0), px(0), py(0), pz(0), dptdE(0),
     dpxdE(0), dpydE(0), dpxdtheta(0), dpydtheta(0), chi2(0)
 
 {  //hier double m
@@ -43,7 +43,7 @@ ZinvisibleFitObject::ZinvisibleFitObject(double E, double theta, double phi,
 ZinvisibleFitObject::~ZinvisibleFitObject() {}
 
 ZinvisibleFitObject::ZinvisibleFitObject (const ZinvisibleFitObject& rhs)
-  : cachevalid(false), ctheta(0), stheta(0), cphi(0), sphi(0),p2(0), p(0), dpdE(0), pt(0), px(0), py(0), pz(0), dptdE(0),
+  : ParticleFitObject (paramstorage), cachevalid(false), ctheta(0), stheta(0), cphi(0), sphi(0),p2(0), p(0), dpdE(0), pt(0), px(0), py(0), pz(0), dptdE(0),
     dpxdE(0), dpydE(0), dpxdtheta(0), dpydtheta(0), chi2(0)
 {
   //std::cout << "copying ZinvisibleFitObject with name" << rhs.name << std::endl;
@@ -129,15 +129,15 @@ bool ZinvisibleFitObject::updateParams (double pp[], int idim) {
 
 // these depend on actual parametrisation!
 double ZinvisibleFitObject::getPx() const {
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   return px;
 }
 double ZinvisibleFitObject::getPy() const {
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   return py;
 }
 double ZinvisibleFitObject::getPz() const {
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   return pz;
 }
 double ZinvisibleFitObject::getE() const {
@@ -145,26 +145,26 @@ double ZinvisibleFitObject::getE() const {
 }
 
 double ZinvisibleFitObject::getP() const {
-    if (!cachevalid) updateCache();
+    if (!cachevalid) updateCacheTraced();
     return p; 
 }
 
 double ZinvisibleFitObject::getP2() const {
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
    return p2; 
 }
 double ZinvisibleFitObject::getPt() const {
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   return pt;
 }
 double ZinvisibleFitObject::getPt2() const {
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   return pt*pt;
 }
 
 double ZinvisibleFitObject::getDPx(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
     case 0: return dpxdE;
     case 1: return dpxdtheta;
@@ -175,7 +175,7 @@ double ZinvisibleFitObject::getDPx(int ilocal) const {
 
 double ZinvisibleFitObject::getDPy(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
     case 0: return dpydE;
     case 1: return dpydtheta;
@@ -186,7 +186,7 @@ double ZinvisibleFitObject::getDPy(int ilocal) const {
 
 double ZinvisibleFitObject::getDPz(int ilocal) const {
   assert (ilocal >= 0 && ilocal < NPAR);
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
   switch (ilocal) {
     case 0: return ctheta;
     case 1: return -pt;
@@ -233,7 +233,7 @@ double ZinvisibleFitObject::getFirstDerivative_Meta_Local( int iMeta, int ilocal
 
 double ZinvisibleFitObject::getSecondDerivative_Meta_Local( int iMeta, int ilocal , int jlocal , int metaSet ) const {
   assert ( metaSet==0 );
-  if (!cachevalid) updateCache();
+  if (!cachevalid) updateCacheTraced();
 
   if ( jlocal<ilocal ) {
     int temp=jlocal;